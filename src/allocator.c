@@ -0,0 +1,34 @@
+#include "allocator.h"
+#include "context.h"
+
+/**
+ * Resizes a block with an allocator (realloc() / free() if it has no function).
+ *
+ * @param allocator The allocator (NULL = realloc() / free()).
+ * @param memory    The block (NULL = allocate a new one).
+ * @param size      The new size in bytes (0 = free the block).
+ * @return          The resized block, or NULL if freed or on failure (the block stays valid then).
+ */
+void *reallocateWith(const MilkyAllocator *allocator, void *memory, size_t size) {
+    if (allocator && allocator->reallocate) return allocator->reallocate(allocator->userData, memory, size);
+
+    if (size == 0) {
+        free(memory);
+        return NULL;
+    }
+    return realloc(memory, size);
+}
+
+/**
+ * Resizes a block with the allocator of a context (see reallocateWith()).
+ */
+void *reallocateContextMemory(MilkyContext *context, void *memory, size_t size) {
+    return reallocateWith(&context->options.allocator, memory, size);
+}
+
+/**
+ * Frees a block with the allocator of a context (NULL is ignored).
+ */
+void releaseContextMemory(MilkyContext *context, void *memory) {
+    if (memory) reallocateWith(&context->options.allocator, memory, 0);
+}
@@ -0,0 +1,14 @@
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "./milky.h"
+
+void *reallocateWith(const MilkyAllocator *allocator, void *memory, size_t size);
+void *reallocateContextMemory(MilkyContext *context, void *memory, size_t size);
+void releaseContextMemory(MilkyContext *context, void *memory);
+
+#endif // ALLOCATOR_H
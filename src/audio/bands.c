@@ -0,0 +1,223 @@
+#include "bands.h"
+#include "../context.h"
+
+static float frequencyToScale(MilkyContext *context, float frequency) {
+    return context->bands.scale == MILKY_BAND_SCALE_MEL ? 2595.0f * log10f(1.0f + frequency / 700.0f) : log2f(frequency);
+}
+
+static float scaleToFrequency(MilkyContext *context, float value) {
+    return context->bands.scale == MILKY_BAND_SCALE_MEL ? 700.0f * (powf(10.0f, value / 2595.0f) - 1.0f) : exp2f(value);
+}
+
+/**
+ * Configures the perceptual binning stage. The weight matrix is rebuilt lazily on the
+ * next update, so this can be called at any time.
+ *
+ * @param scale     Spacing of the band edges (logarithmic or mel).
+ * @param bandCount Number of bands (1 to MILKY_BANDS_MAX_COUNT).
+ * @param floorDb   Level that maps to 0.0 in the normalized output.
+ * @param ceilingDb Level that maps to 1.0 in the normalized output.
+ */
+void initializeSpectrumBands(MilkyContext *context, BandScale scale, size_t bandCount, float floorDb, float ceilingDb) {
+    if (bandCount == 0) bandCount = 1;
+    if (bandCount > MILKY_BANDS_MAX_COUNT) bandCount = MILKY_BANDS_MAX_COUNT;
+    if (ceilingDb <= floorDb) ceilingDb = floorDb + 1.0f;
+
+    context->bands.scale = scale;
+    context->bands.count = bandCount;
+    context->bands.floorDb = floorDb;
+    context->bands.ceilingDb = ceilingDb;
+
+    // force a rebuild of the weight matrix
+    context->bands.matrixBinCount = 0;
+    context->bands.matrixSampleRate = 0;
+}
+
+/**
+ * Releases the weight matrix (it is rebuilt on the next update).
+ */
+void destroySpectrumBands(MilkyContext *context) {
+    releaseContextMemory(context, context->bands.weights);
+    context->bands.weights = NULL;
+    context->bands.matrixBinCount = 0;
+    context->bands.matrixSampleRate = 0;
+}
+
+/**
+ * Builds the sparse weight matrix: one triangular filter per band between the
+ * neighboring band edges. Bands narrower than one FFT bin interpolate between the
+ * two bins around their center frequency.
+ *
+ * @param binCount   Number of magnitudes per spectrum (FFT size / 2).
+ * @param sampleRate Sample rate of the analyzed audio.
+ * @return           1 on success, 0 on allocation failure.
+ */
+static int buildBandMatrix(MilkyContext *context, size_t binCount, size_t sampleRate) {
+    const float binWidth = (float)sampleRate / (2.0f * (float)binCount);
+    const float nyquist = (float)sampleRate * 0.5f;
+    const float maxFrequency = MILKY_BANDS_MAX_FREQUENCY_HZ < nyquist ? MILKY_BANDS_MAX_FREQUENCY_HZ : nyquist;
+    const float low = frequencyToScale(context, MILKY_BANDS_MIN_FREQUENCY_HZ);
+    const float high = frequencyToScale(context, maxFrequency);
+    const float step = (high - low) / (float)(context->bands.count + 1);
+
+    // first pass: bin ranges (so the weight array can be allocated in one piece)
+    size_t totalWeights = 0;
+    for (size_t b = 0; b < context->bands.count; b++) {
+        float lower = scaleToFrequency(context, low + step * (float)b) / binWidth;
+        float upper = scaleToFrequency(context, low + step * (float)(b + 2)) / binWidth;
+        size_t first = (size_t)ceilf(lower);
+        size_t last = (size_t)floorf(upper);
+        if (last >= binCount) last = binCount - 1;
+
+        if (first > last) {
+            // narrower than one bin: interpolate between the bins around the center
+            float center = scaleToFrequency(context, low + step * (float)(b + 1)) / binWidth;
+            first = (size_t)floorf(center);
+            if (first >= binCount - 1) first = binCount - 2;
+            last = first + 1;
+        }
+
+        context->bands.rows[b].firstBin = first;
+        context->bands.rows[b].binCount = last - first + 1;
+        context->bands.rows[b].weightOffset = totalWeights;
+        totalWeights += context->bands.rows[b].binCount;
+    }
+
+    float *weights = (float *)reallocateContextMemory(context, context->bands.weights, totalWeights * sizeof(float));
+    if (!weights) {
+        fprintf(stderr, "Failed to allocate spectrum band weights\n");
+        return 0;
+    }
+    context->bands.weights = weights;
+
+    // second pass: triangular weights, peak 1.0 at the band center
+    for (size_t b = 0; b < context->bands.count; b++) {
+        const BandRow *row = &context->bands.rows[b];
+        float lower = scaleToFrequency(context, low + step * (float)b) / binWidth;
+        float center = scaleToFrequency(context, low + step * (float)(b + 1)) / binWidth;
+        float upper = scaleToFrequency(context, low + step * (float)(b + 2)) / binWidth;
+        float *rowWeights = &context->bands.weights[row->weightOffset];
+
+        context->bands.centerFrequencies[b] = center * binWidth;
+
+        if (floorf(upper) < ceilf(lower) || row->binCount == 2) {
+            float fraction = center - (float)row->firstBin;
+            if (fraction < 0.0f) fraction = 0.0f;
+            if (fraction > 1.0f) fraction = 1.0f;
+            rowWeights[0] = 1.0f - fraction;
+            rowWeights[1] = fraction;
+            for (size_t i = 2; i < row->binCount; i++) rowWeights[i] = 0.0f;
+            continue;
+        }
+
+        for (size_t i = 0; i < row->binCount; i++) {
+            float bin = (float)(row->firstBin + i);
+            float weight = bin <= center ? (bin - lower) / (center - lower) : (upper - bin) / (upper - center);
+            rowWeights[i] = weight < 0.0f ? 0.0f : weight;
+        }
+    }
+
+    context->bands.matrixBinCount = binCount;
+    context->bands.matrixSampleRate = sampleRate;
+    return 1;
+}
+
+/**
+ * Computes the weighted power of one band: sum of weight * magnitude^2 over the
+ * band's contiguous bins.
+ *
+ * @param magnitudes Magnitude spectrum.
+ * @param row        The band's row of the sparse matrix.
+ * @return           Band power (1.0 = full-scale sine).
+ */
+static float applyBandRow(MilkyContext *context, const float *magnitudes, const BandRow *row) {
+    const float *bins = &magnitudes[row->firstBin];
+    const float *weights = &context->bands.weights[row->weightOffset];
+    const size_t count = row->binCount;
+    size_t i = 0;
+    float power = 0.0f;
+
+#if defined(__AVX2__) && defined(__FMA__)
+    __m256 sum = _mm256_setzero_ps();
+    for (; i + 8 <= count; i += 8) {
+        __m256 magnitude = _mm256_loadu_ps(&bins[i]);
+        sum = _mm256_fmadd_ps(_mm256_mul_ps(magnitude, magnitude), _mm256_loadu_ps(&weights[i]), sum);
+    }
+    __m128 half = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+    half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+    half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+    power = _mm_cvtss_f32(half);
+#elif defined(__ARM_NEON__)
+    float32x4_t sum = vdupq_n_f32(0.0f);
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t magnitude = vld1q_f32(&bins[i]);
+        sum = vmlaq_f32(sum, vmulq_f32(magnitude, magnitude), vld1q_f32(&weights[i]));
+    }
+    float32x2_t pair = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+    power = vget_lane_f32(vpadd_f32(pair, pair), 0);
+#endif
+
+    for (; i < count; i++) {
+        power += bins[i] * bins[i] * weights[i];
+    }
+    return power;
+}
+
+/**
+ * Maps a magnitude spectrum onto the perceptual bands. Rebuilds the weight matrix
+ * whenever the FFT size or the sample rate changes.
+ *
+ * @param magnitudes Magnitude spectrum (for example the newest spectrogram frame), may be NULL.
+ * @param binCount   Number of magnitudes.
+ * @param sampleRate Sample rate of the analyzed audio.
+ */
+void updateSpectrumBands(MilkyContext *context, const float *magnitudes, size_t binCount, size_t sampleRate) {
+    if (!magnitudes || binCount < 2) return;
+
+    if (binCount != context->bands.matrixBinCount || sampleRate != context->bands.matrixSampleRate) {
+        if (!buildBandMatrix(context, binCount, sampleRate)) return;
+    }
+
+    const float range = context->bands.ceilingDb - context->bands.floorDb;
+    for (size_t b = 0; b < context->bands.count; b++) {
+        float power = applyBandRow(context, magnitudes, &context->bands.rows[b]);
+        float db = 10.0f * log10f(power + 1e-12f);
+
+        // clamp to the configured range
+        db = db < context->bands.floorDb ? context->bands.floorDb : (db > context->bands.ceilingDb ? context->bands.ceilingDb : db);
+        context->bands.db[b] = db;
+        context->bands.levels[b] = (db - context->bands.floorDb) / range;
+    }
+}
+
+/**
+ * Returns the band levels in dB, clamped to [floor, ceiling].
+ *
+ * @param bandCount Receives the number of bands (may be NULL).
+ * @return          Pointer to the band levels of the newest update.
+ */
+const float *getSpectrumBandsDb(MilkyContext *context, size_t *bandCount) {
+    if (bandCount) *bandCount = context->bands.count;
+    return context->bands.db;
+}
+
+/**
+ * Returns the band levels normalized to [0, 1] (floor to ceiling).
+ *
+ * @param bandCount Receives the number of bands (may be NULL).
+ * @return          Pointer to the normalized band levels of the newest update.
+ */
+const float *getSpectrumBandLevels(MilkyContext *context, size_t *bandCount) {
+    if (bandCount) *bandCount = context->bands.count;
+    return context->bands.levels;
+}
+
+/**
+ * Returns the center frequency of a band in Hz (0 before the first update).
+ *
+ * @param band Index of the band.
+ * @return     Center frequency of the band.
+ */
+float getSpectrumBandCenterFrequency(MilkyContext *context, size_t band) {
+    return band < context->bands.count ? context->bands.centerFrequencies[band] : 0.0f;
+}
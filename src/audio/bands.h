@@ -0,0 +1,67 @@
+#ifndef BANDS_H
+#define BANDS_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#endif
+
+#ifdef __ARM_NEON__
+#include <arm_neon.h>
+#endif
+
+#define MILKY_BANDS_MAX_COUNT 128           // upper limit for the number of perceptual bands
+#define MILKY_BANDS_DEFAULT_COUNT 32        // bands used unless configured otherwise
+#define MILKY_BANDS_DEFAULT_FLOOR_DB -72.0f // levels at or below this map to 0.0
+#define MILKY_BANDS_DEFAULT_CEILING_DB 0.0f // levels at or above this map to 1.0 (0 dB = full-scale sine)
+#define MILKY_BANDS_MIN_FREQUENCY_HZ 30.0f  // lower edge of the first band
+#define MILKY_BANDS_MAX_FREQUENCY_HZ 16000.0f // upper edge of the last band (clipped to nyquist)
+
+#include "../allocator.h"
+
+typedef enum {
+    MILKY_BAND_SCALE_LOG = 0, // logarithmically spaced band edges (constant-Q like)
+    MILKY_BAND_SCALE_MEL = 1  // mel spaced band edges
+} BandScale;
+
+// one row of the sparse weight matrix: a contiguous run of FFT bins
+typedef struct {
+    size_t firstBin;     // first FFT bin with a non-zero weight
+    size_t binCount;     // number of contiguous bins covered by the band
+    size_t weightOffset; // offset of the row's weights in the weight array
+} BandRow;
+
+// perceptual binning stage of a context
+typedef struct {
+    // configuration (see initializeSpectrumBands())
+    BandScale scale;
+    size_t count;
+    float floorDb;
+    float ceilingDb;
+
+    // sparse weight matrix, precomputed per FFT size and sample rate
+    BandRow rows[MILKY_BANDS_MAX_COUNT];
+    float *weights;
+    float centerFrequencies[MILKY_BANDS_MAX_COUNT];
+    size_t matrixBinCount;
+    size_t matrixSampleRate;
+
+    // output of the newest update
+    float db[MILKY_BANDS_MAX_COUNT];
+    float levels[MILKY_BANDS_MAX_COUNT];
+} BandsState;
+
+void initializeSpectrumBands(MilkyContext *context, BandScale scale, size_t bandCount, float floorDb, float ceilingDb);
+void destroySpectrumBands(MilkyContext *context);
+void updateSpectrumBands(MilkyContext *context, const float *magnitudes, size_t binCount, size_t sampleRate);
+const float *getSpectrumBandsDb(MilkyContext *context, size_t *bandCount);
+const float *getSpectrumBandLevels(MilkyContext *context, size_t *bandCount);
+float getSpectrumBandCenterFrequency(MilkyContext *context, size_t band);
+
+#endif // BANDS_H
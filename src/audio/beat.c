@@ -0,0 +1,263 @@
+#include "beat.h"
+#include "../context.h"
+
+// number of hops the local flux mean is computed over (detrending of the onset function)
+#define MILKY_BEAT_MEAN_WINDOW 16
+
+/**
+ * Initializes the onset detector and tempo estimator for the given spectrogram layout.
+ * Precomputes the tempo lag range and a log-gaussian tempo prior so that the per-hop
+ * work stays constant.
+ *
+ * @param sampleRate The sample rate of the audio data (samples per second, per channel).
+ * @param hopSize    Samples between two spectrogram frames.
+ * @param windowSize Analysis window length of the spectrogram frames.
+ */
+void initializeBeatTracker(MilkyContext *context, size_t sampleRate, size_t hopSize, size_t windowSize) {
+    memset(context->beat.previousLogSpectrum, 0, sizeof(context->beat.previousLogSpectrum));
+    memset(context->beat.onsetEnvelope, 0, sizeof(context->beat.onsetEnvelope));
+    memset(context->beat.fluxHistory, 0, sizeof(context->beat.fluxHistory));
+    memset(context->beat.autocorrelation, 0, sizeof(context->beat.autocorrelation));
+    context->beat.fluxSum = 0.0f;
+    context->beat.hopCount = 0;
+    context->beat.noveltyMean = 0.0f;
+    context->beat.noveltyPeak = 0.0f;
+    context->beat.confidence = 0.0f;
+    context->beat.candidateHops = 0;
+
+    // translate the tempo range into autocorrelation lags
+    float hopsPerSecond = (float)sampleRate / (float)hopSize;
+    context->beat.minLag = (size_t)floorf(hopsPerSecond * 60.0f / MILKY_BEAT_MAX_BPM);
+    context->beat.maxLag = (size_t)ceilf(hopsPerSecond * 60.0f / MILKY_BEAT_MIN_BPM);
+    if (context->beat.minLag < 2) context->beat.minLag = 2;
+    if (context->beat.maxLag > MILKY_BEAT_MAX_LAG - 1) context->beat.maxLag = MILKY_BEAT_MAX_LAG - 1;
+
+    // autocorrelation forgets with a time constant of roughly 8 seconds
+    context->beat.autocorrelationDecay = expf(-1.0f / (8.0f * hopsPerSecond));
+
+    // log-gaussian prior around the preferred tempo keeps the estimate on one metrical level
+    for (size_t lag = 0; lag <= MILKY_BEAT_MAX_LAG; lag++) {
+        float bpm = lag > 0 ? 60.0f * hopsPerSecond / (float)lag : 0.0f;
+        float octaves = bpm > 0.0f ? log2f(bpm / MILKY_BEAT_PREFERRED_BPM) : 0.0f;
+        context->beat.lagPrior[lag] = expf(-0.5f * (octaves / 0.9f) * (octaves / 0.9f));
+    }
+
+    context->beat.periodHops = hopsPerSecond * 60.0f / MILKY_BEAT_PREFERRED_BPM;
+    context->beat.candidatePeriodHops = context->beat.periodHops;
+    context->beat.nextBeatHop = context->beat.periodHops;
+
+    // the flux peaks when an attack reaches the center of the analysis window
+    context->beat.onsetOffsetHops = (float)windowSize / (2.0f * (float)hopSize);
+
+    context->beat.sampleRate = sampleRate;
+    context->beat.hopSize = hopSize;
+    context->beat.initialized = 1;
+}
+
+/**
+ * Re-estimates the beat period from the leaky autocorrelation. The strongest lag
+ * (weighted by the tempo prior) is refined by parabolic interpolation. Small changes
+ * are smoothed into the running period; large jumps have to persist for about a second.
+ *
+ * @param hopsPerSecond The hop rate of the onset envelope.
+ */
+static void estimateTempo(MilkyContext *context, float hopsPerSecond) {
+    size_t bestLag = 0;
+    float bestScore = 0.0f;
+    for (size_t lag = context->beat.minLag; lag <= context->beat.maxLag; lag++) {
+        float score = context->beat.autocorrelation[lag] * context->beat.lagPrior[lag];
+        if (score > bestScore) {
+            bestScore = score;
+            bestLag = lag;
+        }
+    }
+
+    if (bestLag == 0 || context->beat.autocorrelation[0] <= 1e-9f) {
+        context->beat.confidence = 0.0f;
+        return;
+    }
+
+    // parabolic interpolation around the peak for a fractional period
+    float period = (float)bestLag;
+    if (bestLag > context->beat.minLag && bestLag < context->beat.maxLag) {
+        float left = context->beat.autocorrelation[bestLag - 1];
+        float center = context->beat.autocorrelation[bestLag];
+        float right = context->beat.autocorrelation[bestLag + 1];
+        float denominator = left - 2.0f * center + right;
+        if (denominator < 0.0f) {
+            period += 0.5f * (left - right) / denominator;
+        }
+    }
+
+    context->beat.confidence = context->beat.autocorrelation[bestLag] / context->beat.autocorrelation[0];
+
+    // the autocorrelation decays evenly in silence, so gate the confidence on onset activity
+    if (context->beat.noveltyMean < 0.05f * context->beat.noveltyPeak) {
+        context->beat.confidence = 0.0f;
+    }
+
+    if (fabsf(period - context->beat.periodHops) < 0.08f * context->beat.periodHops) {
+        // same tempo: follow slowly
+        context->beat.periodHops += 0.1f * (period - context->beat.periodHops);
+        context->beat.candidateHops = 0;
+    } else if (fabsf(period - context->beat.candidatePeriodHops) < 0.08f * context->beat.candidatePeriodHops) {
+        // a different tempo has to win for about one second before we switch
+        if (++context->beat.candidateHops > (size_t)hopsPerSecond) {
+            context->beat.periodHops = period;
+            context->beat.candidateHops = 0;
+        }
+    } else {
+        context->beat.candidatePeriodHops = period;
+        context->beat.candidateHops = 0;
+    }
+}
+
+/**
+ * Processes one spectrogram frame: log-magnitude spectral flux, detrending, incremental
+ * autocorrelation, onset peak picking and the phase-locked beat predictor.
+ * The cost per hop is constant.
+ *
+ * @param magnitudes    Magnitude spectrum of the frame.
+ * @param binCount      Number of magnitudes in the frame.
+ * @param hopsPerSecond The hop rate of the onset envelope.
+ */
+static void processHop(MilkyContext *context, const float *magnitudes, size_t binCount, float hopsPerSecond) {
+    // positive log-magnitude differences (log compression makes quiet attacks count too)
+    float flux = 0.0f;
+    for (size_t k = 1; k < binCount; k++) {
+        float logMagnitude = log1pf(10000.0f * magnitudes[k]);
+        float diff = logMagnitude - context->beat.previousLogSpectrum[k];
+        context->beat.previousLogSpectrum[k] = logMagnitude;
+        if (diff > 0.0f) flux += diff;
+    }
+
+    // subtract the local mean so that sustained loudness doesn't look like onsets
+    const size_t mask = MILKY_BEAT_ONSET_HISTORY - 1;
+    size_t n = context->beat.hopCount;
+    context->beat.fluxSum += flux - context->beat.fluxHistory[(n - MILKY_BEAT_MEAN_WINDOW) & mask];
+    context->beat.fluxHistory[n & mask] = flux;
+    float novelty = flux - context->beat.fluxSum / (float)MILKY_BEAT_MEAN_WINDOW;
+    if (novelty < 0.0f) novelty = 0.0f;
+    context->beat.onsetEnvelope[n & mask] = novelty;
+
+    // leaky autocorrelation, one multiply-add per lag
+    const float decay = context->beat.autocorrelationDecay;
+    context->beat.autocorrelation[0] = context->beat.autocorrelation[0] * decay + novelty * novelty;
+    for (size_t lag = context->beat.minLag; lag <= context->beat.maxLag; lag++) {
+        context->beat.autocorrelation[lag] = context->beat.autocorrelation[lag] * decay
+                                       + novelty * context->beat.onsetEnvelope[(n - lag) & mask];
+    }
+
+    // peak picking: the previous hop is an onset if it is a local maximum above the adaptive threshold
+    float previous = context->beat.onsetEnvelope[(n - 1) & mask];
+    float beforePrevious = context->beat.onsetEnvelope[(n - 2) & mask];
+    float threshold = 1.5f * context->beat.noveltyMean + 1e-3f;
+    context->beat.noveltyMean = context->beat.noveltyMean * 0.98f + novelty * 0.02f;
+    context->beat.noveltyPeak = fmaxf(context->beat.noveltyPeak * 0.9995f, context->beat.noveltyMean);
+
+    context->beat.hopCount++;
+    estimateTempo(context, hopsPerSecond);
+
+    context->beat.onsetDetected = previous > beforePrevious && previous >= novelty && previous > threshold;
+
+    // phase-locked loop: pull the predicted beat towards onsets that land close to it
+    float position = (float)context->beat.hopCount;
+    if (context->beat.onsetDetected) {
+        float onsetPosition = position - 1.0f - context->beat.onsetOffsetHops;
+        float nearestBeat = context->beat.nextBeatHop;
+        if (fabsf(onsetPosition - (nearestBeat - context->beat.periodHops)) < fabsf(onsetPosition - nearestBeat)) {
+            nearestBeat -= context->beat.periodHops;
+        }
+        // onsets close to the prediction correct quickly, far ones (off-beats or a
+        // wrong initial phase) only slowly, so the loop can still acquire the beat
+        float error = onsetPosition - nearestBeat;
+        float gain = fabsf(error) < 0.25f * context->beat.periodHops ? 0.25f : 0.1f;
+        context->beat.nextBeatHop += gain * error;
+    }
+    while (context->beat.nextBeatHop <= position) {
+        context->beat.nextBeatHop += context->beat.periodHops;
+    }
+}
+
+/**
+ * Consumes the newest spectrogram frames. Must be called after every captured chunk
+ * (not only for rendered ones) so that the hop clock stays continuous.
+ *
+ * @param newFrames   Number of frames the STFT appended for this chunk.
+ * @param currentTime Current time in milliseconds (the time the last sample was captured).
+ */
+void processBeatFrames(MilkyContext *context, size_t newFrames, size_t currentTime) {
+    const Spectrogram *spectrogram = getSpectrogram(context);
+    if (!spectrogram) return;
+
+    if (!context->beat.initialized || context->beat.sampleRate != spectrogram->sampleRate || context->beat.hopSize != spectrogram->hopSize) {
+        initializeBeatTracker(context, spectrogram->sampleRate, spectrogram->hopSize, spectrogram->windowSize);
+    }
+
+    const float hopsPerSecond = (float)spectrogram->sampleRate / (float)spectrogram->hopSize;
+    if (newFrames > spectrogram->historyLength) newFrames = spectrogram->historyLength;
+
+    // oldest first
+    for (size_t k = newFrames; k > 0; k--) {
+        processHop(context, getSpectrogramFrame(context, k - 1), spectrogram->binCount, hopsPerSecond);
+    }
+
+    // map the hop-domain prediction onto the render clock: the newest frame ended
+    // as many samples ago as are still waiting for the next hop
+    const double hopMs = 1000.0 / (double)hopsPerSecond;
+    double latestHopTimeMs = (double)currentTime - (double)spectrogram->pendingSamples * 1000.0 / (double)spectrogram->sampleRate;
+    context->beat.anchorTimeMs = latestHopTimeMs + ((double)context->beat.nextBeatHop - (double)context->beat.hopCount) * hopMs;
+    context->beat.periodMs = (double)context->beat.periodHops * hopMs;
+}
+
+/**
+ * Advances the beat clock to the given render time. Sets context->beat.beatDetected for
+ * the frame in which a predicted beat falls, so effects fire on the beat without
+ * waiting for the onset to be detected.
+ *
+ * @param currentTime Current time in milliseconds.
+ */
+void updateBeatClock(MilkyContext *context, size_t currentTime) {
+    context->beat.beatDetected = 0;
+    if (!context->beat.initialized || context->beat.periodMs <= 0.0) return;
+
+    // most recent predicted beat at or before the current time
+    double now = (double)currentTime;
+    double beatsSinceAnchor = floor((now - context->beat.anchorTimeMs) / context->beat.periodMs);
+    double lastBeatTimeMs = context->beat.anchorTimeMs + beatsSinceAnchor * context->beat.periodMs;
+    context->beat.phase = (float)((now - lastBeatTimeMs) / context->beat.periodMs);
+
+    // report every beat once, even if the anchor got nudged by the phase-locked loop
+    if (context->beat.beatCount == 0 || lastBeatTimeMs > context->beat.lastReportedTimeMs + 0.5 * context->beat.periodMs) {
+        context->beat.lastReportedTimeMs = lastBeatTimeMs;
+        context->beat.beatCount++;
+        context->beat.beatDetected = 1;
+    }
+}
+
+/**
+ * Tells whether effects should trigger in the current frame: on predicted beats when
+ * the tempo estimate is reliable, otherwise on detected energy spikes.
+ *
+ * @return 1 if a beat (or energy spike) triggers in this frame, 0 otherwise.
+ */
+int isBeatTriggered(MilkyContext *context) {
+    if (context->beat.confidence >= MILKY_BEAT_MIN_CONFIDENCE) {
+        return context->beat.beatDetected;
+    }
+    return context->energy.energySpikeDetected;
+}
+
+/**
+ * Returns a snapshot of the current tempo and beat phase.
+ *
+ * @return The current tempo estimate, its confidence, the beat phase and beat count.
+ */
+BeatInfo getBeatInfo(MilkyContext *context) {
+    BeatInfo info;
+    info.bpm = context->beat.periodMs > 0.0 ? (float)(60000.0 / context->beat.periodMs) : 0.0f;
+    info.confidence = context->beat.confidence;
+    info.phase = context->beat.phase;
+    info.beatCount = context->beat.beatCount;
+    return info;
+}
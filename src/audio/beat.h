@@ -0,0 +1,77 @@
+#ifndef BEAT_H
+#define BEAT_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "./energy.h"
+#include "./stft.h"
+#include "../milky.h"
+
+#define MILKY_BEAT_ONSET_HISTORY 512      // length of the onset envelope ring (in hops, power of two)
+#define MILKY_BEAT_MAX_LAG 256            // longest beat period the tempo estimator can represent (in hops)
+#define MILKY_BEAT_MIN_BPM 60.0f          // slowest tempo considered
+#define MILKY_BEAT_MAX_BPM 200.0f         // fastest tempo considered
+#define MILKY_BEAT_PREFERRED_BPM 120.0f   // center of the tempo prior
+#define MILKY_BEAT_MIN_CONFIDENCE 0.25f   // below this, beats aren't trusted and energy spikes are used instead
+
+typedef struct {
+    float bpm;        // current tempo estimate in beats per minute
+    float confidence; // normalized autocorrelation strength of the tempo estimate [0, 1]
+    float phase;      // position inside the current beat [0, 1)
+    size_t beatCount; // number of beats reported to the renderer so far
+} BeatInfo;
+
+// onset detector and tempo tracker of a context
+typedef struct {
+    int beatDetected;  // set for exactly one rendered frame whenever a predicted beat falls into it
+    int onsetDetected; // set whenever the last processed hop contained an onset
+
+    // state preservation across spectrogram frames
+    int initialized;
+    size_t sampleRate;
+    size_t hopSize;
+    float onsetOffsetHops;
+    float previousLogSpectrum[MILKY_STFT_MAX_WINDOW_SIZE / 2];
+
+    // onset envelope (detrended, half-wave rectified spectral flux) and raw flux, one value per hop
+    float onsetEnvelope[MILKY_BEAT_ONSET_HISTORY];
+    float fluxHistory[MILKY_BEAT_ONSET_HISTORY];
+    float fluxSum;
+    size_t hopCount;
+
+    // leaky autocorrelation of the onset envelope, updated incrementally per hop
+    float autocorrelation[MILKY_BEAT_MAX_LAG + 1];
+    float autocorrelationDecay;
+    size_t minLag;
+    size_t maxLag;
+    float lagPrior[MILKY_BEAT_MAX_LAG + 1];
+
+    // adaptive onset threshold and tempo / phase tracking (all in hop units)
+    float noveltyMean;
+    float noveltyPeak;
+    float periodHops;
+    float candidatePeriodHops;
+    size_t candidateHops;
+    float nextBeatHop;
+    float confidence;
+
+    // beat clock mapped to the renderer's time base (milliseconds)
+    double anchorTimeMs;
+    double periodMs;
+    double lastReportedTimeMs; // (only valid once beatCount > 0)
+    float phase;
+    size_t beatCount;
+} BeatState;
+
+void initializeBeatTracker(MilkyContext *context, size_t sampleRate, size_t hopSize, size_t windowSize);
+void processBeatFrames(MilkyContext *context, size_t newFrames, size_t currentTime);
+void updateBeatClock(MilkyContext *context, size_t currentTime);
+int isBeatTriggered(MilkyContext *context);
+BeatInfo getBeatInfo(MilkyContext *context);
+
+#endif // BEAT_H
@@ -1,14 +1,26 @@
 #include "capture.h" 
 
-// current rendered frame (buffer allocated globally)
-uint8_t *frame = NULL;
+// renderer of the captured audio (owns the frame, created with the outputs)
+static MilkyContext *milky_captureContext = NULL;
 
-// GLFW window and OpenGL texture
-static GLFWwindow *window = NULL;
-static GLuint texture;
+// sample rate of the rendered audio (the capture stream or the WAVE file)
+static size_t milky_captureSampleRate = MILKY_CAPTURE_SAMPLE_RATE;
 
-#define WIDTH 1920
-#define HEIGHT 1080
+// window / canvas configuration (see config.h)
+static MilkyConfig milky_captureConfig = {
+    .width = MILKY_CONFIG_DEFAULT_WIDTH,
+    .height = MILKY_CONFIG_DEFAULT_HEIGHT
+};
+
+// size of the canvas that is rendered (may differ from the window size)
+static size_t milky_captureCanvasWidth = MILKY_CONFIG_DEFAULT_WIDTH;
+static size_t milky_captureCanvasHeight = MILKY_CONFIG_DEFAULT_HEIGHT;
+
+// 1 once the output backends are open (see output.h)
+static int milky_captureOutputsOpen = 0;
+
+// 1 once an output asked to stop (the mainloop is quitting, no more frames are rendered)
+static int milky_captureStopped = 0;
 
 // SDL window
 //SDL_Window *window = NULL;          
@@ -36,253 +48,56 @@ float performance_now() {
     return (float)(elapsed_usec / 1000.0);
 } 
 
-// for when the window is resized, we want to resize the viewport
-void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
-    glViewport(0, 0, width, height);
-}  
-
-GLuint VAO, VBO, EBO;
-
-void setup_vertex_data() {
-    float vertices[] = {
-        // Positions      // Texture Coords
-        -1.0f, -1.0f,     0.0f, 0.0f,
-         1.0f, -1.0f,     1.0f, 0.0f,
-         1.0f,  1.0f,     1.0f, 1.0f,
-        -1.0f,  1.0f,     0.0f, 1.0f
-    };
-
-    unsigned int indices[] = {
-        0, 1, 2,
-        2, 3, 0
-    };
+/**
+ * Applies a canvas size requested by an output (e.g. a window resize). Called between
+ * frames, so the renderer never sees the size change in the middle of a frame.
+ */
+static void applyPendingCanvasSize(void) {
+    size_t width = 0, height = 0;
+    if (!takeOutputCanvasSize(&width, &height) || width == 0 || height == 0) return;
 
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
-
-    glBindVertexArray(VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-}
-
-
-const char* vertex_shader_src = 
-    "#version 330 core\n"
-    "layout(location = 0) in vec2 aPos;\n"   // Input vertex position
-    "layout(location = 1) in vec2 aTexCoord;\n" // Input texture coordinates
-    "out vec2 TexCoord;\n"                 // Output texture coordinates
-    "uniform float curvatureStrength;      // Strength of the curvature\n"
-    "\n"
-    "void main() {\n"
-    "    // Compute distance from the center of the screen\n"
-    "    vec2 centeredPos = aPos * 2.0 - 1.0; // Convert to [-1, 1] range\n"
-    "    float distanceSq = dot(centeredPos, centeredPos);\n"
-    "\n"
-    "    // Apply curvature effect\n"
-    "    float curvature = curvatureStrength * distanceSq;\n"
-    "    vec3 curvedPosition = vec3(centeredPos, -curvature);\n"
-    "\n"
-    "    // Map back to screen space\n"
-    "    gl_Position = vec4(curvedPosition.xy * 0.5 + 0.5, curvedPosition.z, 1.0);\n"
-    "\n"
-    "    // Pass through the texture coordinates\n"
-    "    TexCoord = aTexCoord;\n"
-    "}\n";
-
-
-const char* fragment_shader_src = 
-"#version 330 core\n"
-"in vec2 TexCoord;\n"
-"out vec4 FragColor;\n"
-"uniform sampler2D texture1;\n"
-"uniform float vignetteIntensity; // Intensity of the vignette effect\n"
-"uniform float zoomFactor;        // Zoom effect multiplier\n"
-"uniform vec2 center;             // Dynamic center point\n"
-"uniform float time;              // Time for animation\n"
-"uniform float rotationSpeed;     // Speed of rotation\n"
-"uniform float blurStrength;      // Strength of radial blur\n"
-"uniform vec3 replacementColor;     // Most frequent color\n"
-"\n"
-// Radial blur helper function\n
-"vec4 radialBlur(sampler2D tex, vec2 uv, vec2 center, float blurStrength) {\n"
-"    vec4 result = vec4(0.0);\n"
-"    float totalWeight = 0.0;\n"
-"    for (float t = 0.0; t < 1.0; t += 0.1) {\n"
-"        vec2 sampleUV = mix(uv, center, t * blurStrength);\n"
-"        vec4 sample = texture(tex, sampleUV);\n"
-"        float weight = 1.0 - t;\n"
-"        result += sample * weight;\n"
-"        totalWeight += weight;\n"
-"    }\n"
-"    return result / totalWeight;\n"
-"}\n"
-"\n"
-"void main() {\n"
-"    // Rotate the texture coordinates\n"
-"    float angle = time * rotationSpeed;\n"
-"    mat2 rotationMatrix = mat2(cos(angle), -sin(angle), sin(angle), cos(angle));\n"
-"    vec2 rotatedUV = rotationMatrix * (TexCoord - center) + center;\n"
-"\n"
-"    // Apply zoom factor\n"
-"    vec2 zoomUV = center + (rotatedUV - center) * zoomFactor;\n"
-"\n"
-"    // Add radial blur\n"
-"    vec4 blurred = radialBlur(texture1, zoomUV, center, blurStrength);\n"
-"\n"
-"   // Replace black pixels with the most occurring color\n"
-"   /*if (blurred.rgb == vec3(0.0, 0.0, 0.0)) {\n"
-"        blurred.rgb = replacementColor;\n"
-"    }*/\n"
-"\n"
-"    // Center dim effect\n"
-"    vec2 offset = TexCoord - center;\n"
-"    float distance = length(offset);\n"
-"    float smoothValue = smoothstep(0.0, 0.9, distance);\n"
-"    float dimFactor = mix(1.0 - 0.3, 1.0, smoothValue);\n"
-"    dimFactor = clamp(dimFactor, 0.0, 1.0);\n"
-"    blurred.rgb *= clamp(dimFactor, 0.0, 1.0);\n"
-"\n"
-"    // Gamma correction\n"
-"    float gamma = 1.8; // Standard gamma correction\n"
-"    blurred.rgb = pow(blurred.rgb, vec3(1.0 / gamma));\n"
-"\n"
-"    // Clamp the final color values to valid range\n"
-"    blurred.rgb = clamp(blurred.rgb, 0.0, 1.0);\n"
-"\n"
-"    // Output the final color\n"
-"    FragColor = blurred;\n"
-"}\n";
-
-
-GLuint shader_program;
-
-void compile_and_link_shaders() {
-    GLuint vertex_shader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex_shader, 1, &vertex_shader_src, NULL);
-    glCompileShader(vertex_shader);
-
-    GLint success;
-    glGetShaderiv(vertex_shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char info_log[512];
-        glGetShaderInfoLog(vertex_shader, 512, NULL, info_log);
-        fprintf(stderr, "ERROR::VERTEX_SHADER_COMPILATION_FAILED\n%s\n", info_log);
+    if (milky_context_resize(milky_captureContext, width, height)) {
+        milky_captureCanvasWidth = width;
+        milky_captureCanvasHeight = height;
     }
-
-    GLuint fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment_shader, 1, &fragment_shader_src, NULL);
-    glCompileShader(fragment_shader);
-
-    glGetShaderiv(fragment_shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char info_log[512];
-        glGetShaderInfoLog(fragment_shader, 512, NULL, info_log);
-        fprintf(stderr, "ERROR::FRAGMENT_SHADER_COMPILATION_FAILED\n%s\n", info_log);
-    }
-
-    shader_program = glCreateProgram();
-    glAttachShader(shader_program, vertex_shader);
-    glAttachShader(shader_program, fragment_shader);
-    glLinkProgram(shader_program);
-
-    glGetProgramiv(shader_program, GL_LINK_STATUS, &success);
-    if (!success) {
-        char info_log[512];
-        glGetProgramInfoLog(shader_program, 512, NULL, info_log);
-        fprintf(stderr, "ERROR::SHADER_PROGRAM_LINKING_FAILED\n%s\n", info_log);
-    }
-
-    glDeleteShader(vertex_shader);
-    glDeleteShader(fragment_shader);
 }
 
-// creates a singleton window instance and initializes the GPU primitives (OpenGL)
-void initialize_glfw() {
-    if (!window) {
-
-        initialize_timer();
+// opens the output backends (window, shared memory, file, ...) and creates the renderer with
+// the canvas size they picked
+void initialize_outputs() {
+    if (milky_captureOutputsOpen) return;
 
-        if (!glfwInit()) {
-            fprintf(stderr, "Failed to initialize GLFW.\n");
-            exit(EXIT_FAILURE);
-        }
+    initialize_timer();
 
-        window = glfwCreateWindow(WIDTH, HEIGHT, "MilkyLinuxOSD", NULL, NULL);
-        if (!window) {
-            fprintf(stderr, "Failed to create GLFW window.\n");
-            glfwTerminate();
-            exit(EXIT_FAILURE);
-        }
-
-        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-
-        glfwMakeContextCurrent(window);
-
-        if (glewInit() != GLEW_OK) {
-            fprintf(stderr, "Failed to initialize GLEW.\n");
-            exit(EXIT_FAILURE);
-        }
-
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-        compile_and_link_shaders();
-        setup_vertex_data();
-    }
-
-    if (!frame) {
-        size_t frameSize = WIDTH * HEIGHT * 4; // RGBA format
-        frame = malloc(frameSize);
-        if (!frame) {
-            fprintf(stderr, "Failed to allocate framebuffer memory.\n");
-            glfwDestroyWindow(window);
-            glfwTerminate();
-            exit(EXIT_FAILURE);
-        }
-        memset(frame, 0, frameSize); // Initialize to black
+    if (!openOutputs(&milky_captureConfig, &milky_captureCanvasWidth, &milky_captureCanvasHeight)) {
+        exit(EXIT_FAILURE);
     }
+    milky_captureOutputsOpen = 1;
 
-}
-
-void cleanup_glfw() {
-    if (frame) {
-        free(frame);
-        frame = NULL;
-    }
+    MilkyContextOptions options = milky_context_default_options();
+    options.width = milky_captureCanvasWidth;
+    options.height = milky_captureCanvasHeight;
+    options.sampleRate = milky_captureSampleRate;
+    options.channels = MILKY_CAPTURE_CHANNELS;
+    options.presetIndex = milky_captureConfig.presetIndex;
+    options.presetDuration = (size_t)(milky_captureConfig.presetDuration * 1000.0f);
+    options.seed = (uint32_t)time(NULL); // a different palette on every run
 
-    if (texture) {
-        glDeleteTextures(1, &texture);
-        texture = 0;
+    milky_captureContext = milky_context_create(&options);
+    if (!milky_captureContext) {
+        closeOutputs();
+        exit(EXIT_FAILURE);
     }
+}
 
-    if (window) {
-        glfwDestroyWindow(window);
-        window = NULL;
-        glfwTerminate();
+void cleanup_outputs() {
+    if (milky_captureOutputsOpen) {
+        closeOutputs();
+        milky_captureOutputsOpen = 0;
     }
 
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &EBO);
-    glDeleteProgram(shader_program);
+    milky_context_destroy(milky_captureContext);
+    milky_captureContext = NULL;
 }
 
 ColorCount colorCounts[MAX_COLORS];
@@ -344,75 +159,6 @@ Color analyze_first_line(uint8_t *frame, int width) {
     return find_most_frequent_color();
 }
 
-// renders the frame (buffer) onto the 2D texture (OpenGL) inside of the window
-static void render_frame(uint8_t *frame) {
-    float time = glfwGetTime(); // Get elapsed time
-    glUniform1f(glGetUniformLocation(shader_program, "time"), time);
-
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, WIDTH, HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, frame);
-
-
-    
-
-    // Update the "curvatureStrength" uniform
-    float curvatureStrength = 0.05f; // Subtle curvature
-    glUniform1f(glGetUniformLocation(shader_program, "curvatureStrength"), curvatureStrength);
-
-
-    // Update the "grainAmount" uniform
-    float vignetteIntensity = 1.1f; // Example grain amount
-    glUniform1f(glGetUniformLocation(shader_program, "vignetteIntensity"), vignetteIntensity);
-
-    /*
-    Color mostFrequentColor = analyze_first_line(frame, 1000);
-    float r = mostFrequentColor.r / 255.0f;
-    float g = mostFrequentColor.g / 255.0f;
-    float b = mostFrequentColor.b / 255.0f;
-
-    GLint replacementColorLoc = glGetUniformLocation(shader_program, "replacementColor");
-    glUniform3f(replacementColorLoc, r, g, b);*/
-
-    // Update the "zoomFactor" uniform
-    float zoomFactor = 0.995f; // Slight zoom-out
-    glUniform1f(glGetUniformLocation(shader_program, "zoomFactor"), zoomFactor);
-
-    // Update the "grainAmount" uniform
-    float grainAmount = 0.03f; // Example grain amount
-    glUniform1f(glGetUniformLocation(shader_program, "grainAmount"), grainAmount);
-
-    // Update the "center" uniform (dynamic movement over time)
-    float centerX = 0.5f; /*+ 0.1f * sin(time * 0.5f); */// Moves left and right
-    float centerY = 0.5f; /*+ 0.1f * cos(time * 0.3f);*/ // Moves up and down
-    glUniform2f(glGetUniformLocation(shader_program, "center"), centerX, centerY);
-
-    // Update the "rotationSpeed" uniform
-    float rotationSpeed = 0.0f; // Example rotation speed (radians per second)
-    glUniform1f(glGetUniformLocation(shader_program, "rotationSpeed"), rotationSpeed);
-
-    // Update the "blurStrength" uniform
-    float blurStrength = 0.001f; // Subtle radial blur
-    glUniform1f(glGetUniformLocation(shader_program, "blurStrength"), blurStrength);
-
-
-    glClear(GL_COLOR_BUFFER_BIT);
-
-    glUseProgram(shader_program);
-
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
-
-    if (!glfwWindowShouldClose(window)) {
-        glfwSwapBuffers(window);
-        glfwPollEvents();
-    } else {
-        glfwTerminate();
-        exit(EXIT_FAILURE);
-    }
-}
-
-
 // the struct is passed by reference (pointer into memory)
 int pulse_initialize(PulseAudio *pa) {
 
@@ -503,6 +249,26 @@ void subscribe_callback(pa_context *c, pa_subscription_event_type_t type, uint32
         pa_operation_unref(op);
 }
 
+/**
+ * Renders a frame from the newest audio and hands it to the outputs. The audio must
+ * have been analyzed up to now (see milky_context_analyze()).
+ *
+ * @param waveform    The newest audio chunk (interleaved unsigned 8-bit stereo).
+ * @param length      Its size in bytes.
+ * @param currentTime Time of the frame in milliseconds (drives the animations).
+ * @return            1 to continue, 0 once an output asked to stop (e.g. the window was closed).
+ */
+static int renderCapturedFrame(const uint8_t *waveform, size_t length, size_t currentTime) {
+    // a window resize since the last frame changes the canvas size now, between frames
+    applyPendingCanvasSize();
+
+    const uint8_t *frame = milky_context_render(milky_captureContext, waveform, length, currentTime);
+
+    // hand the frame to the outputs (window, shared memory ring, file, ...)
+    DisplayMotion motion = getContextFrameMotion(milky_captureContext);
+    return presentOutputs(frame, milky_captureCanvasWidth, milky_captureCanvasHeight, &motion);
+}
+
 // Static variables to track time and rendering
 static struct timespec lastRenderTime = {0, 0};
 
@@ -529,7 +295,12 @@ void stream_read_callback(pa_stream *s, size_t length, void *userdata) {
         fprintf(stderr, "pa_stream_peek() failed: %s\n", pa_strerror(pa_context_errno(pa_stream_get_context(s))));
     }
 
-    initialize_glfw();
+    if (milky_captureStopped) {
+        pa_stream_drop(s);
+        return;
+    }
+
+    initialize_outputs();
 
 
     if (data) {
@@ -544,6 +315,9 @@ void stream_read_callback(pa_stream *s, size_t length, void *userdata) {
         // PulseAudio delivers 4-byte metadata chunks that we'd need to ignore
         if (length >= 1024) {
 
+            // the STFT and the beat tracker need every chunk (not just the rendered ones) to keep their hop clock
+            milky_context_analyze(milky_captureContext, waveform, length, performance_now());
+
             struct timespec currentRenderTime;
             clock_gettime(CLOCK_MONOTONIC, &currentRenderTime);
 
@@ -564,73 +338,12 @@ void stream_read_callback(pa_stream *s, size_t length, void *userdata) {
                 // Update the last render time
                 lastRenderTime = currentRenderTime;
 
-                // here we need to call an FFT algorithm (or implement one)
-                // so that we can get the frequency spectrum for the waveform
-                // this is necessary to calculate the spectral flux    
-                //printf("Received waveform data of size: %zu\n", length);
-
-                uint8_t spectrum[length / 2];
-
-                // specifically initialize memory with zeros
-                memset(spectrum, 0, sizeof(spectrum));
-
-                // calculate the spectrum
-                calculate_spectrum(waveform, length, spectrum);
-
-                size_t spectrumLength = sizeof(spectrum);
-
-                // We're good here.
-                //printf("Received FFT spectrum data of size: %zu\n", spectrumLength);
-
-                // cool! now we only need to call the VIDEO function
-                // and render the framebuffer onto a surface that can handle
-                // framebuffer data -- you'll then see the current playback sound
-                // being beautifully visualized!
-                // We'll use SDL to render the framebuffer on a new window that we're 
-                // going to create.
-
-                // simple demo: width * height * count of values we have to reserve 
-                // memory for because a framebuffer wants Red, Green, Blue, Alpha 
-                // cannel values per pixel.
-
-                size_t frameSize = WIDTH * HEIGHT * 4; // RGBA
-
-                // if frame buffer isn't allocated yet, do it once during initialization
-                if (frame == NULL) {
-                    // allocate memory once
-                    frame = (uint8_t *)malloc(frameSize); 
-                    if (!frame) {
-                        fprintf(stderr, "Failed to allocate memory for the frame buffer.\n");
-                    }
+                // hand the frame to the outputs (window, shared memory ring, file, ...); once
+                // one of them asks to stop (the window was closed), the mainloop quits
+                if (!renderCapturedFrame(waveform, length, performance_now())) {
+                    milky_captureStopped = 1;
+                    pulse_quit((PulseAudio *)userdata, 0);
                 }
-
-                memset(frame, 0, frameSize);
-
-                float *presetsBuffer = NULL; 
-                float speed = 0.1899f;
-                size_t sampleRate = 44100;
-                size_t bitDepth = 32;
-                size_t currentTime = performance_now();
-                
-                // rendering the audio 
-                render(
-                    frame,
-                    WIDTH,
-                    HEIGHT,
-                    waveform,
-                    spectrum,
-                    length,
-                    spectrumLength,
-                    bitDepth,
-                    presetsBuffer,
-                    0.0123f,
-                    currentTime,
-                    sampleRate
-                );
-
-
-                // Render the frame
-                render_frame(frame);
             }
             
 
@@ -667,8 +380,8 @@ void context_state_callback(pa_context *c, void *userdata) {
             // Let's try to record system audio (the audio you're hearing right now!)
             pa_sample_spec ss = {
                 .format = PA_SAMPLE_U8, // 16-bit little-endian
-                .rate = 44100,             // 44.1kHz sample rate
-                .channels = 2              // Stereo
+                .rate = MILKY_CAPTURE_SAMPLE_RATE,   // 44.1kHz sample rate
+                .channels = MILKY_CAPTURE_CHANNELS   // Stereo
             };
 
             pa->stream = pa_stream_new(c, "Audio Capture", &ss, NULL);
@@ -747,7 +460,11 @@ void pulse_quit(PulseAudio *pa, int ret) {
     pa->mainloop_api->quit(pa->mainloop_api, ret);
 }
 
-int run() {
+int run(const MilkyConfig *config) {
+
+    if (config) {
+        milky_captureConfig = *config;
+    }
 
     printf("Testing PulseAudio lib integration...");
 
@@ -761,51 +478,81 @@ int run() {
     int ret = pulse_run(&pa);
 
     pulse_destroy(&pa);
+    cleanup_outputs();
 
     return ret;
 }  
 
-
-void calculate_spectrum(const uint8_t *waveform, size_t sample_count, uint8_t *spectrum) {
-    // Step 1: Allocate memory for KISS FFT input and output
-    kiss_fft_cpx in[sample_count];
-    kiss_fft_cpx out[sample_count];
-    kiss_fft_cfg cfg;
-
-    // Step 2: Normalize waveform into input for FFT (convert uint8_t [0-255] to float [-1.0, 1.0])
-    for (size_t i = 0; i < sample_count; i++) {
-
-        // Center around 0
-        in[i].r = ((float)(waveform[i]) - 128.0f) / 128.0f; 
-
-        // Imaginary part is zero for real input
-        in[i].i = 0.0f; 
-    }
-
-    // Step 3: Allocate FFT configuration
-    cfg = kiss_fft_alloc(sample_count, 0, NULL, NULL);
-    if (!cfg) {
-        fprintf(stderr, "Failed to allocate KISS FFT configuration.\n");
-        return;
-    }
-
-    // Step 4: Perform the FFT
-    kiss_fft(cfg, in, out);
-
-    // Step 5: Compute the magnitude of each frequency bin and normalize to [0, 255]
-    for (size_t i = 0; i < sample_count / 2; i++) { // Only first half is meaningful for real FFT
-
-        // Compute magnitude
-        float magnitude = sqrtf(out[i].r * out[i].r + out[i].i * out[i].i); 
-
-        // Normalization
-        spectrum[i] = (uint8_t)(255.0f * magnitude / (float)sample_count); 
-    }
-
-    // Step 6: Free the FFT configuration
-    free(cfg);
+/**
+ * Renders a WAVE file instead of the captured audio, as fast as the outputs take the
+ * frames (e.g. --output y4m to encode a video of a track). The frames are timed by
+ * the position in the file, not by the clock, so every run renders the same video.
+ *
+ * @param config The configuration (inputFile and frameRate select the file and the timing).
+ * @return       0 once the file was rendered, 1 on failure (like run()).
+ */
+int runFile(const MilkyConfig *config) {
+    milky_captureConfig = *config;
+
+    WavFile wav;
+    if (!openWavFile(&wav, config->inputFile)) return 1;
+
+    // the waveform of a frame covers its audio, but at least as much as a captured chunk
+    const size_t frameRate = config->frameRate;
+    const size_t samplesPerFrame = wav.sampleRate / frameRate;
+    const size_t waveformFrames = samplesPerFrame > MILKY_CAPTURE_MIN_WAVEFORM_FRAMES ? samplesPerFrame : MILKY_CAPTURE_MIN_WAVEFORM_FRAMES;
+    const size_t waveformLength = waveformFrames * MILKY_CAPTURE_CHANNELS;
+    uint8_t *waveform = (uint8_t *)malloc(waveformLength);
+    if (!waveform) {
+        fprintf(stderr, "Failed to allocate the waveform buffer\n");
+        closeWavFile(&wav);
+        return 1;
+    }
+    memset(waveform, 128, waveformLength); // silence
+
+    milky_captureSampleRate = wav.sampleRate;
+    initialize_outputs();
+
+    fprintf(stderr, "Rendering %s (%u Hz) at %zu fps\n", config->inputFile, (unsigned)wav.sampleRate, frameRate);
+    const float startTime = performance_now();
+    uint64_t samplesRead = 0;
+    size_t frameIndex = 0;
+
+    while (1) {
+        // the samples up to the end of this frame (integer math, so long files don't drift)
+        const uint64_t frameEnd = (uint64_t)(frameIndex + 1) * wav.sampleRate / frameRate;
+        size_t newSamples = (size_t)(frameEnd - samplesRead);
+        if (newSamples > waveformFrames) newSamples = waveformFrames;
+
+        // slide the waveform window and append the new samples
+        const size_t newLength = newSamples * MILKY_CAPTURE_CHANNELS;
+        memmove(waveform, waveform + newLength, waveformLength - newLength);
+        uint8_t *chunk = waveform + waveformLength - newLength;
+        const size_t read = readWavFrames(&wav, chunk, newSamples);
+        if (read == 0) break;
+        memset(chunk + read * MILKY_CAPTURE_CHANNELS, 128, (newSamples - read) * MILKY_CAPTURE_CHANNELS);
+        samplesRead = frameEnd;
+
+        const size_t currentTime = (size_t)((uint64_t)frameIndex * 1000 / frameRate);
+        milky_context_analyze(milky_captureContext, chunk, newLength, currentTime);
+
+        if (!renderCapturedFrame(waveform, waveformLength, currentTime)) break;
+        frameIndex++;
+        if (read < newSamples) break;
+    }
+
+    const float elapsed = (performance_now() - startTime) / 1000.0f;
+    const float duration = (float)frameIndex / (float)frameRate;
+    fprintf(stderr, "Rendered %zu frames (%.1f s of audio) in %.1f s (%.1fx realtime)\n",
+        frameIndex, duration, elapsed, elapsed > 0.0f ? duration / elapsed : 0.0f);
+
+    cleanup_outputs();
+    closeWavFile(&wav);
+    free(waveform);
+    return 0;
 }
 
+
 // TODO: need to refactor this. Rendering does NOT belong here (in audio capture code ;)
 // need to pass a function pointer and do all that in a callback function
 // defined in main.c (which does not exist yet ;)
@@ -10,13 +10,27 @@
 // include the PulseAudio library 
 #include <pulse/pulseaudio.h>
 
-// for rendering using GLFW
-#include <GL/glew.h>
-#include <GLFW/glfw3.h>
-
 // include KISS FFT
 #include "./kiss_fft/kiss_fft.h"
 
+// the renderer (spectral analysis and onset / tempo tracking are fed with every captured chunk)
+#include "../context.h"
+
+// WAVE files rendered instead of the captured audio (--input)
+#include "./wav.h"
+
+// window / canvas configuration
+#include "../config.h"
+
+// rendering and presentation of the frames
+#include "../video.h"
+#include "../output/output.h"
+
+// format of the captured system audio stream
+#define MILKY_CAPTURE_SAMPLE_RATE 44100
+#define MILKY_CAPTURE_CHANNELS 2
+#define MILKY_CAPTURE_MIN_WAVEFORM_FRAMES 512 // frames of the waveform rendered from a file (at least)
+
 typedef struct {
     uint8_t r; // Red channel
     uint8_t g; // Green channel
@@ -54,12 +68,8 @@ int pulse_run(PulseAudio *pa);
 void pulse_destroy(PulseAudio *pa);
 void pulse_quit(PulseAudio *pa, int ret);
 
-int run();
-
-void framebuffer_size_callback(GLFWwindow* window, int width, int height);
-
-// FFT related
-void calculate_spectrum(const uint8_t *waveform, size_t sample_count, uint8_t *spectrum);
+int run(const MilkyConfig *config);
+int runFile(const MilkyConfig *config);
 
 typedef struct {
     Color color;
@@ -71,9 +81,8 @@ typedef struct {
 #define MAX_PIXELS 1000 // Max number of pixels to analyze in the first row
 
 
-void initialize_glfw();
-void cleanup_glfw();
-static void render_frame(uint8_t *frame);
+void initialize_outputs();
+void cleanup_outputs();
 
 int color_equals(Color c1, Color c2);
 void add_color(Color c);
@@ -1,16 +1,5 @@
 #include "energy.h"
-
-int milky_energyEnergySpikeDetected = 0;
-
-// State preservation across function calls
-static float milky_energyAvgEnergy = 0.0f;
-static float milky_energyAvgFlux = 0.0f;
-static int milky_energyDetectionCooldownCounter = MILKY_COOLDOWN_PERIOD; // Counter for cooldown period
-static float milky_energyPreviousSpectrum[MILKY_MAX_SPECTRUM_LENGTH] = {0};
-static float milky_energyWeights[MILKY_MAX_SPECTRUM_LENGTH] = {0};
-static size_t milky_energyMaxBin = 0;
-static float milky_energyFrequencyBinWidth = 0.0f;
-static int milky_energyEnergySpikeDetectionInitialized = 0;
+#include "../context.h"
 
 /**
  * Initializes a low-pass biquad filter with a strong Q factor for sharp cutoff at 500 Hz.
@@ -92,6 +81,7 @@ void applyLowPassFilter(BiquadFilter *filter, float *samples, size_t length) {
  * @param sampleRate         the sample rate of the audio data.
  */
 void detectEnergySpike(
+    MilkyContext *context,
     const uint8_t *emphasizedWaveform,
     const uint8_t *spectrum,
     size_t waveformLength,
@@ -105,27 +95,35 @@ void detectEnergySpike(
     const float flux_threshold = 1.4f;         // Threshold for flux ratio
     const float min_volume_threshold = 0.15f;  // Minimum volume threshold for detection
 
+    // The bin weights depend on the spectrum length, so wait for the first spectrum
+    if (spectrumLength == 0) {
+        context->energy.energySpikeDetected = 0;
+        return;
+    }
+
     // Initialize detection parameters and filter if not already done
-    static BiquadFilter lpFilter;
-    if (!milky_energyEnergySpikeDetectionInitialized) {
+    if (!context->energy.energySpikeDetectionInitialized) {
+        // the first spike may be detected right away
+        context->energy.detectionCooldownCounter = MILKY_COOLDOWN_PERIOD;
+
         // Calculate the frequency bin width for the spectrum
-        milky_energyFrequencyBinWidth = (float)sampleRate / (2.0f * (float)spectrumLength);
+        context->energy.frequencyBinWidth = (float)sampleRate / (2.0f * (float)spectrumLength);
 
         // Initialize low-pass filter for 500 Hz cutoff
-        initLowPassFilter(&lpFilter, MILKY_CUTOFF_FREQUENCY_HZ, sampleRate, 1.0f); // Q factor of 1.0 for strong cutoff
+        initLowPassFilter(&context->energy.lowPassFilter, MILKY_CUTOFF_FREQUENCY_HZ, sampleRate, 1.0f); // Q factor of 1.0 for strong cutoff
 
         // Determine the low-frequency maximum bin (under 500 Hz)
-        milky_energyMaxBin = (size_t)(MILKY_CUTOFF_FREQUENCY_HZ / milky_energyFrequencyBinWidth);
-        if (milky_energyMaxBin > spectrumLength) milky_energyMaxBin = spectrumLength;
-        if (milky_energyMaxBin > MILKY_MAX_SPECTRUM_LENGTH) milky_energyMaxBin = MILKY_MAX_SPECTRUM_LENGTH;
+        context->energy.maxBin = (size_t)(MILKY_CUTOFF_FREQUENCY_HZ / context->energy.frequencyBinWidth);
+        if (context->energy.maxBin > spectrumLength) context->energy.maxBin = spectrumLength;
+        if (context->energy.maxBin > MILKY_MAX_SPECTRUM_LENGTH) context->energy.maxBin = MILKY_MAX_SPECTRUM_LENGTH;
 
         // Emphasize low frequencies in weights
         #pragma omp parallel for schedule(static)
-        for (size_t i = 0; i < milky_energyMaxBin; i++) {
-            float frequency = (float)(i + 1) * milky_energyFrequencyBinWidth;
-            milky_energyWeights[i] = 1.0f / (frequency + 1e-6f); // Avoid division by zero
+        for (size_t i = 0; i < context->energy.maxBin; i++) {
+            float frequency = (float)(i + 1) * context->energy.frequencyBinWidth;
+            context->energy.weights[i] = 1.0f / (frequency + 1e-6f); // Avoid division by zero
         }
-        milky_energyEnergySpikeDetectionInitialized = 1;
+        context->energy.energySpikeDetectionInitialized = 1;
     }
 
     // Apply low-pass filter to the waveform (Serial)
@@ -133,7 +131,7 @@ void detectEnergySpike(
     size_t length = (waveformLength < MILKY_MAX_WAVEFORM_LENGTH) ? waveformLength : MILKY_MAX_WAVEFORM_LENGTH;
     for (size_t i = 0; i < length; i++) {
         // Center the waveform data and apply the filter
-        filtered_waveform[i] = processSample(&lpFilter, (float)emphasizedWaveform[i] - 128.0f);
+        filtered_waveform[i] = processSample(&context->energy.lowPassFilter, (float)emphasizedWaveform[i] - 128.0f);
     }
 
     // Calculate filtered energy using the low-pass filtered waveform (Parallel)
@@ -150,14 +148,14 @@ void detectEnergySpike(
 
     // Apply a noise gate: skip detection if the signal is below the noise threshold
     if (current_energy < MILKY_NOISE_GATE_THRESHOLD) {
-        milky_energyEnergySpikeDetected = 0;
+        context->energy.energySpikeDetected = 0;
         return; // Exit early for low-amplitude sections
     }
 
     // Update average energy using exponential moving average
-    milky_energyAvgEnergy = milky_energyAvgEnergy * energy_alpha + current_energy * (1.0f - energy_alpha);
+    context->energy.avgEnergy = context->energy.avgEnergy * energy_alpha + current_energy * (1.0f - energy_alpha);
     // Calculate energy ratio for detection
-    float energy_ratio = current_energy / (milky_energyAvgEnergy + 1e-6f);
+    float energy_ratio = current_energy / (context->energy.avgEnergy + 1e-6f);
 
     // Calculate spectral flux with adaptive frequency emphasis (Parallel)
     float spectral_flux = 0.0f;
@@ -167,39 +165,39 @@ void detectEnergySpike(
     #pragma omp parallel for reduction(+:spectral_flux, sum_weights) schedule(static)
     for (size_t i = 0; i < bins; i++) {
         // Calculate the difference in spectrum values
-        float diff = (float)spectrum[i] - milky_energyPreviousSpectrum[i];
+        float diff = (float)spectrum[i] - context->energy.previousSpectrum[i];
         // Update previous spectrum for the next iteration
-        milky_energyPreviousSpectrum[i] = (float)spectrum[i];
+        context->energy.previousSpectrum[i] = (float)spectrum[i];
 
         if (diff > 0) {
             // Accumulate positive flux weighted by frequency emphasis
-            spectral_flux += diff * milky_energyWeights[i];
+            spectral_flux += diff * context->energy.weights[i];
         }
         // Accumulate weights for normalization
-        sum_weights += milky_energyWeights[i];
+        sum_weights += context->energy.weights[i];
     }
 
     // Normalize spectral flux if weights are non-zero
     if (sum_weights > 0.0f) spectral_flux /= sum_weights;
     // Update flux average using exponential moving average
-    milky_energyAvgFlux = milky_energyAvgFlux * flux_alpha + spectral_flux * (1.0f - flux_alpha);
+    context->energy.avgFlux = context->energy.avgFlux * flux_alpha + spectral_flux * (1.0f - flux_alpha);
     // Calculate flux ratio for detection
-    float flux_ratio = spectral_flux / (milky_energyAvgFlux + 1e-6f);
+    float flux_ratio = spectral_flux / (context->energy.avgFlux + 1e-6f);
 
     // Check cooldown counter before allowing a beat detection
-    if (milky_energyDetectionCooldownCounter >= MILKY_COOLDOWN_PERIOD &&
+    if (context->energy.detectionCooldownCounter >= MILKY_COOLDOWN_PERIOD &&
         energy_ratio > energy_threshold && 
         flux_ratio > flux_threshold && 
         current_energy > min_volume_threshold) 
     {
         // Signal energy spike detection
         printf("native:SIGNAL:SIG_ENERGY\n");
-        milky_energyEnergySpikeDetected = 1;
+        context->energy.energySpikeDetected = 1;
         // Reset cooldown counter after detection
-        milky_energyDetectionCooldownCounter = 0;
+        context->energy.detectionCooldownCounter = 0;
     } else {
-        milky_energyEnergySpikeDetected = 0;
+        context->energy.energySpikeDetected = 0;
         // Increment counter when no detection occurs
-        milky_energyDetectionCooldownCounter++;
+        context->energy.detectionCooldownCounter++;
     }
 }
@@ -6,6 +6,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <omp.h>
+#include "../milky.h"
 
 #define MILKY_MAX_SPECTRUM_LENGTH 1024
 #define MILKY_MAX_WAVEFORM_LENGTH 1024
@@ -15,17 +16,30 @@
 #define MILKY_COOLDOWN_PERIOD 3            // Minimum number of calls between detections
 #define MILKY_PI 3.14159265358979323846
 
-extern int milky_energyEnergySpikeDetected;
-
 typedef struct {
     float a0, a1, a2, b1, b2; // Filter coefficients
     float z1, z2;             // Filter delay elements
 } BiquadFilter;
 
+// energy spike detection of a context (state preservation across function calls)
+typedef struct {
+    int energySpikeDetected;
+    float avgEnergy;
+    float avgFlux;
+    int detectionCooldownCounter; // Counter for cooldown period
+    float previousSpectrum[MILKY_MAX_SPECTRUM_LENGTH];
+    float weights[MILKY_MAX_SPECTRUM_LENGTH];
+    size_t maxBin;
+    float frequencyBinWidth;
+    int energySpikeDetectionInitialized;
+    BiquadFilter lowPassFilter;
+} EnergyState;
+
 void initLowPassFilter(BiquadFilter *filter, float cutoffFreq, float sampleRate, float Q);
 float processSample(BiquadFilter *filter, float input);
 void applyLowPassFilter(BiquadFilter *filter, float *samples, size_t length);
 void detectEnergySpike(
+    MilkyContext *context,
     const uint8_t *emphasizedWaveform,
     const uint8_t *spectrum,
     size_t waveformLength,
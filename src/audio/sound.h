@@ -9,23 +9,20 @@
 #include <stdbool.h>
 #include <omp.h>
 
-#include "../video/draw.h"
-
 #ifdef __ARM_NEON__
 #include <arm_neon.h>
 #endif
 
-// Global variable to store the average offset introduced by smoothing
-extern float milky_soundAverageOffset;
-
-// Cache for the last rendered waveform
-extern float milky_soundCachedWaveform[2048];
+#include "../milky.h"
 
-// Static variable to keep track of frame count
-extern int milky_soundFrameCounter;
+// waveform smoothing of a context
+typedef struct {
+    float averageOffset; // average offset the smoothing introduced into the last waveform
+} SoundState;
 
 // Function to smooth the bass-emphasized waveform
 void smoothBassEmphasizedWaveform(
+    MilkyContext *context,
     const uint8_t *waveform, 
     size_t waveformLength, 
     float *formattedWaveform, 
@@ -33,17 +30,4 @@ void smoothBassEmphasizedWaveform(
     float volumeScale
 );
 
-// Function to render a simple waveform with specified parameters
-void renderWaveformSimple(
-    float timeFrame,
-    uint8_t *frame,
-    size_t canvasWidthPx,
-    size_t canvasHeightPx,
-    const float *emphasizedWaveform,
-    size_t waveformLength,
-    float globalAlphaFactor,
-    int32_t yOffset,
-    int32_t xOffset 
-);
-
 #endif // SOUND_H
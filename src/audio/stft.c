@@ -0,0 +1,188 @@
+#include "stft.h"
+#include "../context.h"
+
+/**
+ * Initializes the short-time fourier transform stage. Precomputes the hann window and
+ * the FFT configuration and (re)allocates the spectrogram history ring.
+ *
+ * @param windowSize Analysis window length in samples (at most MILKY_STFT_MAX_WINDOW_SIZE).
+ * @param hopSize    Samples between two consecutive frames (at most windowSize).
+ * @param sampleRate Sample rate of the analyzed audio (per channel).
+ * @return           1 on success, 0 on failure.
+ */
+int initializeStft(MilkyContext *context, size_t windowSize, size_t hopSize, size_t sampleRate) {
+    if (windowSize < 2 || windowSize > MILKY_STFT_MAX_WINDOW_SIZE || hopSize == 0 || hopSize > windowSize) {
+        fprintf(stderr, "Invalid STFT configuration (window %zu, hop %zu).\n", windowSize, hopSize);
+        return 0;
+    }
+
+    destroyStft(context);
+
+    // the configuration lives in the context's memory (kiss_fft_alloc() only fills it in)
+    size_t configSize = 0;
+    kiss_fft_alloc((int)windowSize, 0, NULL, &configSize);
+    void *configMemory = reallocateContextMemory(context, NULL, configSize);
+    context->stft.fftConfig = configMemory ? kiss_fft_alloc((int)windowSize, 0, configMemory, &configSize) : NULL;
+    if (!context->stft.fftConfig) {
+        releaseContextMemory(context, configMemory);
+        fprintf(stderr, "Failed to allocate KISS FFT configuration for the STFT.\n");
+        return 0;
+    }
+
+    size_t binCount = windowSize / 2;
+    context->stft.spectrogram.magnitudes = (float *)reallocateContextMemory(context, NULL, MILKY_STFT_HISTORY_LENGTH * binCount * sizeof(float));
+    if (!context->stft.spectrogram.magnitudes) {
+        fprintf(stderr, "Failed to allocate spectrogram history.\n");
+        destroyStft(context);
+        return 0;
+    }
+    memset(context->stft.spectrogram.magnitudes, 0, MILKY_STFT_HISTORY_LENGTH * binCount * sizeof(float));
+
+    // periodic hann window; normalize so a full-scale sine has magnitude 1.0
+    float windowSum = 0.0f;
+    for (size_t i = 0; i < windowSize; i++) {
+        context->stft.window[i] = 0.5f - 0.5f * cosf(2.0f * 3.14159265358979323846f * (float)i / (float)windowSize);
+        windowSum += context->stft.window[i];
+    }
+    context->stft.normalization = 2.0f / windowSum;
+
+    memset(context->stft.input, 0, sizeof(context->stft.input));
+    context->stft.inputFill = windowSize - hopSize;
+
+    context->stft.spectrogram.windowSize = windowSize;
+    context->stft.spectrogram.hopSize = hopSize;
+    context->stft.spectrogram.binCount = binCount;
+    context->stft.spectrogram.sampleRate = sampleRate;
+    context->stft.spectrogram.historyLength = MILKY_STFT_HISTORY_LENGTH;
+    context->stft.spectrogram.frameCount = 0;
+    context->stft.spectrogram.pendingSamples = 0;
+    return 1;
+}
+
+/**
+ * Releases the FFT configuration and the spectrogram history.
+ */
+void destroyStft(MilkyContext *context) {
+    releaseContextMemory(context, context->stft.fftConfig);
+    context->stft.fftConfig = NULL;
+    releaseContextMemory(context, context->stft.spectrogram.magnitudes);
+    memset(&context->stft.spectrogram, 0, sizeof(context->stft.spectrogram));
+}
+
+/**
+ * Transforms the current analysis window into the next slot of the spectrogram ring.
+ */
+static void processStftFrame(MilkyContext *context) {
+    const size_t windowSize = context->stft.spectrogram.windowSize;
+    const size_t binCount = context->stft.spectrogram.binCount;
+    kiss_fft_cpx in[windowSize];
+    kiss_fft_cpx out[windowSize];
+
+    for (size_t i = 0; i < windowSize; i++) {
+        in[i].r = context->stft.input[i] * context->stft.window[i];
+        in[i].i = 0.0f;
+    }
+    kiss_fft(context->stft.fftConfig, in, out);
+
+    size_t slot = context->stft.spectrogram.frameCount & (MILKY_STFT_HISTORY_LENGTH - 1);
+    float *magnitudes = &context->stft.spectrogram.magnitudes[slot * binCount];
+    const float normalization = context->stft.normalization;
+    for (size_t k = 0; k < binCount; k++) {
+        magnitudes[k] = sqrtf(out[k].r * out[k].r + out[k].i * out[k].i) * normalization;
+    }
+
+    context->stft.spectrogram.frameCount++;
+}
+
+/**
+ * Feeds captured audio into the STFT. Samples are downmixed to mono; every time a
+ * full hop has been collected, a new frame is appended to the spectrogram ring.
+ * Initializes the STFT with the default window and hop on first use.
+ *
+ * @param samples    Interleaved 8-bit unsigned audio samples.
+ * @param length     Length of the sample buffer in bytes.
+ * @param channels   Number of interleaved channels.
+ * @param sampleRate Sample rate of the audio data (per channel).
+ * @return           Number of new frames appended to the spectrogram.
+ */
+size_t processStftAudio(MilkyContext *context, const uint8_t *samples, size_t length, size_t channels, size_t sampleRate) {
+    if (!context->stft.fftConfig || context->stft.spectrogram.sampleRate != sampleRate) {
+        size_t windowSize = context->stft.fftConfig ? context->stft.spectrogram.windowSize : MILKY_STFT_DEFAULT_WINDOW_SIZE;
+        size_t hopSize = context->stft.fftConfig ? context->stft.spectrogram.hopSize : MILKY_STFT_DEFAULT_HOP_SIZE;
+        if (!initializeStft(context, windowSize, hopSize, sampleRate)) return 0;
+    }
+    if (channels == 0) channels = 1;
+
+    const size_t windowSize = context->stft.spectrogram.windowSize;
+    const size_t hopSize = context->stft.spectrogram.hopSize;
+    const float scale = 1.0f / (128.0f * (float)channels);
+    const size_t frameCount = length / channels;
+    size_t newFrames = 0;
+
+    for (size_t i = 0; i < frameCount; i++) {
+        // downmix the interleaved channels, center around 0
+        int sum = 0;
+        for (size_t c = 0; c < channels; c++) {
+            sum += (int)samples[i * channels + c] - 128;
+        }
+        context->stft.input[context->stft.inputFill++] = (float)sum * scale;
+
+        if (context->stft.inputFill == windowSize) {
+            processStftFrame(context);
+            newFrames++;
+
+            // slide the analysis window by one hop
+            memmove(context->stft.input, context->stft.input + hopSize, (windowSize - hopSize) * sizeof(float));
+            context->stft.inputFill = windowSize - hopSize;
+        }
+    }
+
+    context->stft.spectrogram.pendingSamples = context->stft.inputFill - (windowSize - hopSize);
+    return newFrames;
+}
+
+/**
+ * Returns the spectrogram (configuration and history ring), or NULL before initialization.
+ *
+ * @return Read-only view of the spectrogram.
+ */
+const Spectrogram *getSpectrogram(MilkyContext *context) {
+    return context->stft.fftConfig ? &context->stft.spectrogram : NULL;
+}
+
+/**
+ * Returns a frame from the spectrogram history without copying it.
+ *
+ * @param framesAgo 0 for the newest frame, 1 for the one before, etc.
+ * @return          Pointer to binCount magnitudes, or NULL if that frame doesn't exist (anymore).
+ */
+const float *getSpectrogramFrame(MilkyContext *context, size_t framesAgo) {
+    if (!context->stft.fftConfig || framesAgo >= context->stft.spectrogram.frameCount || framesAgo >= MILKY_STFT_HISTORY_LENGTH) {
+        return NULL;
+    }
+    size_t slot = (context->stft.spectrogram.frameCount - 1 - framesAgo) & (MILKY_STFT_HISTORY_LENGTH - 1);
+    return &context->stft.spectrogram.magnitudes[slot * context->stft.spectrogram.binCount];
+}
+
+/**
+ * Quantizes the newest spectrogram frame to 8 bits (255 = full-scale sine).
+ *
+ * @param spectrum  Output buffer.
+ * @param maxLength Capacity of the output buffer.
+ * @return          Number of bins written (the frame's bin count, clipped to maxLength).
+ */
+size_t quantizeSpectrogramFrame(MilkyContext *context, uint8_t *spectrum, size_t maxLength) {
+    size_t bins = context->stft.spectrogram.binCount < maxLength ? context->stft.spectrogram.binCount : maxLength;
+    const float *magnitudes = getSpectrogramFrame(context, 0);
+
+    if (!magnitudes) {
+        memset(spectrum, 0, bins);
+        return bins;
+    }
+
+    for (size_t k = 0; k < bins; k++) {
+        float value = magnitudes[k] * 255.0f;
+        spectrum[k] = (uint8_t)(value > 255.0f ? 255.0f : value);
+    }
+    return bins;
+}
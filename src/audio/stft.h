@@ -0,0 +1,48 @@
+#ifndef STFT_H
+#define STFT_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "./kiss_fft/kiss_fft.h"
+#include "../allocator.h"
+
+#define MILKY_STFT_DEFAULT_WINDOW_SIZE 2048 // samples per analysis window
+#define MILKY_STFT_DEFAULT_HOP_SIZE 512     // samples between two consecutive frames (75% overlap)
+#define MILKY_STFT_MAX_WINDOW_SIZE 8192     // largest supported analysis window
+#define MILKY_STFT_HISTORY_LENGTH 128       // frames kept in the spectrogram ring (power of two)
+
+// sliding-window spectrogram: the newest frames of magnitude spectra in a ring buffer
+typedef struct {
+    size_t windowSize;     // analysis window length in samples
+    size_t hopSize;        // samples between two frames
+    size_t binCount;       // magnitudes per frame (windowSize / 2)
+    size_t sampleRate;     // sample rate of the analyzed audio (per channel)
+    size_t historyLength;  // frames kept in the ring
+    size_t frameCount;     // total frames produced so far
+    size_t pendingSamples; // samples received since the newest frame was produced
+    float *magnitudes;     // historyLength * binCount normalized magnitudes (1.0 = full-scale sine)
+} Spectrogram;
+
+// analysis state of a context: window, FFT configuration and the sliding input buffer
+typedef struct {
+    Spectrogram spectrogram;
+    kiss_fft_cfg fftConfig;
+    float window[MILKY_STFT_MAX_WINDOW_SIZE];
+    float input[MILKY_STFT_MAX_WINDOW_SIZE];
+    size_t inputFill;
+    float normalization;
+} StftState;
+
+int initializeStft(MilkyContext *context, size_t windowSize, size_t hopSize, size_t sampleRate);
+void destroyStft(MilkyContext *context);
+size_t processStftAudio(MilkyContext *context, const uint8_t *samples, size_t length, size_t channels, size_t sampleRate);
+const Spectrogram *getSpectrogram(MilkyContext *context);
+const float *getSpectrogramFrame(MilkyContext *context, size_t framesAgo);
+size_t quantizeSpectrogramFrame(MilkyContext *context, uint8_t *spectrum, size_t maxLength);
+
+#endif // STFT_H
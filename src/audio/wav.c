@@ -0,0 +1,133 @@
+#include "wav.h"
+
+static uint16_t readLittle16(const uint8_t *bytes) {
+    return (uint16_t)(bytes[0] | bytes[1] << 8);
+}
+
+static uint32_t readLittle32(const uint8_t *bytes) {
+    return (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 | (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+}
+
+/**
+ * Opens a WAVE file and moves to its sample data. Chunks other than "fmt " and
+ * "data" are skipped.
+ *
+ * @param wav  Receives the file and its format.
+ * @param path Path of the file.
+ * @return     1 on success, 0 if it can't be read or has an unsupported format.
+ */
+int openWavFile(WavFile *wav, const char *path) {
+    memset(wav, 0, sizeof(WavFile));
+    wav->file = fopen(path, "rb");
+    if (!wav->file) {
+        fprintf(stderr, "Failed to open %s: %s\n", path, strerror(errno));
+        return 0;
+    }
+
+    uint8_t header[12];
+    if (fread(header, 1, sizeof(header), wav->file) != sizeof(header)
+        || memcmp(header, "RIFF", 4) != 0 || memcmp(header + 8, "WAVE", 4) != 0) {
+        fprintf(stderr, "%s is not a WAVE file\n", path);
+        closeWavFile(wav);
+        return 0;
+    }
+
+    int hasFormat = 0;
+    uint8_t chunk[8];
+    while (fread(chunk, 1, sizeof(chunk), wav->file) == sizeof(chunk)) {
+        uint32_t size = readLittle32(chunk + 4);
+
+        if (memcmp(chunk, "fmt ", 4) == 0 && size >= 16) {
+            uint8_t format[40] = { 0 };
+            size_t length = size < sizeof(format) ? size : sizeof(format);
+            if (fread(format, 1, length, wav->file) != length) break;
+            if (size > length) fseek(wav->file, (long)(size - length), SEEK_CUR);
+
+            wav->format = readLittle16(format);
+            wav->channels = readLittle16(format + 2);
+            wav->sampleRate = readLittle32(format + 4);
+            wav->bitsPerSample = readLittle16(format + 14);
+            if (wav->format == MILKY_WAV_FORMAT_EXTENSIBLE && size >= 26) {
+                wav->format = readLittle16(format + 24); // first bytes of the sub format GUID
+            }
+            hasFormat = 1;
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            wav->dataRemaining = size;
+            break;
+        } else {
+            fseek(wav->file, (long)(size + (size & 1)), SEEK_CUR); // chunks are padded to even sizes
+        }
+    }
+
+    const int supported = hasFormat && wav->dataRemaining > 0 && wav->channels > 0 && wav->channels <= 8 && wav->sampleRate > 0
+        && ((wav->format == MILKY_WAV_FORMAT_PCM && wav->bitsPerSample % 8 == 0 && wav->bitsPerSample >= 8 && wav->bitsPerSample <= 32)
+            || (wav->format == MILKY_WAV_FORMAT_FLOAT && wav->bitsPerSample == 32));
+    if (!supported) {
+        fprintf(stderr, "%s: unsupported WAVE format (up to 8 channels of PCM 8 - 32 bit or 32-bit float expected)\n", path);
+        closeWavFile(wav);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * Converts one sample to the unsigned 8-bit format of the captured audio.
+ */
+static uint8_t toCaptureSample(const WavFile *wav, const uint8_t *sample) {
+    if (wav->format == MILKY_WAV_FORMAT_FLOAT) {
+        float value;
+        memcpy(&value, sample, sizeof(value));
+        if (!(value > -1.0f)) value = -1.0f; // also catches NaN
+        if (value > 1.0f) value = 1.0f;
+        return (uint8_t)lrintf(value * 127.0f + 128.0f);
+    }
+    if (wav->bitsPerSample == 8) return sample[0]; // 8-bit PCM is unsigned already
+    return (uint8_t)(sample[wav->bitsPerSample / 8 - 1] ^ 0x80); // most significant byte, signed to unsigned
+}
+
+/**
+ * Reads the next frames as interleaved unsigned 8-bit stereo, the format PulseAudio
+ * delivers to the capture (mono is duplicated, more channels are reduced to the
+ * first two).
+ *
+ * @param wav        The file.
+ * @param samples    Receives frameCount * 2 samples.
+ * @param frameCount Number of frames to read.
+ * @return           Number of frames read (less than frameCount at the end of the file).
+ */
+size_t readWavFrames(WavFile *wav, uint8_t *samples, size_t frameCount) {
+    const size_t sampleSize = wav->bitsPerSample / 8;
+    const size_t frameSize = sampleSize * wav->channels;
+    uint8_t buffer[MILKY_WAV_READ_FRAMES * 8 * 4]; // up to 8 channels of 32 bit per read
+    const size_t framesPerRead = sizeof(buffer) / frameSize;
+
+    size_t framesRead = 0;
+    while (framesRead < frameCount && wav->dataRemaining >= frameSize) {
+        size_t count = frameCount - framesRead;
+        if (count > framesPerRead) count = framesPerRead;
+        if (count > wav->dataRemaining / frameSize) count = (size_t)(wav->dataRemaining / frameSize);
+
+        count = fread(buffer, frameSize, count, wav->file);
+        if (count == 0) break;
+        wav->dataRemaining -= count * frameSize;
+
+        for (size_t i = 0; i < count; i++) {
+            const uint8_t *frame = buffer + i * frameSize;
+            uint8_t *destination = samples + (framesRead + i) * 2;
+            destination[0] = toCaptureSample(wav, frame);
+            destination[1] = toCaptureSample(wav, wav->channels > 1 ? frame + sampleSize : frame);
+        }
+        framesRead += count;
+    }
+    return framesRead;
+}
+
+/**
+ * Closes the file (safe to call twice).
+ */
+void closeWavFile(WavFile *wav) {
+    if (wav->file) {
+        fclose(wav->file);
+        wav->file = NULL;
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef WAV_H
+#define WAV_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+
+#define MILKY_WAV_FORMAT_PCM 1
+#define MILKY_WAV_FORMAT_FLOAT 3
+#define MILKY_WAV_FORMAT_EXTENSIBLE 0xfffe // the actual format is in the sub format GUID
+#define MILKY_WAV_READ_FRAMES 1024         // frames converted per read
+
+// a RIFF / WAVE file read sequentially (PCM 8 - 32 bit or 32-bit float)
+typedef struct {
+    FILE *file;
+    uint16_t format;        // MILKY_WAV_FORMAT_PCM or MILKY_WAV_FORMAT_FLOAT
+    uint16_t channels;
+    uint32_t sampleRate;    // frames per second
+    uint16_t bitsPerSample;
+    uint64_t dataRemaining; // bytes of sample data not read yet
+} WavFile;
+
+int openWavFile(WavFile *wav, const char *path);
+size_t readWavFrames(WavFile *wav, uint8_t *samples, size_t frameCount);
+void closeWavFile(WavFile *wav);
+
+#endif // WAV_H
@@ -0,0 +1,206 @@
+#include "batch.h"
+
+/**
+ * Checks that the outputs of the batch write files, one per track (a window or a
+ * shared memory ring can't be shared by several workers). The default outputs
+ * become the y4m output.
+ *
+ * @param config The configuration of the tracks (outputs is updated).
+ * @return       1 if the outputs fit, 0 otherwise.
+ */
+static int selectBatchOutputs(MilkyConfig *config) {
+    if (strcmp(config->outputs, MILKY_CONFIG_DEFAULT_OUTPUTS) == 0) {
+        snprintf(config->outputs, sizeof(config->outputs), "y4m");
+    }
+
+    const char *list = config->outputs;
+    while (*list) {
+        size_t length = strcspn(list, ",");
+        if (length > 0 && !(length == 3 && strncmp(list, "y4m", 3) == 0)
+            && !(length == 4 && strncmp(list, "file", 4) == 0)
+            && !(length == 4 && strncmp(list, "null", 4) == 0)) {
+            fprintf(stderr, "Batch rendering writes a file per track, use --output y4m, file or null\n");
+            return 0;
+        }
+        list += length;
+        if (*list == ',') list++;
+    }
+    return 1;
+}
+
+/**
+ * Reads the list of tracks, one WAVE file per line (empty lines and lines starting
+ * with # are skipped). Each track is written next to its input, with the extension
+ * of the output (e.g. song.wav -> song.y4m).
+ *
+ * @param path       The list ("-" = stdin).
+ * @param extension  Extension of the rendered files (e.g. ".y4m").
+ * @param tracks     Receives the tracks (free() them).
+ * @param trackCount Receives their number.
+ * @return           1 on success, 0 on failure (nothing to free then).
+ */
+static int readBatchList(const char *path, const char *extension, BatchTrack **tracks, size_t *trackCount) {
+    FILE *file = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Failed to open %s: %s\n", path, strerror(errno));
+        return 0;
+    }
+
+    BatchTrack *list = NULL;
+    size_t count = 0, capacity = 0;
+    char line[MILKY_CONFIG_MAX_PATH + 2];
+    int success = 1;
+
+    while (fgets(line, sizeof(line), file)) {
+        char *start = line;
+        while (isspace((unsigned char)*start)) start++;
+        size_t length = strlen(start);
+        while (length > 0 && isspace((unsigned char)start[length - 1])) start[--length] = '\0';
+        if (length == 0 || start[0] == '#') continue;
+
+        // the output replaces the extension of the input (if the file name has one)
+        const char *name = strrchr(start, '/');
+        const char *dot = strrchr(name ? name : start, '.');
+        size_t stemLength = dot && dot != (name ? name + 1 : start) ? (size_t)(dot - start) : length;
+        if (length >= MILKY_CONFIG_MAX_PATH || stemLength + strlen(extension) >= MILKY_CONFIG_MAX_PATH) {
+            fprintf(stderr, "Path too long: %s\n", start);
+            success = 0;
+            break;
+        }
+
+        if (count == capacity) {
+            size_t grown = capacity ? capacity * 2 : 16;
+            BatchTrack *resized = (BatchTrack *)realloc(list, grown * sizeof(BatchTrack));
+            if (!resized) {
+                fprintf(stderr, "Failed to allocate the track list\n");
+                success = 0;
+                break;
+            }
+            list = resized;
+            capacity = grown;
+        }
+
+        BatchTrack *track = &list[count++];
+        memcpy(track->inputFile, start, length + 1);
+        memcpy(track->outputFile, start, stemLength);
+        strcpy(track->outputFile + stemLength, extension);
+        track->worker = 0;
+        track->threads = 0;
+    }
+
+    if (file != stdin) fclose(file);
+    if (success && count == 0) {
+        fprintf(stderr, "%s lists no tracks\n", path);
+        success = 0;
+    }
+    if (!success) {
+        free(list);
+        return 0;
+    }
+    *tracks = list;
+    *trackCount = count;
+    return 1;
+}
+
+/**
+ * Renders a list of tracks (--batch), several at once. The renderer itself is per
+ * context, but every track is rendered by its own worker process: the driver of a
+ * track (runFile() and the canvas, configuration and context it keeps in capture.c)
+ * and the output backends (the active list of output.c, the stream and writer thread
+ * of y4m.c, the stream of file.c) exist once per process, and a track that crashes
+ * only fails itself. The processors are shared out among the running workers as
+ * OpenMP threads, so the last tracks get more threads once fewer are left than jobs.
+ *
+ * @param config The configuration (batchFile lists the tracks, jobs limits the workers).
+ * @param render Renders a track in a worker (called with inputFile and outputFile set).
+ * @return       0 if every track was rendered, 1 otherwise (exit code of the process).
+ */
+int runBatch(const MilkyConfig *config, BatchRenderFunction render) {
+    MilkyConfig trackConfig = *config;
+    trackConfig.batchFile[0] = '\0';
+    if (!selectBatchOutputs(&trackConfig)) return 1;
+
+    BatchTrack *tracks = NULL;
+    size_t trackCount = 0;
+    const char *extension = strstr(trackConfig.outputs, "y4m") ? ".y4m" : ".rgba";
+    if (!readBatchList(config->batchFile, extension, &tracks, &trackCount)) return 1;
+
+    const int processors = omp_get_num_procs();
+    size_t jobs = config->jobs;
+    if (jobs == 0) jobs = processors / MILKY_BATCH_THREADS_PER_JOB > 0 ? (size_t)(processors / MILKY_BATCH_THREADS_PER_JOB) : 1;
+    if (jobs > trackCount) jobs = trackCount;
+    fprintf(stderr, "Rendering %zu tracks, %zu at a time on %d processors\n", trackCount, jobs, processors);
+
+    struct timeval startTime, endTime;
+    gettimeofday(&startTime, NULL);
+
+    // the workers inherit the buffers, flushing them keeps messages from being printed twice
+    fflush(stdout);
+    fflush(stderr);
+
+    size_t next = 0, running = 0, failed = 0;
+    int freeThreads = processors;
+
+    while (next < trackCount || running > 0) {
+        // start workers for the free slots, sharing the free threads among them
+        while (running < jobs && next < trackCount) {
+            size_t starting = jobs - running < trackCount - next ? jobs - running : trackCount - next;
+            int threads = freeThreads / (int)starting;
+            if (threads < 1) threads = 1;
+
+            BatchTrack *track = &tracks[next];
+            pid_t worker = fork();
+            if (worker < 0) {
+                fprintf(stderr, "Failed to start a worker: %s\n", strerror(errno));
+                if (running == 0) {
+                    failed += trackCount - next; // nothing to wait for, so nothing would ever start
+                    next = trackCount;
+                }
+                break;
+            }
+            if (worker == 0) {
+                omp_set_num_threads(threads);
+                memcpy(trackConfig.inputFile, track->inputFile, sizeof(trackConfig.inputFile));
+                memcpy(trackConfig.outputFile, track->outputFile, sizeof(trackConfig.outputFile));
+                exit(render(&trackConfig));
+            }
+
+            fprintf(stderr, "Started %s -> %s (%d threads)\n", track->inputFile, track->outputFile, threads);
+            track->worker = worker;
+            track->threads = threads;
+            freeThreads -= threads;
+            running++;
+            next++;
+        }
+        if (running == 0) break;
+
+        int status = 0;
+        pid_t worker = waitpid(-1, &status, 0);
+        if (worker < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "Failed to wait for the workers: %s\n", strerror(errno));
+            failed += trackCount - next + running;
+            break;
+        }
+
+        for (size_t i = 0; i < trackCount; i++) {
+            if (tracks[i].worker != worker) continue;
+
+            const int success = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+            if (!success) failed++;
+            fprintf(stderr, "%s %s\n", success ? "Finished" : "Failed to render", tracks[i].inputFile);
+
+            tracks[i].worker = 0;
+            freeThreads += tracks[i].threads;
+            running--;
+            break;
+        }
+    }
+
+    gettimeofday(&endTime, NULL);
+    const double elapsed = (double)(endTime.tv_sec - startTime.tv_sec) + (double)(endTime.tv_usec - startTime.tv_usec) / 1e6;
+    fprintf(stderr, "Rendered %zu of %zu tracks in %.1f s\n", trackCount - failed, trackCount, elapsed);
+
+    free(tracks);
+    return failed > 0 ? 1 : 0;
+}
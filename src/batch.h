@@ -0,0 +1,34 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/time.h>
+#include <omp.h>
+
+#include "./config.h"
+
+#define MILKY_BATCH_THREADS_PER_JOB 4 // threads per track when the number of jobs is picked automatically
+
+// renders one track in a worker process (inputFile / outputFile are set; returns the exit code)
+typedef int (*BatchRenderFunction)(const MilkyConfig *config);
+
+// a track of the batch and the worker process rendering it
+typedef struct {
+    char inputFile[MILKY_CONFIG_MAX_PATH];
+    char outputFile[MILKY_CONFIG_MAX_PATH];
+    pid_t worker;   // 0 = not started yet (or finished)
+    int threads;    // OpenMP threads of the worker
+} BatchTrack;
+
+int runBatch(const MilkyConfig *config, BatchRenderFunction render);
+
+#endif // BATCH_H
@@ -0,0 +1,305 @@
+#include "config.h"
+
+/**
+ * Returns the configuration used when nothing is configured: a 1080p window on the
+ * primary monitor whose canvas follows the window size.
+ *
+ * @return The default configuration.
+ */
+MilkyConfig getDefaultConfig(void) {
+    MilkyConfig config = {
+        .width = MILKY_CONFIG_DEFAULT_WIDTH,
+        .height = MILKY_CONFIG_DEFAULT_HEIGHT,
+        .fullscreen = 0,
+        .monitor = 0,
+        .fixedCanvas = 0,
+        .presetDirectory = "",
+        .presetIndex = 0,
+        .watchPresets = 0,
+        .presetDuration = 0.0f,
+        .interpolateFrames = 1,
+        .outputs = MILKY_CONFIG_DEFAULT_OUTPUTS,
+        .exportName = MILKY_CONFIG_DEFAULT_EXPORT,
+        .exportSlots = MILKY_EXPORT_DEFAULT_SLOTS,
+        .outputFile = "milky_osd.rgba",
+        .inputFile = "",
+        .frameRate = MILKY_CONFIG_DEFAULT_FRAME_RATE,
+        .batchFile = "",
+        .jobs = 0
+    };
+    return config;
+}
+
+/**
+ * Parses a canvas dimension (0 = size of the monitor).
+ *
+ * @param value The text to parse.
+ * @param size  Receives the dimension.
+ * @return      1 on success, 0 if the value isn't a valid dimension.
+ */
+static int parseSize(const char *value, size_t *size) {
+    char *end = NULL;
+    unsigned long parsed = strtoul(value, &end, 10);
+    if (end == value || *end != '\0' || parsed > MILKY_CONFIG_MAX_SIZE) return 0;
+    *size = (size_t)parsed;
+    return 1;
+}
+
+/**
+ * Parses a canvas size in the form WIDTHxHEIGHT (for example 3840x2160).
+ *
+ * @param value  The text to parse.
+ * @param config Receives the width and height.
+ * @return       1 on success, 0 if the value isn't a valid size.
+ */
+static int parseCanvasSize(const char *value, MilkyConfig *config) {
+    char width[32];
+    const char *separator = strchr(value, 'x');
+    if (!separator || (size_t)(separator - value) >= sizeof(width)) return 0;
+
+    memcpy(width, value, (size_t)(separator - value));
+    width[separator - value] = '\0';
+    return parseSize(width, &config->width) && parseSize(separator + 1, &config->height);
+}
+
+/**
+ * Applies one option (from the command line or a config file) to the configuration.
+ *
+ * @param key    Name of the option (without leading dashes).
+ * @param value  Value of the option (NULL for switches given without a value).
+ * @param config The configuration to update.
+ * @return       1 on success, 0 for unknown options or invalid values.
+ */
+static int applyConfigOption(const char *key, const char *value, MilkyConfig *config) {
+    if (strcmp(key, "fullscreen") == 0) {
+        config->fullscreen = value ? atoi(value) != 0 : 1;
+        return 1;
+    }
+    if (strcmp(key, "fixed-canvas") == 0 || strcmp(key, "fixed_canvas") == 0) {
+        config->fixedCanvas = value ? atoi(value) != 0 : 1;
+        return 1;
+    }
+    if (strcmp(key, "watch-presets") == 0 || strcmp(key, "watch_presets") == 0) {
+        config->watchPresets = value ? atoi(value) != 0 : 1;
+        return 1;
+    }
+    if (!value) return 0;
+
+    if (strcmp(key, "width") == 0) return parseSize(value, &config->width);
+    if (strcmp(key, "height") == 0) return parseSize(value, &config->height);
+    if (strcmp(key, "size") == 0) return parseCanvasSize(value, config);
+    if (strcmp(key, "presets") == 0) {
+        size_t length = strlen(value);
+        if (length >= sizeof(config->presetDirectory)) return 0;
+        memcpy(config->presetDirectory, value, length + 1);
+        return 1;
+    }
+    if (strcmp(key, "preset") == 0) {
+        char *end = NULL;
+        unsigned long index = strtoul(value, &end, 10);
+        if (end == value || *end != '\0') return 0;
+        config->presetIndex = (size_t)index;
+        return 1;
+    }
+    if (strcmp(key, "preset-duration") == 0 || strcmp(key, "preset_duration") == 0) {
+        char *end = NULL;
+        float seconds = strtof(value, &end);
+        if (end == value || *end != '\0' || !(seconds >= 0.0f)) return 0;
+        config->presetDuration = seconds;
+        return 1;
+    }
+    if (strcmp(key, "input") == 0) {
+        size_t length = strlen(value);
+        if (length >= sizeof(config->inputFile)) return 0;
+        memcpy(config->inputFile, value, length + 1);
+        return 1;
+    }
+    if (strcmp(key, "batch") == 0) {
+        size_t length = strlen(value);
+        if (length >= sizeof(config->batchFile)) return 0;
+        memcpy(config->batchFile, value, length + 1);
+        return 1;
+    }
+    if (strcmp(key, "jobs") == 0) {
+        char *end = NULL;
+        unsigned long jobs = strtoul(value, &end, 10);
+        if (end == value || *end != '\0' || jobs > MILKY_CONFIG_MAX_JOBS) return 0;
+        config->jobs = (size_t)jobs;
+        return 1;
+    }
+    if (strcmp(key, "fps") == 0) {
+        char *end = NULL;
+        unsigned long frameRate = strtoul(value, &end, 10);
+        if (end == value || *end != '\0' || frameRate == 0 || frameRate > MILKY_CONFIG_MAX_FRAME_RATE) return 0;
+        config->frameRate = (unsigned)frameRate;
+        return 1;
+    }
+    if (strcmp(key, "interpolate") == 0) {
+        config->interpolateFrames = atoi(value) != 0;
+        return 1;
+    }
+    if (strcmp(key, "output") == 0) {
+        size_t length = strlen(value);
+        if (length == 0 || length >= sizeof(config->outputs)) return 0;
+        memcpy(config->outputs, value, length + 1);
+        return 1;
+    }
+    if (strcmp(key, "output-file") == 0 || strcmp(key, "output_file") == 0) {
+        size_t length = strlen(value);
+        if (length == 0 || length >= sizeof(config->outputFile)) return 0;
+        memcpy(config->outputFile, value, length + 1);
+        return 1;
+    }
+    if (strcmp(key, "export") == 0) {
+        size_t length = strlen(value);
+        if (length == 0 || length >= sizeof(config->exportName) || strchr(value + 1, '/')) return 0;
+        memcpy(config->exportName, value, length + 1);
+        return 1;
+    }
+    if (strcmp(key, "export-slots") == 0 || strcmp(key, "export_slots") == 0) {
+        char *end = NULL;
+        unsigned long slots = strtoul(value, &end, 10);
+        if (end == value || *end != '\0' || slots < 2 || slots > MILKY_EXPORT_MAX_SLOTS) return 0;
+        config->exportSlots = (size_t)slots;
+        return 1;
+    }
+    if (strcmp(key, "monitor") == 0) {
+        config->monitor = atoi(value);
+        return config->monitor >= 0;
+    }
+    return 0;
+}
+
+/**
+ * Loads a config file made of `key = value` lines (same keys as the command line
+ * options, '#' starts a comment).
+ *
+ * @param path   Path of the config file.
+ * @param config The configuration to update.
+ * @return       1 on success, 0 if the file can't be read or contains invalid options.
+ */
+int loadConfigFile(const char *path, MilkyConfig *config) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Failed to open config file: %s\n", path);
+        return 0;
+    }
+
+    char line[MILKY_CONFIG_MAX_LINE];
+    int lineNumber = 0, success = 1;
+    while (fgets(line, sizeof(line), file)) {
+        lineNumber++;
+
+        // strip comments and trailing whitespace
+        char *comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+        size_t length = strlen(line);
+        while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r' || line[length - 1] == ' ' || line[length - 1] == '\t')) {
+            line[--length] = '\0';
+        }
+
+        char *key = line;
+        while (*key == ' ' || *key == '\t') key++;
+        if (*key == '\0') continue;
+
+        char *value = strchr(key, '=');
+        if (value) {
+            char *keyEnd = value;
+            *value++ = '\0';
+            while (keyEnd > key && (keyEnd[-1] == ' ' || keyEnd[-1] == '\t')) *--keyEnd = '\0';
+            while (*value == ' ' || *value == '\t') value++;
+        }
+
+        if (!applyConfigOption(key, value, config)) {
+            fprintf(stderr, "%s:%d: invalid option '%s'\n", path, lineNumber, key);
+            success = 0;
+        }
+    }
+
+    fclose(file);
+    return success;
+}
+
+/**
+ * Parses the command line options into the configuration. Options are given as
+ * `--key value` or `--key=value`; `--config FILE` loads a config file at that
+ * position, so later options override it.
+ *
+ * @param argc   Number of arguments.
+ * @param argv   The arguments.
+ * @param config The configuration to update.
+ * @return       1 to continue, 0 if the program should exit (invalid options or --help).
+ */
+int parseCommandLine(int argc, char *argv[], MilkyConfig *config) {
+    for (int i = 1; i < argc; i++) {
+        const char *argument = argv[i];
+
+        if (strcmp(argument, "--help") == 0 || strcmp(argument, "-h") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        }
+        if (strncmp(argument, "--", 2) != 0) {
+            fprintf(stderr, "Unexpected argument: %s\n", argument);
+            printUsage(argv[0]);
+            return 0;
+        }
+
+        char key[64];
+        const char *value = NULL;
+        const char *equals = strchr(argument + 2, '=');
+        size_t keyLength = equals ? (size_t)(equals - argument - 2) : strlen(argument + 2);
+        if (keyLength >= sizeof(key)) keyLength = sizeof(key) - 1;
+        memcpy(key, argument + 2, keyLength);
+        key[keyLength] = '\0';
+
+        if (equals) {
+            value = equals + 1;
+        } else if (strcmp(key, "fullscreen") != 0 && strcmp(key, "fixed-canvas") != 0
+            && strcmp(key, "watch-presets") != 0 && i + 1 < argc) {
+            value = argv[++i];
+        }
+
+        int success = strcmp(key, "config") == 0
+            ? value && loadConfigFile(value, config)
+            : applyConfigOption(key, value, config);
+
+        if (!success) {
+            fprintf(stderr, "Invalid option: %s\n", argument);
+            printUsage(argv[0]);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Prints the command line options.
+ *
+ * @param program Name of the executable (argv[0]).
+ */
+void printUsage(const char *program) {
+    fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  --size WxH        canvas size, e.g. 3840x2160 (0x0 = size of the monitor)\n"
+        "  --width N         canvas width in pixels\n"
+        "  --height N        canvas height in pixels\n"
+        "  --fullscreen      fullscreen on the selected monitor\n"
+        "  --monitor N       monitor to use (0 = primary)\n"
+        "  --fixed-canvas    keep the canvas size when the window is resized\n"
+        "  --presets DIR     load the presets (*.milk, *.ini) of a directory\n"
+        "  --preset N        preset to start with (0 = first)\n"
+        "  --watch-presets   reload presets when files of the preset directory change\n"
+        "  --preset-duration S  blend to the next preset every S seconds (0 = stay)\n"
+        "  --interpolate 0|1 present at the display refresh rate between rendered frames (default 1)\n"
+        "  --output LIST     where the frames go, comma separated: glfw (window), shm, file, y4m, null\n"
+        "                    (default " MILKY_CONFIG_DEFAULT_OUTPUTS ")\n"
+        "  --export NAME     shared memory ring of the shm output (/dev/shm/NAME, default " MILKY_CONFIG_DEFAULT_EXPORT ")\n"
+        "  --export-slots N  frames in the shared memory ring (2 - 8, default 3)\n"
+        "  --output-file F   raw RGBA frames of the file output, the stream of the y4m output (- = stdout)\n"
+        "  --input FILE      render a WAVE file as fast as possible instead of the captured audio\n"
+        "  --fps N           frames per second of --input and the y4m output (default 30)\n"
+        "  --batch LIST      render the WAVE files listed in LIST (one per line, - = stdin) to FILE.y4m\n"
+        "  --jobs N          tracks of --batch rendered at once (0 = one per 4 processors)\n"
+        "  --config FILE     load options from a file (key = value per line)\n",
+        program);
+}
@@ -0,0 +1,56 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "./video/export.h"
+
+#define MILKY_CONFIG_DEFAULT_WIDTH 1920  // canvas width unless configured otherwise
+#define MILKY_CONFIG_DEFAULT_HEIGHT 1080 // canvas height unless configured otherwise
+#define MILKY_CONFIG_MAX_SIZE 16384      // upper limit for either canvas dimension
+#define MILKY_CONFIG_MAX_LINE 256        // longest line read from a config file
+#define MILKY_CONFIG_MAX_PATH 1024       // longest path in the configuration
+#define MILKY_CONFIG_MAX_OUTPUTS 64      // longest list of output backends
+
+// backends the frames go to unless configured otherwise (see output.h)
+#ifdef MILKY_WITH_GLFW
+#define MILKY_CONFIG_DEFAULT_OUTPUTS "glfw"
+#else
+#define MILKY_CONFIG_DEFAULT_OUTPUTS "null"
+#endif
+#define MILKY_CONFIG_DEFAULT_EXPORT "milky_osd"
+#define MILKY_CONFIG_DEFAULT_FRAME_RATE 30 // frames per second rendered from an input file
+#define MILKY_CONFIG_MAX_FRAME_RATE 240
+#define MILKY_CONFIG_MAX_JOBS 256 // upper limit for the tracks of a batch rendered at once
+
+typedef struct {
+    size_t width;      // canvas (internal render) width in pixels, 0 = size of the monitor
+    size_t height;     // canvas (internal render) height in pixels, 0 = size of the monitor
+    int fullscreen;    // 1 = fullscreen on the selected monitor
+    int monitor;       // index of the monitor to use (0 = primary)
+    int fixedCanvas;   // 1 = keep the canvas size when the window is resized (the image is stretched)
+    char presetDirectory[MILKY_CONFIG_MAX_PATH]; // directory with *.milk / *.ini presets ("" = none)
+    size_t presetIndex;                          // index of the preset to start with
+    int watchPresets;                            // 1 = reload presets when files of the directory change
+    float presetDuration;                        // seconds per preset before blending to the next (0 = stay)
+    int interpolateFrames;                       // 1 = present at the display refresh rate, continuing the motion between frames
+    char outputs[MILKY_CONFIG_MAX_OUTPUTS];      // comma separated backends the frames go to (glfw, shm, file, y4m, null)
+    char exportName[MILKY_CONFIG_MAX_PATH];      // shared memory of the shm output (/dev/shm/NAME)
+    size_t exportSlots;                          // frames in the shared memory ring
+    char outputFile[MILKY_CONFIG_MAX_PATH];      // file of the file and y4m outputs ("-" = stdout)
+    char inputFile[MILKY_CONFIG_MAX_PATH];       // WAVE file rendered as fast as possible instead of the captured audio ("" = capture)
+    unsigned frameRate;                          // frames per second of the input file (and of the y4m output)
+    char batchFile[MILKY_CONFIG_MAX_PATH];       // list of WAVE files rendered like inputFile, several at once ("" = none, see batch.h)
+    size_t jobs;                                 // tracks of the batch rendered at once (0 = picked from the processor count)
+} MilkyConfig;
+
+MilkyConfig getDefaultConfig(void);
+int loadConfigFile(const char *path, MilkyConfig *config);
+int parseCommandLine(int argc, char *argv[], MilkyConfig *config);
+void printUsage(const char *program);
+
+#endif // CONFIG_H
@@ -0,0 +1,260 @@
+#include "context.h"
+
+/**
+ * Grows the frame of a context to a canvas size (it never shrinks).
+ *
+ * @return 1 on success, 0 on allocation failure (the old frame stays valid).
+ */
+static int reserveContextFrame(MilkyContext *context, size_t width, size_t height) {
+    const size_t frameSize = width * height * 4; // RGBA
+    if (context->frame && frameSize <= context->frameCapacity) return 1;
+
+    uint8_t *resized = (uint8_t *)reallocateWith(&context->options.allocator, context->frame, frameSize);
+    if (!resized) {
+        fprintf(stderr, "Failed to allocate a %zux%zu frame\n", width, height);
+        return 0;
+    }
+    context->frame = resized;
+    context->frameCapacity = frameSize;
+    return 1;
+}
+
+/**
+ * Returns the options of a context that renders 1280x720 from 44.1 kHz stereo with
+ * the process' OpenMP threads and the system allocator, starting with the first preset.
+ */
+MilkyContextOptions milky_context_default_options(void) {
+    MilkyContextOptions options;
+    memset(&options, 0, sizeof(options));
+    options.width = MILKY_CONTEXT_DEFAULT_WIDTH;
+    options.height = MILKY_CONTEXT_DEFAULT_HEIGHT;
+    options.sampleRate = MILKY_CONTEXT_DEFAULT_SAMPLE_RATE;
+    options.channels = MILKY_CONTEXT_DEFAULT_CHANNELS;
+    options.seed = MILKY_CONTEXT_DEFAULT_SEED;
+    return options;
+}
+
+/**
+ * Creates an independent renderer. Contexts share nothing but the loaded presets, so
+ * several of them can render different streams in one process, each on its own thread
+ * and with its own thread budget.
+ *
+ * @param options The options (NULL = milky_context_default_options()).
+ * @return        The context, or NULL on invalid options or allocation failure.
+ */
+MilkyContext *milky_context_create(const MilkyContextOptions *options) {
+    MilkyContextOptions resolved = options ? *options : milky_context_default_options();
+    if (resolved.width == 0 || resolved.height == 0 || resolved.sampleRate == 0 || resolved.channels == 0) {
+        fprintf(stderr, "Invalid context options (%zux%zu, %zu Hz, %zu channels)\n",
+            resolved.width, resolved.height, resolved.sampleRate, resolved.channels);
+        return NULL;
+    }
+
+    MilkyContext *context = (MilkyContext *)reallocateWith(&resolved.allocator, NULL, sizeof(MilkyContext));
+    if (!context) {
+        fprintf(stderr, "Failed to allocate a context\n");
+        return NULL;
+    }
+    memset(context, 0, sizeof(MilkyContext));
+    context->options = resolved;
+    context->random = resolved.seed ? resolved.seed : MILKY_CONTEXT_DEFAULT_SEED; // xorshift never leaves 0
+
+    if (!reserveContextFrame(context, resolved.width, resolved.height)) {
+        reallocateWith(&resolved.allocator, context, 0);
+        return NULL;
+    }
+    context->width = resolved.width;
+    context->height = resolved.height;
+    memset(context->frame, 0, context->frameCapacity); // black until the first frame
+
+    // the spectrum has its full length (silent) before the first audio is analyzed
+    if (!initializeStft(context, MILKY_STFT_DEFAULT_WINDOW_SIZE, MILKY_STFT_DEFAULT_HOP_SIZE, resolved.sampleRate)) {
+        reallocateWith(&resolved.allocator, context->frame, 0);
+        reallocateWith(&resolved.allocator, context, 0);
+        return NULL;
+    }
+
+    if (!initializeDisplacementWorker(context)) {
+        fprintf(stderr, "Failed to create the displacement map worker of a context\n");
+        destroyStft(context);
+        reallocateWith(&resolved.allocator, context->frame, 0);
+        reallocateWith(&resolved.allocator, context, 0);
+        return NULL;
+    }
+
+    context->presets = acquirePresetSnapshot();
+    initializeVideo(context);
+    initializeSpectrumBands(context, MILKY_BAND_SCALE_LOG, MILKY_BANDS_DEFAULT_COUNT, MILKY_BANDS_DEFAULT_FLOOR_DB, MILKY_BANDS_DEFAULT_CEILING_DB);
+    initializePaletteTransition(context, MILKY_PALETTE_DEFAULT_TRANSITION_STEPS);
+    setVideoPresetIndex(context, resolved.presetIndex);
+    setVideoPresetDuration(context, resolved.presetDuration);
+    return context;
+}
+
+/**
+ * Feeds audio to the spectral analysis and the beat tracker of a context. Call it
+ * with every chunk of the stream, rendered or not, so the trackers keep their clock.
+ *
+ * @param context     The context.
+ * @param samples     Interleaved unsigned 8-bit samples (channels of the options).
+ * @param length      Their size in bytes.
+ * @param currentTime Time of the chunk in milliseconds.
+ * @return            Number of new STFT frames the chunk completed.
+ */
+size_t milky_context_analyze(MilkyContext *context, const uint8_t *samples, size_t length, size_t currentTime) {
+    if (!context || !samples || length == 0) return 0;
+
+    size_t newFrames = processStftAudio(context, samples, length, context->options.channels, context->options.sampleRate);
+    processBeatFrames(context, newFrames, currentTime);
+    return newFrames;
+}
+
+/**
+ * Renders a frame of a context with its thread budget. The audio must have been
+ * analyzed up to now (see milky_context_analyze()). Different contexts can render
+ * at the same time on different threads; a context itself must only be used by
+ * one thread at a time.
+ *
+ * @param context     The context.
+ * @param waveform    The newest audio (interleaved unsigned 8-bit samples), drawn as the scope
+ *                    (NULL = silence).
+ * @param length      Its size in bytes, at least MILKY_VIDEO_MIN_WAVEFORM_LENGTH; only the
+ *                    newest MILKY_CONTEXT_MAX_WAVEFORM_LENGTH bytes are drawn.
+ * @param currentTime Time of the frame in milliseconds (drives the animations).
+ * @return            The frame (RGBA, see milky_context_get_size()), valid until the next
+ *                    render, resize or destroy of the context; NULL without a context or
+ *                    with a too short waveform.
+ */
+const uint8_t *milky_context_render(MilkyContext *context, const uint8_t *waveform, size_t length, size_t currentTime) {
+    if (!context) return NULL;
+
+    uint8_t silence[MILKY_CONTEXT_SILENCE_LENGTH];
+    if (!waveform) {
+        memset(silence, 128, sizeof(silence));
+        waveform = silence;
+        length = sizeof(silence);
+    } else if (length < MILKY_VIDEO_MIN_WAVEFORM_LENGTH) {
+        fprintf(stderr, "Waveform of %zu bytes is too short to render (at least %d)\n", length, MILKY_VIDEO_MIN_WAVEFORM_LENGTH);
+        return NULL;
+    } else if (length > MILKY_CONTEXT_MAX_WAVEFORM_LENGTH) {
+        // keep whole sample frames, so the channels stay interleaved as they were
+        const size_t cut = (length - MILKY_CONTEXT_MAX_WAVEFORM_LENGTH + context->options.channels - 1)
+            / context->options.channels * context->options.channels;
+        waveform += cut;
+        length -= cut;
+    }
+
+    // the thread budget is an ICV of the calling thread, so contexts on other threads keep theirs
+    const int previousThreads = omp_get_max_threads();
+    if (context->options.threads > 0) omp_set_num_threads(context->options.threads);
+
+    // the frequency spectrum comes from the newest STFT frame, so it has the
+    // same resolution on every render (necessary to calculate the spectral flux)
+    uint8_t spectrum[MILKY_STFT_MAX_WINDOW_SIZE / 2];
+    size_t spectrumLength = quantizeSpectrogramFrame(context, spectrum, sizeof(spectrum));
+
+    // perceptual (log / mel spaced) band levels for the spectrum-driven effects
+    const Spectrogram *spectrogram = getSpectrogram(context);
+    if (spectrogram) {
+        updateSpectrumBands(context, getSpectrogramFrame(context, 0), spectrogram->binCount, spectrogram->sampleRate);
+    }
+
+    // presets reloaded since the last frame are picked up now; the snapshot stays
+    // valid while this frame reads it, however often presets are reloaded meanwhile
+    refreshPresetSnapshot(&context->presets);
+    render(
+        context,
+        context->frame,
+        context->width,
+        context->height,
+        waveform,
+        spectrum,
+        length,
+        spectrumLength,
+        MILKY_CONTEXT_BIT_DEPTH,
+        NULL,
+        0.0123f,
+        currentTime,
+        context->options.sampleRate
+    );
+
+    if (context->options.threads > 0) omp_set_num_threads(previousThreads);
+    return context->frame;
+}
+
+/**
+ * Changes the canvas size of a context (between frames). The feedback history
+ * starts over black with the next frame.
+ *
+ * @return 1 on success, 0 on an invalid size or allocation failure (the size stays).
+ */
+int milky_context_resize(MilkyContext *context, size_t width, size_t height) {
+    if (!context || width == 0 || height == 0) return 0;
+    if (!reserveContextFrame(context, width, height)) return 0;
+
+    context->width = width;
+    context->height = height;
+    memset(context->frame, 0, width * height * 4); // black until the next frame
+    return 1;
+}
+
+/**
+ * Returns the canvas size of a context (the size of its frames).
+ */
+void milky_context_get_size(const MilkyContext *context, size_t *width, size_t *height) {
+    if (width) *width = context ? context->width : 0;
+    if (height) *height = context ? context->height : 0;
+}
+
+/**
+ * Returns the motion the last frame of a context applied to its feedback image
+ * (see getVideoFrameMotion()).
+ */
+DisplayMotion getContextFrameMotion(const MilkyContext *context) {
+    return context->video.frameMotion;
+}
+
+/**
+ * Draws the next number of the random sequence of a context (xorshift32). Each context
+ * has its own sequence, so concurrent contexts don't disturb each other's frames.
+ *
+ * @return A number in [1, UINT32_MAX].
+ */
+uint32_t nextContextRandom(MilkyContext *context) {
+    uint32_t state = context->random;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    context->random = state;
+    return state;
+}
+
+/**
+ * Stops the worker of a context and frees everything it allocated (NULL is ignored).
+ */
+void milky_context_destroy(MilkyContext *context) {
+    if (!context) return;
+
+    destroyDisplacementWorker(context);
+    destroyEffects(context);
+    destroyRasterBatch(context);
+    destroyVideo(context);
+    destroySpectrumBands(context);
+    destroyStft(context);
+    releasePresetSnapshot(context->presets);
+
+    MilkyAllocator allocator = context->options.allocator;
+    reallocateWith(&allocator, context->frame, 0);
+    reallocateWith(&allocator, context, 0);
+}
+
+/**
+ * Loads the presets of a directory into the table all contexts share (presets are
+ * selected with presetIndex). Contexts may be rendering meanwhile: each one switches
+ * to the new table at the start of its next frame.
+ *
+ * @return Number of presets loaded.
+ */
+size_t milky_load_presets(const char *directory) {
+    return reloadPresetDirectory(directory);
+}
@@ -0,0 +1,81 @@
+#ifndef CONTEXT_H
+#define CONTEXT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <omp.h>
+
+#include "./milky.h"
+#include "./allocator.h"
+#include "./video.h"
+#include "./video/raster.h"
+#include "./video/effects/dots.h"
+#include "./video/effects/grid.h"
+#include "./video/effects/nuclide.h"
+#include "./video/effects/shadebobs.h"
+#include "./video/effects/solar.h"
+#include "./video/effects/spectrum.h"
+
+#define MILKY_CONTEXT_DEFAULT_WIDTH 1280
+#define MILKY_CONTEXT_DEFAULT_HEIGHT 720
+#define MILKY_CONTEXT_DEFAULT_SAMPLE_RATE 44100
+#define MILKY_CONTEXT_DEFAULT_CHANNELS 2
+#define MILKY_CONTEXT_DEFAULT_SEED 42
+#define MILKY_CONTEXT_BIT_DEPTH 32 // frames are rendered without quantization
+#define MILKY_CONTEXT_MAX_WAVEFORM_LENGTH 16384 // longer waveforms are cut to their newest bytes
+#define MILKY_CONTEXT_SILENCE_LENGTH 1470 // bytes drawn without a waveform (1/30 s of 44.1 kHz stereo)
+
+// an independent renderer: its frame and the state of every module of the render path
+struct MilkyContext {
+    MilkyContextOptions options;
+
+    // the rendered frame (RGBA), grown with the canvas
+    uint8_t *frame;
+    size_t frameCapacity;
+    size_t width;
+    size_t height;
+
+    // presets the frames read (see refreshPresetSnapshot())
+    const PresetSnapshot *presets;
+
+    // state of the random numbers (see nextContextRandom())
+    uint32_t random;
+
+    // analysis
+    StftState stft;
+    BeatState beat;
+    BandsState bands;
+    EnergyState energy;
+    SoundState sound;
+
+    // rendering
+    VideoState video;
+    PaletteState palette;
+    TransformState transform;
+    TransitionState transition;
+    WarpState warp;
+    DisplaceState displace;
+    RasterState raster;
+    BitDepthState bitdepth;
+
+    // effects
+    EffectState effect;
+    ChaserState chaser;
+    TunnelState tunnel;
+    WaveformState waveform;
+    DotsState dots;
+    GridState grid;
+    NuclideState nuclide;
+    ShadebobsState shadebobs;
+    SolarState solar;
+    SpectrumState spectrum;
+};
+
+DisplayMotion getContextFrameMotion(const MilkyContext *context);
+uint32_t nextContextRandom(MilkyContext *context);
+
+#endif // CONTEXT_H
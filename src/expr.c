@@ -0,0 +1,674 @@
+#include "expr.h"
+
+#define MILKY_EXPR_CONSTANT_BASE MILKY_EXPR_MAX_VARIABLES
+#define MILKY_EXPR_TEMPORARY_BASE (MILKY_EXPR_MAX_VARIABLES + MILKY_EXPR_MAX_CONSTANTS)
+
+// a built-in function and the instruction it compiles to
+typedef struct {
+    const char *name;
+    ExprOpcode opcode;
+    int argumentCount;
+} ExprFunction;
+
+// Milkdrop's function set
+static const ExprFunction milky_exprFunctions[] = {
+    { "abs", MILKY_EXPR_OP_ABS, 1 },     { "above", MILKY_EXPR_OP_ABOVE, 2 }, { "acos", MILKY_EXPR_OP_ACOS, 1 },
+    { "asin", MILKY_EXPR_OP_ASIN, 1 },   { "atan", MILKY_EXPR_OP_ATAN, 1 },   { "atan2", MILKY_EXPR_OP_ATAN2, 2 },
+    { "band", MILKY_EXPR_OP_AND, 2 },    { "below", MILKY_EXPR_OP_BELOW, 2 }, { "bnot", MILKY_EXPR_OP_NOT, 1 },
+    { "bor", MILKY_EXPR_OP_OR, 2 },      { "cos", MILKY_EXPR_OP_COS, 1 },     { "equal", MILKY_EXPR_OP_EQUAL, 2 },
+    { "exp", MILKY_EXPR_OP_EXP, 1 },     { "if", MILKY_EXPR_OP_SELECT, 3 },   { "int", MILKY_EXPR_OP_INT, 1 },
+    { "log", MILKY_EXPR_OP_LOG, 1 },     { "log10", MILKY_EXPR_OP_LOG10, 1 }, { "max", MILKY_EXPR_OP_MAX, 2 },
+    { "min", MILKY_EXPR_OP_MIN, 2 },     { "pow", MILKY_EXPR_OP_POW, 2 },     { "sign", MILKY_EXPR_OP_SIGN, 1 },
+    { "sin", MILKY_EXPR_OP_SIN, 1 },     { "sqr", MILKY_EXPR_OP_SQR, 1 },     { "sqrt", MILKY_EXPR_OP_SQRT, 1 },
+    { "tan", MILKY_EXPR_OP_TAN, 1 }
+};
+
+#define MILKY_EXPR_FUNCTION_COUNT (sizeof(milky_exprFunctions) / sizeof(milky_exprFunctions[0]))
+
+// state of the recursive descent compiler
+typedef struct {
+    const char *position;
+    ExprProgram *program;
+    size_t temporaryCount; // temporaries in use (allocated and released like a stack)
+    int failed;
+} ExprCompiler;
+
+/**
+ * Applies one operation to scalars. Used for constant folding and for the lanes of
+ * operations without a vector implementation, so both give the same results.
+ */
+static float applyExprOperation(ExprOpcode opcode, float a, float b, float c) {
+    switch (opcode) {
+        case MILKY_EXPR_OP_MOVE: return a;
+        case MILKY_EXPR_OP_ADD: return a + b;
+        case MILKY_EXPR_OP_SUB: return a - b;
+        case MILKY_EXPR_OP_MUL: return a * b;
+        case MILKY_EXPR_OP_DIV: return b != 0.0f ? a / b : 0.0f;
+        case MILKY_EXPR_OP_MOD: {
+            float divisor = truncf(b);
+            return divisor != 0.0f ? fmodf(truncf(a), divisor) : 0.0f;
+        }
+        case MILKY_EXPR_OP_NEG: return -a;
+        case MILKY_EXPR_OP_POW: return powf(a, b);
+        case MILKY_EXPR_OP_MIN: return a < b ? a : b;
+        case MILKY_EXPR_OP_MAX: return a > b ? a : b;
+        case MILKY_EXPR_OP_ABOVE: return a > b ? 1.0f : 0.0f;
+        case MILKY_EXPR_OP_BELOW: return a < b ? 1.0f : 0.0f;
+        case MILKY_EXPR_OP_EQUAL: return a == b ? 1.0f : 0.0f;
+        case MILKY_EXPR_OP_NOT_EQUAL: return a != b ? 1.0f : 0.0f;
+        case MILKY_EXPR_OP_ABOVE_EQUAL: return a >= b ? 1.0f : 0.0f;
+        case MILKY_EXPR_OP_BELOW_EQUAL: return a <= b ? 1.0f : 0.0f;
+        case MILKY_EXPR_OP_SELECT: return a != 0.0f ? b : c;
+        case MILKY_EXPR_OP_AND: return a != 0.0f && b != 0.0f ? 1.0f : 0.0f;
+        case MILKY_EXPR_OP_OR: return a != 0.0f || b != 0.0f ? 1.0f : 0.0f;
+        case MILKY_EXPR_OP_NOT: return a == 0.0f ? 1.0f : 0.0f;
+        case MILKY_EXPR_OP_ABS: return fabsf(a);
+        case MILKY_EXPR_OP_SQR: return a * a;
+        case MILKY_EXPR_OP_SQRT: return sqrtf(fabsf(a));
+        case MILKY_EXPR_OP_INT: return truncf(a);
+        case MILKY_EXPR_OP_SIGN: return a > 0.0f ? 1.0f : (a < 0.0f ? -1.0f : 0.0f);
+        case MILKY_EXPR_OP_SIN: return sinf(a);
+        case MILKY_EXPR_OP_COS: return cosf(a);
+        case MILKY_EXPR_OP_TAN: return tanf(a);
+        case MILKY_EXPR_OP_ASIN: return asinf(a);
+        case MILKY_EXPR_OP_ACOS: return acosf(a);
+        case MILKY_EXPR_OP_ATAN: return atanf(a);
+        case MILKY_EXPR_OP_ATAN2: return atan2f(a, b);
+        case MILKY_EXPR_OP_EXP: return expf(a);
+        case MILKY_EXPR_OP_LOG: return logf(a);
+        case MILKY_EXPR_OP_LOG10: return log10f(a);
+        default: return 0.0f;
+    }
+}
+
+static void failExpr(ExprCompiler *compiler, const char *message) {
+    if (!compiler->failed) {
+        fprintf(stderr, "Expression error at '%.24s': %s\n", compiler->position, message);
+    }
+    compiler->failed = 1;
+}
+
+/**
+ * Skips blanks and // comments (newlines separate statements, so they are kept).
+ */
+static void skipExprSpace(ExprCompiler *compiler) {
+    for (;;) {
+        while (*compiler->position == ' ' || *compiler->position == '\t' || *compiler->position == '\r') {
+            compiler->position++;
+        }
+        if (compiler->position[0] != '/' || compiler->position[1] != '/') return;
+        while (*compiler->position != '\0' && *compiler->position != '\n') compiler->position++;
+    }
+}
+
+static int isExprNameStart(char character) {
+    return isalpha((unsigned char)character) || character == '_';
+}
+
+static int isExprNameCharacter(char character) {
+    return isalnum((unsigned char)character) || character == '_';
+}
+
+static int isExprConstant(int reg) {
+    return reg >= MILKY_EXPR_CONSTANT_BASE && reg < MILKY_EXPR_TEMPORARY_BASE;
+}
+
+static int isExprTemporary(int reg) {
+    return reg >= MILKY_EXPR_TEMPORARY_BASE;
+}
+
+static int addExprConstant(ExprCompiler *compiler, float value) {
+    ExprProgram *program = compiler->program;
+    for (size_t i = 0; i < program->constantCount; i++) {
+        if (memcmp(&program->constants[i], &value, sizeof(float)) == 0) return MILKY_EXPR_CONSTANT_BASE + (int)i;
+    }
+    if (program->constantCount >= MILKY_EXPR_MAX_CONSTANTS) {
+        failExpr(compiler, "too many constants");
+        return MILKY_EXPR_CONSTANT_BASE;
+    }
+    program->constants[program->constantCount] = value;
+    return MILKY_EXPR_CONSTANT_BASE + (int)program->constantCount++;
+}
+
+static int addExprVariable(ExprCompiler *compiler, const char *name, size_t length) {
+    ExprProgram *program = compiler->program;
+    if (length >= MILKY_EXPR_MAX_NAME) {
+        failExpr(compiler, "variable name too long");
+        return 0;
+    }
+    for (size_t i = 0; i < program->variableCount; i++) {
+        if (strncasecmp(program->variableNames[i], name, length) == 0 && program->variableNames[i][length] == '\0') return (int)i;
+    }
+    if (program->variableCount >= MILKY_EXPR_MAX_VARIABLES) {
+        failExpr(compiler, "too many variables");
+        return 0;
+    }
+
+    char *variableName = program->variableNames[program->variableCount];
+    for (size_t i = 0; i < length; i++) variableName[i] = (char)tolower((unsigned char)name[i]);
+    variableName[length] = '\0';
+    return (int)program->variableCount++;
+}
+
+static int allocateExprTemporary(ExprCompiler *compiler) {
+    if (compiler->temporaryCount >= MILKY_EXPR_MAX_TEMPORARIES) {
+        failExpr(compiler, "expression too complex");
+        return MILKY_EXPR_TEMPORARY_BASE;
+    }
+    return MILKY_EXPR_TEMPORARY_BASE + (int)compiler->temporaryCount++;
+}
+
+static void releaseExprTemporary(ExprCompiler *compiler, int reg) {
+    if (isExprTemporary(reg) && compiler->temporaryCount > 0 && reg == MILKY_EXPR_TEMPORARY_BASE + (int)compiler->temporaryCount - 1) {
+        compiler->temporaryCount--;
+    }
+}
+
+/**
+ * Emits one instruction (or folds it if all operands are constants). Temporary
+ * operands are released first, so the result reuses the first of them.
+ *
+ * @return The register holding the result.
+ */
+static int emitExprOperation(ExprCompiler *compiler, ExprOpcode opcode, int a, int b, int c, int argumentCount) {
+    ExprProgram *program = compiler->program;
+    const int operands[3] = { a, b, c };
+
+    int constant = 1;
+    for (int i = 0; i < argumentCount; i++) constant &= isExprConstant(operands[i]);
+    if (constant) {
+        float values[3] = { 0.0f, 0.0f, 0.0f };
+        for (int i = 0; i < argumentCount; i++) values[i] = program->constants[operands[i] - MILKY_EXPR_CONSTANT_BASE];
+        return addExprConstant(compiler, applyExprOperation(opcode, values[0], values[1], values[2]));
+    }
+
+    for (int i = argumentCount - 1; i >= 0; i--) releaseExprTemporary(compiler, operands[i]);
+    int destination = allocateExprTemporary(compiler);
+
+    if (program->instructionCount >= MILKY_EXPR_MAX_INSTRUCTIONS) {
+        failExpr(compiler, "too many instructions");
+        return destination;
+    }
+    ExprInstruction *instruction = &program->instructions[program->instructionCount++];
+    instruction->opcode = (uint8_t)opcode;
+    instruction->destination = (uint8_t)destination;
+    instruction->a = (uint8_t)a;
+    instruction->b = (uint8_t)(argumentCount > 1 ? b : a);
+    instruction->c = (uint8_t)(argumentCount > 2 ? c : a);
+    return destination;
+}
+
+static int parseExprExpression(ExprCompiler *compiler);
+static int parseExprUnary(ExprCompiler *compiler);
+
+static int expectExpr(ExprCompiler *compiler, char character) {
+    skipExprSpace(compiler);
+    if (*compiler->position != character) {
+        char message[32];
+        snprintf(message, sizeof(message), "expected '%c'", character);
+        failExpr(compiler, message);
+        return 0;
+    }
+    compiler->position++;
+    return 1;
+}
+
+static int parseExprCall(ExprCompiler *compiler, const char *name, size_t length) {
+    const ExprFunction *function = NULL;
+    for (size_t i = 0; i < MILKY_EXPR_FUNCTION_COUNT; i++) {
+        if (strncasecmp(milky_exprFunctions[i].name, name, length) == 0 && milky_exprFunctions[i].name[length] == '\0') {
+            function = &milky_exprFunctions[i];
+            break;
+        }
+    }
+    if (!function) {
+        failExpr(compiler, "unknown function");
+        return addExprConstant(compiler, 0.0f);
+    }
+
+    compiler->position++; // '('
+    int arguments[3] = { 0, 0, 0 };
+    int count = 0;
+    skipExprSpace(compiler);
+    if (*compiler->position != ')') {
+        while (!compiler->failed) {
+            int argument = parseExprExpression(compiler);
+            if (count < 3) arguments[count] = argument;
+            count++;
+            skipExprSpace(compiler);
+            if (*compiler->position != ',') break;
+            compiler->position++;
+        }
+    }
+    expectExpr(compiler, ')');
+
+    if (count != function->argumentCount) {
+        failExpr(compiler, "wrong number of arguments");
+        return addExprConstant(compiler, 0.0f);
+    }
+    return emitExprOperation(compiler, function->opcode, arguments[0], arguments[1], arguments[2], count);
+}
+
+static int parseExprPrimary(ExprCompiler *compiler) {
+    skipExprSpace(compiler);
+    const char *start = compiler->position;
+
+    if (isdigit((unsigned char)*start) || (*start == '.' && isdigit((unsigned char)start[1]))) {
+        char *end = NULL;
+        float value = strtof(start, &end);
+        compiler->position = end;
+        return addExprConstant(compiler, value);
+    }
+
+    if (*start == '$') {
+        // named constants ($pi, $e, $phi)
+        const char *name = ++compiler->position;
+        while (isExprNameCharacter(*compiler->position)) compiler->position++;
+        size_t length = (size_t)(compiler->position - name);
+        if (length == 2 && strncasecmp(name, "pi", 2) == 0) return addExprConstant(compiler, (float)M_PI);
+        if (length == 1 && strncasecmp(name, "e", 1) == 0) return addExprConstant(compiler, (float)M_E);
+        if (length == 3 && strncasecmp(name, "phi", 3) == 0) return addExprConstant(compiler, 1.61803399f);
+        failExpr(compiler, "unknown constant");
+        return addExprConstant(compiler, 0.0f);
+    }
+
+    if (isExprNameStart(*start)) {
+        while (isExprNameCharacter(*compiler->position)) compiler->position++;
+        size_t length = (size_t)(compiler->position - start);
+        skipExprSpace(compiler);
+        if (*compiler->position == '(') return parseExprCall(compiler, start, length);
+        return addExprVariable(compiler, start, length);
+    }
+
+    if (*start == '(') {
+        compiler->position++;
+        int value = parseExprExpression(compiler);
+        expectExpr(compiler, ')');
+        return value;
+    }
+
+    failExpr(compiler, "unexpected character");
+    return addExprConstant(compiler, 0.0f);
+}
+
+static int parseExprPower(ExprCompiler *compiler) {
+    int base = parseExprPrimary(compiler);
+    skipExprSpace(compiler);
+    if (*compiler->position != '^') return base;
+
+    compiler->position++;
+    int exponent = parseExprUnary(compiler); // right associative: a^b^c = a^(b^c)
+    return emitExprOperation(compiler, MILKY_EXPR_OP_POW, base, exponent, 0, 2);
+}
+
+static int parseExprUnary(ExprCompiler *compiler) {
+    skipExprSpace(compiler);
+    switch (*compiler->position) {
+        case '-':
+            compiler->position++;
+            return emitExprOperation(compiler, MILKY_EXPR_OP_NEG, parseExprUnary(compiler), 0, 0, 1);
+        case '+':
+            compiler->position++;
+            return parseExprUnary(compiler);
+        case '!':
+            compiler->position++;
+            return emitExprOperation(compiler, MILKY_EXPR_OP_NOT, parseExprUnary(compiler), 0, 0, 1);
+        default:
+            return parseExprPower(compiler);
+    }
+}
+
+static int parseExprTerm(ExprCompiler *compiler) {
+    int value = parseExprUnary(compiler);
+    while (!compiler->failed) {
+        skipExprSpace(compiler);
+        char operator = *compiler->position;
+        if (operator != '*' && operator != '/' && operator != '%') return value;
+        compiler->position++;
+
+        int right = parseExprUnary(compiler);
+        ExprOpcode opcode = operator == '*' ? MILKY_EXPR_OP_MUL : (operator == '/' ? MILKY_EXPR_OP_DIV : MILKY_EXPR_OP_MOD);
+        value = emitExprOperation(compiler, opcode, value, right, 0, 2);
+    }
+    return value;
+}
+
+static int parseExprSum(ExprCompiler *compiler) {
+    int value = parseExprTerm(compiler);
+    while (!compiler->failed) {
+        skipExprSpace(compiler);
+        char operator = *compiler->position;
+        if (operator != '+' && operator != '-') return value;
+        // "+=" / "-=" end the expression (compound assignment)
+        if (compiler->position[1] == '=') return value;
+        compiler->position++;
+
+        int right = parseExprTerm(compiler);
+        value = emitExprOperation(compiler, operator == '+' ? MILKY_EXPR_OP_ADD : MILKY_EXPR_OP_SUB, value, right, 0, 2);
+    }
+    return value;
+}
+
+static int parseExprComparison(ExprCompiler *compiler) {
+    int value = parseExprSum(compiler);
+    while (!compiler->failed) {
+        skipExprSpace(compiler);
+        const char *operator = compiler->position;
+        ExprOpcode opcode;
+        size_t length = 2;
+
+        if (operator[0] == '=' && operator[1] == '=') opcode = MILKY_EXPR_OP_EQUAL;
+        else if (operator[0] == '!' && operator[1] == '=') opcode = MILKY_EXPR_OP_NOT_EQUAL;
+        else if (operator[0] == '>' && operator[1] == '=') opcode = MILKY_EXPR_OP_ABOVE_EQUAL;
+        else if (operator[0] == '<' && operator[1] == '=') opcode = MILKY_EXPR_OP_BELOW_EQUAL;
+        else if (operator[0] == '>') { opcode = MILKY_EXPR_OP_ABOVE; length = 1; }
+        else if (operator[0] == '<') { opcode = MILKY_EXPR_OP_BELOW; length = 1; }
+        else return value;
+        compiler->position += length;
+
+        int right = parseExprSum(compiler);
+        value = emitExprOperation(compiler, opcode, value, right, 0, 2);
+    }
+    return value;
+}
+
+static int parseExprExpression(ExprCompiler *compiler) {
+    int value = parseExprComparison(compiler);
+    while (!compiler->failed) {
+        skipExprSpace(compiler);
+        const char *operator = compiler->position;
+        if (!((operator[0] == '&' && operator[1] == '&') || (operator[0] == '|' && operator[1] == '|'))) return value;
+        compiler->position += 2;
+
+        int right = parseExprComparison(compiler);
+        value = emitExprOperation(compiler, operator[0] == '&' ? MILKY_EXPR_OP_AND : MILKY_EXPR_OP_OR, value, right, 0, 2);
+    }
+    return value;
+}
+
+/**
+ * Stores a result in a variable. If the result was just computed into a temporary,
+ * that instruction writes to the variable directly instead.
+ */
+static void emitExprAssignment(ExprCompiler *compiler, int variable, int value) {
+    ExprProgram *program = compiler->program;
+    ExprInstruction *last = program->instructionCount > 0 ? &program->instructions[program->instructionCount - 1] : NULL;
+
+    if (isExprTemporary(value) && last && last->destination == value) {
+        last->destination = (uint8_t)variable;
+    } else if (program->instructionCount < MILKY_EXPR_MAX_INSTRUCTIONS) {
+        ExprInstruction *instruction = &program->instructions[program->instructionCount++];
+        instruction->opcode = MILKY_EXPR_OP_MOVE;
+        instruction->destination = (uint8_t)variable;
+        instruction->a = instruction->b = instruction->c = (uint8_t)value;
+    } else {
+        failExpr(compiler, "too many instructions");
+    }
+    releaseExprTemporary(compiler, value);
+}
+
+/**
+ * Compiles one statement: `name = expression`, `name += expression` (also -=, *=, /=)
+ * or a bare expression (which has no effect).
+ */
+static void parseExprStatement(ExprCompiler *compiler) {
+    skipExprSpace(compiler);
+    const char *start = compiler->position;
+
+    if (isExprNameStart(*start)) {
+        while (isExprNameCharacter(*compiler->position)) compiler->position++;
+        size_t length = (size_t)(compiler->position - start);
+        skipExprSpace(compiler);
+
+        const char *operator = compiler->position;
+        int compound = operator[1] == '=' && (operator[0] == '+' || operator[0] == '-' || operator[0] == '*' || operator[0] == '/');
+        if ((operator[0] == '=' && operator[1] != '=') || compound) {
+            compiler->position += compound ? 2 : 1;
+            int variable = addExprVariable(compiler, start, length);
+            int value = parseExprExpression(compiler);
+            if (compound) {
+                ExprOpcode opcode = operator[0] == '+' ? MILKY_EXPR_OP_ADD : operator[0] == '-' ? MILKY_EXPR_OP_SUB
+                    : operator[0] == '*' ? MILKY_EXPR_OP_MUL : MILKY_EXPR_OP_DIV;
+                value = emitExprOperation(compiler, opcode, variable, value, 0, 2);
+            }
+            emitExprAssignment(compiler, variable, value);
+            return;
+        }
+        compiler->position = start;
+    }
+
+    releaseExprTemporary(compiler, parseExprExpression(compiler));
+}
+
+/**
+ * Compiles equations into register-based bytecode. Statements are separated by ';'
+ * or newlines, `//` starts a comment. Identifiers are variables (case-insensitive);
+ * variables that are read before they are assigned keep the value the caller put
+ * into them (see findExprVariable()).
+ *
+ * @param program Receives the program.
+ * @param source  The equations, for example "zoom = 1.0 + 0.1*sin(time)*bass;".
+ * @return        1 on success, 0 on syntax errors (the program then does nothing).
+ */
+int compileExprProgram(ExprProgram *program, const char *source) {
+    program->valid = 0;
+    program->instructionCount = 0;
+    program->constantCount = 0;
+    program->variableCount = 0;
+
+    ExprCompiler compiler = { source, program, 0, 0 };
+    while (!compiler.failed) {
+        skipExprSpace(&compiler);
+        if (*compiler.position == '\0') break;
+        if (*compiler.position == ';' || *compiler.position == '\n') {
+            compiler.position++;
+            continue;
+        }
+
+        parseExprStatement(&compiler);
+        compiler.temporaryCount = 0;
+
+        skipExprSpace(&compiler);
+        if (!compiler.failed && *compiler.position != '\0' && *compiler.position != ';' && *compiler.position != '\n') {
+            failExpr(&compiler, "expected ';'");
+        }
+    }
+
+    if (compiler.failed) program->instructionCount = 0;
+    program->valid = !compiler.failed;
+    return program->valid;
+}
+
+static uint64_t hashExprSource(const char *source) {
+    uint64_t hash = 14695981039346656037ULL; // FNV-1a
+    for (; *source; source++) {
+        hash = (hash ^ (uint8_t)*source) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+ * Recompiles a program only if its source changed since the last call (cheap
+ * enough to call every frame).
+ *
+ * @param program The program.
+ * @param source  The equations.
+ * @return        1 if the program compiled, 0 otherwise.
+ */
+int updateExprProgram(ExprProgram *program, const char *source) {
+    uint64_t hash = hashExprSource(source);
+    if (hash != program->sourceHash) {
+        compileExprProgram(program, source);
+        program->sourceHash = hash;
+    }
+    return program->valid;
+}
+
+/**
+ * Looks up the index of a variable (case-insensitive).
+ *
+ * @param program The program.
+ * @param name    Name of the variable.
+ * @return        Its index in the variable arrays, or -1 if the program doesn't use it.
+ */
+int findExprVariable(const ExprProgram *program, const char *name) {
+    for (size_t i = 0; i < program->variableCount; i++) {
+        if (strcasecmp(program->variableNames[i], name) == 0) return (int)i;
+    }
+    return -1;
+}
+
+/**
+ * Runs the instructions once on all lanes of the register file.
+ */
+static void executeExprInstructions(const ExprProgram *program, float (*registers)[MILKY_EXPR_LANES]) {
+#if defined(__AVX2__)
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+#elif defined(__ARM_NEON__)
+    const float32x4_t one = vdupq_n_f32(1.0f);
+#endif
+
+    for (size_t i = 0; i < program->instructionCount; i++) {
+        const ExprInstruction *instruction = &program->instructions[i];
+        float *d = registers[instruction->destination];
+        const float *a = registers[instruction->a];
+        const float *b = registers[instruction->b];
+        const float *c = registers[instruction->c];
+
+#if defined(__AVX2__)
+        // eight lanes per operation
+        const __m256 x = _mm256_load_ps(a), y = _mm256_load_ps(b);
+        switch (instruction->opcode) {
+            case MILKY_EXPR_OP_MOVE: _mm256_store_ps(d, x); continue;
+            case MILKY_EXPR_OP_ADD: _mm256_store_ps(d, _mm256_add_ps(x, y)); continue;
+            case MILKY_EXPR_OP_SUB: _mm256_store_ps(d, _mm256_sub_ps(x, y)); continue;
+            case MILKY_EXPR_OP_MUL: _mm256_store_ps(d, _mm256_mul_ps(x, y)); continue;
+            case MILKY_EXPR_OP_DIV: _mm256_store_ps(d, _mm256_andnot_ps(_mm256_cmp_ps(y, zero, _CMP_EQ_OQ), _mm256_div_ps(x, y))); continue;
+            case MILKY_EXPR_OP_NEG: _mm256_store_ps(d, _mm256_xor_ps(x, sign)); continue;
+            case MILKY_EXPR_OP_MIN: _mm256_store_ps(d, _mm256_min_ps(x, y)); continue;
+            case MILKY_EXPR_OP_MAX: _mm256_store_ps(d, _mm256_max_ps(x, y)); continue;
+            case MILKY_EXPR_OP_ABOVE: _mm256_store_ps(d, _mm256_and_ps(_mm256_cmp_ps(x, y, _CMP_GT_OQ), one)); continue;
+            case MILKY_EXPR_OP_BELOW: _mm256_store_ps(d, _mm256_and_ps(_mm256_cmp_ps(x, y, _CMP_LT_OQ), one)); continue;
+            case MILKY_EXPR_OP_EQUAL: _mm256_store_ps(d, _mm256_and_ps(_mm256_cmp_ps(x, y, _CMP_EQ_OQ), one)); continue;
+            case MILKY_EXPR_OP_NOT_EQUAL: _mm256_store_ps(d, _mm256_and_ps(_mm256_cmp_ps(x, y, _CMP_NEQ_UQ), one)); continue;
+            case MILKY_EXPR_OP_ABOVE_EQUAL: _mm256_store_ps(d, _mm256_and_ps(_mm256_cmp_ps(x, y, _CMP_GE_OQ), one)); continue;
+            case MILKY_EXPR_OP_BELOW_EQUAL: _mm256_store_ps(d, _mm256_and_ps(_mm256_cmp_ps(x, y, _CMP_LE_OQ), one)); continue;
+            case MILKY_EXPR_OP_SELECT:
+                _mm256_store_ps(d, _mm256_blendv_ps(_mm256_load_ps(c), y, _mm256_cmp_ps(x, zero, _CMP_NEQ_UQ)));
+                continue;
+            case MILKY_EXPR_OP_AND:
+                _mm256_store_ps(d, _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(x, zero, _CMP_NEQ_UQ), _mm256_cmp_ps(y, zero, _CMP_NEQ_UQ)), one));
+                continue;
+            case MILKY_EXPR_OP_OR:
+                _mm256_store_ps(d, _mm256_and_ps(_mm256_or_ps(_mm256_cmp_ps(x, zero, _CMP_NEQ_UQ), _mm256_cmp_ps(y, zero, _CMP_NEQ_UQ)), one));
+                continue;
+            case MILKY_EXPR_OP_NOT: _mm256_store_ps(d, _mm256_and_ps(_mm256_cmp_ps(x, zero, _CMP_EQ_OQ), one)); continue;
+            case MILKY_EXPR_OP_ABS: _mm256_store_ps(d, _mm256_andnot_ps(sign, x)); continue;
+            case MILKY_EXPR_OP_SQR: _mm256_store_ps(d, _mm256_mul_ps(x, x)); continue;
+            case MILKY_EXPR_OP_SQRT: _mm256_store_ps(d, _mm256_sqrt_ps(_mm256_andnot_ps(sign, x))); continue;
+            case MILKY_EXPR_OP_INT: _mm256_store_ps(d, _mm256_round_ps(x, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC)); continue;
+            case MILKY_EXPR_OP_SIGN:
+                _mm256_store_ps(d, _mm256_sub_ps(_mm256_and_ps(_mm256_cmp_ps(x, zero, _CMP_GT_OQ), one),
+                                                 _mm256_and_ps(_mm256_cmp_ps(x, zero, _CMP_LT_OQ), one)));
+                continue;
+            default: break;
+        }
+#elif defined(__ARM_NEON__)
+        // two times four lanes per operation
+        switch (instruction->opcode) {
+            case MILKY_EXPR_OP_MOVE:
+            case MILKY_EXPR_OP_ADD:
+            case MILKY_EXPR_OP_SUB:
+            case MILKY_EXPR_OP_MUL:
+            case MILKY_EXPR_OP_NEG:
+            case MILKY_EXPR_OP_MIN:
+            case MILKY_EXPR_OP_MAX:
+            case MILKY_EXPR_OP_ABOVE:
+            case MILKY_EXPR_OP_BELOW:
+            case MILKY_EXPR_OP_ABS:
+            case MILKY_EXPR_OP_SQR:
+                for (size_t half = 0; half < MILKY_EXPR_LANES; half += 4) {
+                    float32x4_t x = vld1q_f32(a + half), y = vld1q_f32(b + half), result;
+                    switch (instruction->opcode) {
+                        case MILKY_EXPR_OP_ADD: result = vaddq_f32(x, y); break;
+                        case MILKY_EXPR_OP_SUB: result = vsubq_f32(x, y); break;
+                        case MILKY_EXPR_OP_MUL: result = vmulq_f32(x, y); break;
+                        case MILKY_EXPR_OP_NEG: result = vnegq_f32(x); break;
+                        case MILKY_EXPR_OP_MIN: result = vbslq_f32(vcltq_f32(x, y), x, y); break;
+                        case MILKY_EXPR_OP_MAX: result = vbslq_f32(vcgtq_f32(x, y), x, y); break;
+                        case MILKY_EXPR_OP_ABOVE: result = vreinterpretq_f32_u32(vandq_u32(vcgtq_f32(x, y), vreinterpretq_u32_f32(one))); break;
+                        case MILKY_EXPR_OP_BELOW: result = vreinterpretq_f32_u32(vandq_u32(vcltq_f32(x, y), vreinterpretq_u32_f32(one))); break;
+                        case MILKY_EXPR_OP_ABS: result = vabsq_f32(x); break;
+                        case MILKY_EXPR_OP_SQR: result = vmulq_f32(x, x); break;
+                        default: result = x; break;
+                    }
+                    vst1q_f32(d + half, result);
+                }
+                continue;
+            default: break;
+        }
+#endif
+
+        // everything else (transcendental functions, ...): one lane at a time
+        for (size_t lane = 0; lane < MILKY_EXPR_LANES; lane++) {
+            d[lane] = applyExprOperation((ExprOpcode)instruction->opcode, a[lane], b[lane], c[lane]);
+        }
+    }
+}
+
+/**
+ * Runs a program on many inputs at once (for example all mesh vertices), in
+ * batches of MILKY_EXPR_LANES: every instruction handles eight inputs, so the
+ * dispatch cost is shared and the arithmetic runs in SIMD registers.
+ *
+ * @param program  The program.
+ * @param columns  Per variable: an array of `count` values (read and written), or
+ *                 NULL for variables that are the same for all inputs (may be NULL).
+ * @param uniforms Per variable: the value for variables without a column (may be
+ *                 NULL = 0); assignments to them are not kept.
+ * @param count    Number of inputs.
+ */
+void runExprProgramBatch(const ExprProgram *program, float *const *columns, const float *uniforms, size_t count) {
+    if (!program->valid || program->instructionCount == 0) return;
+
+    float registers[MILKY_EXPR_MAX_REGISTERS][MILKY_EXPR_LANES] __attribute__((aligned(32)));
+    for (size_t i = 0; i < program->constantCount; i++) {
+        for (size_t lane = 0; lane < MILKY_EXPR_LANES; lane++) {
+            registers[MILKY_EXPR_CONSTANT_BASE + i][lane] = program->constants[i];
+        }
+    }
+
+    for (size_t start = 0; start < count; start += MILKY_EXPR_LANES) {
+        const size_t lanes = count - start < MILKY_EXPR_LANES ? count - start : MILKY_EXPR_LANES;
+
+        for (size_t v = 0; v < program->variableCount; v++) {
+            if (columns && columns[v]) {
+                memcpy(registers[v], &columns[v][start], lanes * sizeof(float));
+                for (size_t lane = lanes; lane < MILKY_EXPR_LANES; lane++) registers[v][lane] = 0.0f;
+            } else {
+                float value = uniforms ? uniforms[v] : 0.0f;
+                for (size_t lane = 0; lane < MILKY_EXPR_LANES; lane++) registers[v][lane] = value;
+            }
+        }
+
+        executeExprInstructions(program, registers);
+
+        for (size_t v = 0; v < program->variableCount; v++) {
+            if (columns && columns[v]) memcpy(&columns[v][start], registers[v], lanes * sizeof(float));
+        }
+    }
+}
+
+/**
+ * Runs a program once (for example the per-frame equations).
+ *
+ * @param program   The program.
+ * @param variables Values of the program's variables (read and written, see findExprVariable()).
+ */
+void runExprProgram(const ExprProgram *program, float *variables) {
+    float *columns[MILKY_EXPR_MAX_VARIABLES];
+    for (size_t v = 0; v < program->variableCount; v++) columns[v] = &variables[v];
+    runExprProgramBatch(program, columns, NULL, 1);
+}
@@ -0,0 +1,95 @@
+#ifndef EXPR_H
+#define EXPR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <math.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#ifdef __ARM_NEON__
+#include <arm_neon.h>
+#endif
+
+#define MILKY_EXPR_LANES 8              // values evaluated per instruction (one AVX2 register of floats)
+#define MILKY_EXPR_MAX_VARIABLES 64     // registers [0, 64) hold the variables
+#define MILKY_EXPR_MAX_CONSTANTS 96     // registers [64, 160) hold the constants
+#define MILKY_EXPR_MAX_TEMPORARIES 96   // registers [160, 256) hold intermediate results
+#define MILKY_EXPR_MAX_REGISTERS (MILKY_EXPR_MAX_VARIABLES + MILKY_EXPR_MAX_CONSTANTS + MILKY_EXPR_MAX_TEMPORARIES)
+#define MILKY_EXPR_MAX_INSTRUCTIONS 1024
+#define MILKY_EXPR_MAX_NAME 32          // longest variable name (including the terminator)
+
+typedef enum {
+    MILKY_EXPR_OP_MOVE = 0,
+    MILKY_EXPR_OP_ADD,
+    MILKY_EXPR_OP_SUB,
+    MILKY_EXPR_OP_MUL,
+    MILKY_EXPR_OP_DIV,     // x / 0 = 0
+    MILKY_EXPR_OP_MOD,     // integer modulo, x % 0 = 0
+    MILKY_EXPR_OP_NEG,
+    MILKY_EXPR_OP_POW,
+    MILKY_EXPR_OP_MIN,
+    MILKY_EXPR_OP_MAX,
+    MILKY_EXPR_OP_ABOVE,   // a > b ? 1 : 0
+    MILKY_EXPR_OP_BELOW,   // a < b ? 1 : 0
+    MILKY_EXPR_OP_EQUAL,   // a == b ? 1 : 0
+    MILKY_EXPR_OP_NOT_EQUAL,
+    MILKY_EXPR_OP_ABOVE_EQUAL,
+    MILKY_EXPR_OP_BELOW_EQUAL,
+    MILKY_EXPR_OP_SELECT,  // a != 0 ? b : c
+    MILKY_EXPR_OP_AND,     // a != 0 && b != 0
+    MILKY_EXPR_OP_OR,      // a != 0 || b != 0
+    MILKY_EXPR_OP_NOT,     // a == 0
+    MILKY_EXPR_OP_ABS,
+    MILKY_EXPR_OP_SQR,
+    MILKY_EXPR_OP_SQRT,    // sqrt(|a|)
+    MILKY_EXPR_OP_INT,     // truncated towards zero
+    MILKY_EXPR_OP_SIGN,
+    MILKY_EXPR_OP_SIN,
+    MILKY_EXPR_OP_COS,
+    MILKY_EXPR_OP_TAN,
+    MILKY_EXPR_OP_ASIN,
+    MILKY_EXPR_OP_ACOS,
+    MILKY_EXPR_OP_ATAN,
+    MILKY_EXPR_OP_ATAN2,
+    MILKY_EXPR_OP_EXP,
+    MILKY_EXPR_OP_LOG,
+    MILKY_EXPR_OP_LOG10,
+    MILKY_EXPR_OP_COUNT
+} ExprOpcode;
+
+// one three-address instruction: registers[destination] = opcode(registers[a], registers[b], registers[c])
+typedef struct {
+    uint8_t opcode;
+    uint8_t destination;
+    uint8_t a;
+    uint8_t b;
+    uint8_t c;
+} ExprInstruction;
+
+// compiled equations (register-based bytecode)
+typedef struct {
+    int valid;                   // 1 if the source compiled
+    uint64_t sourceHash;         // hash of the compiled source (see updateExprProgram())
+    size_t instructionCount;
+    ExprInstruction instructions[MILKY_EXPR_MAX_INSTRUCTIONS];
+    size_t constantCount;
+    float constants[MILKY_EXPR_MAX_CONSTANTS];
+    size_t variableCount;
+    char variableNames[MILKY_EXPR_MAX_VARIABLES][MILKY_EXPR_MAX_NAME];
+} ExprProgram;
+
+int compileExprProgram(ExprProgram *program, const char *source);
+int updateExprProgram(ExprProgram *program, const char *source);
+int findExprVariable(const ExprProgram *program, const char *name);
+void runExprProgram(const ExprProgram *program, float *variables);
+void runExprProgramBatch(const ExprProgram *program, float *const *columns, const float *uniforms, size_t count);
+
+#endif // EXPR_H
@@ -92,7 +92,40 @@ int main(int argc, char *argv[]) {
     }
     */
 
-    int ret = run(); // quickly testing creating a PulseAudio object
+    // canvas size, fullscreen and monitor selection (see config.h)
+    MilkyConfig config = getDefaultConfig();
+    if (!parseCommandLine(argc, argv, &config)) {
+        return 1;
+    }
+
+    // a video stream on stdout (--output-file -) must not get mixed up with the messages
+    const int batch = config.batchFile[0] != '\0';
+    if (!batch && strcmp(config.outputFile, "-") == 0) {
+        reserveOutputStdout();
+    }
+
+    // presets are parsed once and cached next to the directory (DIR.cache) for fast startups
+    // (before the workers of a batch start, so they share the presets and the cache)
+    if (config.presetDirectory[0] != '\0') {
+        char cachePath[MILKY_CONFIG_MAX_PATH + 8];
+        size_t length = strlen(config.presetDirectory);
+        while (length > 1 && config.presetDirectory[length - 1] == '/') config.presetDirectory[--length] = '\0';
+        snprintf(cachePath, sizeof(cachePath), "%s.cache", config.presetDirectory);
+
+        size_t presetCount = loadPresetDirectoryCached(config.presetDirectory, cachePath);
+        printf("Loaded %zu presets from %s\n", presetCount, config.presetDirectory);
+
+        // edited presets are parsed on a watcher thread and swapped in between frames
+        if (config.watchPresets && !batch) {
+            startPresetWatcher(config.presetDirectory);
+        }
+    }
+
+    // WAVE files (--input, --batch) are rendered offline, otherwise the system audio is captured
+    int ret = batch ? runBatch(&config, runFile)
+        : config.inputFile[0] != '\0' ? runFile(&config)
+        : run(&config);
+    stopPresetWatcher();
     
      printf("Press Ctrl+C to stop the program.\n");
 
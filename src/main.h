@@ -6,6 +6,8 @@
 
 #include "video.h"
 #include "audio/capture.h"
+#include "presetwatch.h"
+#include "batch.h"
 
 void process_audio_chunk(const uint8_t *waveform, size_t waveformLength, size_t spectrumLength, const uint8_t *spectrum);
 
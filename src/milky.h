@@ -0,0 +1,51 @@
+#ifndef MILKY_H
+#define MILKY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// resizes a block of memory like realloc(): memory NULL allocates a new block, size 0
+// frees it (and returns NULL); on failure NULL is returned and the block stays valid
+typedef void *(*MilkyReallocateFunction)(void *userData, void *memory, size_t size);
+
+// where a context allocates its buffers (frames, feedback history, tables, ...); the
+// displacement maps are allocated on the context's worker thread, so it must be thread-safe
+typedef struct {
+    MilkyReallocateFunction reallocate; // NULL = realloc() / free()
+    void *userData;                     // passed to reallocate
+} MilkyAllocator;
+
+// an independent renderer with all of its state (see milky_context_create()); contexts
+// render concurrently on different threads, each used by one thread at a time
+typedef struct MilkyContext MilkyContext;
+
+typedef struct {
+    size_t width;             // canvas width in pixels
+    size_t height;            // canvas height in pixels
+    size_t sampleRate;        // sample rate of the audio passed to the context (per channel)
+    size_t channels;          // interleaved channels of the audio (unsigned 8-bit samples)
+    int threads;              // OpenMP threads a frame is rendered with (0 = the process default)
+    size_t presetIndex;       // preset to start with (see milky_load_presets())
+    size_t presetDuration;    // milliseconds per preset before blending to the next (0 = stay)
+    uint32_t seed;            // seed of the context's random numbers (same seed and audio, same frames)
+    MilkyAllocator allocator; // allocator of the context's buffers
+} MilkyContextOptions;
+
+MilkyContextOptions milky_context_default_options(void);
+MilkyContext *milky_context_create(const MilkyContextOptions *options);
+size_t milky_context_analyze(MilkyContext *context, const uint8_t *samples, size_t length, size_t currentTime);
+const uint8_t *milky_context_render(MilkyContext *context, const uint8_t *waveform, size_t length, size_t currentTime);
+int milky_context_resize(MilkyContext *context, size_t width, size_t height);
+void milky_context_get_size(const MilkyContext *context, size_t *width, size_t *height);
+void milky_context_destroy(MilkyContext *context);
+size_t milky_load_presets(const char *directory);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MILKY_H
@@ -0,0 +1,33 @@
+#ifndef BACKEND_H
+#define BACKEND_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "../config.h"
+#include "../video/display.h"
+
+// a destination of the finished frames (see output.h for the available backends)
+typedef struct {
+    const char *name; // as selected with --output
+
+    // prepares the backend; may pick the canvas size (e.g. the window's), otherwise leaves it alone
+    // (1 on success, 0 on failure)
+    int (*open)(const MilkyConfig *config, size_t *canvasWidth, size_t *canvasHeight);
+
+    // shows or stores a finished frame (RGBA format) that moved the feedback image by `motion`
+    // (1 to continue, 0 to stop rendering, e.g. once the window was closed)
+    int (*present)(const uint8_t *frame, size_t width, size_t height, const DisplayMotion *motion);
+
+    // 1 if the backend wants another canvas size (e.g. the window was resized; NULL = never)
+    int (*takeCanvasSize)(size_t *width, size_t *height);
+
+    // releases everything open() acquired
+    void (*close)(void);
+} OutputBackend;
+
+// opens the file of an output ("-" = stdout, see output.c)
+FILE *openOutputStream(const char *path);
+
+#endif // BACKEND_H
@@ -0,0 +1,37 @@
+#include "file.h"
+
+// the file the frames are appended to (see openOutputStream())
+static FILE *milky_fileOutput = NULL;
+
+static int openFileOutput(const MilkyConfig *config, size_t *canvasWidth, size_t *canvasHeight) {
+    milky_fileOutput = openOutputStream(config->outputFile);
+    if (!milky_fileOutput) return 0;
+    fprintf(stderr, "Writing %zux%zu RGBA frames to %s\n", *canvasWidth, *canvasHeight, config->outputFile);
+    return 1;
+}
+
+static int presentFileOutput(const uint8_t *frame, size_t width, size_t height, const DisplayMotion *motion) {
+    (void)motion;
+    const size_t frameSize = width * height * 4;
+    if (fwrite(frame, 1, frameSize, milky_fileOutput) != frameSize) {
+        fprintf(stderr, "Failed to write a frame: %s\n", strerror(errno));
+        return 0;
+    }
+    return 1;
+}
+
+static void closeFileOutput(void) {
+    if (milky_fileOutput) {
+        fclose(milky_fileOutput);
+        milky_fileOutput = NULL;
+    }
+}
+
+// appends the raw frames (RGBA, rows top to bottom, no header) to a file or stdout
+const OutputBackend milky_outputFile = {
+    "file",
+    openFileOutput,
+    presentFileOutput,
+    NULL,
+    closeFileOutput
+};
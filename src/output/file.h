@@ -0,0 +1,12 @@
+#ifndef FILE_OUTPUT_H
+#define FILE_OUTPUT_H
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include "./backend.h"
+
+extern const OutputBackend milky_outputFile;
+
+#endif // FILE_OUTPUT_H
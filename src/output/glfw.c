@@ -0,0 +1,457 @@
+#include "glfw.h"
+
+// GLFW window and OpenGL texture
+static GLFWwindow *window = NULL;
+static GLuint texture;
+
+// window configuration (see config.h)
+static MilkyConfig milky_glfwConfig;
+
+// size of the window's framebuffer, set on the main thread and read where the frame is drawn
+static int milky_glfwViewportWidth = 0;
+static int milky_glfwViewportHeight = 0;
+
+// canvas size requested by a window resize (0 = none pending, see takeGlfwCanvasSize())
+static size_t milky_glfwPendingWidth = 0;
+static size_t milky_glfwPendingHeight = 0;
+
+// 1 while frames are presented by the display thread (see presentWindowFrame())
+static int milky_glfwDisplayThread = 0;
+
+// for when the window is resized, we want to resize the viewport (on the next draw, which may
+// run on the display thread); unless the canvas size is fixed, the canvas follows the window
+// (applied between frames by the caller, see takeGlfwCanvasSize())
+void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+    (void)window;
+    __atomic_store_n(&milky_glfwViewportWidth, width, __ATOMIC_RELAXED);
+    __atomic_store_n(&milky_glfwViewportHeight, height, __ATOMIC_RELAXED);
+
+    if (!milky_glfwConfig.fixedCanvas && width > 0 && height > 0) {
+        milky_glfwPendingWidth = (size_t)width;
+        milky_glfwPendingHeight = (size_t)height;
+    }
+}
+
+/**
+ * Returns the monitor selected in the configuration (falls back to the primary monitor).
+ *
+ * @return The monitor, or NULL if GLFW doesn't report any.
+ */
+static GLFWmonitor *getConfiguredMonitor(void) {
+    int count = 0;
+    GLFWmonitor **monitors = glfwGetMonitors(&count);
+    if (!monitors || count == 0) return NULL;
+
+    if (milky_glfwConfig.monitor >= count) {
+        fprintf(stderr, "Monitor %d not found, using the primary monitor.\n", milky_glfwConfig.monitor);
+        return monitors[0];
+    }
+    return monitors[milky_glfwConfig.monitor];
+}
+
+GLuint VAO, VBO, EBO;
+
+void setup_vertex_data() {
+    float vertices[] = {
+        // Positions      // Texture Coords
+        -1.0f, -1.0f,     0.0f, 0.0f,
+         1.0f, -1.0f,     1.0f, 0.0f,
+         1.0f,  1.0f,     1.0f, 1.0f,
+        -1.0f,  1.0f,     0.0f, 1.0f
+    };
+
+    unsigned int indices[] = {
+        0, 1, 2,
+        2, 3, 0
+    };
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+
+    glBindVertexArray(VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+
+const char* vertex_shader_src = 
+    "#version 330 core\n"
+    "layout(location = 0) in vec2 aPos;\n"   // Input vertex position
+    "layout(location = 1) in vec2 aTexCoord;\n" // Input texture coordinates
+    "out vec2 TexCoord;\n"                 // Output texture coordinates
+    "uniform float curvatureStrength;      // Strength of the curvature\n"
+    "\n"
+    "void main() {\n"
+    "    // Compute distance from the center of the screen\n"
+    "    vec2 centeredPos = aPos * 2.0 - 1.0; // Convert to [-1, 1] range\n"
+    "    float distanceSq = dot(centeredPos, centeredPos);\n"
+    "\n"
+    "    // Apply curvature effect\n"
+    "    float curvature = curvatureStrength * distanceSq;\n"
+    "    vec3 curvedPosition = vec3(centeredPos, -curvature);\n"
+    "\n"
+    "    // Map back to screen space\n"
+    "    gl_Position = vec4(curvedPosition.xy * 0.5 + 0.5, curvedPosition.z, 1.0);\n"
+    "\n"
+    "    // Pass through the texture coordinates\n"
+    "    TexCoord = aTexCoord;\n"
+    "}\n";
+
+
+const char* fragment_shader_src = 
+"#version 330 core\n"
+"in vec2 TexCoord;\n"
+"out vec4 FragColor;\n"
+"uniform sampler2D texture1;\n"
+"uniform float vignetteIntensity; // Intensity of the vignette effect\n"
+"uniform float zoomFactor;        // Zoom effect multiplier\n"
+"uniform vec2 center;             // Dynamic center point\n"
+"uniform float time;              // Time for animation\n"
+"uniform float rotationSpeed;     // Speed of rotation\n"
+"uniform float blurStrength;      // Strength of radial blur\n"
+"uniform vec3 replacementColor;     // Most frequent color\n"
+"uniform vec4 presentMotion;      // Motion since the frame was rendered (zoom, rotation, dx, dy)\n"
+"uniform vec2 presentCenter;      // Center of the rotation\n"
+"uniform float aspect;            // Height / width of the frame\n"
+"\n"
+// Continues the feedback motion of the frame between two rendered frames (same transform as transformWarpPoint() in warp.c)\n
+"vec2 presentUV(vec2 uv) {\n"
+"    vec2 zoomed = (uv - 0.5) / presentMotion.x + 0.5;\n"
+"    vec2 offset = (zoomed - presentCenter) * vec2(1.0, aspect);\n"
+"    float c = cos(presentMotion.y), s = sin(presentMotion.y);\n"
+"    vec2 rotated = vec2(offset.x * c - offset.y * s, (offset.x * s + offset.y * c) / aspect);\n"
+"    return rotated + presentCenter - presentMotion.zw;\n"
+"}\n"
+"\n"
+// Radial blur helper function\n
+"vec4 radialBlur(sampler2D tex, vec2 uv, vec2 center, float blurStrength) {\n"
+"    vec4 result = vec4(0.0);\n"
+"    float totalWeight = 0.0;\n"
+"    for (float t = 0.0; t < 1.0; t += 0.1) {\n"
+"        vec2 sampleUV = mix(uv, center, t * blurStrength);\n"
+"        vec4 sample = texture(tex, sampleUV);\n"
+"        float weight = 1.0 - t;\n"
+"        result += sample * weight;\n"
+"        totalWeight += weight;\n"
+"    }\n"
+"    return result / totalWeight;\n"
+"}\n"
+"\n"
+"void main() {\n"
+"    // Rotate the texture coordinates\n"
+"    float angle = time * rotationSpeed;\n"
+"    mat2 rotationMatrix = mat2(cos(angle), -sin(angle), sin(angle), cos(angle));\n"
+"    vec2 rotatedUV = rotationMatrix * (presentUV(TexCoord) - center) + center;\n"
+"\n"
+"    // Apply zoom factor\n"
+"    vec2 zoomUV = center + (rotatedUV - center) * zoomFactor;\n"
+"\n"
+"    // Add radial blur\n"
+"    vec4 blurred = radialBlur(texture1, zoomUV, center, blurStrength);\n"
+"\n"
+"   // Replace black pixels with the most occurring color\n"
+"   /*if (blurred.rgb == vec3(0.0, 0.0, 0.0)) {\n"
+"        blurred.rgb = replacementColor;\n"
+"    }*/\n"
+"\n"
+"    // Center dim effect\n"
+"    vec2 offset = TexCoord - center;\n"
+"    float distance = length(offset);\n"
+"    float smoothValue = smoothstep(0.0, 0.9, distance);\n"
+"    float dimFactor = mix(1.0 - 0.3, 1.0, smoothValue);\n"
+"    dimFactor = clamp(dimFactor, 0.0, 1.0);\n"
+"    blurred.rgb *= clamp(dimFactor, 0.0, 1.0);\n"
+"\n"
+"    // Gamma correction\n"
+"    float gamma = 1.8; // Standard gamma correction\n"
+"    blurred.rgb = pow(blurred.rgb, vec3(1.0 / gamma));\n"
+"\n"
+"    // Clamp the final color values to valid range\n"
+"    blurred.rgb = clamp(blurred.rgb, 0.0, 1.0);\n"
+"\n"
+"    // Output the final color\n"
+"    FragColor = blurred;\n"
+"}\n";
+
+
+GLuint shader_program;
+
+void compile_and_link_shaders() {
+    GLuint vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertex_shader, 1, &vertex_shader_src, NULL);
+    glCompileShader(vertex_shader);
+
+    GLint success;
+    glGetShaderiv(vertex_shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        char info_log[512];
+        glGetShaderInfoLog(vertex_shader, 512, NULL, info_log);
+        fprintf(stderr, "ERROR::VERTEX_SHADER_COMPILATION_FAILED\n%s\n", info_log);
+    }
+
+    GLuint fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragment_shader, 1, &fragment_shader_src, NULL);
+    glCompileShader(fragment_shader);
+
+    glGetShaderiv(fragment_shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        char info_log[512];
+        glGetShaderInfoLog(fragment_shader, 512, NULL, info_log);
+        fprintf(stderr, "ERROR::FRAGMENT_SHADER_COMPILATION_FAILED\n%s\n", info_log);
+    }
+
+    shader_program = glCreateProgram();
+    glAttachShader(shader_program, vertex_shader);
+    glAttachShader(shader_program, fragment_shader);
+    glLinkProgram(shader_program);
+
+    glGetProgramiv(shader_program, GL_LINK_STATUS, &success);
+    if (!success) {
+        char info_log[512];
+        glGetProgramInfoLog(shader_program, 512, NULL, info_log);
+        fprintf(stderr, "ERROR::SHADER_PROGRAM_LINKING_FAILED\n%s\n", info_log);
+    }
+
+    glDeleteShader(vertex_shader);
+    glDeleteShader(fragment_shader);
+}
+
+// draws a frame (buffer) onto the 2D texture (OpenGL) inside of the window; the texture is only
+// re-uploaded when the frame changed, the motion continues the feedback motion since it was rendered
+static void draw_frame(const uint8_t *pixels, size_t width, size_t height, int upload, const DisplayMotion *motion) {
+    glUseProgram(shader_program);
+    glViewport(0, 0, __atomic_load_n(&milky_glfwViewportWidth, __ATOMIC_RELAXED),
+               __atomic_load_n(&milky_glfwViewportHeight, __ATOMIC_RELAXED));
+
+    float time = glfwGetTime(); // Get elapsed time
+    glUniform1f(glGetUniformLocation(shader_program, "time"), time);
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+    if (upload) {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, (GLsizei)width, (GLsizei)height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    }
+
+    // Update the "presentMotion", "presentCenter" and "aspect" uniforms
+    glUniform4f(glGetUniformLocation(shader_program, "presentMotion"), motion->zoom, motion->rotation, motion->dx, motion->dy);
+    glUniform2f(glGetUniformLocation(shader_program, "presentCenter"), motion->centerX, motion->centerY);
+    glUniform1f(glGetUniformLocation(shader_program, "aspect"), width > 0 ? (float)height / (float)width : 1.0f);
+
+    // Update the "curvatureStrength" uniform
+    float curvatureStrength = 0.05f; // Subtle curvature
+    glUniform1f(glGetUniformLocation(shader_program, "curvatureStrength"), curvatureStrength);
+
+
+    // Update the "grainAmount" uniform
+    float vignetteIntensity = 1.1f; // Example grain amount
+    glUniform1f(glGetUniformLocation(shader_program, "vignetteIntensity"), vignetteIntensity);
+
+    /*
+    Color mostFrequentColor = analyze_first_line(frame, 1000);
+    float r = mostFrequentColor.r / 255.0f;
+    float g = mostFrequentColor.g / 255.0f;
+    float b = mostFrequentColor.b / 255.0f;
+
+    GLint replacementColorLoc = glGetUniformLocation(shader_program, "replacementColor");
+    glUniform3f(replacementColorLoc, r, g, b);*/
+
+    // Update the "zoomFactor" uniform
+    float zoomFactor = 0.995f; // Slight zoom-out
+    glUniform1f(glGetUniformLocation(shader_program, "zoomFactor"), zoomFactor);
+
+    // Update the "grainAmount" uniform
+    float grainAmount = 0.03f; // Example grain amount
+    glUniform1f(glGetUniformLocation(shader_program, "grainAmount"), grainAmount);
+
+    // Update the "center" uniform (dynamic movement over time)
+    float centerX = 0.5f; /*+ 0.1f * sin(time * 0.5f); */// Moves left and right
+    float centerY = 0.5f; /*+ 0.1f * cos(time * 0.3f);*/ // Moves up and down
+    glUniform2f(glGetUniformLocation(shader_program, "center"), centerX, centerY);
+
+    // Update the "rotationSpeed" uniform
+    float rotationSpeed = 0.0f; // Example rotation speed (radians per second)
+    glUniform1f(glGetUniformLocation(shader_program, "rotationSpeed"), rotationSpeed);
+
+    // Update the "blurStrength" uniform
+    float blurStrength = 0.001f; // Subtle radial blur
+    glUniform1f(glGetUniformLocation(shader_program, "blurStrength"), blurStrength);
+
+
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    glBindVertexArray(VAO);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    glBindVertexArray(0);
+}
+
+/**
+ * Shows a frame on the display thread (see startDisplayThread()): the GL context is
+ * taken over on the first call, every call waits for the display refresh.
+ *
+ * @param presentation The frame and its motion since it was rendered.
+ * @param userData     Unused.
+ * @return             1 to keep presenting, 0 once the window should close.
+ */
+static int presentWindowFrame(const DisplayPresentation *presentation, void *userData) {
+    (void)userData;
+    if (glfwGetCurrentContext() != window) {
+        glfwMakeContextCurrent(window);
+        glfwSwapInterval(1);
+    }
+
+    draw_frame(presentation->pixels, presentation->width, presentation->height, presentation->isNew, &presentation->motion);
+
+    if (glfwWindowShouldClose(window)) return 0;
+    glfwSwapBuffers(window);
+    return 1;
+}
+
+// creates the window and initializes the GPU primitives (OpenGL); the canvas starts with the size
+// of the window's framebuffer (in pixels, HiDPI aware) unless it's fixed to the configured size
+static int openGlfwOutput(const MilkyConfig *config, size_t *canvasWidth, size_t *canvasHeight) {
+    milky_glfwConfig = *config;
+
+    if (!glfwInit()) {
+        fprintf(stderr, "Failed to initialize GLFW.\n");
+        return 0;
+    }
+
+    // a canvas size of 0 means the size of the monitor
+    GLFWmonitor *monitor = getConfiguredMonitor();
+    const GLFWvidmode *mode = monitor ? glfwGetVideoMode(monitor) : NULL;
+    size_t width = milky_glfwConfig.width, height = milky_glfwConfig.height;
+    if (width == 0) width = mode ? (size_t)mode->width : MILKY_CONFIG_DEFAULT_WIDTH;
+    if (height == 0) height = mode ? (size_t)mode->height : MILKY_CONFIG_DEFAULT_HEIGHT;
+
+    if (milky_glfwConfig.fullscreen && mode) {
+        window = glfwCreateWindow(mode->width, mode->height, "MilkyLinuxOSD", monitor, NULL);
+    } else {
+        window = glfwCreateWindow((int)width, (int)height, "MilkyLinuxOSD", NULL, NULL);
+    }
+    if (!window) {
+        fprintf(stderr, "Failed to create GLFW window.\n");
+        glfwTerminate();
+        return 0;
+    }
+
+    // windowed mode on another monitor: center the window on it
+    if (!milky_glfwConfig.fullscreen && mode && milky_glfwConfig.monitor > 0) {
+        int monitorX = 0, monitorY = 0;
+        glfwGetMonitorPos(monitor, &monitorX, &monitorY);
+        glfwSetWindowPos(window, monitorX + (mode->width - (int)width) / 2, monitorY + (mode->height - (int)height) / 2);
+    }
+
+    int framebufferWidth = 0, framebufferHeight = 0;
+    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+    *canvasWidth = width;
+    *canvasHeight = height;
+    if (!milky_glfwConfig.fixedCanvas && framebufferWidth > 0 && framebufferHeight > 0) {
+        *canvasWidth = (size_t)framebufferWidth;
+        *canvasHeight = (size_t)framebufferHeight;
+    }
+
+    framebuffer_size_callback(window, framebufferWidth, framebufferHeight);
+    milky_glfwPendingWidth = 0;
+    milky_glfwPendingHeight = 0;
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+    glfwMakeContextCurrent(window);
+
+    if (glewInit() != GLEW_OK) {
+        fprintf(stderr, "Failed to initialize GLEW.\n");
+        glfwDestroyWindow(window);
+        window = NULL;
+        glfwTerminate();
+        return 0;
+    }
+
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    compile_and_link_shaders();
+    setup_vertex_data();
+
+    // frames are shown at the display refresh rate by the display thread, which owns the
+    // GL context from now on (events and the window stay on this thread)
+    if (milky_glfwConfig.interpolateFrames) {
+        glfwMakeContextCurrent(NULL);
+        milky_glfwDisplayThread = startDisplayThread(presentWindowFrame, NULL);
+        if (!milky_glfwDisplayThread) glfwMakeContextCurrent(window);
+    }
+    return 1;
+}
+
+// renders the frame (buffer) onto the 2D texture (OpenGL) inside of the window (or hands it to the
+// display thread, which keeps its motion going until the next one)
+static int presentGlfwOutput(const uint8_t *frame, size_t width, size_t height, const DisplayMotion *motion) {
+    if (milky_glfwDisplayThread) {
+        submitDisplayFrame(frame, width, height, motion);
+    } else {
+        DisplayMotion still = getStaticDisplayMotion();
+        draw_frame(frame, width, height, 1, &still);
+        if (!glfwWindowShouldClose(window)) glfwSwapBuffers(window);
+    }
+
+    glfwPollEvents();
+    return !glfwWindowShouldClose(window);
+}
+
+static int takeGlfwCanvasSize(size_t *width, size_t *height) {
+    if (milky_glfwPendingWidth == 0 || milky_glfwPendingHeight == 0) return 0;
+
+    *width = milky_glfwPendingWidth;
+    *height = milky_glfwPendingHeight;
+    milky_glfwPendingWidth = 0;
+    milky_glfwPendingHeight = 0;
+    return 1;
+}
+
+static void closeGlfwOutput(void) {
+    if (!window) return;
+
+    if (milky_glfwDisplayThread) {
+        stopDisplayThread();
+        milky_glfwDisplayThread = 0;
+        glfwMakeContextCurrent(window);
+    }
+
+    if (texture) {
+        glDeleteTextures(1, &texture);
+        texture = 0;
+    }
+
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &EBO);
+    glDeleteProgram(shader_program);
+
+    glfwDestroyWindow(window);
+    window = NULL;
+    glfwTerminate();
+}
+
+// shows the frames in a window (OpenGL), at the display refresh rate with --interpolate 1
+const OutputBackend milky_outputGlfw = {
+    "glfw",
+    openGlfwOutput,
+    presentGlfwOutput,
+    takeGlfwCanvasSize,
+    closeGlfwOutput
+};
@@ -0,0 +1,17 @@
+#ifndef GLFW_OUTPUT_H
+#define GLFW_OUTPUT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// for rendering using GLFW
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "./backend.h"
+
+extern const OutputBackend milky_outputGlfw;
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+
+#endif // GLFW_OUTPUT_H
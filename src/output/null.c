@@ -0,0 +1,28 @@
+#include "null.h"
+
+static int openNullOutput(const MilkyConfig *config, size_t *canvasWidth, size_t *canvasHeight) {
+    (void)config;
+    (void)canvasWidth;
+    (void)canvasHeight;
+    return 1;
+}
+
+static int presentNullOutput(const uint8_t *frame, size_t width, size_t height, const DisplayMotion *motion) {
+    (void)frame;
+    (void)width;
+    (void)height;
+    (void)motion;
+    return 1;
+}
+
+static void closeNullOutput(void) {
+}
+
+// discards the frames (renders at full speed without any presentation cost, e.g. for benchmarks)
+const OutputBackend milky_outputNull = {
+    "null",
+    openNullOutput,
+    presentNullOutput,
+    NULL,
+    closeNullOutput
+};
@@ -0,0 +1,8 @@
+#ifndef NULL_OUTPUT_H
+#define NULL_OUTPUT_H
+
+#include "./backend.h"
+
+extern const OutputBackend milky_outputNull;
+
+#endif // NULL_OUTPUT_H
@@ -0,0 +1,157 @@
+#include "output.h"
+
+// backends that can be selected with --output (the window only if built with GLFW)
+static const OutputBackend *const milky_outputBackends[] = {
+#ifdef MILKY_WITH_GLFW
+    &milky_outputGlfw,
+#endif
+    &milky_outputShm,
+    &milky_outputFile,
+    &milky_outputY4m,
+    &milky_outputNull
+};
+
+// stdout of the process, moved aside for the outputs that write to "-" (-1 = not reserved)
+static int milky_outputStdout = -1;
+
+// the opened backends, in the order they were selected
+static const OutputBackend *milky_outputActive[MILKY_OUTPUT_MAX_ACTIVE];
+static size_t milky_outputActiveCount = 0;
+
+/**
+ * Finds a backend by name.
+ *
+ * @param name The name (e.g. "glfw", "shm", "file", "null").
+ * @return     The backend, or NULL if there's none of that name in this build.
+ */
+const OutputBackend *findOutputBackend(const char *name) {
+    for (size_t i = 0; i < sizeof(milky_outputBackends) / sizeof(milky_outputBackends[0]); i++) {
+        if (strcmp(milky_outputBackends[i]->name, name) == 0) return milky_outputBackends[i];
+    }
+    return NULL;
+}
+
+/**
+ * Opens the backends selected in the configuration (a comma separated list). The
+ * canvas size starts as configured (0 = default) and may be picked by a backend,
+ * for example the window.
+ *
+ * @param config       The configuration (outputs lists the backends).
+ * @param canvasWidth  Receives the canvas width.
+ * @param canvasHeight Receives the canvas height.
+ * @return             1 on success, 0 if a backend is unknown or fails to open (none stays open).
+ */
+int openOutputs(const MilkyConfig *config, size_t *canvasWidth, size_t *canvasHeight) {
+    closeOutputs();
+
+    *canvasWidth = config->width ? config->width : MILKY_CONFIG_DEFAULT_WIDTH;
+    *canvasHeight = config->height ? config->height : MILKY_CONFIG_DEFAULT_HEIGHT;
+
+    const char *list = config->outputs;
+    while (*list) {
+        char name[32];
+        size_t length = strcspn(list, ",");
+        if (length >= sizeof(name)) length = sizeof(name) - 1;
+        memcpy(name, list, length);
+        name[length] = '\0';
+        list += strcspn(list, ",");
+        if (*list == ',') list++;
+        if (name[0] == '\0') continue;
+
+        const OutputBackend *backend = findOutputBackend(name);
+        if (!backend) {
+            fprintf(stderr, "Unknown output: %s\n", name);
+            closeOutputs();
+            return 0;
+        }
+        if (milky_outputActiveCount == MILKY_OUTPUT_MAX_ACTIVE) {
+            fprintf(stderr, "Too many outputs (at most %d)\n", MILKY_OUTPUT_MAX_ACTIVE);
+            closeOutputs();
+            return 0;
+        }
+        if (!backend->open(config, canvasWidth, canvasHeight)) {
+            fprintf(stderr, "Failed to open the %s output\n", name);
+            closeOutputs();
+            return 0;
+        }
+        milky_outputActive[milky_outputActiveCount++] = backend;
+    }
+    return 1;
+}
+
+/**
+ * Hands a finished frame to every open backend.
+ *
+ * @param frame  The frame (RGBA format).
+ * @param width  Its width in pixels.
+ * @param height Its height in pixels.
+ * @param motion Motion of the feedback image in the frame (see getVideoFrameMotion()).
+ * @return       1 to continue, 0 if a backend asks to stop (e.g. the window was closed).
+ */
+int presentOutputs(const uint8_t *frame, size_t width, size_t height, const DisplayMotion *motion) {
+    int running = 1;
+    for (size_t i = 0; i < milky_outputActiveCount; i++) {
+        if (!milky_outputActive[i]->present(frame, width, height, motion)) running = 0;
+    }
+    return running;
+}
+
+/**
+ * Checks whether a backend wants another canvas size (the first request wins).
+ *
+ * @param width  Receives the requested width.
+ * @param height Receives the requested height.
+ * @return       1 if a size was requested since the last call, 0 otherwise.
+ */
+int takeOutputCanvasSize(size_t *width, size_t *height) {
+    int requested = 0;
+    for (size_t i = 0; i < milky_outputActiveCount; i++) {
+        size_t requestedWidth = 0, requestedHeight = 0;
+        if (milky_outputActive[i]->takeCanvasSize && milky_outputActive[i]->takeCanvasSize(&requestedWidth, &requestedHeight) && !requested) {
+            *width = requestedWidth;
+            *height = requestedHeight;
+            requested = 1;
+        }
+    }
+    return requested;
+}
+
+/**
+ * Closes the open backends (in reverse order).
+ */
+void closeOutputs(void) {
+    while (milky_outputActiveCount > 0) {
+        milky_outputActive[--milky_outputActiveCount]->close();
+    }
+}
+
+/**
+ * Keeps stdout for the frames of the file outputs (--output-file -): the process'
+ * stdout is moved aside and replaced by stderr, so messages printed from now on
+ * can't end up in the middle of the video stream. Call before anything is printed.
+ */
+void reserveOutputStdout(void) {
+    if (milky_outputStdout >= 0) return;
+
+    fflush(stdout);
+    milky_outputStdout = dup(STDOUT_FILENO);
+    if (milky_outputStdout >= 0) dup2(STDERR_FILENO, STDOUT_FILENO);
+}
+
+/**
+ * Opens the file an output writes to.
+ *
+ * @param path The path, or "-" for stdout (see reserveOutputStdout()).
+ * @return     The stream (close with fclose()), or NULL on failure.
+ */
+FILE *openOutputStream(const char *path) {
+    FILE *stream = NULL;
+    if (strcmp(path, "-") == 0) {
+        int file = dup(milky_outputStdout >= 0 ? milky_outputStdout : STDOUT_FILENO);
+        stream = file >= 0 ? fdopen(file, "wb") : NULL;
+    } else {
+        stream = fopen(path, "wb");
+    }
+    if (!stream) fprintf(stderr, "Failed to open %s: %s\n", path, strerror(errno));
+    return stream;
+}
@@ -0,0 +1,30 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "./backend.h"
+#include "./null.h"
+#include "./shm.h"
+#include "./file.h"
+#include "./y4m.h"
+
+#ifdef MILKY_WITH_GLFW
+#include "./glfw.h"
+#endif
+
+#define MILKY_OUTPUT_MAX_ACTIVE 4 // backends that can be selected at once
+
+const OutputBackend *findOutputBackend(const char *name);
+int openOutputs(const MilkyConfig *config, size_t *canvasWidth, size_t *canvasHeight);
+int presentOutputs(const uint8_t *frame, size_t width, size_t height, const DisplayMotion *motion);
+int takeOutputCanvasSize(size_t *width, size_t *height);
+void closeOutputs(void);
+void reserveOutputStdout(void);
+
+#endif // OUTPUT_H
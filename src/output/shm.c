@@ -0,0 +1,22 @@
+#include "shm.h"
+
+static int openShmOutput(const MilkyConfig *config, size_t *canvasWidth, size_t *canvasHeight) {
+    if (!openFrameExport(config->exportName, config->exportSlots, *canvasWidth, *canvasHeight)) return 0;
+    fprintf(stderr, "Publishing frames to /dev/shm/%s\n", config->exportName[0] == '/' ? config->exportName + 1 : config->exportName);
+    return 1;
+}
+
+static int presentShmOutput(const uint8_t *frame, size_t width, size_t height, const DisplayMotion *motion) {
+    (void)motion;
+    publishFrameExport(frame, width, height); // a failed frame is dropped, the next one may fit again
+    return 1;
+}
+
+// publishes the frames to a shared memory ring (see export.h)
+const OutputBackend milky_outputShm = {
+    "shm",
+    openShmOutput,
+    presentShmOutput,
+    NULL,
+    closeFrameExport
+};
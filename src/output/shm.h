@@ -0,0 +1,9 @@
+#ifndef SHM_OUTPUT_H
+#define SHM_OUTPUT_H
+
+#include "./backend.h"
+#include "../video/export.h"
+
+extern const OutputBackend milky_outputShm;
+
+#endif // SHM_OUTPUT_H
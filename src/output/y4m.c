@@ -0,0 +1,163 @@
+#include "y4m.h"
+
+// the stream and its format (fixed by the header, written with the first frame)
+static FILE *milky_y4mFile = NULL;
+static unsigned milky_y4mFrameRate = 30;
+static size_t milky_y4mWidth = 0;
+static size_t milky_y4mHeight = 0;
+static size_t milky_y4mFrameSize = 0; // bytes of one I420 frame
+
+// converted frames waiting for the writer thread (guarded by the lock): slots
+// [head, head + count) are full, the render thread fills the one after them
+static pthread_t milky_y4mThread;
+static pthread_mutex_t milky_y4mLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t milky_y4mFilled = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t milky_y4mEmptied = PTHREAD_COND_INITIALIZER;
+static uint8_t *milky_y4mQueue[MILKY_Y4M_QUEUE_LENGTH];
+static size_t milky_y4mHead = 0;
+static size_t milky_y4mCount = 0;
+static int milky_y4mStopping = 0;
+static int milky_y4mFailed = 0;
+static int milky_y4mStarted = 0;
+
+// writes the queued frames, so a slow pipe (an encoder) never blocks the rendering
+// unless the queue is full
+static void *runY4mWriter(void *argument) {
+    (void)argument;
+
+    pthread_mutex_lock(&milky_y4mLock);
+    while (1) {
+        while (milky_y4mCount == 0 && !milky_y4mStopping) {
+            pthread_cond_wait(&milky_y4mFilled, &milky_y4mLock);
+        }
+        if (milky_y4mCount == 0) break;
+
+        const uint8_t *frame = milky_y4mQueue[milky_y4mHead];
+        pthread_mutex_unlock(&milky_y4mLock);
+
+        int written = fputs("FRAME\n", milky_y4mFile) >= 0
+            && fwrite(frame, 1, milky_y4mFrameSize, milky_y4mFile) == milky_y4mFrameSize;
+
+        pthread_mutex_lock(&milky_y4mLock);
+        if (!written) {
+            fprintf(stderr, "Failed to write a frame: %s\n", strerror(errno));
+            milky_y4mFailed = 1;
+            milky_y4mCount = 0;
+            pthread_cond_signal(&milky_y4mEmptied);
+            break;
+        }
+        milky_y4mHead = (milky_y4mHead + 1) % MILKY_Y4M_QUEUE_LENGTH;
+        milky_y4mCount--;
+        pthread_cond_signal(&milky_y4mEmptied);
+    }
+    pthread_mutex_unlock(&milky_y4mLock);
+    return NULL;
+}
+
+static int openY4mOutput(const MilkyConfig *config, size_t *canvasWidth, size_t *canvasHeight) {
+    (void)canvasWidth;
+    (void)canvasHeight;
+
+    milky_y4mFile = openOutputStream(config->outputFile);
+    if (!milky_y4mFile) return 0;
+
+    milky_y4mFrameRate = config->frameRate;
+    milky_y4mWidth = 0;
+    milky_y4mHeight = 0;
+    milky_y4mHead = 0;
+    milky_y4mCount = 0;
+    milky_y4mStopping = 0;
+    milky_y4mFailed = 0;
+    return 1;
+}
+
+/**
+ * Writes the stream header and allocates the queue for the size of the first frame
+ * (a Y4M stream can't change its size later).
+ */
+static int startY4mStream(size_t width, size_t height) {
+    milky_y4mWidth = width;
+    milky_y4mHeight = height;
+    milky_y4mFrameSize = width * height + 2 * MILKY_YUV_CHROMA_SIZE(width) * MILKY_YUV_CHROMA_SIZE(height);
+
+    for (size_t i = 0; i < MILKY_Y4M_QUEUE_LENGTH; i++) {
+        milky_y4mQueue[i] = (uint8_t *)malloc(milky_y4mFrameSize);
+        if (!milky_y4mQueue[i]) {
+            fprintf(stderr, "Failed to allocate the Y4M queue\n");
+            return 0;
+        }
+    }
+
+    // 4:2:0 with the chroma centered between the luma samples (2x2 averages), BT.601 limited range
+    fprintf(milky_y4mFile, "YUV4MPEG2 W%zu H%zu F%u:1 Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n", width, height, milky_y4mFrameRate);
+    fprintf(stderr, "Writing %zux%zu Y4M at %u fps\n", width, height, milky_y4mFrameRate);
+
+    if (pthread_create(&milky_y4mThread, NULL, runY4mWriter, NULL) != 0) {
+        fprintf(stderr, "Failed to start the Y4M writer\n");
+        return 0;
+    }
+    milky_y4mStarted = 1;
+    return 1;
+}
+
+static int presentY4mOutput(const uint8_t *frame, size_t width, size_t height, const DisplayMotion *motion) {
+    (void)motion;
+
+    if (!milky_y4mStarted && !startY4mStream(width, height)) return 0;
+    if (width != milky_y4mWidth || height != milky_y4mHeight) {
+        fprintf(stderr, "The canvas size changed, the Y4M stream stays %zux%zu (use --fixed-canvas)\n", milky_y4mWidth, milky_y4mHeight);
+        return 0;
+    }
+
+    // wait for a free slot (offline rendering outpaces the encoder, which sets the pace then)
+    pthread_mutex_lock(&milky_y4mLock);
+    while (milky_y4mCount == MILKY_Y4M_QUEUE_LENGTH && !milky_y4mFailed) {
+        pthread_cond_wait(&milky_y4mEmptied, &milky_y4mLock);
+    }
+    const int failed = milky_y4mFailed;
+    const size_t slot = (milky_y4mHead + milky_y4mCount) % MILKY_Y4M_QUEUE_LENGTH;
+    pthread_mutex_unlock(&milky_y4mLock);
+    if (failed) return 0;
+
+    // the writer never touches the free slot, so it is converted without the lock
+    uint8_t *planes = milky_y4mQueue[slot];
+    const size_t chromaSize = MILKY_YUV_CHROMA_SIZE(width) * MILKY_YUV_CHROMA_SIZE(height);
+    convertRgbaToI420(frame, width, height, planes, planes + width * height, planes + width * height + chromaSize);
+
+    pthread_mutex_lock(&milky_y4mLock);
+    milky_y4mCount++;
+    pthread_cond_signal(&milky_y4mFilled);
+    pthread_mutex_unlock(&milky_y4mLock);
+    return 1;
+}
+
+// drains the queue before closing the stream
+static void closeY4mOutput(void) {
+    if (milky_y4mStarted) {
+        pthread_mutex_lock(&milky_y4mLock);
+        milky_y4mStopping = 1;
+        pthread_cond_signal(&milky_y4mFilled);
+        pthread_mutex_unlock(&milky_y4mLock);
+        pthread_join(milky_y4mThread, NULL);
+        milky_y4mStarted = 0;
+    }
+
+    for (size_t i = 0; i < MILKY_Y4M_QUEUE_LENGTH; i++) {
+        free(milky_y4mQueue[i]);
+        milky_y4mQueue[i] = NULL;
+    }
+
+    if (milky_y4mFile) {
+        fclose(milky_y4mFile);
+        milky_y4mFile = NULL;
+    }
+}
+
+// encodes the frames as a YUV4MPEG2 stream (e.g. piped into ffmpeg: --output-file - | ffmpeg -i - ...)
+const OutputBackend milky_outputY4m = {
+    "y4m",
+    openY4mOutput,
+    presentY4mOutput,
+    NULL,
+    closeY4mOutput
+};
@@ -0,0 +1,17 @@
+#ifndef Y4M_OUTPUT_H
+#define Y4M_OUTPUT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+
+#include "./backend.h"
+#include "../video/yuv.h"
+
+#define MILKY_Y4M_QUEUE_LENGTH 4 // converted frames waiting for the writer thread
+
+extern const OutputBackend milky_outputY4m;
+
+#endif // Y4M_OUTPUT_H
@@ -1,35 +1,256 @@
 #include "preset.h"
 
-// Ordered list of well-known property names
-const char *milky_presetWellKnownPropertyNames[MILKY_MAX_PROPERTY_COUNT_PER_PRESET] = {
+// Ordered list of well-known property names (indexed by PresetProperty)
+const char *milky_presetWellKnownPropertyNames[MILKY_PRESET_PROPERTY_COUNT] = {
     "damping", "effect_bar", "effect_chasers", "effect_dots", "effect_grid",
     "effect_nuclide", "effect_shadebobs", "effect_solar", "effect_spectral",
     "f1", "f2", "f3", "f4", "gamma", "magic", "mode", "pal_bFX",
     "pal_curve_id_1", "pal_curve_id_2", "pal_curve_id_3", "pal_FXpalnum",
     "pal_hi_oband", "pal_lo_band", "s1", "s2", "shift", "spectrum",
-    "t1", "t2", "volpos", "wave", "x_center", "y_center"
+    "t1", "t2", "volpos", "wave", "x_center", "y_center",
+    "zoom", "zoomexp", "rot", "warp", "warp_speed", "warp_scale", "dx", "dy", "sx", "sy",
+    "displacement_map"
 };
 
-// Struct for a preset, including properties and their names
+// a name (or Milkdrop alias) of a property, for the sorted lookup table
 typedef struct {
-    int presetNumber;
-    float properties[MILKY_MAX_PROPERTY_COUNT_PER_PRESET];
-    const char *propertyNames[MILKY_MAX_PROPERTY_COUNT_PER_PRESET]; // Ordered property names
-} Preset;
+    const char *name;
+    PresetProperty property;
+} PresetPropertyName;
 
-// Populate property names in each Preset
-void initializePresetPropertyNames(Preset *preset) {
-    for (size_t i = 0; i < MILKY_MAX_PROPERTY_COUNT_PER_PRESET; i++) {
-        preset->propertyNames[i] = milky_presetWellKnownPropertyNames[i];
+// Milkdrop names of properties that exist in both
+static const PresetPropertyName milky_presetAliases[] = {
+    { "cx", MILKY_PRESET_X_CENTER },
+    { "cy", MILKY_PRESET_Y_CENTER },
+    { "fDecay", MILKY_PRESET_DAMPING },
+    { "fGammaAdj", MILKY_PRESET_GAMMA },
+    { "fWarpAnimSpeed", MILKY_PRESET_WARP_SPEED },
+    { "fWarpScale", MILKY_PRESET_WARP_SCALE },
+    { "fZoomExponent", MILKY_PRESET_ZOOM_EXPONENT }
+};
+
+#define MILKY_PRESET_ALIAS_COUNT (sizeof(milky_presetAliases) / sizeof(milky_presetAliases[0]))
+
+// all names and aliases, sorted case-insensitively for bsearch() (built on first use)
+static PresetPropertyName milky_presetSortedNames[MILKY_PRESET_PROPERTY_COUNT + MILKY_PRESET_ALIAS_COUNT];
+static pthread_once_t milky_presetSortedNamesOnce = PTHREAD_ONCE_INIT;
+
+// the active presets are a snapshot of the storage table, a mapped binary cache or a
+// table published by the hot reload; contexts hold a reference to the snapshot their
+// frames read (see acquirePresetSnapshot()), so swapping it never waits for a frame
+static PresetTable milky_presetStorage;
+static PresetSnapshot milky_presetStorageSnapshot = { milky_presetStorage.presets, 0, 1, NULL, NULL, 0 };
+static PresetSnapshot *milky_presetActive = &milky_presetStorageSnapshot; // accessed atomically
+
+// readers between loading milky_presetActive and counting their reference, by the parity
+// of the epoch they started in (see waitForPresetReaders()); accessed atomically
+static unsigned milky_presetEpoch = 0;
+static int milky_presetReaders[2] = { 0, 0 };
+
+// serializes the publishers, never taken by a frame
+static pthread_mutex_t milky_presetPublishLock = PTHREAD_MUTEX_INITIALIZER;
+
+static int comparePropertyNames(const void *a, const void *b) {
+    return strcasecmp(((const PresetPropertyName *)a)->name, ((const PresetPropertyName *)b)->name);
+}
+
+static void buildSortedPropertyNames(void) {
+    size_t count = 0;
+    for (size_t i = 0; i < MILKY_PRESET_PROPERTY_COUNT; i++) {
+        milky_presetSortedNames[count].name = milky_presetWellKnownPropertyNames[i];
+        milky_presetSortedNames[count++].property = (PresetProperty)i;
     }
+    for (size_t i = 0; i < MILKY_PRESET_ALIAS_COUNT; i++) {
+        milky_presetSortedNames[count++] = milky_presetAliases[i];
+    }
+    qsort(milky_presetSortedNames, count, sizeof(PresetPropertyName), comparePropertyNames);
+}
+
+/**
+ * Resolves a property name (case-insensitive, Milkdrop aliases like cx / cy included)
+ * to its index. Meant to be called once at load or registration time, so the render
+ * path can read the values by index.
+ *
+ * @param propertyName The name of the property.
+ * @return             The property index, or -1 if the name is unknown.
+ */
+int resolvePresetProperty(const char *propertyName) {
+    if (!propertyName) return -1;
+    pthread_once(&milky_presetSortedNamesOnce, buildSortedPropertyNames);
+
+    PresetPropertyName key = { propertyName, MILKY_PRESET_DAMPING };
+    const PresetPropertyName *match = (const PresetPropertyName *)bsearch(&key, milky_presetSortedNames,
+        MILKY_PRESET_PROPERTY_COUNT + MILKY_PRESET_ALIAS_COUNT, sizeof(PresetPropertyName), comparePropertyNames);
+    return match ? (int)match->property : -1;
+}
+
+/**
+ * Returns the canonical name of a property.
+ *
+ * @param property The property.
+ * @return         Its name, or NULL for invalid indices.
+ */
+const char *getPresetPropertyName(PresetProperty property) {
+    return (unsigned)property < MILKY_PRESET_PROPERTY_COUNT ? milky_presetWellKnownPropertyNames[property] : NULL;
+}
+
+/**
+ * Takes a reference to the active presets. The snapshot stays valid (and unchanged by
+ * the hot reload) until releasePresetSnapshot(); never blocks.
+ *
+ * @return The active snapshot.
+ */
+const PresetSnapshot *acquirePresetSnapshot(void) {
+    const unsigned parity = __atomic_load_n(&milky_presetEpoch, __ATOMIC_SEQ_CST) & 1;
+    __atomic_add_fetch(&milky_presetReaders[parity], 1, __ATOMIC_SEQ_CST);
+    PresetSnapshot *snapshot = __atomic_load_n(&milky_presetActive, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&snapshot->references, 1, __ATOMIC_SEQ_CST);
+    __atomic_sub_fetch(&milky_presetReaders[parity], 1, __ATOMIC_SEQ_CST);
+    return snapshot;
 }
 
-Preset presets[MILKY_MAX_PRESETS];
-size_t presetCount = 0;
+/**
+ * Drops a reference taken by acquirePresetSnapshot(). The last one frees a replaced
+ * snapshot with its table or mapped cache (the storage snapshot is never freed).
+ *
+ * @param snapshot The snapshot (NULL is ignored).
+ */
+void releasePresetSnapshot(const PresetSnapshot *snapshot) {
+    PresetSnapshot *released = (PresetSnapshot *)snapshot;
+    if (!released || __atomic_sub_fetch(&released->references, 1, __ATOMIC_ACQ_REL) != 0) return;
+    if (released == &milky_presetStorageSnapshot) return;
+
+    if (released->mapping) munmap(released->mapping, released->mappingSize);
+    free(released->table);
+    free(released);
+}
+
+/**
+ * Moves a reference to the active presets if they were replaced since it was taken.
+ * Called at the start of every frame; costs one atomic load while nothing changed.
+ *
+ * @param snapshot The reference to update.
+ */
+void refreshPresetSnapshot(const PresetSnapshot **snapshot) {
+    if (*snapshot == __atomic_load_n(&milky_presetActive, __ATOMIC_ACQUIRE)) return;
+
+    const PresetSnapshot *active = acquirePresetSnapshot();
+    releasePresetSnapshot(*snapshot);
+    *snapshot = active;
+}
+
+/**
+ * Returns a preset of a snapshot.
+ *
+ * @param snapshot    The snapshot.
+ * @param presetIndex The index of the preset.
+ * @return            The preset, or NULL if the index is out of range.
+ */
+const Preset *getSnapshotPreset(const PresetSnapshot *snapshot, size_t presetIndex) {
+    return presetIndex < snapshot->count ? &snapshot->presets[presetIndex] : NULL;
+}
+
+/**
+ * Waits until no reader can still be about to take a reference to a snapshot that was
+ * just replaced. Readers are only counted for the few instructions of
+ * acquirePresetSnapshot(); the epoch is flipped before waiting for each parity, so
+ * readers that start meanwhile don't keep the publisher waiting.
+ */
+static void waitForPresetReaders(void) {
+    for (int phase = 0; phase < 2; phase++) {
+        const unsigned parity = __atomic_fetch_add(&milky_presetEpoch, 1, __ATOMIC_SEQ_CST) & 1;
+        while (__atomic_load_n(&milky_presetReaders[parity], __ATOMIC_SEQ_CST) != 0) {
+            sched_yield();
+        }
+    }
+}
+
+/**
+ * Makes a snapshot the active presets and drops the reference of the replaced one,
+ * which is freed once the last context moved past it.
+ *
+ * @param snapshot The new snapshot.
+ */
+static void replaceActivePresets(PresetSnapshot *snapshot) {
+    pthread_mutex_lock(&milky_presetPublishLock);
+    __atomic_add_fetch(&snapshot->references, 1, __ATOMIC_SEQ_CST);
+    PresetSnapshot *replaced = __atomic_exchange_n(&milky_presetActive, snapshot, __ATOMIC_SEQ_CST);
+    waitForPresetReaders();
+    releasePresetSnapshot(replaced);
+    pthread_mutex_unlock(&milky_presetPublishLock);
+}
+
+/**
+ * Wraps presets that aren't in the storage table into a new snapshot.
+ *
+ * @param presets     The presets.
+ * @param count       Number of presets.
+ * @param table       Table to free with the snapshot, or NULL.
+ * @param mapping     Mapped cache to unmap with the snapshot, or NULL.
+ * @param mappingSize Size of the mapping.
+ * @return            The snapshot (without references), or NULL if it can't be allocated.
+ */
+static PresetSnapshot *createPresetSnapshot(const Preset *presets, size_t count, PresetTable *table, void *mapping, size_t mappingSize) {
+    PresetSnapshot *snapshot = (PresetSnapshot *)malloc(sizeof(PresetSnapshot));
+    if (!snapshot) {
+        fprintf(stderr, "Failed to allocate a preset snapshot\n");
+        return NULL;
+    }
+    snapshot->presets = presets;
+    snapshot->count = count;
+    snapshot->references = 0;
+    snapshot->table = table;
+    snapshot->mapping = mapping;
+    snapshot->mappingSize = mappingSize;
+    return snapshot;
+}
+
+/**
+ * Makes the storage table the active one. Presets of a mapped cache or a published
+ * table are copied into it first, so files loaded afterwards are appended to them.
+ */
+static void activatePresetStorage(void) {
+    const PresetSnapshot *active = milky_presetActive;
+    if (active == &milky_presetStorageSnapshot) return;
+
+    memcpy(milky_presetStorage.presets, active->presets, active->count * sizeof(Preset));
+    milky_presetStorage.count = active->count;
+    milky_presetStorageSnapshot.count = active->count;
+    replaceActivePresets(&milky_presetStorageSnapshot);
+}
+
+/**
+ * Removes all presets (and releases a mapped cache).
+ */
+static void resetPresets(void) {
+    activatePresetStorage();
+    milky_presetStorage.count = 0;
+    milky_presetStorageSnapshot.count = 0;
+}
+
+/**
+ * Adds an empty preset to a table.
+ *
+ * @param table The table.
+ * @param name  Name of the preset.
+ * @return      The new preset, or NULL if the table is full.
+ */
+static Preset *addPreset(PresetTable *table, const char *name) {
+    if (table->count >= MILKY_MAX_PRESETS) {
+        fprintf(stderr, "Too many presets, ignoring '%s'.\n", name);
+        return NULL;
+    }
+
+    Preset *preset = &table->presets[table->count];
+    memset(preset, 0, sizeof(Preset));
+    preset->presetNumber = (int32_t)++table->count;
+    snprintf(preset->name, sizeof(preset->name), "%s", name);
+    return preset;
+}
 
 /**
  * Parses a flattened buffer into a global list of Presets with ordered property names.
- * 
+ *
  * @param buffer       Pointer to the buffer containing preset data.
  * @param bufferLength The length of the buffer.
  */
@@ -37,50 +258,549 @@ void parseFlattenedPresetBuffer(const float *buffer, size_t bufferLength) {
     // calculate the number of properties per preset
     size_t sectionSize = MILKY_MAX_PROPERTY_COUNT_PER_PRESET;
     // determine the number of presets based on buffer length
-    presetCount = bufferLength / sectionSize;
+    size_t count = bufferLength / sectionSize;
 
     // ensure the preset count does not exceed the maximum allowed
-    if (presetCount > MILKY_MAX_PRESETS) {
-        presetCount = MILKY_MAX_PRESETS;
+    if (count > MILKY_MAX_PRESETS) {
+        count = MILKY_MAX_PRESETS;
     }
 
-    // iterate over each preset to initialize and populate properties
-    for (size_t i = 0; i < presetCount; i++) {
-        // assign a unique preset number starting from 1
-        presets[i].presetNumber = (int) i + 1;
+    resetPresets();
+
+    // iterate over each preset to populate its properties (only the ones a section carries
+    // are defined, so legacy buffers keep the classic motion instead of the warp mesh)
+    for (size_t i = 0; i < count; i++) {
+        char name[MILKY_PRESET_NAME_LENGTH];
+        snprintf(name, sizeof(name), "preset%02zu", i);
+
+        Preset *preset = addPreset(&milky_presetStorage, name);
+        if (!preset) break;
+        memcpy(preset->values, buffer + (i * sectionSize), MILKY_PRESET_FLATTENED_PROPERTY_COUNT * sizeof(float));
+        preset->definedMask = (1ULL << MILKY_PRESET_FLATTENED_PROPERTY_COUNT) - 1;
+    }
+    milky_presetStorageSnapshot.count = milky_presetStorage.count;
+}
+
+/**
+ * Returns the number of loaded presets. Frames read the snapshot of their context
+ * instead (see acquirePresetSnapshot()).
+ */
+size_t getPresetCount(void) {
+    return __atomic_load_n(&milky_presetActive, __ATOMIC_ACQUIRE)->count;
+}
+
+/**
+ * Returns a loaded preset. The pointer stays valid until the presets are replaced;
+ * frames read the snapshot of their context instead.
+ *
+ * @param presetIndex The index of the preset.
+ * @return            The preset, or NULL if the index is out of range.
+ */
+const Preset *getPreset(size_t presetIndex) {
+    return getSnapshotPreset(__atomic_load_n(&milky_presetActive, __ATOMIC_ACQUIRE), presetIndex);
+}
+
+/**
+ * Reads a property of a preset by index (O(1), doesn't log, safe to call every frame).
+ *
+ * @param presetIndex  The index of the preset.
+ * @param property     The property.
+ * @param defaultValue The value to return if the preset doesn't exist or doesn't define the property.
+ * @return             The value of the property, or defaultValue.
+ */
+float getPresetValue(size_t presetIndex, PresetProperty property, float defaultValue) {
+    const Preset *preset = getPreset(presetIndex);
+    return preset ? getPresetRecordValue(preset, property, defaultValue) : defaultValue;
+}
+
+/**
+ * Reads a property of a preset record (for example a blended one, see blendPresets()).
+ *
+ * @param preset       The preset (NULL = built-in defaults).
+ * @param property     The property.
+ * @param defaultValue The value to return if the preset doesn't define the property.
+ * @return             The value of the property, or defaultValue.
+ */
+float getPresetRecordValue(const Preset *preset, PresetProperty property, float defaultValue) {
+    if (!preset || (unsigned)property >= MILKY_PRESET_PROPERTY_COUNT) return defaultValue;
+    return (preset->definedMask >> property) & 1 ? preset->values[property] : defaultValue;
+}
+
+/**
+ * Interpolates the properties of two presets. Continuous properties defined by both
+ * are blended linearly; switches and ids (effect_*, mode, wave, palette ids, ...)
+ * and properties only one of them defines switch over at the halfway point.
+ *
+ * @param from    The preset at weight 0 (NULL = built-in defaults).
+ * @param to      The preset at weight 1 (NULL = built-in defaults).
+ * @param weight  Position of the blend in [0, 1].
+ * @param blended Receives the blended preset (named and numbered like the nearer one).
+ */
+void blendPresets(const Preset *from, const Preset *to, float weight, Preset *blended) {
+    static const Preset defaults;
+    if (!from) from = &defaults;
+    if (!to) to = &defaults;
+    if (weight < 0.0f) weight = 0.0f;
+    if (weight > 1.0f) weight = 1.0f;
 
-        // initialize property names for the current preset
-        initializePresetPropertyNames(&presets[i]);
+    const Preset *nearer = weight < 0.5f ? from : to;
+    const uint64_t both = from->definedMask & to->definedMask;
 
-        // copy properties from the buffer into the current preset
-        memcpy(presets[i].properties, buffer + (i * sectionSize), sectionSize * sizeof(float));
+    *blended = *nearer;
+    for (size_t i = 0; i < MILKY_PRESET_PROPERTY_COUNT; i++) {
+        if ((both >> i) & 1 && !((MILKY_PRESET_DISCRETE_MASK >> i) & 1)) {
+            blended->values[i] = from->values[i] + (to->values[i] - from->values[i]) * weight;
+        }
     }
 }
 
 /**
  * Retrieves a property value by name for a specific preset.
- * 
+ *
  * @param presetIndex  The index of the preset.
  * @param propertyName The name of the property to retrieve.
  * @return             The value of the property, or 0.0f if not found.
  */
 float getPresetPropertyByName(size_t presetIndex, const char *propertyName) {
-    // check if the preset index is within the valid range
-    if (presetIndex >= presetCount) {
-        printf("Preset index out of range.\n");
-        return 0.0f; // return default value if index is invalid
-    }
-
-    // search for the property name within the preset's properties
-    for (size_t i = 0; i < MILKY_MAX_PROPERTY_COUNT_PER_PRESET; i++) {
-        // compare the current property name with the target name
-        if (strcmp(presets[presetIndex].propertyNames[i], propertyName) == 0) {
-            // return the property value if a match is found
-            return presets[presetIndex].properties[i];
+    return getPresetPropertyOrDefault(presetIndex, propertyName, 0.0f);
+}
+
+/**
+ * Retrieves a property value by name for a specific preset, falling back to a default
+ * when no such preset has been loaded or the preset doesn't define the property.
+ * Resolves the name on every call; hot paths should resolve it once with
+ * resolvePresetProperty() and use getPresetValue().
+ *
+ * @param presetIndex  The index of the preset.
+ * @param propertyName The name of the property to retrieve.
+ * @param defaultValue The value to return if the property isn't available.
+ * @return             The value of the property, or defaultValue if not found.
+ */
+float getPresetPropertyOrDefault(size_t presetIndex, const char *propertyName, float defaultValue) {
+    int property = resolvePresetProperty(propertyName);
+    return property < 0 ? defaultValue : getPresetValue(presetIndex, (PresetProperty)property, defaultValue);
+}
+
+/**
+ * Removes leading and trailing whitespace in place.
+ */
+static char *trim(char *text) {
+    while (*text == ' ' || *text == '\t') text++;
+    size_t length = strlen(text);
+    while (length > 0 && (text[length - 1] == ' ' || text[length - 1] == '\t' || text[length - 1] == '\r' || text[length - 1] == '\n')) {
+        text[--length] = '\0';
+    }
+    return text;
+}
+
+/**
+ * Returns the file name of a path without directory and extension.
+ */
+static void getBaseName(const char *path, char *name, size_t nameSize) {
+    const char *slash = strrchr(path, '/');
+    snprintf(name, nameSize, "%s", slash ? slash + 1 : path);
+    char *dot = strrchr(name, '.');
+    if (dot && dot != name) *dot = '\0';
+}
+
+/**
+ * Checks whether a key names a numbered equation line ("per_frame_12") of a kind.
+ */
+static int isPresetCodeKey(const char *key, const char *prefix) {
+    size_t length = strlen(prefix);
+    if (strncasecmp(key, prefix, length) != 0 || key[length] == '\0') return 0;
+    for (key += length; *key; key++) {
+        if (*key < '0' || *key > '9') return 0;
+    }
+    return 1;
+}
+
+/**
+ * Appends one line of equations to the code of a preset.
+ *
+ * @return 1 on success, 0 if the code would get too long.
+ */
+static int appendPresetCode(char *code, const char *line) {
+    size_t used = strlen(code), length = strlen(line);
+    if (used + length + 2 > MILKY_PRESET_CODE_LENGTH) return 0;
+    if (used > 0) code[used++] = '\n';
+    memcpy(code + used, line, length + 1);
+    return 1;
+}
+
+/**
+ * Parses a preset file in the INI style of Milkdrop's .milk files:
+ *
+ *     [preset00]
+ *     effect_grid=1
+ *     x_center=0.5   ; comments start with ';', '#' or '//'
+ *
+ * Every [section] starts a new preset named after the section (Milkdrop's generic
+ * [preset00] and lines before the first section use the file name). Property names
+ * are resolved once here; unknown keys are skipped. The per-frame equations
+ * (per_frame_N) and per-vertex equations (per_pixel_N / per_vertex_N) are kept as
+ * source, one line each in the order of the file, and compiled by the renderer.
+ * Values of known properties must be finite numbers, invalid ones are reported and
+ * ignored. Doesn't touch the active presets, so it can run on any thread.
+ *
+ * @param path  Path of the preset file.
+ * @param table The table to append the presets to.
+ * @return      Number of presets loaded from the file, -1 if it can't be read.
+ */
+int parsePresetFile(const char *path, PresetTable *table) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Failed to open preset file: %s\n", path);
+        return -1;
+    }
+
+    char baseName[MILKY_PRESET_NAME_LENGTH];
+    getBaseName(path, baseName, sizeof(baseName));
+
+    char line[MILKY_PRESET_MAX_LINE];
+    Preset *preset = NULL;
+    int loaded = 0, lineNumber = 0;
+
+    while (fgets(line, sizeof(line), file)) {
+        lineNumber++;
+        char *text = trim(line);
+        if (*text == '\0' || *text == ';' || *text == '#' || (text[0] == '/' && text[1] == '/')) continue;
+
+        if (*text == '[') {
+            char *end = strchr(text, ']');
+            if (!end) {
+                fprintf(stderr, "%s:%d: unterminated section header\n", path, lineNumber);
+                continue;
+            }
+            *end = '\0';
+            const char *section = trim(text + 1);
+            preset = addPreset(table, strncasecmp(section, "preset", 6) == 0 || *section == '\0' ? baseName : section);
+            if (preset) loaded++;
+            continue;
+        }
+
+        char *equals = strchr(text, '=');
+        if (!equals) {
+            fprintf(stderr, "%s:%d: expected key=value\n", path, lineNumber);
+            continue;
+        }
+        *equals = '\0';
+        char *key = trim(text);
+        char *value = trim(equals + 1);
+
+        int perFrame = isPresetCodeKey(key, "per_frame_");
+        if (perFrame || isPresetCodeKey(key, "per_pixel_") || isPresetCodeKey(key, "per_vertex_")) {
+            if (!preset) {
+                preset = addPreset(table, baseName);
+                if (!preset) break;
+                loaded++;
+            }
+            if (!appendPresetCode(perFrame ? preset->perFrameCode : preset->perVertexCode, value)) {
+                fprintf(stderr, "%s:%d: equations of '%s' too long, ignoring %s\n", path, lineNumber, preset->name, key);
+            }
+            continue;
+        }
+
+        int property = resolvePresetProperty(key);
+        if (property < 0) continue;
+
+        char *end = NULL;
+        float number = strtof(value, &end);
+        end = end ? trim(end) : NULL;
+        if (end == value || (end && *end != '\0' && *end != ';' && *end != '#') || !isfinite(number)) {
+            fprintf(stderr, "%s:%d: invalid value '%s' for %s\n", path, lineNumber, value, key);
+            continue;
+        }
+
+        // properties before the first section belong to a preset named after the file
+        if (!preset) {
+            preset = addPreset(table, baseName);
+            if (!preset) break;
+            loaded++;
+        }
+        preset->values[property] = number;
+        preset->definedMask |= 1ULL << property;
+    }
+
+    fclose(file);
+    return loaded;
+}
+
+/**
+ * Appends the presets of a file to the loaded presets (see parsePresetFile()).
+ *
+ * @param path Path of the preset file.
+ * @return     Number of presets loaded from the file, -1 if it can't be read.
+ */
+int loadPresetFile(const char *path) {
+    activatePresetStorage();
+    int loaded = parsePresetFile(path, &milky_presetStorage);
+    milky_presetStorageSnapshot.count = milky_presetStorage.count;
+    return loaded;
+}
+
+/**
+ * Checks whether a file name is one of a preset file (*.milk, *.ini, not hidden).
+ *
+ * @param name The file name.
+ * @return     1 for preset files, 0 otherwise.
+ */
+int isPresetFileName(const char *name) {
+    const char *dot = strrchr(name, '.');
+    return name[0] != '.' && dot && (strcasecmp(dot, ".milk") == 0 || strcasecmp(dot, ".ini") == 0);
+}
+
+static int compareFileNames(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+/**
+ * Lists the preset files (*.milk, *.ini) of a directory, sorted by name.
+ *
+ * @param directory The directory.
+ * @param count     Receives the number of files.
+ * @return          Array of file names (free each and the array), NULL if the directory can't be read.
+ */
+char **listPresetFiles(const char *directory, size_t *count) {
+    DIR *dir = opendir(directory);
+    *count = 0;
+    if (!dir) {
+        fprintf(stderr, "Failed to open preset directory: %s\n", directory);
+        return NULL;
+    }
+
+    char **names = NULL;
+    size_t capacity = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (!isPresetFileName(entry->d_name)) continue;
+        if (*count == capacity) {
+            size_t grown = capacity ? capacity * 2 : 64;
+            char **resized = (char **)realloc(names, grown * sizeof(char *));
+            if (!resized) break;
+            names = resized;
+            capacity = grown;
         }
+        names[*count] = strdup(entry->d_name);
+        if (names[*count]) (*count)++;
+    }
+    closedir(dir);
+
+    if (names) qsort(names, *count, sizeof(char *), compareFileNames);
+    return names ? names : (char **)calloc(1, sizeof(char *));
+}
+
+/**
+ * Frees a list returned by listPresetFiles().
+ */
+void freePresetFiles(char **names, size_t count) {
+    for (size_t i = 0; i < count; i++) free(names[i]);
+    free(names);
+}
+
+/**
+ * Appends the listed preset files of a directory to a table.
+ */
+static void parsePresetFiles(const char *directory, char **names, size_t count, PresetTable *table) {
+    char path[4096];
+    for (size_t i = 0; i < count; i++) {
+        snprintf(path, sizeof(path), "%s/%s", directory, names[i]);
+        parsePresetFile(path, table);
+    }
+}
+
+/**
+ * Replaces the loaded presets with all preset files (*.milk, *.ini) of a directory,
+ * in file name order. Only call it while no frame renders (see reloadPresetDirectory()).
+ *
+ * @param directory The directory.
+ * @return          Number of presets loaded.
+ */
+size_t loadPresetDirectory(const char *directory) {
+    size_t count = 0;
+    char **names = listPresetFiles(directory, &count);
+    if (!names) return 0;
+
+    resetPresets();
+    parsePresetFiles(directory, names, count, &milky_presetStorage);
+    milky_presetStorageSnapshot.count = milky_presetStorage.count;
+
+    freePresetFiles(names, count);
+    return milky_presetStorage.count;
+}
+
+/**
+ * Replaces the loaded presets with the preset files of a directory like
+ * loadPresetDirectory(), but safe while other threads render: the files are parsed
+ * into a new table, which is published (see publishPresetTable()).
+ *
+ * @param directory The directory.
+ * @return          Number of presets loaded (0 keeps the old presets if the directory can't be read).
+ */
+size_t reloadPresetDirectory(const char *directory) {
+    size_t count = 0;
+    char **names = listPresetFiles(directory, &count);
+    if (!names) return 0;
+
+    PresetTable *table = (PresetTable *)malloc(sizeof(PresetTable));
+    if (!table) {
+        fprintf(stderr, "Failed to allocate the presets of %s\n", directory);
+        freePresetFiles(names, count);
+        return 0;
+    }
+    table->count = 0;
+    parsePresetFiles(directory, names, count, table);
+    freePresetFiles(names, count);
+
+    const size_t loaded = table->count;
+    publishPresetTable(table);
+    return loaded;
+}
+
+/**
+ * Writes the loaded presets to a binary cache that mapPresetCache() can map
+ * without any parsing.
+ *
+ * @param path Path of the cache file (written to a temporary file and renamed).
+ * @return     1 on success, 0 on failure.
+ */
+int writePresetCache(const char *path) {
+    char temporaryPath[4096];
+    snprintf(temporaryPath, sizeof(temporaryPath), "%s.tmp", path);
+
+    FILE *file = fopen(temporaryPath, "wb");
+    if (!file) {
+        fprintf(stderr, "Failed to write preset cache: %s\n", path);
+        return 0;
+    }
+
+    PresetCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "MILKYPRE", sizeof(header.magic));
+    header.version = MILKY_PRESET_CACHE_VERSION;
+    header.propertyCount = MILKY_PRESET_PROPERTY_COUNT;
+    header.recordSize = sizeof(Preset);
+    const PresetSnapshot *active = milky_presetActive;
+    header.presetCount = (uint32_t)active->count;
+
+    int success = fwrite(&header, sizeof(header), 1, file) == 1
+        && fwrite(active->presets, sizeof(Preset), active->count, file) == active->count;
+    success = (fclose(file) == 0) && success;
+
+    if (!success || rename(temporaryPath, path) != 0) {
+        fprintf(stderr, "Failed to write preset cache: %s\n", path);
+        remove(temporaryPath);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * Replaces the loaded presets with a binary cache written by writePresetCache().
+ * The file is mapped read-only and used in place.
+ *
+ * @param path Path of the cache file.
+ * @return     1 on success, 0 if the file is missing, from another version or damaged.
+ */
+int mapPresetCache(const char *path) {
+    int descriptor = open(path, O_RDONLY);
+    if (descriptor < 0) return 0;
+
+    struct stat info;
+    if (fstat(descriptor, &info) != 0 || (size_t)info.st_size < sizeof(PresetCacheHeader)) {
+        close(descriptor);
+        return 0;
+    }
+
+    size_t size = (size_t)info.st_size;
+    void *mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    close(descriptor);
+    if (mapping == MAP_FAILED) return 0;
+
+    const PresetCacheHeader *header = (const PresetCacheHeader *)mapping;
+    if (memcmp(header->magic, "MILKYPRE", sizeof(header->magic)) != 0
+        || header->version != MILKY_PRESET_CACHE_VERSION
+        || header->propertyCount != MILKY_PRESET_PROPERTY_COUNT
+        || header->recordSize != sizeof(Preset)
+        || header->presetCount > MILKY_MAX_PRESETS
+        || sizeof(PresetCacheHeader) + (size_t)header->presetCount * sizeof(Preset) > size) {
+        munmap(mapping, size);
+        return 0;
     }
 
-    // notify if the property name is not found and return default value
-    printf("Property name '%s' not found in preset %zu.\n", propertyName, presetIndex + 1);
-    return 0.0f;
+    const Preset *presets = (const Preset *)((const uint8_t *)mapping + sizeof(PresetCacheHeader));
+    PresetSnapshot *snapshot = createPresetSnapshot(presets, header->presetCount, NULL, mapping, size);
+    if (!snapshot) {
+        munmap(mapping, size);
+        return 0;
+    }
+    replaceActivePresets(snapshot);
+    return 1;
+}
+
+/**
+ * Checks whether a file was modified after another one (with the nanoseconds of the
+ * timestamps, so an edit within the second the cache was written still counts).
+ */
+static int isModifiedAfter(const struct stat *info, const struct stat *reference) {
+    if (info->st_mtim.tv_sec != reference->st_mtim.tv_sec) return info->st_mtim.tv_sec > reference->st_mtim.tv_sec;
+    return info->st_mtim.tv_nsec > reference->st_mtim.tv_nsec;
+}
+
+/**
+ * Checks whether a cache file is at least as new as a directory and all of its preset files.
+ */
+static int isPresetCacheFresh(const char *directory, const char *cachePath) {
+    struct stat cacheInfo, info;
+    if (stat(cachePath, &cacheInfo) != 0 || stat(directory, &info) != 0) return 0;
+    if (isModifiedAfter(&info, &cacheInfo)) return 0; // files added, removed or renamed
+
+    size_t count = 0;
+    char **names = listPresetFiles(directory, &count);
+    if (!names) return 0;
+
+    int fresh = 1;
+    char path[4096];
+    for (size_t i = 0; i < count && fresh; i++) {
+        snprintf(path, sizeof(path), "%s/%s", directory, names[i]);
+        fresh = stat(path, &info) == 0 && !isModifiedAfter(&info, &cacheInfo);
+    }
+    freePresetFiles(names, count);
+    return fresh;
+}
+
+/**
+ * Loads a preset directory through a binary cache: if the cache is newer than the
+ * directory and all of its preset files, it's mapped; otherwise the directory is
+ * parsed and the cache rewritten (failing to write it isn't fatal).
+ *
+ * @param directory The preset directory.
+ * @param cachePath Path of the binary cache.
+ * @return          Number of presets loaded.
+ */
+size_t loadPresetDirectoryCached(const char *directory, const char *cachePath) {
+    if (isPresetCacheFresh(directory, cachePath) && mapPresetCache(cachePath)) {
+        return getPresetCount();
+    }
+
+    size_t count = loadPresetDirectory(directory);
+    if (count > 0) writePresetCache(cachePath);
+    return count;
+}
+
+/**
+ * Hands a complete preset table to the renderers (RCU style): it becomes the active
+ * presets at once, every context switches to it at the start of its next frame
+ * (see refreshPresetSnapshot()) and the replaced presets are freed when the last
+ * context moved past them. Never waits for a frame; can be called from any thread.
+ *
+ * @param table The new presets (allocated with malloc(), ownership is taken).
+ */
+void publishPresetTable(PresetTable *table) {
+    PresetSnapshot *snapshot = createPresetSnapshot(table->presets, table->count, table, NULL, 0);
+    if (!snapshot) {
+        free(table);
+        return;
+    }
+    replaceActivePresets(snapshot);
 }
@@ -4,12 +4,149 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <string.h>
+#include <strings.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#include <sched.h>
 
 #define MILKY_MAX_PRESETS 100
 #define MILKY_MAX_PROPERTY_COUNT_PER_PRESET 64
+#define MILKY_PRESET_NAME_LENGTH 64         // longest preset name (including the terminator)
+#define MILKY_PRESET_MAX_LINE 1024          // longest line read from a preset file
+#define MILKY_PRESET_CODE_LENGTH 2048       // longest per-frame / per-vertex equations of a preset (including the terminator)
+#define MILKY_PRESET_CACHE_VERSION 4        // bump when the layout of Preset changes
+
+// well-known preset properties, in the order of the flattened preset buffer
+// (new properties must be appended at the end: flattened buffers and the binary cache are indexed by it)
+typedef enum {
+    MILKY_PRESET_DAMPING = 0,
+    MILKY_PRESET_EFFECT_BAR,
+    MILKY_PRESET_EFFECT_CHASERS,
+    MILKY_PRESET_EFFECT_DOTS,
+    MILKY_PRESET_EFFECT_GRID,
+    MILKY_PRESET_EFFECT_NUCLIDE,
+    MILKY_PRESET_EFFECT_SHADEBOBS,
+    MILKY_PRESET_EFFECT_SOLAR,
+    MILKY_PRESET_EFFECT_SPECTRAL,
+    MILKY_PRESET_F1,
+    MILKY_PRESET_F2,
+    MILKY_PRESET_F3,
+    MILKY_PRESET_F4,
+    MILKY_PRESET_GAMMA,
+    MILKY_PRESET_MAGIC,
+    MILKY_PRESET_MODE,
+    MILKY_PRESET_PAL_BFX,
+    MILKY_PRESET_PAL_CURVE_ID_1,
+    MILKY_PRESET_PAL_CURVE_ID_2,
+    MILKY_PRESET_PAL_CURVE_ID_3,
+    MILKY_PRESET_PAL_FXPALNUM,
+    MILKY_PRESET_PAL_HI_OBAND,
+    MILKY_PRESET_PAL_LO_BAND,
+    MILKY_PRESET_S1,
+    MILKY_PRESET_S2,
+    MILKY_PRESET_SHIFT,
+    MILKY_PRESET_SPECTRUM,
+    MILKY_PRESET_T1,
+    MILKY_PRESET_T2,
+    MILKY_PRESET_VOLPOS,
+    MILKY_PRESET_WAVE,
+    MILKY_PRESET_X_CENTER,
+    MILKY_PRESET_Y_CENTER,
+    MILKY_PRESET_ZOOM,          // per-vertex motion of the warp mesh (see warp.h)
+    MILKY_PRESET_ZOOM_EXPONENT,
+    MILKY_PRESET_ROTATION,
+    MILKY_PRESET_WARP,
+    MILKY_PRESET_WARP_SPEED,
+    MILKY_PRESET_WARP_SCALE,
+    MILKY_PRESET_DX,
+    MILKY_PRESET_DY,
+    MILKY_PRESET_SX,
+    MILKY_PRESET_SY,
+    MILKY_PRESET_DISPLACEMENT_MAP, // > 0 bakes the static motion into a per-pixel table (see displace.h)
+    MILKY_PRESET_PROPERTY_COUNT
+} PresetProperty;
+
+// properties a section of a flattened preset buffer carries (the ones before the warp
+// mesh; the rest of the section is padding)
+#define MILKY_PRESET_FLATTENED_PROPERTY_COUNT MILKY_PRESET_ZOOM
+
+// properties that are switches or ids, which can't be interpolated
+#define MILKY_PRESET_DISCRETE_MASK ( \
+    (1ULL << MILKY_PRESET_EFFECT_BAR) | (1ULL << MILKY_PRESET_EFFECT_CHASERS) | (1ULL << MILKY_PRESET_EFFECT_DOTS) | \
+    (1ULL << MILKY_PRESET_EFFECT_GRID) | (1ULL << MILKY_PRESET_EFFECT_NUCLIDE) | (1ULL << MILKY_PRESET_EFFECT_SHADEBOBS) | \
+    (1ULL << MILKY_PRESET_EFFECT_SOLAR) | (1ULL << MILKY_PRESET_EFFECT_SPECTRAL) | (1ULL << MILKY_PRESET_MODE) | \
+    (1ULL << MILKY_PRESET_PAL_BFX) | (1ULL << MILKY_PRESET_PAL_CURVE_ID_1) | (1ULL << MILKY_PRESET_PAL_CURVE_ID_2) | \
+    (1ULL << MILKY_PRESET_PAL_CURVE_ID_3) | (1ULL << MILKY_PRESET_PAL_FXPALNUM) | (1ULL << MILKY_PRESET_SPECTRUM) | \
+    (1ULL << MILKY_PRESET_WAVE) | (1ULL << MILKY_PRESET_DISPLACEMENT_MAP))
+
+// a preset with its properties resolved to a flat array (also the record of the binary cache)
+typedef struct {
+    int32_t presetNumber;                     // 1-based number in loading order
+    uint32_t reserved;                        // keeps the record 8-byte aligned in the cache
+    uint64_t definedMask;                     // bit n is set if the preset defines property n
+    char name[MILKY_PRESET_NAME_LENGTH];      // file (or section) name of the preset
+    float values[MILKY_PRESET_PROPERTY_COUNT];
+    char perFrameCode[MILKY_PRESET_CODE_LENGTH];  // per_frame_N equations, one per line (see expr.h)
+    char perVertexCode[MILKY_PRESET_CODE_LENGTH]; // per_pixel_N / per_vertex_N equations, one per line
+} Preset;
+
+// a complete set of presets (the unit the hot reload swaps in, see publishPresetTable())
+typedef struct {
+    size_t count;
+    Preset presets[MILKY_MAX_PRESETS];
+} PresetTable;
+
+// presets frames read from: the storage table, a mapped cache or a published table,
+// freed with it by the last holder once replaced (see acquirePresetSnapshot())
+typedef struct {
+    const Preset *presets;
+    size_t count;
+    int references;     // the active slot and every context holding it (accessed atomically)
+    PresetTable *table; // freed with the snapshot, or NULL
+    void *mapping;      // mapped cache unmapped with the snapshot, or NULL
+    size_t mappingSize;
+} PresetSnapshot;
+
+// header of the memory-mappable binary cache (followed by presetCount Preset records)
+typedef struct {
+    char magic[8];          // "MILKYPRE"
+    uint32_t version;       // MILKY_PRESET_CACHE_VERSION
+    uint32_t propertyCount; // MILKY_PRESET_PROPERTY_COUNT
+    uint32_t recordSize;    // sizeof(Preset)
+    uint32_t presetCount;   // number of records
+} PresetCacheHeader;
 
 void parseFlattenedPresetBuffer(const float *buffer, size_t bufferLength);
+int resolvePresetProperty(const char *propertyName);
+const char *getPresetPropertyName(PresetProperty property);
+size_t getPresetCount(void);
+const Preset *getPreset(size_t presetIndex);
+float getPresetValue(size_t presetIndex, PresetProperty property, float defaultValue);
+float getPresetRecordValue(const Preset *preset, PresetProperty property, float defaultValue);
+void blendPresets(const Preset *from, const Preset *to, float weight, Preset *blended);
 float getPresetPropertyByName(size_t presetIndex, const char *propertyName);
+float getPresetPropertyOrDefault(size_t presetIndex, const char *propertyName, float defaultValue);
+int isPresetFileName(const char *name);
+char **listPresetFiles(const char *directory, size_t *count);
+void freePresetFiles(char **names, size_t count);
+int parsePresetFile(const char *path, PresetTable *table);
+int loadPresetFile(const char *path);
+size_t loadPresetDirectory(const char *directory);
+size_t reloadPresetDirectory(const char *directory);
+int writePresetCache(const char *path);
+int mapPresetCache(const char *path);
+size_t loadPresetDirectoryCached(const char *directory, const char *cachePath);
+void publishPresetTable(PresetTable *table);
+const PresetSnapshot *acquirePresetSnapshot(void);
+void releasePresetSnapshot(const PresetSnapshot *snapshot);
+void refreshPresetSnapshot(const PresetSnapshot **snapshot);
+const Preset *getSnapshotPreset(const PresetSnapshot *snapshot, size_t presetIndex);
 
 #endif // PRESET_H
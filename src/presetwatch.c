@@ -0,0 +1,261 @@
+#include "presetwatch.h"
+
+// state of the watcher thread (the file list is only touched by the thread itself)
+static pthread_t milky_presetWatchThread;
+static int milky_presetWatchRunning = 0; // accessed atomically
+static int milky_presetWatchDescriptor = -1;
+static char milky_presetWatchDirectory[MILKY_PRESET_WATCH_MAX_PATH];
+static PresetWatchFile *milky_presetWatchFiles = NULL; // sorted by file name, like loadPresetDirectory()
+static size_t milky_presetWatchFileCount = 0;
+static PresetTable *milky_presetWatchScratch = NULL;   // parse buffer for a single file
+
+static int compareWatchFiles(const void *a, const void *b) {
+    return strcmp(((const PresetWatchFile *)a)->fileName, ((const PresetWatchFile *)b)->fileName);
+}
+
+static PresetWatchFile *findWatchFile(const char *fileName) {
+    if (milky_presetWatchFileCount == 0) return NULL;
+
+    PresetWatchFile key = { (char *)fileName, NULL, 0 };
+    return (PresetWatchFile *)bsearch(&key, milky_presetWatchFiles, milky_presetWatchFileCount,
+        sizeof(PresetWatchFile), compareWatchFiles);
+}
+
+/**
+ * Forgets the presets of a file (deleted or moved away).
+ *
+ * @param fileName Name of the file inside the watched directory.
+ * @return         1 if the file was known, 0 otherwise.
+ */
+static int removeWatchFile(const char *fileName) {
+    PresetWatchFile *file = findWatchFile(fileName);
+    if (!file) return 0;
+
+    free(file->fileName);
+    free(file->presets);
+    size_t index = (size_t)(file - milky_presetWatchFiles);
+    memmove(file, file + 1, (milky_presetWatchFileCount - index - 1) * sizeof(PresetWatchFile));
+    milky_presetWatchFileCount--;
+    return 1;
+}
+
+static void clearWatchFiles(void) {
+    for (size_t i = 0; i < milky_presetWatchFileCount; i++) {
+        free(milky_presetWatchFiles[i].fileName);
+        free(milky_presetWatchFiles[i].presets);
+    }
+    free(milky_presetWatchFiles);
+    milky_presetWatchFiles = NULL;
+    milky_presetWatchFileCount = 0;
+}
+
+/**
+ * (Re)parses one file of the watched directory. Only this file is read, the
+ * presets of all other files are kept as they are.
+ *
+ * @param fileName Name of the file inside the watched directory.
+ * @return         1 if the presets changed, 0 otherwise.
+ */
+static int updateWatchFile(const char *fileName) {
+    char path[MILKY_PRESET_WATCH_MAX_PATH * 2];
+    snprintf(path, sizeof(path), "%s/%s", milky_presetWatchDirectory, fileName);
+
+    milky_presetWatchScratch->count = 0;
+    if (parsePresetFile(path, milky_presetWatchScratch) < 0) {
+        return removeWatchFile(fileName); // gone again or unreadable
+    }
+
+    size_t count = milky_presetWatchScratch->count;
+    Preset *presets = NULL;
+    if (count > 0) {
+        presets = (Preset *)malloc(count * sizeof(Preset));
+        if (!presets) {
+            fprintf(stderr, "Failed to allocate presets of %s\n", path);
+            return 0;
+        }
+        memcpy(presets, milky_presetWatchScratch->presets, count * sizeof(Preset));
+    }
+
+    PresetWatchFile *file = findWatchFile(fileName);
+    if (file) {
+        free(file->presets);
+        file->presets = presets;
+        file->count = count;
+        return 1;
+    }
+
+    char *name = strdup(fileName);
+    PresetWatchFile *files = (PresetWatchFile *)realloc(milky_presetWatchFiles,
+        (milky_presetWatchFileCount + 1) * sizeof(PresetWatchFile));
+    if (!name || !files) {
+        fprintf(stderr, "Failed to track preset file %s\n", path);
+        free(name);
+        free(presets);
+        if (files) milky_presetWatchFiles = files;
+        return 0;
+    }
+
+    milky_presetWatchFiles = files;
+    files[milky_presetWatchFileCount].fileName = name;
+    files[milky_presetWatchFileCount].presets = presets;
+    files[milky_presetWatchFileCount].count = count;
+    milky_presetWatchFileCount++;
+    qsort(milky_presetWatchFiles, milky_presetWatchFileCount, sizeof(PresetWatchFile), compareWatchFiles);
+    return 1;
+}
+
+/**
+ * Parses all preset files of the watched directory (at startup and after an event
+ * queue overflow, when single changes can't be tracked anymore).
+ */
+static void scanWatchedDirectory(void) {
+    size_t count = 0;
+    char **names = listPresetFiles(milky_presetWatchDirectory, &count);
+
+    clearWatchFiles();
+    for (size_t i = 0; i < count; i++) {
+        updateWatchFile(names[i]);
+    }
+    freePresetFiles(names, count);
+}
+
+/**
+ * Concatenates the presets of all files into a new table and hands it to the
+ * renderers, which switch to it at the start of their next frame (see publishPresetTable()).
+ */
+static void publishWatchedPresets(void) {
+    PresetTable *table = (PresetTable *)malloc(sizeof(PresetTable));
+    if (!table) {
+        fprintf(stderr, "Failed to allocate the reloaded presets\n");
+        return;
+    }
+
+    table->count = 0;
+    for (size_t i = 0; i < milky_presetWatchFileCount; i++) {
+        const PresetWatchFile *file = &milky_presetWatchFiles[i];
+        for (size_t j = 0; j < file->count; j++) {
+            if (table->count >= MILKY_MAX_PRESETS) {
+                fprintf(stderr, "Too many presets, ignoring '%s'.\n", file->presets[j].name);
+                continue;
+            }
+            table->presets[table->count] = file->presets[j];
+            table->presets[table->count].presetNumber = (int32_t)(table->count + 1);
+            table->count++;
+        }
+    }
+
+    publishPresetTable(table);
+    printf("Reloaded %zu presets from %s\n", table->count, milky_presetWatchDirectory);
+}
+
+/**
+ * Reads all pending inotify events and republishes the presets if a preset file
+ * was written, moved in, moved away or deleted.
+ */
+static void handleWatchEvents(void) {
+    char buffer[MILKY_PRESET_WATCH_EVENT_BUFFER] __attribute__((aligned(__alignof__(struct inotify_event))));
+    int changed = 0;
+    ssize_t length;
+
+    while ((length = read(milky_presetWatchDescriptor, buffer, sizeof(buffer))) > 0) {
+        const struct inotify_event *event;
+        for (char *position = buffer; position < buffer + length; position += sizeof(struct inotify_event) + event->len) {
+            event = (const struct inotify_event *)position;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                scanWatchedDirectory();
+                changed = 1;
+                continue;
+            }
+            if (event->len == 0 || !isPresetFileName(event->name)) continue;
+
+            if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                changed |= updateWatchFile(event->name);
+            } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                changed |= removeWatchFile(event->name);
+            }
+        }
+    }
+
+    if (changed) publishWatchedPresets();
+}
+
+static void *runPresetWatcher(void *argument) {
+    (void)argument;
+
+    // the directory was loaded (or mapped from the cache) before, so only the
+    // watcher's own view of the files is built here; nothing is published yet
+    scanWatchedDirectory();
+
+    struct pollfd descriptor = { milky_presetWatchDescriptor, POLLIN, 0 };
+    while (__atomic_load_n(&milky_presetWatchRunning, __ATOMIC_ACQUIRE)) {
+        int ready = poll(&descriptor, 1, MILKY_PRESET_WATCH_POLL_MS);
+        if (ready < 0 && errno != EINTR) {
+            fprintf(stderr, "Failed to watch preset directory: %s\n", strerror(errno));
+            break;
+        }
+        if (ready > 0) handleWatchEvents();
+    }
+    return NULL;
+}
+
+/**
+ * Starts a thread that watches a preset directory (inotify) and reloads changed
+ * files off the render thread. Only the changed file is parsed; the complete set
+ * of presets is then published and swapped in between two frames, so editing a
+ * preset never stalls rendering.
+ *
+ * @param directory The preset directory (as loaded with loadPresetDirectory()).
+ * @return          1 on success, 0 if the directory can't be watched.
+ */
+int startPresetWatcher(const char *directory) {
+    if (__atomic_load_n(&milky_presetWatchRunning, __ATOMIC_ACQUIRE)) return 1;
+
+    size_t length = strlen(directory);
+    if (length >= sizeof(milky_presetWatchDirectory)) {
+        fprintf(stderr, "Preset directory path too long: %s\n", directory);
+        return 0;
+    }
+    memcpy(milky_presetWatchDirectory, directory, length + 1);
+
+    milky_presetWatchScratch = (PresetTable *)malloc(sizeof(PresetTable));
+    if (!milky_presetWatchScratch) {
+        fprintf(stderr, "Failed to allocate the preset watcher\n");
+        return 0;
+    }
+
+    milky_presetWatchDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (milky_presetWatchDescriptor < 0
+        || inotify_add_watch(milky_presetWatchDescriptor, directory, IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE) < 0) {
+        fprintf(stderr, "Failed to watch preset directory %s: %s\n", directory, strerror(errno));
+        stopPresetWatcher();
+        return 0;
+    }
+
+    __atomic_store_n(&milky_presetWatchRunning, 1, __ATOMIC_RELEASE);
+    if (pthread_create(&milky_presetWatchThread, NULL, runPresetWatcher, NULL) != 0) {
+        fprintf(stderr, "Failed to start the preset watcher thread\n");
+        __atomic_store_n(&milky_presetWatchRunning, 0, __ATOMIC_RELEASE);
+        stopPresetWatcher();
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * Stops the watcher thread and releases its resources (safe to call if it was
+ * never started).
+ */
+void stopPresetWatcher(void) {
+    if (__atomic_exchange_n(&milky_presetWatchRunning, 0, __ATOMIC_ACQ_REL)) {
+        pthread_join(milky_presetWatchThread, NULL);
+    }
+    if (milky_presetWatchDescriptor >= 0) {
+        close(milky_presetWatchDescriptor);
+        milky_presetWatchDescriptor = -1;
+    }
+
+    clearWatchFiles();
+    free(milky_presetWatchScratch);
+    milky_presetWatchScratch = NULL;
+}
@@ -0,0 +1,31 @@
+#ifndef PRESETWATCH_H
+#define PRESETWATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+#include "./preset.h"
+
+#define MILKY_PRESET_WATCH_POLL_MS 200       // how often the watcher thread checks for the stop request
+#define MILKY_PRESET_WATCH_EVENT_BUFFER 4096 // bytes of inotify events read at once
+#define MILKY_PRESET_WATCH_MAX_PATH 1024     // longest path of a watched file
+
+// presets parsed from one file of the watched directory
+typedef struct {
+    char *fileName;  // name of the file inside the directory
+    Preset *presets; // the file's presets (numbered when the table is rebuilt)
+    size_t count;    // number of presets
+} PresetWatchFile;
+
+int startPresetWatcher(const char *directory);
+void stopPresetWatcher(void);
+
+#endif // PRESETWATCH_H
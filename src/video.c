@@ -1,26 +1,17 @@
 #include "video.h"
+#include "context.h"
 
-// flag to check if lastFrame is initialized
-static int milky_videoIsLastFrameInitialized = 0;
+// layers of the waveform scope (the classic centered oscilloscope line)
+static const WaveformLayer milky_videoWaveformLayers[] = {
+    { MILKY_WAVEFORM_LINES, MILKY_SCOPE_WAVEFORM, 0.5f, 1.0f, 2.5f, 255 }
+};
 
-// global variable to store the previous time
-static size_t milky_videoPrevTime = 0;
-static size_t milky_videoPrevFrameSize = 0;
-static float milky_videoSpeedScalar = 0.01f;
-
-// static buffer to be reused across render calls
-static uint8_t *milky_videoTempBuffer = NULL;
-static uint8_t *milky_videoPrevFrame = NULL;
-static size_t milky_videoTempBufferSize = 0;
-static size_t milky_videoLastCanvasWidthPx = 0;
-static size_t milky_videoLastCanvasHeightPx = 0;
-
-// remember the last time we reacted to energy spiked
-static clock_t milky_energyLastChangeInitTime = 0;
+static int reserveBuffer(MilkyContext *context, uint8_t **buffer, size_t *capacity, size_t size);
 
 /**
  * Renders one visual frame based on audio waveform and spectrum data.
  *
+ * @param context         Context whose state is rendered.
  * @param frame           Canvas frame buffer (RGBA format).
  * @param canvasWidthPx   Canvas width in pixels.
  * @param canvasHeightPx  Canvas height in pixels.
@@ -29,12 +20,13 @@ static clock_t milky_energyLastChangeInitTime = 0;
  * @param waveformLength  Length of the waveform data array.
  * @param spectrumLength  Length of the spectrum data array.
  * @param bitDepth        Bit depth of the rendering.
- * @param presetsBuffer   Preset data.
+ * @param presetsBuffer   Unused (presets are loaded up front, see loadPresetDirectory() and setVideoPresetIndex()).
  * @param speed           Speed factor for the rendering.
  * @param currentTime     Current time in milliseconds.
  * @param sampleRate      Waveform sample rate (samples per second)
  */
 void render(
+               MilkyContext *context,
                uint8_t *frame,
                size_t canvasWidthPx,
                size_t canvasHeightPx,
@@ -52,188 +44,310 @@ void render(
                 
                 speed = 0.03323f; // NICE; great factor value found!
 
-               if (waveformLength == 0 || spectrumLength == 0) {
-                   fprintf(stderr, "No waveform or spectrum data provided\n");
-                   return;
-               }
+               // (an empty spectrum is fine: the energy detection waits for the first one)
+               if (!waveform || waveformLength < MILKY_VIDEO_MIN_WAVEFORM_LENGTH) return;
 
                // Pre-calculate frame size and check memory requirements once
                const size_t frameSize = canvasWidthPx * canvasHeightPx * 4;
 
-               if (milky_videoPrevFrameSize == 0) {
-                   milky_videoPrevFrameSize = frameSize;
+               if (context->video.prevFrameSize == 0) {
+                   context->video.prevFrameSize = frameSize;
+               }
+
+               // Only update memory if canvas size changes (the frame is skipped if the buffers can't grow)
+               if (!reserveAndUpdateMemory(context, canvasWidthPx, canvasHeightPx, frame, frameSize)) {
+                   return;
+               }
+
+               // Advance the beat clock so effects can fire on predicted beats in this frame
+               updateBeatClock(context, currentTime);
+
+               // Move on to the next preset when its time is up (blended over a few frames)
+               if (context->video.presetDuration > 0 && context->presets->count > 1) {
+                   if (context->video.presetStartTime == 0) {
+                       context->video.presetStartTime = currentTime;
+                   } else if (currentTime - context->video.presetStartTime >= context->video.presetDuration) {
+                       transitionVideoPreset(context, (context->video.presetIndex + 1) % context->presets->count, MILKY_TRANSITION_DEFAULT_FRAMES);
+                       context->video.presetStartTime = currentTime;
+                   }
                }
 
-               // Only update memory if canvas size changes
-               reserveAndUpdateMemory(canvasWidthPx, canvasHeightPx, frame, frameSize);
+               // Properties of this frame: the active preset, or a blend while a transition runs
+               float transitionWeight = 0.0f;
+               const Preset *blendedPreset = advancePresetTransition(context, &transitionWeight);
+               const Preset *preset = blendedPreset ? blendedPreset : getSnapshotPreset(context->presets, context->video.presetIndex);
              
              // Process emphasized waveform
              float emphasizedWaveform[waveformLength];
-             smoothBassEmphasizedWaveform(waveform, waveformLength, emphasizedWaveform, canvasWidthPx, 0.65f);
+             smoothBassEmphasizedWaveform(context, waveform, waveformLength, emphasizedWaveform, canvasWidthPx, 0.65f);
      
 
-                //fprintf(stdout, "milky_videoPrevTime: %zu, currentTime: %zu deltaTime: %f\n", milky_videoPrevTime, currentTime, (float)(currentTime - milky_videoPrevTime));
-                float deltaTime = (float)(currentTime - milky_videoPrevTime);
+                //fprintf(stdout, "prevTime: %zu, currentTime: %zu deltaTime: %f\n", context->video.prevTime, currentTime, (float)(currentTime - context->video.prevTime));
+                float deltaTime = (float)(currentTime - context->video.prevTime);
                 // Pre-calculate time frame and constants outside of per-pixel rendering for efficiency
-                const float timeFrame = (milky_videoPrevTime == 0) ? 0.01f : deltaTime / 1000.0f;
+                const float timeFrame = (context->video.prevTime == 0) ? 0.01f : deltaTime / 1000.0f;
 
                // Optimize buffer copies for NEON by vectorizing the copying operation
                // Copy the previous frame to a temporary buffer, minimizing redundant operations
-               if (!milky_videoIsLastFrameInitialized) {
+               if (!context->video.isLastFrameInitialized) {
                    clearFrame(frame, frameSize);
-                   clearFrame(milky_videoPrevFrame, milky_videoPrevFrameSize);
-                   milky_videoIsLastFrameInitialized = 1;
+                   clearFrame(context->video.prevFrame, context->video.prevFrameSize);
+                   context->video.isLastFrameInitialized = 1;
                } else {
-                   milky_videoSpeedScalar += speed * 2;
+                   context->video.speedScalar += speed * 2;
 
-                   //fprintf(stdout, "speedscalar: %f  speed: %f  ", milky_videoSpeedScalar);
-              // renderChasers(milky_videoSpeedScalar/4, frame, speed , 1, canvasWidthPx, canvasHeightPx, 88, 1);
 
 
-                   blurFrame(milky_videoPrevFrame, frameSize, 2, 0.95f);
+                   blurFrame(context->video.prevFrame, frameSize, 2, 0.95f);
 
-                   preserveMassFade(milky_videoPrevFrame, milky_videoTempBuffer, frameSize);
+                   preserveMassFade(context->video.prevFrame, context->video.tempBuffer, frameSize);
                    
                    #ifdef __ARM_NEON__
                    size_t i = 0;
                    for (; i + 16 <= frameSize; i += 16) {
-                       uint8x16_t prevFrameData = vld1q_u8(&milky_videoPrevFrame[i]);
-                       vst1q_u8(&milky_videoTempBuffer[i], prevFrameData);
+                       uint8x16_t prevFrameData = vld1q_u8(&context->video.prevFrame[i]);
+                       vst1q_u8(&context->video.tempBuffer[i], prevFrameData);
                        vst1q_u8(&frame[i], prevFrameData);
                    }
                    for (; i < frameSize; i++) {
-                       milky_videoTempBuffer[i] = milky_videoPrevFrame[i];
-                       frame[i] = milky_videoTempBuffer[i];
+                       context->video.tempBuffer[i] = context->video.prevFrame[i];
+                       frame[i] = context->video.tempBuffer[i];
                    }
                    #else
-                   memcpy(milky_videoTempBuffer, milky_videoPrevFrame, frameSize);
-                   memcpy(frame, milky_videoTempBuffer, frameSize);
+                   memcpy(context->video.tempBuffer, context->video.prevFrame, frameSize);
+                   memcpy(frame, context->video.tempBuffer, frameSize);
                    #endif
                }
 
-               milky_videoPrevTime = currentTime;
+               context->video.prevTime = currentTime;
                // Apply color palette for visual effects
-               applyPaletteToCanvas(currentTime, frame, canvasWidthPx, canvasHeightPx);
-               //renderChasers(milky_videoSpeedScalar, frame, speed  * 20, 1, canvasWidthPx, canvasHeightPx, 44, 2);
+               applyPaletteToCanvas(context, currentTime, frame, canvasWidthPx, canvasHeightPx);
 
-               //renderTunnelCircle(currentTime, milky_videoSpeedScalar, frame, 50, 1, canvasWidthPx, canvasHeightPx, 42, 2);
+               //renderTunnelCircle(currentTime, context->video.speedScalar, frame, 50, 1, canvasWidthPx, canvasHeightPx, 42, 2);
 
-               // Render waveform with multiple emphasis levels
-               //renderWaveformSimple(timeFrame, frame, canvasWidthPx, canvasHeightPx, emphasizedWaveform, waveformLength, 0.85f, 1, 1);
-               renderWaveformSimple(timeFrame, frame, canvasWidthPx, canvasHeightPx, emphasizedWaveform, waveformLength, 5.0f, 0, 0);
-               renderWaveformSimple(timeFrame, frame, canvasWidthPx, canvasHeightPx, emphasizedWaveform, waveformLength, 0.0f, 1, 0);
+               // Render all waveform layers in one pass (the smoothing leaves the last two samples unset)
+               renderWaveform(context, frame, canvasWidthPx, canvasHeightPx, emphasizedWaveform, waveformLength - 2,
+                              milky_videoWaveformLayers, sizeof(milky_videoWaveformLayers) / sizeof(milky_videoWaveformLayers[0]),
+                              getPresetRecordValue(preset, MILKY_PRESET_X_CENTER, 0.5f),
+                              getPresetRecordValue(preset, MILKY_PRESET_Y_CENTER, 0.5f));
      
-               detectEnergySpike(waveform, spectrum, waveformLength, spectrumLength, sampleRate);
+               // registered effects (spectrum bars, dots, grid, ...), switched by the active preset's effect_* properties
+               EffectContext effectContext = createEffectContext(context, currentTime, timeFrame, context->video.speedScalar);
+               // (during a transition, effects only one of both presets enables are cross-faded)
+               if (blendedPreset && reserveBuffer(context, &context->video.transitionBuffer, &context->video.transitionBufferSize, frameSize)) {
+                   renderEffectTransition(context, frame, context->video.transitionBuffer, canvasWidthPx, canvasHeightPx,
+                                          getPresetTransitionSource(context), getPresetTransitionTarget(context), transitionWeight, &effectContext);
+               } else {
+                   renderEffects(context, frame, canvasWidthPx, canvasHeightPx, preset, &effectContext);
+               }
+
+               detectEnergySpike(context, waveform, spectrum, waveformLength, spectrumLength, sampleRate);
 
-               renderChasers(milky_videoSpeedScalar, frame, speed  * 20, 2, canvasWidthPx, canvasHeightPx, 42, 2);
+               if (getPresetRecordValue(preset, MILKY_PRESET_EFFECT_CHASERS, 1.0f) > 0.0f) {
+                   renderChasers(context, context->video.speedScalar, frame, speed  * 20, 2, canvasWidthPx, canvasHeightPx, 2);
+               }
                
 
                if (bitDepth < 32) {
-                   reduceBitDepth(frame, frameSize, bitDepth);
+                   reduceBitDepth(context, frame, canvasWidthPx, canvasHeightPx, bitDepth);
                }
                     
-                // Seed the random number generator with the current time
-                srand((unsigned int)time(NULL));
-
                 // Generate a random float between 0.2 and 0.5
-                float rotationAngle = ((float)rand() / (float)RAND_MAX) * (0.5f - 0.2f) + 0.2f;
+                float rotationAngle = ((float)nextContextRandom(context) / (float)UINT32_MAX) * (0.5f - 0.2f) + 0.2f;
 
                 if (rotationAngle > 0 && rotationAngle < 0.05) rotationAngle = 0.05f;
                 if (rotationAngle < 0 && rotationAngle > -0.05) rotationAngle = -0.05f;
 
-                float zoomFactor = ((float)rand() / (float)RAND_MAX) * (0.2f - 0.1f) + 0.1f;
+                float zoomFactor = ((float)nextContextRandom(context) / (float)UINT32_MAX) * (0.2f - 0.1f) + 0.1f;
 
                 if (zoomFactor > 0 && zoomFactor < 0.05) zoomFactor = 0.05f;
                 if (zoomFactor < 0 && zoomFactor > -0.05) zoomFactor = -0.05f;
 
-               // check if it's time to regenerate the palette based on energy spikes and time elapsed
-                if ((milky_energyEnergySpikeDetected && currentTime - milky_energyLastChangeInitTime > 10 * 1000) || milky_energyLastChangeInitTime == 0) {
+               // check if it's time to flip the direction based on predicted beats (or energy spikes) and time elapsed
+                if ((isBeatTriggered(context) && currentTime - context->video.energyLastChangeInitTime > 10 * 1000) || context->video.energyLastChangeInitTime == 0) {
                     rotationAngle = -rotationAngle;
                     zoomFactor = -zoomFactor;
                     // invert (make it minus, rotate in different direction)
-                    milky_energyLastChangeInitTime = currentTime; // update the last initialization time
+                    context->video.energyLastChangeInitTime = currentTime; // update the last initialization time
                 }
      
                
-               // Rotate and scale effects with NEON-optimized copy
-               rotate(timeFrame, milky_videoTempBuffer, frame, 0.02 * currentTime, rotationAngle, canvasWidthPx, canvasHeightPx);
-               scale(frame, milky_videoTempBuffer, 1.15f, canvasWidthPx, canvasHeightPx);
+               if (preset && ((preset->definedMask & MILKY_WARP_PROPERTY_MASK) || preset->perFrameCode[0] || preset->perVertexCode[0])) {
+                   // Presets with displacement_map use their static motion (no equations) from a per-pixel
+                   // table built on a worker; the mesh stands in until it is ready (and during transitions)
+                   WarpParameters warpParameters = getWarpParameters(preset);
+                   const int displaced = !blendedPreset && getPresetRecordValue(preset, MILKY_PRESET_DISPLACEMENT_MAP, 0.0f) > 0.0f;
+                   const DisplacementMap *displacementMap = displaced ? prepareDisplacementMap(context, &warpParameters, canvasWidthPx, canvasHeightPx) : NULL;
+
+                   if (displacementMap) {
+                       applyDisplacementMap(displacementMap, context->video.tempBuffer, frame);
+                   } else if (displaced) {
+                       evaluateWarpMesh(context, &warpParameters, canvasWidthPx, canvasHeightPx, 0.0f, NULL);
+                       applyWarpMesh(context, context->video.tempBuffer, frame, canvasWidthPx, canvasHeightPx);
+                   } else {
+                       // Preset-driven motion: equations on the mesh vertices, interpolated per pixel
+                       // (the preset's equations are compiled once, when they change)
+                       uint64_t frameProgramHash = context->video.frameProgram.sourceHash;
+                       updateExprProgram(&context->video.frameProgram, preset->perFrameCode);
+                       if (context->video.frameProgram.sourceHash != frameProgramHash) {
+                           memset(context->video.frameVariables, 0, sizeof(context->video.frameVariables));
+                       }
+                       updateExprProgram(&context->video.vertexProgram, preset->perVertexCode);
+
+                       WarpInputs warpInputs = { (float)currentTime / 1000.0f, (float)context->video.frameCount,
+                                                 effectContext.bass, effectContext.mid, effectContext.treble };
+                       runWarpFrameEquations(&context->video.frameProgram, context->video.frameVariables, &warpInputs, &warpParameters);
+
+                       WarpVertexEquations vertexEquations = { &context->video.vertexProgram, &context->video.frameProgram, context->video.frameVariables, &warpInputs };
+                       evaluateWarpMesh(context, &warpParameters, canvasWidthPx, canvasHeightPx, warpInputs.time, &vertexEquations);
+                       applyWarpMesh(context, context->video.tempBuffer, frame, canvasWidthPx, canvasHeightPx);
+                   }
+                   memcpy(frame, context->video.tempBuffer, frameSize);
+
+                   context->video.frameMotion.zoom = warpParameters.zoom;
+                   context->video.frameMotion.rotation = warpParameters.rotation;
+                   context->video.frameMotion.dx = warpParameters.dx;
+                   context->video.frameMotion.dy = warpParameters.dy;
+                   context->video.frameMotion.centerX = warpParameters.centerX;
+                   context->video.frameMotion.centerY = warpParameters.centerY;
+               } else {
+                   // Rotate and scale effects with NEON-optimized copy
+                   rotate(context, timeFrame, context->video.tempBuffer, frame, 0.02 * currentTime, rotationAngle, canvasWidthPx, canvasHeightPx);
+                   scale(frame, context->video.tempBuffer, 1.15f, canvasWidthPx, canvasHeightPx);
+                   context->video.frameMotion = getStaticDisplayMotion();
+               }
      
                // Copy the final frame to the previous frame buffer
                #ifdef __ARM_NEON__
                size_t j = 0;
                for (; j + 16 <= frameSize; j += 16) {
-                   vst1q_u8(&milky_videoPrevFrame[j], vld1q_u8(&frame[j]));
+                   vst1q_u8(&context->video.prevFrame[j], vld1q_u8(&frame[j]));
                }
                for (; j < frameSize; j++) {
-                   milky_videoPrevFrame[j] = frame[j];
+                   context->video.prevFrame[j] = frame[j];
                }
                #else
-               memcpy(milky_videoPrevFrame, frame, frameSize);
+               memcpy(context->video.prevFrame, frame, frameSize);
                #endif
 
                // Update frame size to match current frame
-               milky_videoPrevFrameSize = frameSize;
+               context->video.prevFrameSize = frameSize;
+               context->video.frameCount++;
            }
 
 
+/**
+ * Resets the renderer of a context to its first frame.
+ */
+void initializeVideo(MilkyContext *context) {
+    memset(&context->video, 0, sizeof(VideoState));
+    context->video.speedScalar = 0.01f;
+    context->video.frameMotion = getStaticDisplayMotion();
+}
+
+/**
+ * Frees the buffers of the renderer of a context.
+ */
+void destroyVideo(MilkyContext *context) {
+    releaseContextMemory(context, context->video.tempBuffer);
+    releaseContextMemory(context, context->video.prevFrame);
+    releaseContextMemory(context, context->video.transitionBuffer);
+    initializeVideo(context);
+}
+
+/**
+ * Selects the preset whose properties drive the rendering.
+ *
+ * @param presetIndex Index of the preset (out of range = built-in defaults).
+ */
+void setVideoPresetIndex(MilkyContext *context, size_t presetIndex) {
+    context->video.presetIndex = presetIndex;
+}
+
+/**
+ * Blends from the active preset to another one over a number of frames: numeric
+ * properties are interpolated and effects that only one of both presets enables
+ * are cross-faded. The feedback buffer is shared, so the transition costs at most
+ * one more effect layer and one blend per frame.
+ *
+ * @param presetIndex Index of the preset to change to.
+ * @param frameCount  Length of the transition in frames (0 = switch immediately).
+ */
+void transitionVideoPreset(MilkyContext *context, size_t presetIndex, size_t frameCount) {
+    startPresetTransition(context, getSnapshotPreset(context->presets, context->video.presetIndex), getSnapshotPreset(context->presets, presetIndex), frameCount);
+    context->video.presetIndex = presetIndex;
+}
+
+/**
+ * Sets how long each preset is shown before blending to the next one.
+ *
+ * @param milliseconds Time per preset (0 = stay on the selected preset).
+ */
+void setVideoPresetDuration(MilkyContext *context, size_t milliseconds) {
+    context->video.presetDuration = milliseconds;
+    context->video.presetStartTime = 0;
+}
+
+/**
+ * Returns the motion the last frame applied to the feedback image (zoom, rotation
+ * and translation of the preset's warp, after its per-frame equations), so the
+ * display can continue it between frames. Frames without a warp report no motion.
+ *
+ * @return The motion per frame.
+ */
+DisplayMotion getVideoFrameMotion(MilkyContext *context) {
+    return context->video.frameMotion;
+}
+
+/**
+ * Grows a buffer to at least `size` bytes. Buffers never shrink, so resizing the
+ * canvas back and forth only reallocates when it gets bigger than ever before.
+ *
+ * @param buffer   The buffer to grow (may point to NULL).
+ * @param capacity The allocated size of the buffer.
+ * @param size     The required size in bytes.
+ * @return         1 on success, 0 on allocation failure (the old buffer stays valid).
+ */
+static int reserveBuffer(MilkyContext *context, uint8_t **buffer, size_t *capacity, size_t size) {
+    if (*buffer && size <= *capacity) return 1;
+
+    uint8_t *resized = (uint8_t *)reallocateContextMemory(context, *buffer, size);
+    if (!resized) return 0;
+
+    *buffer = resized;
+    *capacity = size;
+    return 1;
+}
+
 /**
  * Reserves and updates memory dynamically for rendering based on canvas size.
+ * When the canvas size changes (between frames), the buffers are grown if needed
+ * and the feedback history is cleared, since it no longer matches the geometry.
  *
  * @param canvasWidthPx  Canvas width in pixels.
  * @param canvasHeightPx Canvas height in pixels.
  * @param frame          Frame buffer to be updated.
  * @param frameSize      Size of the frame buffer.
+ * @return               1 on success, 0 on allocation failure (the buffers and the canvas
+ *                       size stay as they were, so the frame can't be rendered).
  */
-void reserveAndUpdateMemory(size_t canvasWidthPx, size_t canvasHeightPx, uint8_t *frame, size_t frameSize) {
-    // check if the canvas size has changed and reinitialize buffers if necessary
-    if (canvasWidthPx != milky_videoLastCanvasWidthPx || canvasHeightPx != milky_videoLastCanvasHeightPx) {
-        clearFrame(frame, frameSize);
-        if (milky_videoPrevFrame) {
-            free(milky_videoPrevFrame);
-        }
-        milky_videoPrevFrame = (uint8_t *)malloc(frameSize);
-        if (!milky_videoPrevFrame) {
-            fprintf(stderr, "Failed to allocate prevFrame buffer\n");
-            return;
-        }
-        milky_videoLastCanvasWidthPx = canvasWidthPx;
-        milky_videoLastCanvasHeightPx = canvasHeightPx;
-
-        // free and reallocate the temporary buffer if canvas size changes
-        if (milky_videoTempBuffer) {
-            free(milky_videoTempBuffer);
-        }
-        milky_videoTempBuffer = (uint8_t *)malloc(frameSize);
-        if (!milky_videoTempBuffer) {
-            fprintf(stderr, "Failed to allocate temporary buffer\n");
-            return;
-        }
-        milky_videoTempBufferSize = frameSize;
+int reserveAndUpdateMemory(MilkyContext *context, size_t canvasWidthPx, size_t canvasHeightPx, uint8_t *frame, size_t frameSize) {
+    if (!reserveBuffer(context, &context->video.prevFrame, &context->video.prevFrameCapacity, frameSize)) {
+        fprintf(stderr, "Failed to allocate prevFrame buffer\n");
+        return 0;
     }
-
-    // allocate or reuse the prevFrame buffer
-    if (!milky_videoPrevFrame || milky_videoTempBufferSize < frameSize) {
-        if (milky_videoPrevFrame) {
-            free(milky_videoPrevFrame);
-        }
-        milky_videoPrevFrame = (uint8_t *)malloc(frameSize);
-        if (!milky_videoPrevFrame) {
-            fprintf(stderr, "Failed to allocate prevFrame buffer\n");
-            return;
-        }
+    if (!reserveBuffer(context, &context->video.tempBuffer, &context->video.tempBufferSize, frameSize)) {
+        fprintf(stderr, "Failed to allocate temporary buffer\n");
+        return 0;
     }
 
-    // allocate or reuse the temporary buffer
-    if (!milky_videoTempBuffer || milky_videoTempBufferSize < frameSize) {
-        if (milky_videoTempBuffer) {
-            free(milky_videoTempBuffer);
-        }
-        milky_videoTempBuffer = (uint8_t *)malloc(frameSize);
-        if (!milky_videoTempBuffer) {
-            fprintf(stderr, "Failed to allocate temporary buffer\n");
-            return;
-        }
-        milky_videoTempBufferSize = frameSize;
+    // check if the canvas size has changed and start over with a black history if so
+    if (canvasWidthPx != context->video.lastCanvasWidthPx || canvasHeightPx != context->video.lastCanvasHeightPx) {
+        clearFrame(frame, frameSize);
+        clearFrame(context->video.prevFrame, frameSize);
+        context->video.prevFrameSize = frameSize;
+        context->video.lastCanvasWidthPx = canvasWidthPx;
+        context->video.lastCanvasHeightPx = canvasHeightPx;
     }
+    return 1;
 }
@@ -13,24 +13,77 @@
 
 #include "./audio/sound.h"
 #include "./audio/energy.h"
+#include "./audio/beat.h"
+#include "./audio/bands.h"
+#include "./preset.h"
 #include "./video/bitdepth.h"
 #include "./video/transform.h"
 #include "./video/draw.h"
 #include "./video/palette.h"
 #include "./video/effects/chaser.h"
 #include "./video/effects/tunnel.h"
+#include "./video/effects/effect.h"
+#include "./video/effects/waveform.h"
 #include "./video/blur.h"
+#include "./video/transition.h"
+#include "./video/warp.h"
+#include "./video/displace.h"
+#include "./video/display.h"
+#include "./allocator.h"
 
 #ifdef __ARM_NEON__
 #include <arm_neon.h>
 #endif
 
+// the smoothing of the scope reads two samples ahead (see smoothBassEmphasizedWaveform())
+#define MILKY_VIDEO_MIN_WAVEFORM_LENGTH 3
+
+// renderer of a context: feedback history, preset rotation and equations
+typedef struct {
+    // flag to check if lastFrame is initialized
+    int isLastFrameInitialized;
+
+    // the previous time and the accumulated animation time
+    size_t prevTime;
+    size_t prevFrameSize;
+    float speedScalar;
+
+    // buffers reused across render calls
+    uint8_t *tempBuffer;
+    uint8_t *prevFrame;
+    size_t tempBufferSize;
+    size_t prevFrameCapacity;
+    size_t lastCanvasWidthPx;
+    size_t lastCanvasHeightPx;
+
+    // index of the preset whose properties drive the effects
+    size_t presetIndex;
+
+    // automatic preset changes (0 = stay on the selected preset) and the layer buffer of transitions
+    size_t presetDuration;
+    size_t presetStartTime;
+    uint8_t *transitionBuffer;
+    size_t transitionBufferSize;
+
+    // compiled equations of the active preset and the per-frame variables they keep between frames
+    ExprProgram frameProgram;
+    ExprProgram vertexProgram;
+    float frameVariables[MILKY_EXPR_MAX_VARIABLES];
+    size_t frameCount;
+
+    // motion of the feedback image in the last frame (see getVideoFrameMotion())
+    DisplayMotion frameMotion;
+
+    // remember the last time we reacted to energy spiked
+    clock_t energyLastChangeInitTime;
+} VideoState;
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 void render(
+    MilkyContext *context,          // Context whose state is rendered
     uint8_t *frame,                 // Canvas frame buffer (RGBA format)
     size_t canvasWidthPx,           // Canvas width in pixels
     size_t canvasHeightPx,          // Canvas height in pixels
@@ -49,7 +102,13 @@ void render(
 }
 #endif
 
-void reserveAndUpdateMemory(size_t canvasWidthPx, size_t canvasHeightPx,  uint8_t *frame, size_t frameSize);
+void initializeVideo(MilkyContext *context);
+void destroyVideo(MilkyContext *context);
+void setVideoPresetIndex(MilkyContext *context, size_t presetIndex);
+void transitionVideoPreset(MilkyContext *context, size_t presetIndex, size_t frameCount);
+void setVideoPresetDuration(MilkyContext *context, size_t milliseconds);
+DisplayMotion getVideoFrameMotion(MilkyContext *context);
+int reserveAndUpdateMemory(MilkyContext *context, size_t canvasWidthPx, size_t canvasHeightPx,  uint8_t *frame, size_t frameSize);
 void updateAudioData(const uint8_t *waveform, const uint8_t *spectrum, size_t waveformLength, size_t spectrumLength);
 
 #endif // VIDEO_H
@@ -1,87 +1,126 @@
 #include "bitdepth.h"
+#include "../context.h"
+
+// 8x8 Bayer matrix: every threshold 0..63 exactly once, neighbors as far apart as possible
+static const uint8_t milky_bitdepthBayer[MILKY_DITHER_TILE_SIZE][MILKY_DITHER_TILE_SIZE] = {
+    {  0, 32,  8, 40,  2, 34, 10, 42 },
+    { 48, 16, 56, 24, 50, 18, 58, 26 },
+    { 12, 44,  4, 36, 14, 46,  6, 38 },
+    { 60, 28, 52, 20, 62, 30, 54, 22 },
+    {  3, 35, 11, 43,  1, 33,  9, 41 },
+    { 51, 19, 59, 27, 49, 17, 57, 25 },
+    { 15, 47,  7, 39, 13, 45,  5, 37 },
+    { 63, 31, 55, 23, 61, 29, 53, 21 }
+};
 
 /**
- * Quantizes a color value using the PNUQ (Perceptually Non-Uniform Quantization) method.
- * Therefore, reduces the color depth of a given color value based on the specified bit depth.
- * It supports common bit depths such as 24, 16, and 8 bits, and defaults to no quantization for unsupported bit depths.
+ * Returns the number of quantization steps of a channel at the given bit depth:
+ * 16 bit is RGB565, 8 bit is RGB332, other depths split their bits evenly.
  *
- * @param color    The original color value to be quantized (0-255).
- * @param bitDepth The target bit depth for quantization (e.g., 24, 16, 8).
- * @return         The quantized color value adjusted to the specified bit depth.
+ * @param bitDepth The target bit depth (24 or more = no quantization).
+ * @param channel  0 = red, 1 = green, 2 = blue.
+ * @return         Highest quantized level (2^bits - 1).
  */
-uint8_t quantize_pnuq(uint8_t color, uint8_t bitDepth) {
-  // determine the number of quantization levels based on the bit depth
-  uint8_t levels;
-  switch (bitDepth) {
-      case 24:
-          levels = 255;  // 24-bit color uses full 8-bit per channel, no reduction
-          break;
-      case 16:
-          levels = 31;   // 16-bit color typically uses 5 bits for red/blue, 6 for green
-          break;
-      case 8:
-          levels = 7;    // 8-bit color uses 3 bits per channel
-          break;
-      default:
-          levels = 255;  // unsupported bit depths default to no quantization
-  }
+static uint16_t getChannelLevels(uint8_t bitDepth, int channel) {
+    static const uint8_t rgb565[3] = { 5, 6, 5 };
+    static const uint8_t rgb332[3] = { 3, 3, 2 };
+
+    int bits;
+    if (bitDepth >= 24) bits = 8;
+    else if (bitDepth == 16) bits = rgb565[channel];
+    else if (bitDepth == 8) bits = rgb332[channel];
+    else bits = bitDepth / 3 < 1 ? 1 : bitDepth / 3;
 
-  // perform quantization by scaling the color to the reduced level and back to 0-255
-  uint8_t quantized = (color * levels / 255) * (255 / levels);
-  return quantized;
+    return (uint16_t)((1 << bits) - 1);
 }
 
 /**
- * Reduces the bit depth of an RGBA frame.
- * Iterates over each pixel in the frame and quantizes the red, green, and blue channels
- * using the Perceptually Non-Uniform Quantization (PNUQ) method. It then applies dithering to the quantized
- * colors to reduce banding effects.
+ * Builds the per-byte tables for a bit depth. A channel v with L levels becomes
+ * q = (v * L + threshold) / 255 (the threshold comes from the Bayer tile and is
+ * 0..254, so exact levels are never dithered) and is scaled back to 0..255 as
+ * (q * scale + 128) >> 8. Alpha uses L = 255, threshold 0 and scale 256, which
+ * leaves it unchanged.
  *
- * @param frame     The frame buffer containing the RGBA pixel data.
- * @param frameSize The size of the frame buffer in bytes.
- * @param bitDepth  The target bit depth for quantization (e.g., 24, 16, 8).
+ * @param bitDepth The target bit depth.
  */
-void reduceBitDepth(uint8_t *frame, size_t frameSize, uint8_t bitDepth) {
-  // iterate over each pixel in the frame
-  
-  for (size_t i = 0; i < frameSize; i += 4) {
-      // quantize the red, green, and blue channels using PNUQ
-      uint8_t r = quantize_pnuq(frame[i], bitDepth);
-      uint8_t g = quantize_pnuq(frame[i + 1], bitDepth);
-      uint8_t b = quantize_pnuq(frame[i + 2], bitDepth);
+static void buildDitherTables(MilkyContext *context, uint8_t bitDepth) {
+    for (int byte = 0; byte < MILKY_DITHER_TILE_SIZE * 4; byte++) {
+        int channel = byte & 3;
+        uint16_t levels = channel == 3 ? 255 : getChannelLevels(bitDepth, channel);
+        context->bitdepth.levels[byte] = levels;
+        context->bitdepth.scales[byte] = (uint16_t)((255 * 256 + levels / 2) / levels);
 
-      // apply dithering to the quantized colors to reduce banding
-      r = dither(r, frame[i]);
-      g = dither(g, frame[i + 1]);
-      b = dither(b, frame[i + 2]);
+        for (int row = 0; row < MILKY_DITHER_TILE_SIZE; row++) {
+            int threshold = milky_bitdepthBayer[row][byte / 4];
+            context->bitdepth.thresholds[row][byte] = channel == 3 ? 0 : (uint16_t)(((2 * threshold + 1) * 255) / 128);
+        }
+    }
+    context->bitdepth.tableDepth = bitDepth;
+}
 
-      // store the quantized and dithered values back into the frame
-      frame[i] = r;
-      frame[i + 1] = g;
-      frame[i + 2] = b;
-  }
+/**
+ * Quantizes one byte (see buildDitherTables()).
+ */
+static inline uint8_t quantizeByte(uint8_t value, uint16_t levels, uint16_t threshold, uint16_t scale) {
+    uint32_t x = (uint32_t)value * levels + threshold;
+    uint32_t q = (x + (x >> 8) + 1) >> 8; // x / 255 (exact for x < 65535)
+    uint32_t result = (q * scale + 128) >> 8;
+    return (uint8_t)(result > 255 ? 255 : result);
 }
 
 /**
- * Applies dithering using the Floyd-Steinberg method.
- * Calculates the error between the original and quantized color, then adjusts the quantized
- * color by diffusing the error. The adjusted color is clamped to ensure it remains within the valid range.
+ * Reduces the bit depth of an RGBA frame with ordered dithering: every channel is
+ * quantized against the threshold of an 8x8 Bayer tile, so banding turns into a
+ * fine regular pattern (the retro look) without any error diffusion between pixels.
+ * Rows are processed in parallel and 16 channels at a time (16-bit lanes).
  *
- * @param quantized_color The quantized color value.
- * @param original_color  The original color value before quantization.
- * @return                The dithered color value.
+ * @param frame    The frame buffer containing the RGBA pixel data.
+ * @param width    The width of the frame in pixels.
+ * @param height   The height of the frame in pixels.
+ * @param bitDepth The target bit depth (e.g. 16 = RGB565, 8 = RGB332; 24 or more = unchanged).
  */
-uint8_t dither(uint8_t quantized_color, uint8_t original_color) {
-  // calculate the error between the original and quantized color
-  int16_t error = (int16_t)original_color - (int16_t)quantized_color;
+void reduceBitDepth(MilkyContext *context, uint8_t *frame, size_t width, size_t height, uint8_t bitDepth) {
+    if (bitDepth >= 24) return;
+    if (bitDepth != context->bitdepth.tableDepth) buildDitherTables(context, bitDepth);
+
+    const size_t rowBytes = width * 4;
+    const size_t tileBytes = MILKY_DITHER_TILE_SIZE * 4;
+    const uint16_t *levels = context->bitdepth.levels;
+    const uint16_t *scales = context->bitdepth.scales;
 
-  // adjust the quantized color by diffusing the error
-  int16_t adjusted_color = quantized_color + (error * 7 / 16);
+    #pragma omp parallel for schedule(static)
+    for (size_t y = 0; y < height; y++) {
+        uint8_t *row = &frame[y * rowBytes];
+        const uint16_t *thresholds = context->bitdepth.thresholds[y % MILKY_DITHER_TILE_SIZE];
+        size_t i = 0;
 
-  // clamp the adjusted color to ensure it remains within the valid range
-  if (adjusted_color > 255) adjusted_color = 255;
-  if (adjusted_color < 0) adjusted_color = 0;
+#if defined(__AVX2__)
+        for (; i + tileBytes <= rowBytes; i += tileBytes) {
+            for (size_t half = 0; half < tileBytes; half += 16) {
+                __m256i value = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)&row[i + half]));
+                __m256i x = _mm256_add_epi16(_mm256_mullo_epi16(value, _mm256_loadu_si256((const __m256i *)&levels[half])),
+                                             _mm256_loadu_si256((const __m256i *)&thresholds[half]));
+                __m256i q = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), _mm256_set1_epi16(1)), 8);
+                __m256i result = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(q, _mm256_loadu_si256((const __m256i *)&scales[half])),
+                                                                    _mm256_set1_epi16(128)), 8);
+                _mm_storeu_si128((__m128i *)&row[i + half], _mm_packus_epi16(_mm256_castsi256_si128(result), _mm256_extracti128_si256(result, 1)));
+            }
+        }
+#elif defined(__ARM_NEON__)
+        for (; i + tileBytes <= rowBytes; i += tileBytes) {
+            for (size_t part = 0; part < tileBytes; part += 8) {
+                uint16x8_t value = vmovl_u8(vld1_u8(&row[i + part]));
+                uint16x8_t x = vmlaq_u16(vld1q_u16(&thresholds[part]), value, vld1q_u16(&levels[part]));
+                uint16x8_t q = vshrq_n_u16(vaddq_u16(vaddq_u16(x, vshrq_n_u16(x, 8)), vdupq_n_u16(1)), 8);
+                uint16x8_t result = vshrq_n_u16(vmlaq_u16(vdupq_n_u16(128), q, vld1q_u16(&scales[part])), 8);
+                vst1_u8(&row[i + part], vqmovn_u16(result));
+            }
+        }
+#endif
 
-  // return the adjusted color as a uint8_t
-  return (uint8_t)adjusted_color;
+        for (; i < rowBytes; i++) {
+            size_t byte = i & (tileBytes - 1); // tileBytes is a power of two
+            row[i] = quantizeByte(row[i], levels[byte], thresholds[byte], scales[byte]);
+        }
+    }
 }
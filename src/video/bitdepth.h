@@ -7,8 +7,27 @@
 #include <math.h>
 #include <omp.h>
 
-uint8_t quantize_pnuq(uint8_t color, uint8_t bitDepth);
-void reduceBitDepth(uint8_t *frame, size_t frameSize, uint8_t bitDepth);
-uint8_t dither(uint8_t quantized_color, uint8_t original_color);
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#ifdef __ARM_NEON__
+#include <arm_neon.h>
+#endif
+
+#include "../milky.h"
+
+#define MILKY_DITHER_TILE_SIZE 8 // edge length of the ordered (Bayer) dither tile in pixels
+
+// dither tables of a context
+typedef struct {
+    // per-byte tables for the current bit depth (one tile row = 8 RGBA pixels = 32 bytes)
+    uint16_t thresholds[MILKY_DITHER_TILE_SIZE][MILKY_DITHER_TILE_SIZE * 4];
+    uint16_t levels[MILKY_DITHER_TILE_SIZE * 4];
+    uint16_t scales[MILKY_DITHER_TILE_SIZE * 4];
+    uint8_t tableDepth; // 0 = no tables built yet
+} BitDepthState;
+
+void reduceBitDepth(MilkyContext *context, uint8_t *frame, size_t width, size_t height, uint8_t bitDepth);
 
 #endif // BITDEPTH_H
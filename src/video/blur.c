@@ -120,6 +120,108 @@ void boxBlurAndPerspective2(
 }
 */
 
+#ifdef MILKY_FIXED_POINT_KERNELS
+/**
+ * Counts how often the float kernel below fades a byte: pixel i fades bytes
+ * i * step .. i * step + 2, so with a step below 3 neighboring pixels overlap.
+ *
+ * @param index     Index of the byte.
+ * @param numPixels Number of pixels visited (frameSize / step).
+ * @param step      Distance between the visited pixels in bytes.
+ * @return          Number of times the byte is scaled by the factor.
+ */
+static size_t countFades(size_t index, size_t numPixels, size_t step) {
+    size_t first = index < 2 ? 0 : (index - 2 + step - 1) / step;
+    size_t last = index / step;
+    if (last >= numPixels) last = numPixels - 1;
+    return last >= first ? last - first + 1 : 0;
+}
+
+/**
+ * Fades the bytes from..to one by one (see countFades()).
+ */
+static void fadeBytes(uint8_t *prevFrame, size_t from, size_t to, size_t numPixels, size_t step, uint16_t fraction) {
+    for (size_t i = from; i < to; i++) {
+        for (size_t fades = countFades(i, numPixels, step); fades > 0; fades--) {
+            prevFrame[i] = mulFixedFraction(prevFrame[i], fraction);
+        }
+    }
+}
+
+/**
+ * Fixed-point variant of the fade below (16-bit lanes, within 1 LSB of the float kernel
+ * per fade). Every byte is scaled by the factor as many times as the float kernel's
+ * pixel loop touches it (step 4: R, G and B once, alpha never). For steps that divide
+ * 16 this pattern repeats every 16 bytes, so whole blocks are faded in Q8.8 with one
+ * mulhi per pass and a per-lane mask for the lanes that are faded fewer times.
+ *
+ * @param prevFrame A pointer to the frame buffer containing pixel data in RGBA format.
+ * @param frameSize The total size of the frame buffer in bytes.
+ * @param step      Distance between the faded pixels in bytes.
+ * @param factor    Fade factor (0..1).
+ */
+void blurFrame(uint8_t *prevFrame, size_t frameSize, size_t step, float factor) {
+    if (step == 0 || frameSize < step || factor >= 1.0f) return;
+
+    const size_t numPixels = frameSize / step;
+    const uint16_t fraction = toFixedFraction(factor);
+
+    // bytes 16 .. numPixels * step are in the periodic part of the pattern
+    size_t blockStart = 16, blockEnd = 16;
+    uint16_t laneMasks[3][16];
+    if (16 % step == 0 && numPixels * step >= 32) {
+        blockEnd = (numPixels * step) / 16 * 16;
+        for (size_t lane = 0; lane < 16; lane++) {
+            size_t fades = countFades(16 + lane, numPixels, step);
+            for (size_t pass = 0; pass < 3; pass++) {
+                laneMasks[pass][lane] = pass < fades ? 0xFFFF : 0;
+            }
+        }
+    }
+
+    #pragma omp parallel for schedule(static)
+    for (size_t block = blockStart; block < blockEnd; block += 16) {
+        uint8_t *bytes = &prevFrame[block];
+#if defined(__AVX2__)
+        const __m256i integerBits = _mm256_set1_epi16((short)0xFF00);
+        __m256i lanes = _mm256_slli_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)bytes)), MILKY_FIXED_SHIFT);
+        for (size_t pass = 0; pass < 3; pass++) {
+            // Q8.8 * Q0.16 -> Q8.8, truncated to whole channel values like the float cast
+            __m256i faded = _mm256_and_si256(_mm256_mulhi_epu16(lanes, _mm256_set1_epi16((short)fraction)), integerBits);
+            lanes = _mm256_blendv_epi8(lanes, faded, _mm256_loadu_si256((const __m256i *)laneMasks[pass]));
+        }
+        lanes = _mm256_srli_epi16(lanes, MILKY_FIXED_SHIFT);
+        _mm_storeu_si128((__m128i *)bytes, _mm_packus_epi16(_mm256_castsi256_si128(lanes), _mm256_extracti128_si256(lanes, 1)));
+#elif defined(__ARM_NEON__)
+        uint8x16_t pixels = vld1q_u8(bytes);
+        uint16x8_t low = vmovl_u8(vget_low_u8(pixels));
+        uint16x8_t high = vmovl_u8(vget_high_u8(pixels));
+        for (size_t pass = 0; pass < 3; pass++) {
+            // widening multiply, keep the high halves (value * fraction >> 16)
+            uint16x8_t fadedLow = vcombine_u16(vshrn_n_u32(vmull_n_u16(vget_low_u16(low), fraction), 16),
+                                               vshrn_n_u32(vmull_n_u16(vget_high_u16(low), fraction), 16));
+            uint16x8_t fadedHigh = vcombine_u16(vshrn_n_u32(vmull_n_u16(vget_low_u16(high), fraction), 16),
+                                                vshrn_n_u32(vmull_n_u16(vget_high_u16(high), fraction), 16));
+            low = vbslq_u16(vld1q_u16(&laneMasks[pass][0]), fadedLow, low);
+            high = vbslq_u16(vld1q_u16(&laneMasks[pass][8]), fadedHigh, high);
+        }
+        vst1q_u8(bytes, vcombine_u8(vmovn_u16(low), vmovn_u16(high)));
+#else
+        for (size_t lane = 0; lane < 16; lane++) {
+            uint8_t value = bytes[lane];
+            for (size_t pass = 0; pass < 3; pass++) {
+                if (laneMasks[pass][lane]) value = mulFixedFraction(value, fraction);
+            }
+            bytes[lane] = value;
+        }
+#endif
+    }
+
+    // head, tail and steps that don't fit the 16-byte blocks
+    fadeBytes(prevFrame, 0, blockStart < frameSize ? blockStart : frameSize, numPixels, step, fraction);
+    fadeBytes(prevFrame, blockEnd, frameSize, numPixels, step, fraction);
+}
+#else
 /**
  * Iterates over each pixel in the given frame and applies a fade effect
  * to the red, green, and blue channels. The fade effect is achieved by multiplying each
@@ -145,6 +247,7 @@ void blurFrame(uint8_t *prevFrame, size_t frameSize, size_t step, float factor)
         // Alpha channel (pixel[3]) remains unchanged
     }
 }
+#endif
 
 void preserveMassFade(uint8_t *prevFrame, uint8_t *frame, size_t frameSize) {
   // Ensure frameSize is a multiple of 4
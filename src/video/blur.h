@@ -11,6 +11,8 @@
 #include <arm_neon.h>
 #endif
 
+#include "./fixed.h"
+
 void blurFrame(uint8_t *prevFrame, size_t frameSize, size_t step, float factor);
 void preserveMassFade(uint8_t *prevFrame, uint8_t *frame, size_t frameSize);
 
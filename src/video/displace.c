@@ -0,0 +1,326 @@
+#include "displace.h"
+#include "../context.h"
+
+static int isSameDisplacementRequest(const DisplacementRequest *request, const WarpParameters *parameters, size_t width, size_t height) {
+    return request->width == width && request->height == height
+        && memcmp(&request->parameters, parameters, sizeof(WarpParameters)) == 0;
+}
+
+/**
+ * Converts a source position to an offset from the pixel in 1/16 pixels. The
+ * position is clamped to the frame first (samples outside repeat its edge), so the
+ * offset always leads into the frame.
+ *
+ * @param position The source position in pixels.
+ * @param pixel    The position of the pixel itself.
+ * @param size     The canvas width or height.
+ * @return         The offset (beyond int16 for sources more than 2047 pixels away).
+ */
+static long toDisplacementOffset(float position, size_t pixel, size_t size) {
+    const float last = (float)(size - 1);
+    if (!(position >= 0.0f)) position = 0.0f; // also catches NaN
+    if (position > last) position = last;
+
+    return lrintf(position * (float)(1 << MILKY_DISPLACE_SUBPIXEL_BITS)) - (long)(pixel << MILKY_DISPLACE_SUBPIXEL_BITS);
+}
+
+/**
+ * Evaluates a motion exactly for every pixel (no mesh interpolation). Expensive
+ * (per-pixel trigonometry), which is why it runs on the worker thread. The animated
+ * warp is frozen at its start, since the map is static. A motion with offsets that
+ * don't fit into an entry (only possible on canvases over 2048 pixels) is marked as
+ * overflowing instead of being clamped.
+ *
+ * @param request   The motion and canvas size.
+ * @param allocator The allocator of the map.
+ * @return          The new map, or NULL on allocation failure.
+ */
+static DisplacementMap *buildDisplacementMap(const DisplacementRequest *request, const MilkyAllocator *allocator) {
+    const size_t width = request->width, height = request->height;
+
+    DisplacementMap *map = (DisplacementMap *)reallocateWith(allocator, NULL, sizeof(DisplacementMap) + width * height * sizeof(DisplacementEntry));
+    float *u = (float *)malloc(width * 2 * sizeof(float));
+    if (!map || !u) {
+        fprintf(stderr, "Failed to allocate a %zux%zu displacement map\n", width, height);
+        if (map) reallocateWith(allocator, map, 0);
+        free(u);
+        return NULL;
+    }
+    float *v = u + width;
+
+    map->parameters = request->parameters;
+    map->width = width;
+    map->height = height;
+    map->overflow = 0;
+    for (size_t y = 0; y < height && !map->overflow; y++) {
+        evaluateWarpRow(&request->parameters, width, height, y, 0.0f, u, v);
+
+        DisplacementEntry *entries = &map->entries[y * width];
+        for (size_t x = 0; x < width; x++) {
+            const long dx = toDisplacementOffset(u[x], x, width);
+            const long dy = toDisplacementOffset(v[x], y, height);
+            if (dx < INT16_MIN || dx > INT16_MAX || dy < INT16_MIN || dy > INT16_MAX) {
+                map->overflow = 1;
+                break;
+            }
+            entries[x].dx = (int16_t)dx;
+            entries[x].dy = (int16_t)dy;
+        }
+    }
+
+    free(u);
+    return map;
+}
+
+// frees a map (NULL is ignored)
+static void releaseDisplacementMap(DisplacementMap *map, const MilkyAllocator *allocator) {
+    if (map) reallocateWith(allocator, map, 0);
+}
+
+// builds the requested maps of a context (the argument is its DisplaceState)
+static void *runDisplacementWorker(void *argument) {
+    DisplaceState *state = (DisplaceState *)argument;
+
+    pthread_mutex_lock(&state->lock);
+    for (;;) {
+        while (!state->requested && !state->stopping) {
+            pthread_cond_wait(&state->wake, &state->lock);
+        }
+        if (state->stopping) break;
+
+        DisplacementRequest request = state->request;
+        state->requested = 0;
+        pthread_mutex_unlock(&state->lock);
+
+        // built outside the lock; a newer request just queues up behind it
+        DisplacementMap *map = buildDisplacementMap(&request, state->allocator);
+        if (map) {
+            releaseDisplacementMap(__atomic_exchange_n(&state->finished, map, __ATOMIC_ACQ_REL), state->allocator);
+        }
+
+        pthread_mutex_lock(&state->lock);
+    }
+    pthread_mutex_unlock(&state->lock);
+    return NULL;
+}
+
+/**
+ * Hands a motion to the worker thread (started on first use).
+ *
+ * @return 1 if the worker got the request, 0 if it couldn't be started.
+ */
+static int requestDisplacementMap(MilkyContext *context, const WarpParameters *parameters, size_t width, size_t height) {
+    pthread_mutex_lock(&context->displace.lock);
+    if (!context->displace.started) {
+        context->displace.stopping = 0;
+        if (pthread_create(&context->displace.thread, NULL, runDisplacementWorker, &context->displace) != 0) {
+            pthread_mutex_unlock(&context->displace.lock);
+            fprintf(stderr, "Failed to start the displacement map worker thread\n");
+            return 0;
+        }
+        context->displace.started = 1;
+    }
+
+    context->displace.request.parameters = *parameters;
+    context->displace.request.width = width;
+    context->displace.request.height = height;
+    context->displace.requested = 1;
+    pthread_cond_signal(&context->displace.wake);
+    pthread_mutex_unlock(&context->displace.lock);
+    return 1;
+}
+
+/**
+ * Returns the displacement map of a motion: a table with the source offset and the
+ * bilinear weights of every pixel, so the feedback transform of a frame is a pure
+ * gather (see applyDisplacementMap()). Maps are built asynchronously on a worker
+ * thread when the motion or the canvas size changes; until the new one is ready,
+ * NULL is returned and the caller falls back to the warp mesh, so a preset change
+ * never stalls a frame. A motion whose map overflows keeps returning NULL, so its
+ * frames stay on the warp mesh. Cheap when nothing changed (call it every frame).
+ *
+ * @param parameters The motion (static: the animated warp is frozen).
+ * @param width      The canvas width in pixels (at least 2).
+ * @param height     The canvas height in pixels (at least 2).
+ * @return           The map, or NULL if it isn't ready (yet).
+ */
+const DisplacementMap *prepareDisplacementMap(MilkyContext *context, const WarpParameters *parameters, size_t width, size_t height) {
+    if (width < 2 || height < 2) return NULL;
+
+    if (!context->displace.hasRequest || !isSameDisplacementRequest(&context->displace.lastRequest, parameters, width, height)) {
+        if (!requestDisplacementMap(context, parameters, width, height)) return NULL;
+        context->displace.lastRequest.parameters = *parameters;
+        context->displace.lastRequest.width = width;
+        context->displace.lastRequest.height = height;
+        context->displace.hasRequest = 1;
+    }
+
+    // pick up a finished map (only between frames, so the active one is never in use)
+    if (__atomic_load_n(&context->displace.finished, __ATOMIC_RELAXED)) {
+        DisplacementMap *finished = __atomic_exchange_n(&context->displace.finished, NULL, __ATOMIC_ACQ_REL);
+        if (finished) {
+            releaseDisplacementMap(context->displace.active, context->displace.allocator);
+            context->displace.active = finished;
+        }
+    }
+
+    const DisplacementMap *map = context->displace.active;
+    return map && !map->overflow && map->width == width && map->height == height
+        && memcmp(&map->parameters, parameters, sizeof(WarpParameters)) == 0 ? map : NULL;
+}
+
+/**
+ * Blends four pixels with 4-bit bilinear weights, two channels per 32-bit multiply
+ * (red / blue and green / alpha; 255 * 256 still fits into each 16-bit half).
+ *
+ * @param p00 Top-left pixel (RGBA packed into 32 bits).
+ * @param p01 Top-right pixel.
+ * @param p10 Bottom-left pixel.
+ * @param p11 Bottom-right pixel.
+ * @param fx  Horizontal weight of the right pixels [0, 15].
+ * @param fy  Vertical weight of the bottom pixels [0, 15].
+ * @return    The blended pixel.
+ */
+static inline uint32_t blendDisplaced(uint32_t p00, uint32_t p01, uint32_t p10, uint32_t p11, uint32_t fx, uint32_t fy) {
+    const uint32_t w00 = (16 - fx) * (16 - fy), w01 = fx * (16 - fy);
+    const uint32_t w10 = (16 - fx) * fy, w11 = fx * fy;
+
+    const uint32_t redBlue = (p00 & 0x00FF00FF) * w00 + (p01 & 0x00FF00FF) * w01
+                           + (p10 & 0x00FF00FF) * w10 + (p11 & 0x00FF00FF) * w11;
+    const uint32_t greenAlpha = ((p00 >> 8) & 0x00FF00FF) * w00 + ((p01 >> 8) & 0x00FF00FF) * w01
+                              + ((p10 >> 8) & 0x00FF00FF) * w10 + ((p11 >> 8) & 0x00FF00FF) * w11;
+    return ((redBlue >> 8) & 0x00FF00FF) | (greenAlpha & 0xFF00FF00);
+}
+
+#if defined(__AVX2__)
+// weighted sum of four pixels for eight pixels at once (see blendDisplaced())
+static inline __m256i blendDisplacedAVX2(__m256i p00, __m256i p01, __m256i p10, __m256i p11, __m256i fx, __m256i fy) {
+    const __m256i sixteen = _mm256_set1_epi32(16);
+    const __m256i mask = _mm256_set1_epi32(0x00FF00FF);
+    const __m256i inverseX = _mm256_sub_epi32(sixteen, fx), inverseY = _mm256_sub_epi32(sixteen, fy);
+
+    // weights <= 256, repeated in both 16-bit halves of a lane
+    __m256i w00 = _mm256_mullo_epi16(inverseX, inverseY), w01 = _mm256_mullo_epi16(fx, inverseY);
+    __m256i w10 = _mm256_mullo_epi16(inverseX, fy), w11 = _mm256_mullo_epi16(fx, fy);
+    w00 = _mm256_or_si256(w00, _mm256_slli_epi32(w00, 16));
+    w01 = _mm256_or_si256(w01, _mm256_slli_epi32(w01, 16));
+    w10 = _mm256_or_si256(w10, _mm256_slli_epi32(w10, 16));
+    w11 = _mm256_or_si256(w11, _mm256_slli_epi32(w11, 16));
+
+    __m256i redBlue = _mm256_add_epi16(
+        _mm256_add_epi16(_mm256_mullo_epi16(_mm256_and_si256(p00, mask), w00), _mm256_mullo_epi16(_mm256_and_si256(p01, mask), w01)),
+        _mm256_add_epi16(_mm256_mullo_epi16(_mm256_and_si256(p10, mask), w10), _mm256_mullo_epi16(_mm256_and_si256(p11, mask), w11)));
+    __m256i greenAlpha = _mm256_add_epi16(
+        _mm256_add_epi16(_mm256_mullo_epi16(_mm256_and_si256(_mm256_srli_epi32(p00, 8), mask), w00),
+                         _mm256_mullo_epi16(_mm256_and_si256(_mm256_srli_epi32(p01, 8), mask), w01)),
+        _mm256_add_epi16(_mm256_mullo_epi16(_mm256_and_si256(_mm256_srli_epi32(p10, 8), mask), w10),
+                         _mm256_mullo_epi16(_mm256_and_si256(_mm256_srli_epi32(p11, 8), mask), w11)));
+    return _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(redBlue, 8), mask), _mm256_andnot_si256(mask, greenAlpha));
+}
+#endif
+
+/**
+ * Transforms a frame with a displacement map: one table read and one bilinear
+ * gather per pixel, no arithmetic that depends on the motion (with AVX2, eight
+ * pixels per step with hardware gathers).
+ *
+ * @param map         The map (from prepareDisplacementMap(), for the size of the frames).
+ * @param destination The transformed frame (RGBA format, must not overlap the source).
+ * @param source      The frame to transform.
+ */
+void applyDisplacementMap(const DisplacementMap *map, uint8_t *destination, const uint8_t *source) {
+    const size_t width = map->width, height = map->height;
+    const uint32_t *pixels = (const uint32_t *)source;
+
+    #pragma omp parallel for schedule(static)
+    for (int y = 0; y < (int)height; y++) {
+        const DisplacementEntry *entries = &map->entries[(size_t)y * width];
+        const int32_t rowY = (int32_t)((uint32_t)y << MILKY_DISPLACE_SUBPIXEL_BITS);
+        uint32_t *row = (uint32_t *)&destination[(size_t)y * width * 4];
+        size_t x = 0;
+
+#if defined(__AVX2__)
+        const __m256i fraction = _mm256_set1_epi32((1 << MILKY_DISPLACE_SUBPIXEL_BITS) - 1);
+        const __m256i lastColumn = _mm256_set1_epi32((int)width - 1), lastRow = _mm256_set1_epi32((int)height - 1);
+        const __m256i rowStride = _mm256_set1_epi32((int)width);
+        const __m256i columns = _mm256_slli_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), MILKY_DISPLACE_SUBPIXEL_BITS);
+        const __m256i rows = _mm256_set1_epi32(rowY);
+
+        for (; x + 8 <= width; x += 8) {
+            // eight entries: dx in the low, dy in the high 16 bits of each lane
+            const __m256i offsets = _mm256_loadu_si256((const __m256i *)&entries[x]);
+            const __m256i dx = _mm256_srai_epi32(_mm256_slli_epi32(offsets, 16), 16), dy = _mm256_srai_epi32(offsets, 16);
+            const __m256i sourceX = _mm256_add_epi32(_mm256_add_epi32(columns, _mm256_set1_epi32((int)(x << MILKY_DISPLACE_SUBPIXEL_BITS))), dx);
+            const __m256i sourceY = _mm256_add_epi32(rows, dy);
+
+            const __m256i column = _mm256_srli_epi32(sourceX, MILKY_DISPLACE_SUBPIXEL_BITS);
+            const __m256i line = _mm256_srli_epi32(sourceY, MILKY_DISPLACE_SUBPIXEL_BITS);
+            const __m256i topLeft = _mm256_add_epi32(_mm256_mullo_epi32(line, rowStride), column);
+            // on the last column / row the weight of the missing neighbor is 0
+            const __m256i right = _mm256_srli_epi32(_mm256_cmpgt_epi32(lastColumn, column), 31);
+            const __m256i down = _mm256_and_si256(_mm256_cmpgt_epi32(lastRow, line), rowStride);
+            const __m256i bottomLeft = _mm256_add_epi32(topLeft, down);
+
+            const __m256i p00 = _mm256_i32gather_epi32((const int *)pixels, topLeft, 4);
+            const __m256i p01 = _mm256_i32gather_epi32((const int *)pixels, _mm256_add_epi32(topLeft, right), 4);
+            const __m256i p10 = _mm256_i32gather_epi32((const int *)pixels, bottomLeft, 4);
+            const __m256i p11 = _mm256_i32gather_epi32((const int *)pixels, _mm256_add_epi32(bottomLeft, right), 4);
+
+            _mm256_storeu_si256((__m256i *)&row[x], blendDisplacedAVX2(p00, p01, p10, p11,
+                _mm256_and_si256(sourceX, fraction), _mm256_and_si256(sourceY, fraction)));
+        }
+#endif
+
+        for (; x < width; x++) {
+            const uint32_t sourceX = (uint32_t)((int32_t)((uint32_t)x << MILKY_DISPLACE_SUBPIXEL_BITS) + entries[x].dx);
+            const uint32_t sourceY = (uint32_t)(rowY + entries[x].dy);
+            const size_t column = sourceX >> MILKY_DISPLACE_SUBPIXEL_BITS, line = sourceY >> MILKY_DISPLACE_SUBPIXEL_BITS;
+
+            const size_t topLeft = line * width + column;
+            const size_t right = column + 1 < width ? 1 : 0;
+            const size_t bottomLeft = topLeft + (line + 1 < height ? width : 0);
+            row[x] = blendDisplaced(pixels[topLeft], pixels[topLeft + right], pixels[bottomLeft], pixels[bottomLeft + right],
+                                    sourceX & ((1 << MILKY_DISPLACE_SUBPIXEL_BITS) - 1), sourceY & ((1 << MILKY_DISPLACE_SUBPIXEL_BITS) - 1));
+        }
+    }
+}
+
+/**
+ * Prepares the worker of a context (it starts with the first request). The maps are
+ * allocated with the context's allocator.
+ *
+ * @param context The context.
+ * @return        1 on success, 0 if the lock couldn't be created.
+ */
+int initializeDisplacementWorker(MilkyContext *context) {
+    context->displace.allocator = &context->options.allocator;
+    if (pthread_mutex_init(&context->displace.lock, NULL) != 0) return 0;
+    if (pthread_cond_init(&context->displace.wake, NULL) != 0) {
+        pthread_mutex_destroy(&context->displace.lock);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * Stops the worker thread of a context and releases all maps (safe to call
+ * if it never ran, but only once after initializeDisplacementWorker()).
+ */
+void destroyDisplacementWorker(MilkyContext *context) {
+    pthread_mutex_lock(&context->displace.lock);
+    int started = context->displace.started;
+    context->displace.stopping = 1;
+    pthread_cond_signal(&context->displace.wake);
+    pthread_mutex_unlock(&context->displace.lock);
+
+    if (started) pthread_join(context->displace.thread, NULL);
+    pthread_cond_destroy(&context->displace.wake);
+    pthread_mutex_destroy(&context->displace.lock);
+
+    context->displace.started = 0;
+    context->displace.requested = 0;
+    context->displace.hasRequest = 0;
+    releaseDisplacementMap(__atomic_exchange_n(&context->displace.finished, NULL, __ATOMIC_ACQ_REL), context->displace.allocator);
+    releaseDisplacementMap(context->displace.active, context->displace.allocator);
+    context->displace.active = NULL;
+}
@@ -0,0 +1,72 @@
+#ifndef DISPLACE_H
+#define DISPLACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <omp.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "./warp.h"
+#include "../allocator.h"
+
+#define MILKY_DISPLACE_SUBPIXEL_BITS 4 // source offsets are stored in 1/16 pixels (the bilinear weights)
+
+// source offset of one pixel in 1/16 pixels: offset >> 4 leads to the top-left source
+// pixel, the low 4 bits are the bilinear weight of its right (lower) neighbor
+typedef struct {
+    int16_t dx;
+    int16_t dy;
+} DisplacementEntry;
+
+// a precomputed per-pixel feedback transform (see prepareDisplacementMap())
+typedef struct {
+    WarpParameters parameters; // the motion the map was built for
+    size_t width;
+    size_t height;
+    int overflow;              // 1 if an offset didn't fit into an entry (the map isn't used)
+    DisplacementEntry entries[]; // width * height entries, row by row
+} DisplacementMap;
+
+// a map the worker is asked to build
+typedef struct {
+    WarpParameters parameters;
+    size_t width;
+    size_t height;
+} DisplacementRequest;
+
+// displacement maps of a context and the worker thread that builds them
+typedef struct {
+    const MilkyAllocator *allocator; // allocator of the maps (used by the worker, outside of frames)
+
+    // worker thread (the request and the flags are guarded by the lock)
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    int started;
+    int stopping;
+    int requested;
+    DisplacementRequest request;
+
+    // map finished by the worker and not picked up yet (accessed atomically)
+    DisplacementMap *finished;
+
+    // state of the render thread
+    DisplacementMap *active;
+    DisplacementRequest lastRequest;
+    int hasRequest;
+} DisplaceState;
+
+int initializeDisplacementWorker(MilkyContext *context);
+const DisplacementMap *prepareDisplacementMap(MilkyContext *context, const WarpParameters *parameters, size_t width, size_t height);
+void applyDisplacementMap(const DisplacementMap *map, uint8_t *destination, const uint8_t *source);
+void destroyDisplacementWorker(MilkyContext *context);
+
+#endif // DISPLACE_H
@@ -0,0 +1,225 @@
+#include "display.h"
+
+// present thread
+static pthread_t milky_displayThread;
+static int milky_displayRunning = 0; // accessed atomically
+static DisplayPresentFunction milky_displayPresent = NULL; // set while a thread is started (and not joined yet)
+static void *milky_displayUserData = NULL;
+
+// frame handoff: the render thread fills the back buffer, the present thread shows the
+// front buffer (both swap under the lock, so neither ever touches the other's buffer)
+static pthread_mutex_t milky_displayLock = PTHREAD_MUTEX_INITIALIZER;
+static uint8_t *milky_displayBack = NULL;
+static size_t milky_displayBackCapacity = 0;
+static size_t milky_displayBackWidth = 0;
+static size_t milky_displayBackHeight = 0;
+static DisplayMotion milky_displayBackMotion;
+static int milky_displayPending = 0;
+static double milky_displaySubmitTime = 0.0;
+static double milky_displayInterval = MILKY_DISPLAY_DEFAULT_INTERVAL;
+
+// state of the present thread
+static uint8_t *milky_displayFront = NULL;
+static size_t milky_displayFrontCapacity = 0;
+
+static double getDisplayTime(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+/**
+ * Returns a motion that leaves the image unchanged.
+ */
+DisplayMotion getStaticDisplayMotion(void) {
+    DisplayMotion motion = { 1.0f, 0.0f, 0.0f, 0.0f, 0.5f, 0.5f };
+    return motion;
+}
+
+/**
+ * Scales the motion of one CPU frame to a fraction of it: zoom is compounded, the
+ * rest is linear, so presenting phases 0 .. 1 between two frames lands where the
+ * next CPU frame continues.
+ *
+ * @param motion The motion of one CPU frame.
+ * @param phase  The fraction [0, 1].
+ * @return       The partial motion.
+ */
+DisplayMotion extrapolateDisplayMotion(const DisplayMotion *motion, float phase) {
+    DisplayMotion partial = *motion;
+    partial.zoom = motion->zoom > 0.0f ? powf(motion->zoom, phase) : 1.0f;
+    partial.rotation = motion->rotation * phase;
+    partial.dx = motion->dx * phase;
+    partial.dy = motion->dy * phase;
+    return partial;
+}
+
+static void *runDisplayThread(void *argument) {
+    (void)argument;
+
+    double frameTime = 0.0, interval = MILKY_DISPLAY_DEFAULT_INTERVAL, lastPresent = 0.0;
+    DisplayMotion motion = getStaticDisplayMotion();
+    size_t width = 0, height = 0;
+
+    while (__atomic_load_n(&milky_displayRunning, __ATOMIC_ACQUIRE)) {
+        DisplayPresentation presentation;
+        presentation.isNew = 0;
+
+        pthread_mutex_lock(&milky_displayLock);
+        if (milky_displayPending) {
+            uint8_t *front = milky_displayFront;
+            size_t frontCapacity = milky_displayFrontCapacity;
+            milky_displayFront = milky_displayBack;
+            milky_displayFrontCapacity = milky_displayBackCapacity;
+            milky_displayBack = front;
+            milky_displayBackCapacity = frontCapacity;
+
+            width = milky_displayBackWidth;
+            height = milky_displayBackHeight;
+            motion = milky_displayBackMotion;
+            frameTime = milky_displaySubmitTime;
+            interval = milky_displayInterval;
+            milky_displayPending = 0;
+            presentation.isNew = 1;
+        }
+        pthread_mutex_unlock(&milky_displayLock);
+
+        if (!milky_displayFront) {
+            // nothing rendered yet
+            struct timespec wait = { 0, 1000000L };
+            nanosleep(&wait, NULL);
+            continue;
+        }
+
+        double now = getDisplayTime();
+        float phase = (float)((now - frameTime) / interval);
+        if (phase < 0.0f) phase = 0.0f;
+        if (phase > 1.0f) phase = 1.0f;
+
+        presentation.pixels = milky_displayFront;
+        presentation.width = width;
+        presentation.height = height;
+        presentation.phase = phase;
+        presentation.motion = extrapolateDisplayMotion(&motion, phase);
+        if (!milky_displayPresent(&presentation, milky_displayUserData)) break;
+
+        // don't spin if the swap doesn't wait for the display refresh
+        now = getDisplayTime();
+        if (now - lastPresent < MILKY_DISPLAY_MIN_PRESENT_INTERVAL) {
+            double rest = MILKY_DISPLAY_MIN_PRESENT_INTERVAL - (now - lastPresent);
+            struct timespec wait = { 0, (long)(rest * 1e9) };
+            nanosleep(&wait, NULL);
+            now = getDisplayTime();
+        }
+        lastPresent = now;
+    }
+
+    __atomic_store_n(&milky_displayRunning, 0, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+/**
+ * Starts the present thread: it shows the newest CPU frame on every display refresh
+ * and, between two CPU frames, hands the present function the frame's motion
+ * extrapolated to the time that passed, so motion looks as smooth as the refresh
+ * rate allows without rendering more CPU frames.
+ *
+ * @param present  Shows a presentation and waits for vsync (runs on the present thread).
+ * @param userData Passed to present.
+ * @return         1 on success, 0 if the thread can't be started.
+ */
+int startDisplayThread(DisplayPresentFunction present, void *userData) {
+    if (__atomic_load_n(&milky_displayRunning, __ATOMIC_ACQUIRE)) return 1;
+
+    // a thread that stopped on its own (present returned 0) is joined before it's replaced
+    if (milky_displayPresent) {
+        pthread_join(milky_displayThread, NULL);
+        milky_displayPresent = NULL;
+    }
+
+    milky_displayPresent = present;
+    milky_displayUserData = userData;
+    __atomic_store_n(&milky_displayRunning, 1, __ATOMIC_RELEASE);
+    if (pthread_create(&milky_displayThread, NULL, runDisplayThread, NULL) != 0) {
+        fprintf(stderr, "Failed to start the display thread\n");
+        __atomic_store_n(&milky_displayRunning, 0, __ATOMIC_RELEASE);
+        milky_displayPresent = NULL; // no thread to join
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * Checks whether frames go through the present thread.
+ */
+int isDisplayThreadRunning(void) {
+    return __atomic_load_n(&milky_displayRunning, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * Hands a rendered frame to the present thread (copied, so the caller can render
+ * the next frame into the same buffer right away). Also measures the interval of
+ * the CPU frames that the extrapolation is based on.
+ *
+ * @param pixels The frame (RGBA format).
+ * @param width  Its width in pixels.
+ * @param height Its height in pixels.
+ * @param motion Motion of the feedback image per CPU frame (NULL = none).
+ */
+void submitDisplayFrame(const uint8_t *pixels, size_t width, size_t height, const DisplayMotion *motion) {
+    const size_t size = width * height * 4;
+    const double now = getDisplayTime();
+
+    pthread_mutex_lock(&milky_displayLock);
+    if (size > milky_displayBackCapacity) {
+        uint8_t *resized = (uint8_t *)realloc(milky_displayBack, size);
+        if (!resized) {
+            pthread_mutex_unlock(&milky_displayLock);
+            fprintf(stderr, "Failed to allocate the display buffer\n");
+            return;
+        }
+        milky_displayBack = resized;
+        milky_displayBackCapacity = size;
+    }
+    memcpy(milky_displayBack, pixels, size);
+    milky_displayBackWidth = width;
+    milky_displayBackHeight = height;
+    milky_displayBackMotion = motion ? *motion : getStaticDisplayMotion();
+
+    // smoothed interval of the CPU frames (bounded, so a stall doesn't freeze the extrapolation)
+    if (milky_displaySubmitTime > 0.0) {
+        double interval = now - milky_displaySubmitTime;
+        if (interval < 0.001) interval = 0.001;
+        if (interval > 0.2) interval = 0.2;
+        milky_displayInterval = milky_displayInterval * 0.8 + interval * 0.2;
+    }
+    milky_displaySubmitTime = now;
+    milky_displayPending = 1;
+    pthread_mutex_unlock(&milky_displayLock);
+}
+
+/**
+ * Stops the present thread and releases the frame buffers (safe to call if it
+ * never ran).
+ */
+void stopDisplayThread(void) {
+    __atomic_store_n(&milky_displayRunning, 0, __ATOMIC_RELEASE);
+    if (milky_displayPresent) {
+        // also joins a thread that stopped on its own (present returned 0)
+        pthread_join(milky_displayThread, NULL);
+        milky_displayPresent = NULL;
+    }
+
+    pthread_mutex_lock(&milky_displayLock);
+    free(milky_displayBack);
+    milky_displayBack = NULL;
+    milky_displayBackCapacity = 0;
+    milky_displayPending = 0;
+    milky_displaySubmitTime = 0.0;
+    milky_displayInterval = MILKY_DISPLAY_DEFAULT_INTERVAL;
+    pthread_mutex_unlock(&milky_displayLock);
+
+    free(milky_displayFront);
+    milky_displayFront = NULL;
+    milky_displayFrontCapacity = 0;
+}
@@ -0,0 +1,46 @@
+#ifndef DISPLAY_H
+#define DISPLAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+
+#define MILKY_DISPLAY_DEFAULT_INTERVAL 0.024 // seconds between CPU frames until measured (the render gate of capture.c)
+#define MILKY_DISPLAY_MIN_PRESENT_INTERVAL (1.0 / 240.0) // upper limit of the present rate if vsync isn't honored
+
+// motion of the feedback image per CPU frame (see WarpParameters), extrapolated between frames
+typedef struct {
+    float zoom;     // > 1 zooms in
+    float rotation; // radians around (centerX, centerY)
+    float dx;       // translation (fraction of the width)
+    float dy;       // translation (fraction of the height)
+    float centerX;  // center of the rotation [0, 1]
+    float centerY;
+} DisplayMotion;
+
+// what the present thread shows on one display refresh
+typedef struct {
+    const uint8_t *pixels; // the newest CPU frame (RGBA format)
+    size_t width;
+    size_t height;
+    int isNew;             // 1 if the frame changed since the last present (upload it)
+    float phase;           // time since the frame arrived, in CPU frame intervals [0, 1]
+    DisplayMotion motion;  // the frame's motion extrapolated by phase (no motion at phase 0)
+} DisplayPresentation;
+
+// shows one presentation and waits for the display refresh (vsync); returns 0 to stop the thread
+typedef int (*DisplayPresentFunction)(const DisplayPresentation *presentation, void *userData);
+
+DisplayMotion getStaticDisplayMotion(void);
+DisplayMotion extrapolateDisplayMotion(const DisplayMotion *motion, float phase);
+int startDisplayThread(DisplayPresentFunction present, void *userData);
+int isDisplayThreadRunning(void);
+void submitDisplayFrame(const uint8_t *pixels, size_t width, size_t height, const DisplayMotion *motion);
+void stopDisplayThread(void);
+
+#endif // DISPLAY_H
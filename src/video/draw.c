@@ -125,3 +125,422 @@ void drawLine(uint8_t *screen, size_t width, size_t height, int x0, int y0, int
     }
 }
 
+
+/**
+ * Brightens a horizontal run of pixels in one row to at least the given gray
+ * intensity (per-channel max, alpha forced to opaque). The run [x0, x1) is clipped
+ * to the row, so callers can pass unclipped coordinates.
+ *
+ * @param row       The first pixel of the row (RGBA format).
+ * @param width     The width of the row in pixels.
+ * @param x0        The first x-coordinate of the run (inclusive).
+ * @param x1        The last x-coordinate of the run (exclusive).
+ * @param intensity The gray level to blend in.
+ */
+void blendSpanMax(uint8_t *row, size_t width, int x0, int x1, uint8_t intensity) {
+    if (x0 < 0) x0 = 0;
+    if (x1 > (int)width) x1 = (int)width;
+    if (x1 <= x0 || intensity == 0) return;
+
+    uint8_t *pixels = &row[(size_t)x0 * 4];
+    const size_t count = (size_t)(x1 - x0);
+    const uint32_t color = (uint32_t)intensity | ((uint32_t)intensity << 8) | ((uint32_t)intensity << 16) | 0xFF000000u;
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    const __m256i value = _mm256_set1_epi32((int)color);
+    for (; i + 8 <= count; i += 8) {
+        __m256i *target = (__m256i *)&pixels[i * 4];
+        _mm256_storeu_si256(target, _mm256_max_epu8(_mm256_loadu_si256(target), value));
+    }
+#elif defined(__ARM_NEON__)
+    const uint8x16_t value = vreinterpretq_u8_u32(vdupq_n_u32(color));
+    for (; i + 4 <= count; i += 4) {
+        vst1q_u8(&pixels[i * 4], vmaxq_u8(vld1q_u8(&pixels[i * 4]), value));
+    }
+#endif
+
+    for (; i < count; i++) {
+        uint8_t *pixel = &pixels[i * 4];
+        pixel[0] = pixel[0] > intensity ? pixel[0] : intensity;
+        pixel[1] = pixel[1] > intensity ? pixel[1] : intensity;
+        pixel[2] = pixel[2] > intensity ? pixel[2] : intensity;
+        pixel[3] = 255;
+    }
+}
+
+/**
+ * Draws the rows [yStart, yEnd) of a filled disc as max-blended spans.
+ * Only one square root per row is needed; rows outside the disc are skipped.
+ *
+ * @param screen    The screen buffer to draw on (RGBA format).
+ * @param width     The width of the screen buffer in pixels.
+ * @param yStart    The first row that may be written (inclusive).
+ * @param yEnd      The last row that may be written (exclusive).
+ * @param centerX   The x-coordinate of the disc center.
+ * @param centerY   The y-coordinate of the disc center.
+ * @param radius    The radius of the disc in pixels.
+ * @param intensity The gray level to blend in.
+ */
+void drawDiscRows(uint8_t *screen, size_t width, size_t yStart, size_t yEnd, float centerX, float centerY, float radius, uint8_t intensity) {
+    int top = (int)floorf(centerY - radius);
+    int bottom = (int)ceilf(centerY + radius);
+    if (top < (int)yStart) top = (int)yStart;
+    if (bottom > (int)yEnd) bottom = (int)yEnd;
+
+    for (int y = top; y < bottom; y++) {
+        float dy = (float)y + 0.5f - centerY;
+        float squared = radius * radius - dy * dy;
+        if (squared <= 0.0f) continue;
+
+        float half = sqrtf(squared);
+        blendSpanMax(&screen[(size_t)y * width * 4], width, (int)lrintf(centerX - half), (int)lrintf(centerX + half), intensity);
+    }
+}
+
+/**
+ * Brightens the pixels [x0, x1) of a ring row by the ring's coverage of each
+ * pixel: the overlap of the pixel's radial footprint [d - 0.5, d + 0.5] with
+ * [innerRadius, outerRadius].
+ */
+static void blendRingCoverage(uint8_t *row, size_t width, int x0, int x1, float centerX, float dySquared,
+                              float innerRadius, float outerRadius, uint8_t intensity) {
+    if (x0 < 0) x0 = 0;
+    if (x1 > (int)width) x1 = (int)width;
+
+    for (int x = x0; x < x1; x++) {
+        float dx = (float)x + 0.5f - centerX;
+        float distance = sqrtf(dx * dx + dySquared);
+        float from = distance - 0.5f > innerRadius ? distance - 0.5f : innerRadius;
+        float to = distance + 0.5f < outerRadius ? distance + 0.5f : outerRadius;
+        if (to <= from) continue;
+
+        uint8_t value = (uint8_t)((float)intensity * (to - from > 1.0f ? 1.0f : to - from));
+        uint8_t *pixel = &row[(size_t)x * 4];
+        pixel[0] = pixel[0] > value ? pixel[0] : value;
+        pixel[1] = pixel[1] > value ? pixel[1] : value;
+        pixel[2] = pixel[2] > value ? pixel[2] : value;
+        pixel[3] = 255;
+    }
+}
+
+/**
+ * Draws the rows [yStart, yEnd) of an anti-aliased ring (annulus) as max-blended spans.
+ *
+ * Per row, the x-extents of the fully covered part and of the partially covered
+ * edges are computed analytically (a few square roots per row); the fully covered
+ * spans are SIMD span fills and only the edge pixels get a per-pixel coverage.
+ * The cost scales with the ring's area, not with the screen's.
+ *
+ * @param screen      The screen buffer to draw on (RGBA format).
+ * @param width       The width of the screen buffer in pixels.
+ * @param yStart      The first row that may be written (inclusive).
+ * @param yEnd        The last row that may be written (exclusive).
+ * @param centerX     The x-coordinate of the ring center.
+ * @param centerY     The y-coordinate of the ring center.
+ * @param innerRadius The inner radius of the ring in pixels.
+ * @param outerRadius The outer radius of the ring in pixels.
+ * @param intensity   The gray level to blend in.
+ */
+void drawRingRows(uint8_t *screen, size_t width, size_t yStart, size_t yEnd, float centerX, float centerY, float innerRadius, float outerRadius, uint8_t intensity) {
+    if (innerRadius < 0.0f) innerRadius = 0.0f;
+    if (outerRadius <= innerRadius) return;
+
+    int top = (int)floorf(centerY - outerRadius - 0.5f);
+    int bottom = (int)ceilf(centerY + outerRadius + 0.5f);
+    if (top < (int)yStart) top = (int)yStart;
+    if (bottom > (int)yEnd) bottom = (int)yEnd;
+
+    // squared radii bounding the partially and the fully covered pixels
+    const float edgeOuter = (outerRadius + 0.5f) * (outerRadius + 0.5f);
+    const float fullOuter = outerRadius > 0.5f ? (outerRadius - 0.5f) * (outerRadius - 0.5f) : 0.0f;
+    const float fullInner = (innerRadius + 0.5f) * (innerRadius + 0.5f);
+    const float edgeInner = innerRadius > 0.5f ? (innerRadius - 0.5f) * (innerRadius - 0.5f) : 0.0f;
+
+    for (int y = top; y < bottom; y++) {
+        float dy = (float)y + 0.5f - centerY;
+        float dySquared = dy * dy;
+        if (dySquared >= edgeOuter) continue;
+
+        // x-extents (relative to the center) of the ring's zones in this row
+        float xEdge = sqrtf(edgeOuter - dySquared);
+        float xFull = dySquared < fullOuter ? sqrtf(fullOuter - dySquared) : 0.0f;
+        float xInner = dySquared < fullInner ? sqrtf(fullInner - dySquared) : 0.0f;
+        float xHole = dySquared < edgeInner ? sqrtf(edgeInner - dySquared) : 0.0f;
+        if (xFull < xInner) xFull = xInner; // no fully covered pixels in this row
+
+        uint8_t *row = &screen[(size_t)y * width * 4];
+
+        // left half: outer edge, full span, inner edge
+        int fullStart = (int)floorf(centerX - xFull - 0.5f) + 1;
+        int fullEnd = (int)floorf(centerX - xInner - 0.5f) + 1;
+        blendRingCoverage(row, width, (int)floorf(centerX - xEdge - 0.5f), fullStart, centerX, dySquared, innerRadius, outerRadius, intensity);
+        blendSpanMax(row, width, fullStart, fullEnd, intensity);
+        blendRingCoverage(row, width, fullEnd, (int)floorf(centerX - xHole - 0.5f) + 2, centerX, dySquared, innerRadius, outerRadius, intensity);
+
+        // right half: inner edge, full span, outer edge
+        fullStart = (int)ceilf(centerX + xInner - 0.5f);
+        fullEnd = (int)ceilf(centerX + xFull - 0.5f);
+        blendRingCoverage(row, width, (int)ceilf(centerX + xHole - 0.5f) - 1, fullStart, centerX, dySquared, innerRadius, outerRadius, intensity);
+        blendSpanMax(row, width, fullStart, fullEnd, intensity);
+        blendRingCoverage(row, width, fullEnd, (int)ceilf(centerX + xEdge - 0.5f) + 1, centerX, dySquared, innerRadius, outerRadius, intensity);
+    }
+}
+
+// outcodes of the Cohen-Sutherland line clipper
+#define MILKY_CLIP_INSIDE 0
+#define MILKY_CLIP_LEFT 1
+#define MILKY_CLIP_RIGHT 2
+#define MILKY_CLIP_TOP 4
+#define MILKY_CLIP_BOTTOM 8
+
+static int computeClipCode(float x, float y, float xMin, float yMin, float xMax, float yMax) {
+    int code = MILKY_CLIP_INSIDE;
+    if (x < xMin) code |= MILKY_CLIP_LEFT;
+    else if (x > xMax) code |= MILKY_CLIP_RIGHT;
+    if (y < yMin) code |= MILKY_CLIP_TOP;
+    else if (y > yMax) code |= MILKY_CLIP_BOTTOM;
+    return code;
+}
+
+/**
+ Cohen-Sutherland line clipping.
+
+ Clips the segment (x0, y0) - (x1, y1) in place to the rectangle
+ [xMin, xMax] x [yMin, yMax].
+
+ @param x0   The x-coordinate of the starting point (updated).
+ @param y0   The y-coordinate of the starting point (updated).
+ @param x1   The x-coordinate of the ending point (updated).
+ @param y1   The y-coordinate of the ending point (updated).
+ @param xMin The left edge of the clip rectangle.
+ @param yMin The top edge of the clip rectangle.
+ @param xMax The right edge of the clip rectangle.
+ @param yMax The bottom edge of the clip rectangle.
+ @return     1 if a part of the segment is inside the rectangle, 0 otherwise.
+*/
+int clipLine(float *x0, float *y0, float *x1, float *y1, float xMin, float yMin, float xMax, float yMax) {
+    int code0 = computeClipCode(*x0, *y0, xMin, yMin, xMax, yMax);
+    int code1 = computeClipCode(*x1, *y1, xMin, yMin, xMax, yMax);
+
+    while (1) {
+        if (!(code0 | code1)) return 1; // both inside
+        if (code0 & code1) return 0;    // both on the same outer side
+
+        // move the outside point onto the clip edge
+        int code = code0 ? code0 : code1;
+        float x, y;
+        if (code & MILKY_CLIP_BOTTOM) {
+            x = *x0 + (*x1 - *x0) * (yMax - *y0) / (*y1 - *y0);
+            y = yMax;
+        } else if (code & MILKY_CLIP_TOP) {
+            x = *x0 + (*x1 - *x0) * (yMin - *y0) / (*y1 - *y0);
+            y = yMin;
+        } else if (code & MILKY_CLIP_RIGHT) {
+            y = *y0 + (*y1 - *y0) * (xMax - *x0) / (*x1 - *x0);
+            x = xMax;
+        } else {
+            y = *y0 + (*y1 - *y0) * (xMin - *x0) / (*x1 - *x0);
+            x = xMin;
+        }
+
+        if (code == code0) {
+            *x0 = x;
+            *y0 = y;
+            code0 = computeClipCode(x, y, xMin, yMin, xMax, yMax);
+        } else {
+            *x1 = x;
+            *y1 = y;
+            code1 = computeClipCode(x, y, xMin, yMin, xMax, yMax);
+        }
+    }
+}
+
+/**
+ * Computes the x-interval of a row inside a capsule (all points within `radius`
+ * of the segment). The capsule is convex, so the interval is the hull of the
+ * intervals of its two end discs and its body.
+ *
+ * @return 1 if the row intersects the capsule (interval in *left, *right), 0 otherwise.
+ */
+static int intersectCapsuleRow(float py, float x0, float y0, float x1, float y1,
+                               float dirX, float dirY, float length, float radius, float *left, float *right) {
+    float low = 1e30f, high = -1e30f;
+    const float radiusSquared = radius * radius;
+
+    // end discs (round caps)
+    float dy0 = py - y0;
+    if (dy0 * dy0 < radiusSquared) {
+        float half = sqrtf(radiusSquared - dy0 * dy0);
+        low = fminf(low, x0 - half);
+        high = fmaxf(high, x0 + half);
+    }
+    float dy1 = py - y1;
+    if (dy1 * dy1 < radiusSquared) {
+        float half = sqrtf(radiusSquared - dy1 * dy1);
+        low = fminf(low, x1 - half);
+        high = fmaxf(high, x1 + half);
+    }
+
+    // body: perpendicular distance <= radius and projection within [0, length]
+    if (length > 0.0f) {
+        float bodyLow = -1e30f, bodyHigh = 1e30f;
+        // normal (-dirY, dirX): |(x - x0) * -dirY + dy0 * dirX| <= radius
+        if (fabsf(dirY) > 1e-6f) {
+            float a = (dy0 * dirX - radius) / dirY + x0;
+            float b = (dy0 * dirX + radius) / dirY + x0;
+            bodyLow = fmaxf(bodyLow, fminf(a, b));
+            bodyHigh = fminf(bodyHigh, fmaxf(a, b));
+        } else if (fabsf(dy0) > radius) {
+            bodyHigh = bodyLow - 1.0f;
+        }
+        // tangent: 0 <= (x - x0) * dirX + dy0 * dirY <= length
+        if (fabsf(dirX) > 1e-6f) {
+            float a = -dy0 * dirY / dirX + x0;
+            float b = (length - dy0 * dirY) / dirX + x0;
+            bodyLow = fmaxf(bodyLow, fminf(a, b));
+            bodyHigh = fminf(bodyHigh, fmaxf(a, b));
+        } else if (dy0 * dirY < 0.0f || dy0 * dirY > length) {
+            bodyHigh = bodyLow - 1.0f;
+        }
+        if (bodyLow <= bodyHigh) {
+            low = fminf(low, bodyLow);
+            high = fmaxf(high, bodyHigh);
+        }
+    }
+
+    *left = low;
+    *right = high;
+    return low <= high;
+}
+
+/**
+ * Brightens the pixels [xFrom, xTo) of a row by the capsule's coverage of each
+ * pixel (the overlap of the pixel's footprint [d - 0.5, d + 0.5] with [-r, r],
+ * where d is the distance of the pixel center from the segment).
+ */
+static void blendCapsuleCoverage(uint8_t *row, size_t width, int xFrom, int xTo, float py, float x0, float y0,
+                                 float dirX, float dirY, float length, float radius, uint8_t intensity) {
+    if (xFrom < 0) xFrom = 0;
+    if (xTo > (int)width) xTo = (int)width;
+
+    for (int x = xFrom; x < xTo; x++) {
+        float px = (float)x + 0.5f - x0;
+        float qy = py - y0;
+        float t = px * dirX + qy * dirY;
+        t = t < 0.0f ? 0.0f : (t > length ? length : t);
+        float ex = px - t * dirX;
+        float ey = qy - t * dirY;
+        float distance = sqrtf(ex * ex + ey * ey);
+
+        float from = distance - 0.5f > -radius ? distance - 0.5f : -radius;
+        float to = distance + 0.5f < radius ? distance + 0.5f : radius;
+        if (to <= from) continue;
+
+        uint8_t value = (uint8_t)((float)intensity * (to - from > 1.0f ? 1.0f : to - from));
+        uint8_t *pixel = &row[(size_t)x * 4];
+        pixel[0] = pixel[0] > value ? pixel[0] : value;
+        pixel[1] = pixel[1] > value ? pixel[1] : value;
+        pixel[2] = pixel[2] > value ? pixel[2] : value;
+        pixel[3] = 255;
+    }
+}
+
+/**
+ * Draws the rows [yStart, yEnd) of a thick anti-aliased line with round caps
+ * (a capsule) as max-blended spans.
+ *
+ * Per row, the x-interval of the capsule grown by half a pixel (any coverage) and
+ * shrunk by half a pixel (full coverage) are computed analytically; the fully
+ * covered interval is one SIMD span fill and only the pixels in between get a
+ * per-pixel coverage. Max-blending makes consecutive segments of a polyline join
+ * with round joins without double-brightening the overlap.
+ * The segment is expected to be clipped already (see drawThickLine()).
+ *
+ * @param screen    The screen buffer to draw on (RGBA format).
+ * @param width     The width of the screen buffer in pixels.
+ * @param yStart    The first row that may be written (inclusive).
+ * @param yEnd      The last row that may be written (exclusive).
+ * @param x0        The x-coordinate of the starting point.
+ * @param y0        The y-coordinate of the starting point.
+ * @param x1        The x-coordinate of the ending point.
+ * @param y1        The y-coordinate of the ending point.
+ * @param thickness The line thickness in pixels.
+ * @param intensity The gray level to blend in.
+ */
+void drawThickLineRows(uint8_t *screen, size_t width, size_t yStart, size_t yEnd, float x0, float y0, float x1, float y1, float thickness, uint8_t intensity) {
+    const float radius = thickness * 0.5f;
+    const float dx = x1 - x0;
+    const float dy = y1 - y0;
+    const float length = sqrtf(dx * dx + dy * dy);
+    const float dirX = length > 0.0f ? dx / length : 1.0f;
+    const float dirY = length > 0.0f ? dy / length : 0.0f;
+
+    int top = (int)floorf(fminf(y0, y1) - radius - 0.5f);
+    int bottom = (int)ceilf(fmaxf(y0, y1) + radius + 0.5f);
+    if (top < (int)yStart) top = (int)yStart;
+    if (bottom > (int)yEnd) bottom = (int)yEnd;
+
+    for (int y = top; y < bottom; y++) {
+        const float py = (float)y + 0.5f;
+        float outerLeft, outerRight, innerLeft, innerRight;
+        if (!intersectCapsuleRow(py, x0, y0, x1, y1, dirX, dirY, length, radius + 0.5f, &outerLeft, &outerRight)) continue;
+
+        uint8_t *row = &screen[(size_t)y * width * 4];
+        int from = (int)floorf(outerLeft - 0.5f);
+        int to = (int)ceilf(outerRight - 0.5f) + 1;
+
+        if (radius > 0.5f && intersectCapsuleRow(py, x0, y0, x1, y1, dirX, dirY, length, radius - 0.5f, &innerLeft, &innerRight)) {
+            // pixel centers inside the shrunken capsule are fully covered
+            int fullStart = (int)ceilf(innerLeft - 0.5f);
+            int fullEnd = (int)floorf(innerRight - 0.5f) + 1;
+            if (fullEnd > fullStart) {
+                blendCapsuleCoverage(row, width, from, fullStart, py, x0, y0, dirX, dirY, length, radius, intensity);
+                blendSpanMax(row, width, fullStart, fullEnd, intensity);
+                blendCapsuleCoverage(row, width, fullEnd, to, py, x0, y0, dirX, dirY, length, radius, intensity);
+                continue;
+            }
+        }
+        blendCapsuleCoverage(row, width, from, to, py, x0, y0, dirX, dirY, length, radius, intensity);
+    }
+}
+
+/**
+ * Draws a thick anti-aliased line with round caps. The segment is clipped once
+ * (Cohen-Sutherland) to the canvas grown by the line's radius.
+ *
+ * @param screen    The screen buffer to draw on (RGBA format).
+ * @param width     The width of the screen buffer in pixels.
+ * @param height    The height of the screen buffer in pixels.
+ * @param x0        The x-coordinate of the starting point.
+ * @param y0        The y-coordinate of the starting point.
+ * @param x1        The x-coordinate of the ending point.
+ * @param y1        The y-coordinate of the ending point.
+ * @param thickness The line thickness in pixels.
+ * @param intensity The gray level to blend in.
+ */
+void drawThickLine(uint8_t *screen, size_t width, size_t height, float x0, float y0, float x1, float y1, float thickness, uint8_t intensity) {
+    const float margin = thickness * 0.5f + 1.0f;
+    if (!clipLine(&x0, &y0, &x1, &y1, -margin, -margin, (float)width + margin, (float)height + margin)) return;
+    drawThickLineRows(screen, width, 0, height, x0, y0, x1, y1, thickness, intensity);
+}
+
+/**
+ * Draws a thick anti-aliased polyline with round joins and caps.
+ *
+ * @param screen     The screen buffer to draw on (RGBA format).
+ * @param width      The width of the screen buffer in pixels.
+ * @param height     The height of the screen buffer in pixels.
+ * @param points     The vertices as interleaved x, y coordinates.
+ * @param pointCount The number of vertices.
+ * @param thickness  The line thickness in pixels.
+ * @param intensity  The gray level to blend in.
+ */
+void drawThickPolyline(uint8_t *screen, size_t width, size_t height, const float *points, size_t pointCount, float thickness, uint8_t intensity) {
+    if (pointCount == 1) {
+        drawThickLine(screen, width, height, points[0], points[1], points[0], points[1], thickness, intensity);
+    }
+    for (size_t i = 1; i < pointCount; i++) {
+        drawThickLine(screen, width, height, points[2 * i - 2], points[2 * i - 1], points[2 * i], points[2 * i + 1], thickness, intensity);
+    }
+}
@@ -8,9 +8,24 @@
 #include <string.h>
 #include <omp.h>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#ifdef __ARM_NEON__
+#include <arm_neon.h>
+#endif
+
 void clearFrame(uint8_t *frame, size_t frameSize);
 void setPixel(uint8_t *frame, size_t canvasWidthPx, size_t canvasHeightPx,
               int x, int y, uint8_t srcR, uint8_t srcG, uint8_t srcB, uint8_t srcA);
 void drawLine(uint8_t *frame, size_t width, size_t height, int x0, int y0, int x1, int y1, uint8_t r, uint8_t g, uint8_t b, uint8_t a);
+void blendSpanMax(uint8_t *row, size_t width, int x0, int x1, uint8_t intensity);
+void drawRingRows(uint8_t *screen, size_t width, size_t yStart, size_t yEnd, float centerX, float centerY, float innerRadius, float outerRadius, uint8_t intensity);
+int clipLine(float *x0, float *y0, float *x1, float *y1, float xMin, float yMin, float xMax, float yMax);
+void drawThickLineRows(uint8_t *screen, size_t width, size_t yStart, size_t yEnd, float x0, float y0, float x1, float y1, float thickness, uint8_t intensity);
+void drawThickLine(uint8_t *screen, size_t width, size_t height, float x0, float y0, float x1, float y1, float thickness, uint8_t intensity);
+void drawThickPolyline(uint8_t *screen, size_t width, size_t height, const float *points, size_t pointCount, float thickness, uint8_t intensity);
+void drawDiscRows(uint8_t *screen, size_t width, size_t yStart, size_t yEnd, float centerX, float centerY, float radius, uint8_t intensity);
 
 #endif // DRAW_H
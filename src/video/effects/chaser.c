@@ -1,34 +1,56 @@
 #include "chaser.h"
+#include "../../context.h"
 
-// structure to represent a chaser, which is a moving point on the screen
-typedef struct {
-    float coeff1; // coefficient for x-axis movement calculation
-    float coeff2; // coefficient for x-axis movement calculation
-    float coeff3; // coefficient for y-axis movement calculation
-    float coeff4; // coefficient for y-axis movement calculation
-    float pathLengthX; // length of the path on the x-axis
-    float pathLengthY; // length of the path on the y-axis
-    int prevX; // previous x-coordinate of the chaser
-    int prevY; // previous y-coordinate of the chaser
-} Chaser;
-
-// array to store the chasers (precomputed coefficients, path lenghts, position cache), limited to MAX_CHASERS
-static Chaser chasers[MILKY_MAX_CHASERS];
-
-// variables to track the last known canvas dimensions
-// used to determine if the chasers need reinitialization
-// this is necessary on sudden canvas size changes
-static size_t lastWidth = 0;
-static size_t lastHeight = 0;
+/**
+ Calculates the position of a chaser at a given animation time
+ (two superimposed cosine oscillations per axis around the canvas center).
+
+ @param chaser The chaser.
+ @param time   The animation time of the chaser.
+ @param width  The width of the screen buffer in pixels.
+ @param height The height of the screen buffer in pixels.
+ @param x      Receives the x-coordinate.
+ @param y      Receives the y-coordinate.
+*/
+static void calculateChaserPosition(const Chaser *chaser, float time, size_t width, size_t height, float *x, float *y) {
+    *x = (float)(width / 2) + chaser->pathLengthX * (cosf(time * 0.1102f * chaser->coeff1 + 10.0f)
+                + cosf(time * 0.1312f * chaser->coeff2 + 20.0f));
+    *y = (float)(height / 2) + chaser->pathLengthY * (cosf(time * 0.1204f * chaser->coeff3 + 40.0f)
+                + cosf(time * 0.1715f * chaser->coeff4 + 30.0f));
+}
+
+/**
+ Rescales the chasers' paths and previous positions to a new canvas size, so a resize keeps
+ their motion (and random coefficients) instead of starting over.
+
+ @param oldWidth  The previous width of the canvas in pixels.
+ @param oldHeight The previous height of the canvas in pixels.
+ @param width     The new width of the canvas in pixels.
+ @param height    The new height of the canvas in pixels.
+*/
+static void resizeChasers(MilkyContext *context, size_t oldWidth, size_t oldHeight, size_t width, size_t height) {
+    const float scaleX = (float)width / (float)oldWidth;
+    const float scaleY = (float)height / (float)oldHeight;
+
+    for (unsigned int k = 0; k < MILKY_MAX_CHASERS; k++) {
+        context->chaser.chasers[k].pathLengthX *= scaleX;
+        context->chaser.chasers[k].pathLengthY *= scaleY;
+        context->chaser.chasers[k].prevX = (float)(width / 2) + (context->chaser.chasers[k].prevX - (float)(oldWidth / 2)) * scaleX;
+        context->chaser.chasers[k].prevY = (float)(height / 2) + (context->chaser.chasers[k].prevY - (float)(oldHeight / 2)) * scaleY;
+    }
+}
 
 /**
  Renders a set of "chasers" on a screen buffer. 
 
  Each chaser is a moving point that leaves a trail as it moves across the screen. 
  The function takes into account the current time frame, speed, and the number of chasers to render. 
- It also ensures that the chasers are reinitialized if the canvas size changes. 
- For each chaser, it calculates a new position based on trigonometric functions to create a smooth and varied movement pattern. t
- The new position is then used to draw a line from the chaser's previous position to its new position on the screen buffer. 
+ It also rescales the chasers if the canvas size changes. 
+ For each chaser, it calculates a new position based on trigonometric functions to create a smooth and varied movement pattern.
+ The path travelled since the previous frame is sampled into a polyline (one vertex per
+ MILKY_CHASER_SUBSTEP_LENGTH pixels), so fast chasers draw curved trails instead of straight chords,
+ and queued as a thick anti-aliased polyline with round joins and caps; all trails are then
+ rasterized in parallel by screen bands (see flushRasterBatch()).
  The previous position is updated for the next frame.
 
  @param timeFrame The current time frame for animation (used to create variation in chaser movement).
@@ -37,74 +59,68 @@ static size_t lastHeight = 0;
  @param count     The number of chasers to render.
  @param width     The width of the screen buffer in pixels.
  @param height    The height of the screen buffer in pixels.
- @param seed      The seed value for random number generation (used to ensure reproducibility).
+ @param thickness The minimum thickness of the trails in pixels.
 */
-void renderChasers(float timeFrame, uint8_t *screen, float speed, unsigned int count, size_t width, size_t height, unsigned int seed, int thickness) {
-    
-    // Parallel region to encompass all parallel work
-    #pragma omp parallel
-    {
-        // Single thread handles reinitialization to prevent multiple initializations
-        #pragma omp single nowait
-        {
-            // Reinitialize chasers if canvas size changes
-            if (lastWidth != width || lastHeight != height) {
-                initializeChasers(count, width, height, seed);
-                lastWidth = width;
-                lastHeight = height;
-            }
-        }
+void renderChasers(MilkyContext *context, float timeFrame, uint8_t *screen, float speed, unsigned int count, size_t width, size_t height, int thickness) {
+    if (count > MILKY_MAX_CHASERS) count = MILKY_MAX_CHASERS;
+
+    // Initialize the chasers once; later canvas size changes only rescale their paths
+    if (context->chaser.lastWidth == 0 || context->chaser.lastHeight == 0) {
+        initializeChasers(context, count, width, height);
+        context->chaser.lastWidth = width;
+        context->chaser.lastHeight = height;
+    } else if (context->chaser.lastWidth != width || context->chaser.lastHeight != height) {
+        resizeChasers(context, context->chaser.lastWidth, context->chaser.lastHeight, width, height);
+        context->chaser.lastWidth = width;
+        context->chaser.lastHeight = height;
+    }
 
-        // Scaling the thickness of chasers so that on larger resolutions, they won't be tiny
-        // Compute scaled_thickness once per thread
-        float scaled_thickness = fmaxf((float)thickness, (float)(width + height) * 0.002f); 
-        int int_scaled_thickness = (int)scaled_thickness;
-
-        // Parallelize the chaser loop
-        #pragma omp for schedule(static)
-        for (unsigned int k = 0; k < count; k++) {
-            Chaser *chaser = &chasers[k];
-
-            // Update frame for this chaser to create variation
-            float chaserTimeFrame = (timeFrame * speed + (float)k) * 50.0f;
-
-            // Calculate new position using trigonometric functions for smooth movement
-            int x1 = (int)(width / 2 + chaser->pathLengthX * (cosf(chaserTimeFrame * 0.1102f * chaser->coeff1 + 10.0f) 
-                        + cosf(chaserTimeFrame * 0.1312f * chaser->coeff2 + 20.0f)));
-            int y1 = (int)(height / 2 + chaser->pathLengthY * (cosf(chaserTimeFrame * 0.1204f * chaser->coeff3 + 40.0f) 
-                        + cosf(chaserTimeFrame * 0.1715f * chaser->coeff4 + 30.0f)));
-
-            // Ensure coordinates are within canvas bounds
-            x1 = (x1 < 0) ? 0 : (x1 >= (int)width ? (int)(width - 1) : x1);
-            y1 = (y1 < 0) ? 0 : (y1 >= (int)height ? (int)(height - 1) : y1);
-
-            // Draw line from previous position to new position with specified thickness
-            for (int offset = -int_scaled_thickness / 2; offset <= int_scaled_thickness / 2; offset++) {
-                // Draw the main line
-                drawLine(screen, width, height, chaser->prevX, chaser->prevY + offset, x1, y1 + offset, 
-                         MILKY_CHASER_INTENSITY, MILKY_CHASER_INTENSITY, MILKY_CHASER_INTENSITY, 255);
-
-                // Add antialiasing effect at the edges
-                if (offset == -int_scaled_thickness / 2 || offset == int_scaled_thickness / 2) {
-                    // Apply a lighter intensity for antialiasing
-                    drawLine(screen, width, height, chaser->prevX, chaser->prevY + offset - 1, x1, y1 + offset - 1, 
-                             MILKY_CHASER_INTENSITY, MILKY_CHASER_INTENSITY, MILKY_CHASER_INTENSITY, 127);
-                    drawLine(screen, width, height, chaser->prevX, chaser->prevY + offset + 1, x1, y1 + offset + 1, 
-                             MILKY_CHASER_INTENSITY, MILKY_CHASER_INTENSITY, MILKY_CHASER_INTENSITY, 127);
-                }
-            }
-
-            // Update previous position for the next frame
-            chaser->prevX = x1;
-            chaser->prevY = y1;
+    // Scaling the thickness of chasers so that on larger resolutions, they won't be tiny
+    float scaledThickness = fmaxf((float)thickness, (float)(width + height) * 0.002f);
+
+    // the trails are queued and rasterized band by band, so overlapping trails never
+    // race on the same pixels and the output doesn't depend on the thread count
+    beginRasterBatch(context, width, height);
+
+    for (unsigned int k = 0; k < count; k++) {
+        Chaser *chaser = &context->chaser.chasers[k];
+
+        // Update frame for this chaser to create variation
+        float chaserTimeFrame = (timeFrame * speed + (float)k) * 50.0f;
+
+        float x1, y1;
+        calculateChaserPosition(chaser, chaserTimeFrame, width, height, &x1, &y1);
+
+        // subdivide the path travelled since the last frame, depending on the distance covered
+        float distance = hypotf(x1 - chaser->prevX, y1 - chaser->prevY);
+        int substeps = isnan(chaser->prevTime) ? 1 : (int)(distance / MILKY_CHASER_SUBSTEP_LENGTH) + 1;
+        if (substeps > MILKY_CHASER_MAX_SUBSTEPS) substeps = MILKY_CHASER_MAX_SUBSTEPS;
+
+        float points[2 * (MILKY_CHASER_MAX_SUBSTEPS + 1)];
+        points[0] = chaser->prevX;
+        points[1] = chaser->prevY;
+        for (int step = 1; step < substeps; step++) {
+            float time = chaser->prevTime + (chaserTimeFrame - chaser->prevTime) * (float)step / (float)substeps;
+            calculateChaserPosition(chaser, time, width, height, &points[2 * step], &points[2 * step + 1]);
         }
+        points[2 * substeps] = x1;
+        points[2 * substeps + 1] = y1;
+
+        queueRasterPolyline(context, points, (size_t)substeps + 1, scaledThickness, MILKY_CHASER_INTENSITY);
+
+        // Update previous position for the next frame
+        chaser->prevX = x1;
+        chaser->prevY = y1;
+        chaser->prevTime = chaserTimeFrame;
     }
+
+    flushRasterBatch(context, screen);
 }
 
 /**
  Initializes an array of 'Chaser' structures with random coefficients and path lengths
- based on the given canvas dimensions. it seeds the random number generator with a specified seed
- to ensure reproducibility. Each chaser is assigned random coefficients that influence its movement
+ based on the given canvas dimensions. The numbers come from the random sequence of the context,
+ so the same seed gives the same chasers. Each chaser is assigned random coefficients that influence its movement
  pattern. the path length for each chaser is calculated as a percentage of the canvas size, ensuring
  that the chaser's movement is proportional to the canvas dimensions. Initially, all chasers are
  positioned at the center of the canvas.
@@ -112,25 +128,24 @@ void renderChasers(float timeFrame, uint8_t *screen, float speed, unsigned int c
  @param count  The number of chasers to initialize.
  @param width  The width of the canvas in pixels.
  @param height The height of the canvas in pixels.
- @param seed   The seed value for random number generation.
 */
-void initializeChasers(unsigned int count, size_t width, size_t height, unsigned int seed) {
-    srand(seed); // seed the random number generator for stable randomness
-
-    #pragma omp parallel for
-    for (int k = 0; k < count; k++) {
+void initializeChasers(MilkyContext *context, unsigned int count, size_t width, size_t height) {
+    // sequential on purpose: the numbers are drawn from one sequence, so a parallel loop
+    // would hand out the coefficients in a different order on every run
+    for (unsigned int k = 0; k < count; k++) {
         // generate random coefficients for the chasers
-        chasers[k].coeff1 = ((float)(rand() % 100)) * 0.01f;
-        chasers[k].coeff2 = ((float)(rand() % 100)) * 0.01f;
-        chasers[k].coeff3 = ((float)(rand() % 100)) * 0.01f;
-        chasers[k].coeff4 = ((float)(rand() % 100)) * 0.01f;
+        context->chaser.chasers[k].coeff1 = ((float)(nextContextRandom(context) % 100)) * 0.01f;
+        context->chaser.chasers[k].coeff2 = ((float)(nextContextRandom(context) % 100)) * 0.01f;
+        context->chaser.chasers[k].coeff3 = ((float)(nextContextRandom(context) % 100)) * 0.01f;
+        context->chaser.chasers[k].coeff4 = ((float)(nextContextRandom(context) % 100)) * 0.01f;
 
         // calculate the chaser path length as a percentage of the canvas size
-        chasers[k].pathLengthX = ((float)(rand() % 61 + 20)) * 0.01f * width / 4;  // 20% to 80% of width
-        chasers[k].pathLengthY = ((float)(rand() % 61 + 20)) * 0.01f * height / 4; // 20% to 80% of height
+        context->chaser.chasers[k].pathLengthX = ((float)(nextContextRandom(context) % 61 + 20)) * 0.01f * width / 4;  // 20% to 80% of width
+        context->chaser.chasers[k].pathLengthY = ((float)(nextContextRandom(context) % 61 + 20)) * 0.01f * height / 4; // 20% to 80% of height
 
         // initialize previous positions at the center
-        chasers[k].prevX = (int) width / 2;
-        chasers[k].prevY = (int) height / 2;
+        context->chaser.chasers[k].prevX = (float)(width / 2);
+        context->chaser.chasers[k].prevY = (float)(height / 2);
+        context->chaser.chasers[k].prevTime = NAN;
     }
 }
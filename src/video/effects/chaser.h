@@ -11,6 +11,8 @@
 #endif
 
 #include "../draw.h"
+#include "../raster.h"
+#include "../../milky.h"
 
 // maximum number of chasers that can be rendered simultaneously
 #define MILKY_MAX_CHASERS 20
@@ -18,8 +20,38 @@
 // intensity of the chaser's trail on the screen
 #define MILKY_CHASER_INTENSITY 255
 
+// maximum number of polyline segments a chaser's trail is subdivided into per frame
+#define MILKY_CHASER_MAX_SUBSTEPS 32
+
+// trail length (in pixels) covered by one polyline segment
+#define MILKY_CHASER_SUBSTEP_LENGTH 6.0f
+
+// structure to represent a chaser, which is a moving point on the screen
+typedef struct {
+    float coeff1; // coefficient for x-axis movement calculation
+    float coeff2; // coefficient for x-axis movement calculation
+    float coeff3; // coefficient for y-axis movement calculation
+    float coeff4; // coefficient for y-axis movement calculation
+    float pathLengthX; // length of the path on the x-axis
+    float pathLengthY; // length of the path on the y-axis
+    float prevX; // previous x-coordinate of the chaser
+    float prevY; // previous y-coordinate of the chaser
+    float prevTime; // animation time of the previous position (NAN until the first frame)
+} Chaser;
+
+// chasers of a context
+typedef struct {
+    // the chasers (precomputed coefficients, path lenghts, position cache), limited to MAX_CHASERS
+    Chaser chasers[MILKY_MAX_CHASERS];
+
+    // the last known canvas dimensions, used to determine if the chasers need to be
+    // initialized or rescaled (on sudden canvas size changes)
+    size_t lastWidth;
+    size_t lastHeight;
+} ChaserState;
+
 // Function prototypes
-void initializeChasers(unsigned int count, size_t width, size_t height, unsigned int seed);
-void renderChasers(float timeFrame, uint8_t *screen, float speed, unsigned int count, size_t width, size_t height, unsigned int seed, int thickness);
+void initializeChasers(MilkyContext *context, unsigned int count, size_t width, size_t height);
+void renderChasers(MilkyContext *context, float timeFrame, uint8_t *screen, float speed, unsigned int count, size_t width, size_t height, int thickness);
 
 #endif // CHASER_H
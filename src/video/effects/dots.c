@@ -0,0 +1,52 @@
+#include "dots.h"
+#include "../../context.h"
+
+static void resizeDots(MilkyContext *context, size_t width, size_t height) {
+    context->dots.width = width;
+    context->dots.height = height;
+}
+
+/**
+ * Moves the dots along a wobbling ring: the ring spins with time, breathes with
+ * the bass and the dots grow with the treble.
+ *
+ * @param context The per-frame input of the effects.
+ */
+static void updateDots(MilkyContext *context, const EffectContext *input) {
+    const float centerX = (float)context->dots.width * 0.5f;
+    const float centerY = (float)context->dots.height * 0.5f;
+    const float time = input->speedScalar;
+    const float ringRadius = (float)context->dots.height * MILKY_DOTS_RING_RADIUS * (0.7f + 0.6f * input->bass);
+
+    for (int i = 0; i < MILKY_DOTS_COUNT; i++) {
+        float angle = (float)i * (2.0f * 3.14159265f / (float)MILKY_DOTS_COUNT) + time * 0.7f;
+        float wobble = 1.0f + 0.15f * sinf(time * 2.3f + (float)i * 0.9f);
+        context->dots.x[i] = centerX + cosf(angle) * ringRadius * wobble;
+        context->dots.y[i] = centerY + sinf(angle) * ringRadius * wobble;
+    }
+
+    context->dots.radius = (float)context->dots.height * MILKY_DOTS_RADIUS * (1.0f + input->treble);
+    context->dots.intensity = (uint8_t)(160.0f + 95.0f * input->mid);
+}
+
+static void renderDotsBand(MilkyContext *context, uint8_t *screen, size_t width, size_t height, size_t yStart, size_t yEnd, const EffectContext *input) {
+    (void)height;
+    (void)input;
+
+    for (int i = 0; i < MILKY_DOTS_COUNT; i++) {
+        // quick reject of dots that don't touch this band
+        if (context->dots.y[i] + context->dots.radius < (float)yStart || context->dots.y[i] - context->dots.radius >= (float)yEnd) continue;
+        drawDiscRows(screen, width, yStart, yEnd, context->dots.x[i], context->dots.y[i], context->dots.radius, context->dots.intensity);
+    }
+}
+
+static size_t estimateDotsCost(size_t width, size_t height) {
+    (void)width;
+    float radius = (float)height * MILKY_DOTS_RADIUS * 2.0f;
+    return (size_t)(MILKY_DOTS_COUNT * 3.14159265f * radius * radius);
+}
+
+const Effect milky_dotsEffect = {
+    "effect_dots", 0.0f,
+    resizeDots, resizeDots, updateDots, renderDotsBand, estimateDotsCost, NULL
+};
@@ -0,0 +1,30 @@
+#ifndef DOTS_H
+#define DOTS_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "effect.h"
+
+#define MILKY_DOTS_COUNT 32            // number of dots on the ring
+#define MILKY_DOTS_RADIUS 0.006f       // dot radius as a fraction of the canvas height
+#define MILKY_DOTS_RING_RADIUS 0.22f   // ring radius as a fraction of the canvas height
+
+// dots of a context
+typedef struct {
+    // canvas size the dots are laid out for
+    size_t width;
+    size_t height;
+
+    // dot positions and size of the current frame
+    float x[MILKY_DOTS_COUNT];
+    float y[MILKY_DOTS_COUNT];
+    float radius;
+    uint8_t intensity;
+} DotsState;
+
+// ring of dots pulsing with the bass (preset property effect_dots)
+extern const Effect milky_dotsEffect;
+
+#endif // DOTS_H
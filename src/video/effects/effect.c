@@ -0,0 +1,275 @@
+#include "effect.h"
+#include "../../context.h"
+#include "spectrum.h"
+#include "dots.h"
+#include "grid.h"
+#include "nuclide.h"
+#include "shadebobs.h"
+#include "solar.h"
+
+// registered effects, rendered in registration order
+static const Effect *milky_effectRegistry[MILKY_EFFECT_MAX_COUNT];
+static size_t milky_effectCount = 0;
+
+// the built-in effects are registered by the first frame of any context
+static pthread_once_t milky_effectBuiltinsOnce = PTHREAD_ONCE_INIT;
+
+// preset property of each effect, resolved at registration (-1 = unknown, always the default)
+static int milky_effectProperty[MILKY_EFFECT_MAX_COUNT];
+
+/**
+ * Adds an effect to the registry. Effects are rendered in registration order,
+ * so later effects are drawn on top of earlier ones.
+ *
+ * @param effect The effect to register (must stay valid for the program's lifetime).
+ * @return       1 on success, 0 if the registry is full.
+ */
+int registerEffect(const Effect *effect) {
+    if (milky_effectCount >= MILKY_EFFECT_MAX_COUNT) {
+        fprintf(stderr, "Effect registry full, cannot register '%s'.\n", effect->propertyName);
+        return 0;
+    }
+    milky_effectProperty[milky_effectCount] = resolvePresetProperty(effect->propertyName);
+    milky_effectRegistry[milky_effectCount++] = effect;
+    return 1;
+}
+
+/**
+ * Registers the built-in effects (once per process, see milky_effectBuiltinsOnce).
+ */
+static void registerBuiltinEffects(void) {
+    registerEffect(&milky_spectralEffect);
+    registerEffect(&milky_gridEffect);
+    registerEffect(&milky_solarEffect);
+    registerEffect(&milky_nuclideEffect);
+    registerEffect(&milky_shadebobsEffect);
+    registerEffect(&milky_dotsEffect);
+    registerEffect(&milky_barEffect);
+}
+
+/**
+ * Averages the band levels whose center frequency lies in [fromHz, toHz).
+ *
+ * @param levels    Normalized band levels.
+ * @param bandCount Number of band levels.
+ * @param fromHz    Lower frequency limit.
+ * @param toHz      Upper frequency limit.
+ * @return          Average level, 0 if no band lies in the range.
+ */
+static float averageBandLevels(MilkyContext *context, const float *levels, size_t bandCount, float fromHz, float toHz) {
+    float sum = 0.0f;
+    size_t count = 0;
+    for (size_t b = 0; b < bandCount; b++) {
+        float frequency = getSpectrumBandCenterFrequency(context, b);
+        if (frequency >= fromHz && frequency < toHz) {
+            sum += levels[b];
+            count++;
+        }
+    }
+    return count ? sum / (float)count : 0.0f;
+}
+
+/**
+ * Collects the per-frame input of the effects: band levels, their bass / mid /
+ * treble averages and the beat clock.
+ *
+ * @param context     The rendering context.
+ * @param currentTime Current time in milliseconds.
+ * @param timeFrame   Seconds since the previous frame.
+ * @param speedScalar Accumulated animation time of the renderer.
+ * @return            The effect context for this frame.
+ */
+EffectContext createEffectContext(MilkyContext *context, size_t currentTime, float timeFrame, float speedScalar) {
+    EffectContext input;
+    BeatInfo beatInfo = getBeatInfo(context);
+
+    input.currentTime = currentTime;
+    input.timeFrame = timeFrame;
+    input.speedScalar = speedScalar;
+    input.bandLevels = getSpectrumBandLevels(context, &input.bandCount);
+    input.bass = averageBandLevels(context, input.bandLevels, input.bandCount, 0.0f, 250.0f);
+    input.mid = averageBandLevels(context, input.bandLevels, input.bandCount, 250.0f, 4000.0f);
+    input.treble = averageBandLevels(context, input.bandLevels, input.bandCount, 4000.0f, 1e9f);
+    input.beat = isBeatTriggered(context);
+    input.beatPhase = beatInfo.phase;
+    return input;
+}
+
+/**
+ * Checks whether a preset switches an effect on.
+ *
+ * @param index  Index of the effect in the registry.
+ * @param preset The preset (NULL = built-in defaults).
+ * @return       1 if the effect is enabled, 0 otherwise.
+ */
+static int isEffectEnabled(size_t index, const Preset *preset) {
+    const Effect *effect = milky_effectRegistry[index];
+    float enabledValue = milky_effectProperty[index] < 0 ? effect->defaultEnabled
+        : getPresetRecordValue(preset, (PresetProperty)milky_effectProperty[index], effect->defaultEnabled);
+    return enabledValue > 0.0f;
+}
+
+/**
+ * (Re)initializes an effect for the canvas size and updates it (once per frame).
+ *
+ * @param context The rendering context.
+ * @param index   Index of the effect in the registry.
+ * @param width   The width of the screen buffer in pixels.
+ * @param height  The height of the screen buffer in pixels.
+ * @param input   The per-frame input of the effects.
+ * @return        Estimated pixel writes of the effect.
+ */
+static size_t prepareEffect(MilkyContext *context, size_t index, size_t width, size_t height, const EffectContext *input) {
+    const Effect *effect = milky_effectRegistry[index];
+
+    if (context->effect.width[index] == 0) {
+        if (effect->initialize) effect->initialize(context, width, height);
+    } else if (context->effect.width[index] != width || context->effect.height[index] != height) {
+        if (effect->resize) effect->resize(context, width, height);
+    }
+    context->effect.width[index] = width;
+    context->effect.height[index] = height;
+
+    if (effect->update) effect->update(context, input);
+    return effect->estimateCost ? effect->estimateCost(width, height) : width * height;
+}
+
+/**
+ * Splits the screen into horizontal bands — more bands the more pixel writes the
+ * effects estimate — and renders the effects of one or two layers on the thread
+ * pool. Every band renders all effects of its layer on exactly one thread.
+ *
+ * @param context     The rendering context.
+ * @param screens     The screen buffers (RGBA format), one per layer.
+ * @param effects     The effects of each layer, in registration order.
+ * @param counts      The number of effects of each layer.
+ * @param layerCount  The number of layers (1 or 2).
+ * @param width       The width of the screen buffers in pixels.
+ * @param height      The height of the screen buffers in pixels.
+ * @param cost        Estimated pixel writes of all layers.
+ * @param input       The per-frame input of the effects.
+ */
+static void renderEffectBands(MilkyContext *context, uint8_t *const *screens, const Effect *effects[][MILKY_EFFECT_MAX_COUNT],
+                              const size_t *counts, size_t layerCount, size_t width, size_t height,
+                              size_t cost, const EffectContext *input) {
+    if (height == 0) return;
+
+    // more estimated work, more bands (keeps small workloads off the thread pool)
+    size_t bandCount = cost / MILKY_EFFECT_BAND_COST;
+    if (bandCount < 1) bandCount = 1;
+    if (bandCount > MILKY_EFFECT_MAX_BANDS) bandCount = MILKY_EFFECT_MAX_BANDS;
+    if (bandCount > height) bandCount = height;
+
+    const int taskCount = (int)(bandCount * layerCount);
+    #pragma omp parallel for schedule(dynamic, 1) if (taskCount > 1)
+    for (int task = 0; task < taskCount; task++) {
+        size_t layer = (size_t)task / bandCount;
+        size_t band = (size_t)task % bandCount;
+        size_t yStart = height * band / bandCount;
+        size_t yEnd = height * (band + 1) / bandCount;
+        for (size_t i = 0; i < counts[layer]; i++) {
+            effects[layer][i]->renderBand(context, screens[layer], width, height, yStart, yEnd, input);
+        }
+    }
+}
+
+/**
+ * Renders all effects enabled by the active preset.
+ *
+ * Enabled effects are (re)initialized when the canvas size changes and updated
+ * once. The screen is then split into horizontal bands — more bands the more pixel
+ * writes the enabled effects estimate — and every band renders all enabled effects
+ * on exactly one thread.
+ *
+ * @param context The rendering context.
+ * @param screen  The screen buffer to render on (RGBA format).
+ * @param width   The width of the screen buffer in pixels.
+ * @param height  The height of the screen buffer in pixels.
+ * @param preset  The active preset (NULL = built-in defaults).
+ * @param input   The per-frame input of the effects.
+ */
+void renderEffects(MilkyContext *context, uint8_t *screen, size_t width, size_t height, const Preset *preset, const EffectContext *input) {
+    pthread_once(&milky_effectBuiltinsOnce, registerBuiltinEffects);
+
+    const Effect *enabled[1][MILKY_EFFECT_MAX_COUNT];
+    size_t enabledCount = 0;
+    size_t cost = 0;
+
+    for (size_t i = 0; i < milky_effectCount; i++) {
+        if (!isEffectEnabled(i, preset)) continue;
+        cost += prepareEffect(context, i, width, height, input);
+        enabled[0][enabledCount++] = milky_effectRegistry[i];
+    }
+
+    if (enabledCount == 0) return;
+    renderEffectBands(context, &screen, enabled, &enabledCount, 1, width, height, cost, input);
+}
+
+/**
+ * Renders the effects during a preset transition. If both presets enable the same
+ * effects, they are rendered once, like renderEffects(). Otherwise the outgoing
+ * preset's effects are rendered on a copy of the screen and the incoming preset's
+ * on the screen itself — both layers at the same time on the thread pool — and the
+ * copy is faded out. Every effect is still updated only once per frame, and no
+ * effect is rendered more than twice.
+ *
+ * @param context The rendering context.
+ * @param screen  The screen buffer to render on (RGBA format).
+ * @param scratch A buffer of the same size for the outgoing layer.
+ * @param width   The width of the screen buffer in pixels.
+ * @param height  The height of the screen buffer in pixels.
+ * @param from    The outgoing preset (NULL = built-in defaults).
+ * @param to      The incoming preset (NULL = built-in defaults).
+ * @param weight  Weight of the incoming preset in [0, 1].
+ * @param input   The per-frame input of the effects.
+ */
+void renderEffectTransition(MilkyContext *context, uint8_t *screen, uint8_t *scratch, size_t width, size_t height,
+                            const Preset *from, const Preset *to, float weight, const EffectContext *input) {
+    pthread_once(&milky_effectBuiltinsOnce, registerBuiltinEffects);
+
+    // layer 0 = incoming preset (on the screen), layer 1 = outgoing preset (on the copy)
+    const Effect *enabled[2][MILKY_EFFECT_MAX_COUNT];
+    size_t enabledCount[2] = { 0, 0 };
+    size_t cost = 0;
+    int differs = 0;
+
+    for (size_t i = 0; i < milky_effectCount; i++) {
+        int incoming = isEffectEnabled(i, to);
+        int outgoing = isEffectEnabled(i, from);
+        if (!incoming && !outgoing) continue;
+
+        size_t effectCost = prepareEffect(context, i, width, height, input);
+        if (incoming) {
+            enabled[0][enabledCount[0]++] = milky_effectRegistry[i];
+            cost += effectCost;
+        }
+        if (outgoing) {
+            enabled[1][enabledCount[1]++] = milky_effectRegistry[i];
+            cost += effectCost;
+        }
+        differs |= incoming != outgoing;
+    }
+
+    if (!differs) {
+        if (enabledCount[0] > 0) renderEffectBands(context, &screen, enabled, enabledCount, 1, width, height, cost / 2, input);
+        return;
+    }
+
+    const size_t frameSize = width * height * 4;
+    uint8_t *screens[2] = { screen, scratch };
+    memcpy(scratch, screen, frameSize);
+    renderEffectBands(context, screens, enabled, enabledCount, 2, width, height, cost, input);
+    blendFixed(screen, scratch, frameSize, toFixed(1.0f - weight));
+}
+
+/**
+ * Releases the effects of a context; they are initialized again before
+ * their next frame.
+ */
+void destroyEffects(MilkyContext *context) {
+    for (size_t i = 0; i < milky_effectCount; i++) {
+        if (context->effect.width[i] != 0 && milky_effectRegistry[i]->destroy) milky_effectRegistry[i]->destroy(context);
+        context->effect.width[i] = 0;
+        context->effect.height[i] = 0;
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef EFFECT_H
+#define EFFECT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <omp.h>
+#include <pthread.h>
+
+#include "../draw.h"
+#include "../fixed.h"
+#include "../../preset.h"
+#include "../../audio/bands.h"
+#include "../../audio/beat.h"
+#include "../../allocator.h"
+
+#define MILKY_EFFECT_MAX_COUNT 32          // maximum number of registered effects
+#define MILKY_EFFECT_MAX_BANDS 64          // upper limit for the number of screen bands rendered in parallel
+#define MILKY_EFFECT_BAND_COST 16384       // estimated pixel writes that justify one more screen band
+
+// per-frame input shared by all effects
+typedef struct {
+    size_t currentTime;      // current time in milliseconds
+    float timeFrame;         // seconds since the previous frame
+    float speedScalar;       // accumulated animation time of the renderer
+    const float *bandLevels; // normalized perceptual band levels [0, 1]
+    size_t bandCount;        // number of band levels
+    float bass;              // average level of the bands below 250 Hz
+    float mid;               // average level of the bands between 250 Hz and 4 kHz
+    float treble;            // average level of the bands above 4 kHz
+    int beat;                // set if a beat (or energy spike) falls into this frame
+    float beatPhase;         // position inside the current beat [0, 1)
+} EffectContext;
+
+/**
+ * Common interface of all effects rendered on top of the feedback frame.
+ *
+ * Effects keep their animation state in update(), which runs once per frame on a
+ * single thread. renderBand() is then called for horizontal screen bands in
+ * parallel and must only write the rows [yStart, yEnd), so every pixel has exactly
+ * one writer and the output doesn't depend on the thread count. State lives in the
+ * effect's part of the rendering context and heap memory comes from the context
+ * allocator; destroy() releases it when the context goes away.
+ */
+typedef struct {
+    const char *propertyName; // preset property that switches the effect on (> 0) or off
+    float defaultEnabled;     // value used when the active preset doesn't define the property
+    void (*initialize)(MilkyContext *context, size_t width, size_t height);
+    void (*resize)(MilkyContext *context, size_t width, size_t height);
+    void (*update)(MilkyContext *context, const EffectContext *input);
+    void (*renderBand)(MilkyContext *context, uint8_t *screen, size_t width, size_t height, size_t yStart, size_t yEnd, const EffectContext *input);
+    size_t (*estimateCost)(size_t width, size_t height); // estimated pixel writes per frame
+    void (*destroy)(MilkyContext *context); // releases what initialize() / resize() allocated (NULL = nothing)
+} Effect;
+
+// effects of a context
+typedef struct {
+    // canvas size each effect was last initialized / resized for (0 = not initialized yet)
+    size_t width[MILKY_EFFECT_MAX_COUNT];
+    size_t height[MILKY_EFFECT_MAX_COUNT];
+} EffectState;
+
+int registerEffect(const Effect *effect);
+EffectContext createEffectContext(MilkyContext *context, size_t currentTime, float timeFrame, float speedScalar);
+void renderEffects(MilkyContext *context, uint8_t *screen, size_t width, size_t height, const Preset *preset, const EffectContext *input);
+void renderEffectTransition(MilkyContext *context, uint8_t *screen, uint8_t *scratch, size_t width, size_t height,
+                            const Preset *from, const Preset *to, float weight, const EffectContext *input);
+void destroyEffects(MilkyContext *context);
+
+#endif // EFFECT_H
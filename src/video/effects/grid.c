@@ -0,0 +1,59 @@
+#include "grid.h"
+#include "../../context.h"
+
+static void resizeGrid(MilkyContext *context, size_t width, size_t height) {
+    context->grid.width = width;
+    context->grid.height = height;
+}
+
+/**
+ * Scrolls the grid diagonally; the cells shrink with the mids and the lines
+ * brighten with the bass.
+ *
+ * @param context The per-frame input of the effects.
+ */
+static void updateGrid(MilkyContext *context, const EffectContext *input) {
+    float spacing = (float)context->grid.height / (float)MILKY_GRID_CELLS * (1.0f - 0.35f * input->mid);
+    context->grid.spacing = spacing < 4.0f ? 4 : (int)spacing;
+
+    float thickness = (float)context->grid.height * MILKY_GRID_THICKNESS;
+    context->grid.thickness = thickness < 1.0f ? 1 : (int)thickness;
+
+    float scroll = input->speedScalar * (float)context->grid.spacing * 0.5f;
+    context->grid.offsetX = (int)fmodf(scroll, (float)context->grid.spacing);
+    context->grid.offsetY = (int)fmodf(scroll * 0.6f, (float)context->grid.spacing);
+    context->grid.intensity = (uint8_t)(60.0f + 140.0f * input->bass);
+}
+
+/**
+ * Renders the rows [yStart, yEnd) of the grid: a horizontal line is one full-row
+ * span, other rows get one short span per vertical line.
+ */
+static void renderGridBand(MilkyContext *context, uint8_t *screen, size_t width, size_t height, size_t yStart, size_t yEnd, const EffectContext *input) {
+    (void)height;
+    (void)input;
+
+    const int spacing = context->grid.spacing;
+    const int thickness = context->grid.thickness;
+
+    for (size_t y = yStart; y < yEnd; y++) {
+        uint8_t *row = &screen[y * width * 4];
+        if (((int)y + context->grid.offsetY) % spacing < thickness) {
+            blendSpanMax(row, width, 0, (int)width, context->grid.intensity);
+            continue;
+        }
+        for (int x = spacing - context->grid.offsetX; x - spacing < (int)width; x += spacing) {
+            blendSpanMax(row, width, x - spacing, x - spacing + thickness, context->grid.intensity);
+        }
+    }
+}
+
+static size_t estimateGridCost(size_t width, size_t height) {
+    float thickness = (float)height * MILKY_GRID_THICKNESS;
+    return (size_t)(2.0f * (float)MILKY_GRID_CELLS * thickness * (float)(width + height));
+}
+
+const Effect milky_gridEffect = {
+    "effect_grid", 0.0f,
+    resizeGrid, resizeGrid, updateGrid, renderGridBand, estimateGridCost, NULL
+};
@@ -0,0 +1,30 @@
+#ifndef GRID_H
+#define GRID_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "effect.h"
+
+#define MILKY_GRID_CELLS 12            // grid cells along the canvas height (at rest)
+#define MILKY_GRID_THICKNESS 0.0015f   // line thickness as a fraction of the canvas height
+
+// grid of a context
+typedef struct {
+    // canvas size the grid is laid out for
+    size_t width;
+    size_t height;
+
+    // grid layout of the current frame
+    int spacing;
+    int thickness;
+    int offsetX;
+    int offsetY;
+    uint8_t intensity;
+} GridState;
+
+// scrolling lattice of lines (preset property effect_grid)
+extern const Effect milky_gridEffect;
+
+#endif // GRID_H
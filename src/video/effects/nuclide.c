@@ -0,0 +1,82 @@
+#include "nuclide.h"
+#include "../../context.h"
+
+static void resizeNuclide(MilkyContext *context, size_t width, size_t height) {
+    context->nuclide.width = width;
+    context->nuclide.height = height;
+}
+
+/**
+ * Samples the tilted elliptic orbits and places one electron on each of them.
+ * The atom spins with time, the orbits widen with the mids and the nucleus
+ * swells with the bass.
+ *
+ * @param context The per-frame input of the effects.
+ */
+static void updateNuclide(MilkyContext *context, const EffectContext *input) {
+    const float centerX = (float)context->nuclide.width * 0.5f;
+    const float centerY = (float)context->nuclide.height * 0.5f;
+    const float time = input->speedScalar;
+    const float longAxis = (float)context->nuclide.height * MILKY_NUCLIDE_RADIUS;
+    const float shortAxis = longAxis * (0.25f + 0.2f * input->mid);
+    const float dotRadius = (float)context->nuclide.height * 0.002f + 0.5f;
+    const uint8_t orbitIntensity = (uint8_t)(90.0f + 100.0f * input->mid);
+    size_t index = 0;
+
+    for (int orbit = 0; orbit < MILKY_NUCLIDE_ORBITS; orbit++) {
+        float tilt = (float)orbit * (3.14159265f / (float)MILKY_NUCLIDE_ORBITS) + time * 0.3f;
+        float cosTilt = cosf(tilt);
+        float sinTilt = sinf(tilt);
+
+        for (int i = 0; i < MILKY_NUCLIDE_ORBIT_POINTS; i++, index++) {
+            float angle = (float)i * (2.0f * 3.14159265f / (float)MILKY_NUCLIDE_ORBIT_POINTS);
+            float ex = cosf(angle) * longAxis;
+            float ey = sinf(angle) * shortAxis;
+            context->nuclide.x[index] = centerX + ex * cosTilt - ey * sinTilt;
+            context->nuclide.y[index] = centerY + ex * sinTilt + ey * cosTilt;
+            context->nuclide.radius[index] = dotRadius;
+            context->nuclide.intensity[index] = orbitIntensity;
+        }
+    }
+
+    // electrons, one per orbit, at different speeds
+    for (int orbit = 0; orbit < MILKY_NUCLIDE_ORBITS; orbit++, index++) {
+        float tilt = (float)orbit * (3.14159265f / (float)MILKY_NUCLIDE_ORBITS) + time * 0.3f;
+        float angle = time * (2.0f + (float)orbit * 0.7f);
+        float ex = cosf(angle) * longAxis;
+        float ey = sinf(angle) * shortAxis;
+        context->nuclide.x[index] = centerX + ex * cosf(tilt) - ey * sinf(tilt);
+        context->nuclide.y[index] = centerY + ex * sinf(tilt) + ey * cosf(tilt);
+        context->nuclide.radius[index] = dotRadius * (4.0f + 3.0f * input->treble);
+        context->nuclide.intensity[index] = 255;
+    }
+
+    // nucleus
+    context->nuclide.x[index] = centerX;
+    context->nuclide.y[index] = centerY;
+    context->nuclide.radius[index] = longAxis * (0.06f + 0.08f * input->bass);
+    context->nuclide.intensity[index] = 255;
+}
+
+static void renderNuclideBand(MilkyContext *context, uint8_t *screen, size_t width, size_t height, size_t yStart, size_t yEnd, const EffectContext *input) {
+    (void)height;
+    (void)input;
+
+    for (size_t i = 0; i < MILKY_NUCLIDE_POINT_COUNT + MILKY_NUCLIDE_ORBITS + 1; i++) {
+        float y = context->nuclide.y[i];
+        float radius = context->nuclide.radius[i];
+        if (y + radius < (float)yStart || y - radius >= (float)yEnd) continue;
+        drawDiscRows(screen, width, yStart, yEnd, context->nuclide.x[i], y, radius, context->nuclide.intensity[i]);
+    }
+}
+
+static size_t estimateNuclideCost(size_t width, size_t height) {
+    (void)width;
+    float radius = (float)height * 0.002f + 0.5f;
+    return (size_t)(MILKY_NUCLIDE_POINT_COUNT * 4.0f * radius * radius) + (size_t)(height * height / 100);
+}
+
+const Effect milky_nuclideEffect = {
+    "effect_nuclide", 0.0f,
+    resizeNuclide, resizeNuclide, updateNuclide, renderNuclideBand, estimateNuclideCost, NULL
+};
@@ -0,0 +1,32 @@
+#ifndef NUCLIDE_H
+#define NUCLIDE_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "effect.h"
+
+#define MILKY_NUCLIDE_ORBITS 3            // number of electron orbits
+#define MILKY_NUCLIDE_ORBIT_POINTS 192    // points sampled along every orbit
+#define MILKY_NUCLIDE_RADIUS 0.3f         // orbit radius (long axis) as a fraction of the canvas height
+
+#define MILKY_NUCLIDE_POINT_COUNT (MILKY_NUCLIDE_ORBITS * MILKY_NUCLIDE_ORBIT_POINTS)
+
+// atom of a context
+typedef struct {
+    // canvas size the atom is laid out for
+    size_t width;
+    size_t height;
+
+    // orbit points of the current frame (followed by the electrons and the nucleus)
+    float x[MILKY_NUCLIDE_POINT_COUNT + MILKY_NUCLIDE_ORBITS + 1];
+    float y[MILKY_NUCLIDE_POINT_COUNT + MILKY_NUCLIDE_ORBITS + 1];
+    float radius[MILKY_NUCLIDE_POINT_COUNT + MILKY_NUCLIDE_ORBITS + 1];
+    uint8_t intensity[MILKY_NUCLIDE_POINT_COUNT + MILKY_NUCLIDE_ORBITS + 1];
+} NuclideState;
+
+// spinning atom: nucleus and electrons on tilted elliptic orbits (preset property effect_nuclide)
+extern const Effect milky_nuclideEffect;
+
+#endif // NUCLIDE_H
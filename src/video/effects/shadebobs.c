@@ -0,0 +1,127 @@
+#include "shadebobs.h"
+#include "../../context.h"
+
+/**
+ * Rebuilds the bob sprite (a smooth radial falloff) for the canvas size.
+ *
+ * @param width  The width of the screen buffer in pixels.
+ * @param height The height of the screen buffer in pixels.
+ */
+static void resizeShadebobs(MilkyContext *context, size_t width, size_t height) {
+    int size = (int)((float)height * MILKY_SHADEBOBS_SIZE);
+    if (size < 2) size = 2;
+
+    uint32_t *sprite = (uint32_t *)reallocateContextMemory(context, context->shadebobs.sprite, (size_t)size * (size_t)size * sizeof(uint32_t));
+    if (!sprite) {
+        fprintf(stderr, "Failed to allocate shadebob sprite\n");
+        context->shadebobs.size = 0;
+        return;
+    }
+
+    const float radius = (float)size * 0.5f;
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            float dx = ((float)x + 0.5f - radius) / radius;
+            float dy = ((float)y + 0.5f - radius) / radius;
+            float falloff = 1.0f - (dx * dx + dy * dy);
+            uint32_t value = falloff > 0.0f ? (uint32_t)((float)MILKY_SHADEBOBS_PEAK * falloff * falloff + 0.5f) : 0;
+            sprite[y * size + x] = value | (value << 8) | (value << 16);
+        }
+    }
+
+    context->shadebobs.sprite = sprite;
+    context->shadebobs.size = size;
+    context->shadebobs.width = width;
+    context->shadebobs.height = height;
+}
+
+/**
+ * Moves the bobs along lissajous paths; they travel faster with the bass.
+ *
+ * @param context The per-frame input of the effects.
+ */
+static void updateShadebobs(MilkyContext *context, const EffectContext *input) {
+    const float time = input->speedScalar * (1.0f + input->bass);
+    const float rangeX = ((float)context->shadebobs.width - (float)context->shadebobs.size) * 0.5f;
+    const float rangeY = ((float)context->shadebobs.height - (float)context->shadebobs.size) * 0.5f;
+
+    for (int i = 0; i < MILKY_SHADEBOBS_COUNT; i++) {
+        float phase = (float)i * 0.785f;
+        context->shadebobs.x[i] = (int)(rangeX * (1.0f + sinf(time * 1.3f + phase) * cosf(time * 0.37f + phase * 2.0f)));
+        context->shadebobs.y[i] = (int)(rangeY * (1.0f + sinf(time * 0.9f + phase * 1.5f)));
+    }
+}
+
+/**
+ * Adds one row of the sprite onto a row of the screen with saturation.
+ *
+ * @param target First screen pixel covered by the sprite row.
+ * @param source First sprite pixel to add.
+ * @param count  Number of pixels.
+ */
+static void addSpriteRow(uint8_t *target, const uint32_t *source, int count) {
+    int i = 0;
+
+#if defined(__AVX2__)
+    for (; i + 8 <= count; i += 8) {
+        __m256i *pixels = (__m256i *)&target[i * 4];
+        __m256i sprite = _mm256_loadu_si256((const __m256i *)&source[i]);
+        _mm256_storeu_si256(pixels, _mm256_adds_epu8(_mm256_loadu_si256(pixels), sprite));
+    }
+#elif defined(__ARM_NEON__)
+    for (; i + 4 <= count; i += 4) {
+        uint8x16_t sprite = vreinterpretq_u8_u32(vld1q_u32(&source[i]));
+        vst1q_u8(&target[i * 4], vqaddq_u8(vld1q_u8(&target[i * 4]), sprite));
+    }
+#endif
+
+    for (; i < count; i++) {
+        const uint8_t *add = (const uint8_t *)&source[i];
+        uint8_t *pixel = &target[i * 4];
+        for (int c = 0; c < 3; c++) {
+            int sum = pixel[c] + add[c];
+            pixel[c] = (uint8_t)(sum > 255 ? 255 : sum);
+        }
+    }
+}
+
+static void renderShadebobsBand(MilkyContext *context, uint8_t *screen, size_t width, size_t height, size_t yStart, size_t yEnd, const EffectContext *input) {
+    (void)height;
+    (void)input;
+
+    const int size = context->shadebobs.size;
+    if (size == 0) return;
+
+    for (int i = 0; i < MILKY_SHADEBOBS_COUNT; i++) {
+        int top = context->shadebobs.y[i] < (int)yStart ? (int)yStart : context->shadebobs.y[i];
+        int bottom = context->shadebobs.y[i] + size > (int)yEnd ? (int)yEnd : context->shadebobs.y[i] + size;
+
+        // clip the sprite columns to the canvas
+        int left = context->shadebobs.x[i] < 0 ? 0 : context->shadebobs.x[i];
+        int right = context->shadebobs.x[i] + size > (int)width ? (int)width : context->shadebobs.x[i] + size;
+        if (right <= left) continue;
+
+        for (int y = top; y < bottom; y++) {
+            const uint32_t *spriteRow = &context->shadebobs.sprite[(y - context->shadebobs.y[i]) * size + (left - context->shadebobs.x[i])];
+            addSpriteRow(&screen[((size_t)y * width + (size_t)left) * 4], spriteRow, right - left);
+        }
+    }
+}
+
+static size_t estimateShadebobsCost(size_t width, size_t height) {
+    (void)width;
+    float size = (float)height * MILKY_SHADEBOBS_SIZE;
+    return (size_t)(MILKY_SHADEBOBS_COUNT * size * size);
+}
+
+// frees the sprite
+static void destroyShadebobs(MilkyContext *context) {
+    releaseContextMemory(context, context->shadebobs.sprite);
+    context->shadebobs.sprite = NULL;
+    context->shadebobs.size = 0;
+}
+
+const Effect milky_shadebobsEffect = {
+    "effect_shadebobs", 0.0f,
+    resizeShadebobs, resizeShadebobs, updateShadebobs, renderShadebobsBand, estimateShadebobsCost, destroyShadebobs
+};
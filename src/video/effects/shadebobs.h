@@ -0,0 +1,42 @@
+#ifndef SHADEBOBS_H
+#define SHADEBOBS_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#ifdef __ARM_NEON__
+#include <arm_neon.h>
+#endif
+
+#include "effect.h"
+
+#define MILKY_SHADEBOBS_COUNT 8           // number of bobs
+#define MILKY_SHADEBOBS_SIZE 0.08f        // bob diameter as a fraction of the canvas height
+#define MILKY_SHADEBOBS_PEAK 40           // intensity a bob adds at its center per frame
+
+// bobs of a context
+typedef struct {
+    // canvas size the bobs are laid out for
+    size_t width;
+    size_t height;
+
+    // precomputed bob sprite: size * size RGBA pixels (alpha 0, so adding leaves alpha untouched)
+    uint32_t *sprite;
+    int size;
+
+    // top-left corners of the bobs in the current frame
+    int x[MILKY_SHADEBOBS_COUNT];
+    int y[MILKY_SHADEBOBS_COUNT];
+} ShadebobsState;
+
+// additive bobs on lissajous paths, accumulating in the feedback buffer (preset property effect_shadebobs)
+extern const Effect milky_shadebobsEffect;
+
+#endif // SHADEBOBS_H
@@ -0,0 +1,89 @@
+#include "solar.h"
+#include "../../context.h"
+
+static void resizeSolar(MilkyContext *context, size_t width, size_t height) {
+    context->solar.width = width;
+    context->solar.height = height;
+}
+
+/**
+ * Lays out the rays: every spectrum band drives the length of two mirrored rays,
+ * the whole corona rotates slowly and the core swells with the bass.
+ *
+ * @param context The per-frame input of the effects.
+ */
+static void updateSolar(MilkyContext *context, const EffectContext *input) {
+    size_t bandCount = input->bandLevels ? input->bandCount : 0;
+    if (bandCount * 2 > MILKY_SOLAR_MAX_RAYS) bandCount = MILKY_SOLAR_MAX_RAYS / 2;
+
+    const float height = (float)context->solar.height;
+    const float rotation = input->speedScalar * 0.1f;
+    context->solar.coreRadius = height * MILKY_SOLAR_CORE_RADIUS * (1.0f + 0.5f * input->bass);
+    context->solar.rayCount = bandCount * 2;
+
+    for (size_t ray = 0; ray < context->solar.rayCount; ray++) {
+        // mirror the bands so the low frequencies point up and down
+        size_t band = ray < bandCount ? ray : context->solar.rayCount - 1 - ray;
+        float level = input->bandLevels[band];
+        level = level < 0.0f ? 0.0f : (level > 1.0f ? 1.0f : level);
+
+        float angle = rotation + (float)ray * (2.0f * 3.14159265f / (float)context->solar.rayCount);
+        context->solar.cos[ray] = cosf(angle);
+        context->solar.sin[ray] = sinf(angle);
+        context->solar.inner[ray] = context->solar.coreRadius;
+        context->solar.outer[ray] = context->solar.coreRadius + level * height * MILKY_SOLAR_RAY_LENGTH;
+        context->solar.intensity[ray] = (uint8_t)(100.0f + 155.0f * level);
+    }
+}
+
+/**
+ * Renders the rows [yStart, yEnd) of the sun. Each ray is clipped analytically to
+ * the band's rows, so a band only walks the part of the ray it owns.
+ */
+static void renderSolarBand(MilkyContext *context, uint8_t *screen, size_t width, size_t height, size_t yStart, size_t yEnd, const EffectContext *input) {
+    (void)height;
+    (void)input;
+
+    const float centerX = (float)context->solar.width * 0.5f;
+    const float centerY = (float)context->solar.height * 0.5f;
+
+    drawDiscRows(screen, width, yStart, yEnd, centerX, centerY, context->solar.coreRadius, 255);
+
+    for (size_t ray = 0; ray < context->solar.rayCount; ray++) {
+        const float cosine = context->solar.cos[ray];
+        const float sine = context->solar.sin[ray];
+        float from = context->solar.inner[ray];
+        float to = context->solar.outer[ray];
+
+        // restrict the radial range to the rows of this band
+        if (fabsf(sine) > 1e-6f) {
+            float a = ((float)yStart - centerY) / sine;
+            float b = ((float)yEnd - centerY) / sine;
+            float low = a < b ? a : b;
+            float high = a < b ? b : a;
+            from = from > low ? from : low;
+            to = to < high ? to : high;
+        } else if (centerY < (float)yStart || centerY >= (float)yEnd) {
+            continue;
+        }
+
+        // step along the ray (two pixels wide)
+        for (float t = from; t < to; t += 0.7f) {
+            int y = (int)floorf(centerY + sine * t);
+            if (y < (int)yStart || y >= (int)yEnd) continue;
+            int x = (int)floorf(centerX + cosine * t);
+            blendSpanMax(&screen[(size_t)y * width * 4], width, x, x + 2, context->solar.intensity[ray]);
+        }
+    }
+}
+
+static size_t estimateSolarCost(size_t width, size_t height) {
+    (void)width;
+    float core = (float)height * MILKY_SOLAR_CORE_RADIUS;
+    return (size_t)(3.14159265f * core * core + (float)MILKY_SOLAR_MAX_RAYS * (float)height * MILKY_SOLAR_RAY_LENGTH);
+}
+
+const Effect milky_solarEffect = {
+    "effect_solar", 0.0f,
+    resizeSolar, resizeSolar, updateSolar, renderSolarBand, estimateSolarCost, NULL
+};
@@ -0,0 +1,33 @@
+#ifndef SOLAR_H
+#define SOLAR_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "effect.h"
+
+#define MILKY_SOLAR_MAX_RAYS 256          // upper limit for the number of rays (two per spectrum band)
+#define MILKY_SOLAR_CORE_RADIUS 0.06f     // radius of the sun's core as a fraction of the canvas height
+#define MILKY_SOLAR_RAY_LENGTH 0.3f       // maximum ray length as a fraction of the canvas height
+
+// sun of a context
+typedef struct {
+    // canvas size the sun is laid out for
+    size_t width;
+    size_t height;
+
+    // rays of the current frame: direction, radial extent and intensity
+    float cos[MILKY_SOLAR_MAX_RAYS];
+    float sin[MILKY_SOLAR_MAX_RAYS];
+    float inner[MILKY_SOLAR_MAX_RAYS];
+    float outer[MILKY_SOLAR_MAX_RAYS];
+    uint8_t intensity[MILKY_SOLAR_MAX_RAYS];
+    size_t rayCount;
+    float coreRadius;
+} SolarState;
+
+// sun with one ray per spectrum band on either side (preset property effect_solar)
+extern const Effect milky_solarEffect;
+
+#endif // SOLAR_H
@@ -0,0 +1,147 @@
+#include "spectrum.h"
+#include "../../context.h"
+
+/**
+ * Remembers the canvas size the bars and the waterfall are laid out for.
+ *
+ * @param width  The width of the screen buffer in pixels.
+ * @param height The height of the screen buffer in pixels.
+ */
+static void resizeSpectrum(MilkyContext *context, size_t width, size_t height) {
+    context->spectrum.width = width;
+    context->spectrum.height = height;
+}
+
+/**
+ * Recomputes the pixel columns of the bars and waterfall columns, clipped to the canvas.
+ *
+ * @param width     The width of the screen buffer in pixels.
+ * @param bandCount The number of bands to lay out.
+ */
+static void updateSpectrumLayout(MilkyContext *context, size_t width, size_t bandCount) {
+    if (width == context->spectrum.layoutWidth && bandCount == context->spectrum.layoutBands) return;
+
+    const float pitch = (float)width / (float)bandCount;
+    const float gap = pitch * MILKY_SPECTRUM_BAR_GAP * 0.5f;
+
+    for (size_t b = 0; b < bandCount; b++) {
+        int start = (int)lrintf((float)b * pitch + gap);
+        int end = (int)lrintf((float)(b + 1) * pitch - gap);
+        context->spectrum.barStart[b] = start;
+        context->spectrum.barEnd[b] = end <= start ? start + 1 : end;
+    }
+    for (size_t b = 0; b <= bandCount; b++) {
+        context->spectrum.columnStart[b] = (int)lrintf((float)b * pitch);
+    }
+
+    context->spectrum.layoutWidth = width;
+    context->spectrum.layoutBands = bandCount;
+}
+
+/**
+ * Advances the bar heights: bars rise immediately and fall off smoothly.
+ *
+ * @param context The per-frame input of the effects.
+ */
+static void updateSpectrumBars(MilkyContext *context, const EffectContext *input) {
+    size_t bandCount = input->bandCount > MILKY_SPECTRUM_MAX_BANDS ? MILKY_SPECTRUM_MAX_BANDS : input->bandCount;
+    const int height = (int)context->spectrum.height;
+    const int maxBarHeight = (int)((float)height * MILKY_SPECTRUM_BAR_HEIGHT);
+
+    context->spectrum.barCount = input->bandLevels ? bandCount : 0;
+    if (context->spectrum.barCount == 0) return;
+
+    updateSpectrumLayout(context, context->spectrum.width, bandCount);
+
+    for (size_t b = 0; b < bandCount; b++) {
+        float level = input->bandLevels[b];
+        level = level < 0.0f ? 0.0f : (level > 1.0f ? 1.0f : level);
+        float decayed = context->spectrum.barLevels[b] * MILKY_SPECTRUM_BAR_DECAY;
+        context->spectrum.barLevels[b] = level > decayed ? level : decayed;
+
+        context->spectrum.barTop[b] = height - (int)(context->spectrum.barLevels[b] * (float)maxBarHeight);
+        context->spectrum.barIntensity[b] = (uint8_t)(127.0f + 128.0f * context->spectrum.barLevels[b]);
+    }
+}
+
+/**
+ * Renders the rows [yStart, yEnd) of the spectrum bars: per row a handful of SIMD
+ * span fills clipped to the bars' columns.
+ */
+static void renderSpectrumBarsBand(MilkyContext *context, uint8_t *screen, size_t width, size_t height, size_t yStart, size_t yEnd, const EffectContext *input) {
+    (void)height;
+    (void)input;
+
+    for (size_t y = yStart; y < yEnd; y++) {
+        uint8_t *row = &screen[y * width * 4];
+        for (size_t b = 0; b < context->spectrum.barCount; b++) {
+            if ((int)y < context->spectrum.barTop[b]) continue;
+            blendSpanMax(row, width, context->spectrum.barStart[b], context->spectrum.barEnd[b], context->spectrum.barIntensity[b]);
+        }
+    }
+}
+
+static size_t estimateSpectrumBarsCost(size_t width, size_t height) {
+    return (size_t)((float)(width * height) * MILKY_SPECTRUM_BAR_HEIGHT * 0.5f);
+}
+
+/**
+ * Appends the newest spectrum to the waterfall ring; scrolling is just advancing
+ * the ring's head (no memmove of the history).
+ *
+ * @param context The per-frame input of the effects.
+ */
+static void updateSpectralWaterfall(MilkyContext *context, const EffectContext *input) {
+    size_t bandCount = input->bandCount > MILKY_SPECTRUM_MAX_BANDS ? MILKY_SPECTRUM_MAX_BANDS : input->bandCount;
+    if (!input->bandLevels || bandCount == 0) return;
+
+    updateSpectrumLayout(context, context->spectrum.width, bandCount);
+
+    uint8_t *newest = context->spectrum.waterfall[context->spectrum.waterfallHead & (MILKY_SPECTRUM_WATERFALL_ROWS - 1)];
+    for (size_t b = 0; b < bandCount; b++) {
+        float level = input->bandLevels[b];
+        level = level < 0.0f ? 0.0f : (level > 1.0f ? 1.0f : level);
+        newest[b] = (uint8_t)(level * 255.0f);
+    }
+    context->spectrum.waterfallHead++;
+    context->spectrum.waterfallBands = bandCount;
+}
+
+/**
+ * Renders the rows [yStart, yEnd) of the waterfall (newest spectrum at the top
+ * edge, older ones further down). Every screen row maps to one ring row and is
+ * drawn as one SIMD span fill per band column.
+ */
+static void renderSpectralWaterfallBand(MilkyContext *context, uint8_t *screen, size_t width, size_t height, size_t yStart, size_t yEnd, const EffectContext *input) {
+    (void)input;
+
+    const size_t head = context->spectrum.waterfallHead;
+    const size_t regionHeight = (size_t)((float)height * MILKY_SPECTRUM_WATERFALL_HEIGHT);
+    const size_t visibleRows = head < MILKY_SPECTRUM_WATERFALL_ROWS ? head : MILKY_SPECTRUM_WATERFALL_ROWS;
+    if (yEnd > regionHeight) yEnd = regionHeight;
+
+    for (size_t y = yStart; y < yEnd; y++) {
+        size_t age = y * MILKY_SPECTRUM_WATERFALL_ROWS / regionHeight;
+        if (age >= visibleRows) break;
+
+        const uint8_t *ringRow = context->spectrum.waterfall[(head - 1 - age) & (MILKY_SPECTRUM_WATERFALL_ROWS - 1)];
+        uint8_t *row = &screen[y * width * 4];
+        for (size_t b = 0; b < context->spectrum.waterfallBands; b++) {
+            blendSpanMax(row, width, context->spectrum.columnStart[b], context->spectrum.columnStart[b + 1], ringRow[b]);
+        }
+    }
+}
+
+static size_t estimateSpectralWaterfallCost(size_t width, size_t height) {
+    return (size_t)((float)(width * height) * MILKY_SPECTRUM_WATERFALL_HEIGHT);
+}
+
+const Effect milky_barEffect = {
+    "effect_bar", 0.0f,
+    resizeSpectrum, resizeSpectrum, updateSpectrumBars, renderSpectrumBarsBand, estimateSpectrumBarsCost, NULL
+};
+
+const Effect milky_spectralEffect = {
+    "effect_spectral", 0.0f,
+    resizeSpectrum, resizeSpectrum, updateSpectralWaterfall, renderSpectralWaterfallBand, estimateSpectralWaterfallCost, NULL
+};
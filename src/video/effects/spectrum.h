@@ -0,0 +1,48 @@
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "effect.h"
+
+#define MILKY_SPECTRUM_MAX_BANDS 128        // upper limit for the number of bars / waterfall columns
+#define MILKY_SPECTRUM_BAR_HEIGHT 0.25f     // maximum bar height as a fraction of the canvas height
+#define MILKY_SPECTRUM_BAR_GAP 0.2f         // gap between two bars as a fraction of the bar pitch
+#define MILKY_SPECTRUM_BAR_DECAY 0.85f      // per-frame fall-off of the bar heights (rise is immediate)
+#define MILKY_SPECTRUM_WATERFALL_ROWS 256   // rows kept in the waterfall ring texture (power of two)
+#define MILKY_SPECTRUM_WATERFALL_HEIGHT 0.25f // waterfall height as a fraction of the canvas height
+
+// bars and waterfall of a context
+typedef struct {
+    // smoothed bar heights (0..1), falling off by MILKY_SPECTRUM_BAR_DECAY per frame
+    float barLevels[MILKY_SPECTRUM_MAX_BANDS];
+    int barTop[MILKY_SPECTRUM_MAX_BANDS];
+    uint8_t barIntensity[MILKY_SPECTRUM_MAX_BANDS];
+    size_t barCount;
+
+    // column layout: first and last (exclusive) pixel of every bar / waterfall column
+    int barStart[MILKY_SPECTRUM_MAX_BANDS];
+    int barEnd[MILKY_SPECTRUM_MAX_BANDS];
+    int columnStart[MILKY_SPECTRUM_MAX_BANDS + 1];
+    size_t layoutWidth;
+    size_t layoutBands;
+    size_t width;
+    size_t height;
+
+    // waterfall ring texture: one row of band intensities per frame, the head advances instead of scrolling
+    uint8_t waterfall[MILKY_SPECTRUM_WATERFALL_ROWS][MILKY_SPECTRUM_MAX_BANDS];
+    size_t waterfallHead;
+    size_t waterfallBands;
+} SpectrumState;
+
+// spectrum bars along the bottom edge (preset property effect_bar)
+extern const Effect milky_barEffect;
+
+// scrolling spectral waterfall along the top edge (preset property effect_spectral)
+extern const Effect milky_spectralEffect;
+
+#endif // SPECTRUM_H
@@ -1,7 +1,5 @@
 #include "tunnel.h"
-
-static clock_t milky_tunnelLastPaletteInitTime = 0;
-
+#include "../../context.h"
 
 /**
  * Draws a pixel on the screen with specified RGBA values.
@@ -28,21 +26,68 @@ void drawPixel(uint8_t *screen, size_t width, size_t height, int x, int y, uint8
     screen[index + 3] = a; // A
 }
 
+/**
+ * Renders concentric anti-aliased rings around a common center.
+ *
+ * The rows covered by the outermost ring are split into bands of
+ * MILKY_TUNNEL_ROWS_PER_BAND rows; every band rasterizes all rings with the
+ * analytic span rasterizer (see drawRingRows()), so each row is written by one
+ * thread and the cost scales with the rings' area.
+ *
+ * @param screen    The screen buffer to render the rings on.
+ * @param width     The width of the screen buffer in pixels.
+ * @param height    The height of the screen buffer in pixels.
+ * @param centerX   The x-coordinate of the common center.
+ * @param centerY   The y-coordinate of the common center.
+ * @param radii     The (center line) radii of the rings.
+ * @param count     The number of rings.
+ * @param thickness The thickness of every ring in pixels.
+ * @param intensity The gray level of the rings.
+ */
+void renderTunnelRings(uint8_t *screen, size_t width, size_t height, float centerX, float centerY, const float *radii, unsigned int count, float thickness, uint8_t intensity) {
+    float maxRadius = 0.0f;
+    for (unsigned int k = 0; k < count; k++) {
+        if (radii[k] > maxRadius) maxRadius = radii[k];
+    }
+
+    // only the rows the rings can touch
+    int top = (int)floorf(centerY - maxRadius - thickness);
+    int bottom = (int)ceilf(centerY + maxRadius + thickness);
+    if (top < 0) top = 0;
+    if (bottom > (int)height) bottom = (int)height;
+    if (bottom <= top) return;
+
+    const int bandCount = (bottom - top + MILKY_TUNNEL_ROWS_PER_BAND - 1) / MILKY_TUNNEL_ROWS_PER_BAND;
+    const float halfThickness = thickness * 0.5f;
+
+    #pragma omp parallel for schedule(dynamic, 4)
+    for (int band = 0; band < bandCount; band++) {
+        size_t yStart = (size_t)(top + band * MILKY_TUNNEL_ROWS_PER_BAND);
+        size_t yEnd = yStart + MILKY_TUNNEL_ROWS_PER_BAND > (size_t)bottom ? (size_t)bottom : yStart + MILKY_TUNNEL_ROWS_PER_BAND;
+        for (unsigned int k = 0; k < count; k++) {
+            drawRingRows(screen, width, yStart, yEnd, centerX, centerY, radii[k] - halfThickness, radii[k] + halfThickness, intensity);
+        }
+    }
+}
+
 /**
  Renders a tunnel circle (a circle that gets faded into a tunnely visualiztation) 
 
+ Draws `count` concentric rings, starting at `radius` and growing by
+ MILKY_TUNNEL_RING_SPACING per ring (rings that don't fit the screen are dropped).
+
  @param timeFrame The current time frame for animation (used to create variation in chaser movement).
  @param screen    The screen buffer to render the chasers on.
  @param speed     The speed factor for chaser movement (higher values result in faster movement).
- @param count     The number of chasers to render.
+ @param count     The number of concentric rings to render.
  @param width     The width of the screen buffer in pixels.
  @param height    The height of the screen buffer in pixels.
  @param seed      The seed value for random number generation (used to ensure reproducibility).
 */
-void renderTunnelCircle(size_t currentTime, float timeFrame, uint8_t *screen, int radius, unsigned int count, size_t width, size_t height, unsigned int seed, int thickness) {
+void renderTunnelCircle(MilkyContext *context, size_t currentTime, float timeFrame, uint8_t *screen, int radius, unsigned int count, size_t width, size_t height, unsigned int seed, int thickness) {
 
     // check if it's time to regenerate the palette based on energy spikes and time elapsed
-     if ((milky_energyEnergySpikeDetected && currentTime - milky_tunnelLastPaletteInitTime > 20 /** ms */) || milky_tunnelLastPaletteInitTime == 0) {
+     if ((context->energy.energySpikeDetected && currentTime - context->tunnel.lastPaletteInitTime > 20 /** ms */) || context->tunnel.lastPaletteInitTime == 0) {
     // Calculate center coordinates
         float centerX = width / 2.0f;
         float centerY = height / 2.0f;
@@ -60,32 +105,18 @@ void renderTunnelCircle(size_t currentTime, float timeFrame, uint8_t *screen, in
             if (radius < 0) radius = 0;
         }
 
-        // Precompute thickness boundaries
-        float innerRadius = (float)radius - (float)thickness / 2.0f;
-        float outerRadius = (float)radius + (float)thickness / 2.0f;
-
-        // Define circle color (e.g., white)
-        uint8_t circleR = MILKY_MAX_COLOR;
-        uint8_t circleG = MILKY_MAX_COLOR;
-        uint8_t circleB = MILKY_MAX_COLOR;
-        uint8_t circleA = MILKY_MAX_COLOR;
-
-        // Parallelize the loop over each pixel
-        #pragma omp parallel for schedule(static) collapse(2)
-        for (size_t y = 0; y < height; y++) {
-            for (size_t x = 0; x < width; x++) {
-                // Compute distance from the center
-                float dx = (float)x - centerX;
-                float dy = (float)y - centerY;
-                float distance = sqrtf(dx * dx + dy * dy);
-
-                // Check if the pixel is within the thickness range
-                if (distance >= innerRadius && distance <= outerRadius) {
-                    drawPixel(screen, width, height, (int)x, (int)y, circleR, circleG, circleB, circleA);
-                }
-            }
+        // concentric rings in perspective spacing, as long as they fit the screen
+        float maxRadius = (float)(width > height ? width / 2 : height / 2) - (float)thickness / 2.0f;
+        float radii[MILKY_TUNNEL_MAX_RINGS];
+        unsigned int ringCount = 0;
+        float ringRadius = (float)radius;
+        while (ringCount < count && ringCount < MILKY_TUNNEL_MAX_RINGS && (ringRadius <= maxRadius || ringCount == 0)) {
+            radii[ringCount++] = ringRadius;
+            ringRadius *= MILKY_TUNNEL_RING_SPACING;
         }
 
-        milky_tunnelLastPaletteInitTime = currentTime; // update the last initialization time
+        renderTunnelRings(screen, width, height, centerX, centerY, radii, ringCount, (float)thickness, MILKY_TUNNEL_MAX_COLOR);
+
+        context->tunnel.lastPaletteInitTime = currentTime; // update the last initialization time
     }
 }
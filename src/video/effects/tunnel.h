@@ -7,15 +7,32 @@
 #include <stdlib.h>
 #include <time.h>
 #include "../../audio/energy.h"
+#include "../draw.h"
 
 #ifdef __ARM_NEON__
 #include <arm_neon.h>
+#include "../../milky.h"
 #endif
 
 // intensity of the chaser's trail on the screen
-#define MILKY_MAX_COLOR 255
+#define MILKY_TUNNEL_MAX_COLOR 255
+
+// upper limit for the number of concentric rings drawn in one call
+#define MILKY_TUNNEL_MAX_RINGS 64
+
+// radius ratio of two neighboring tunnel rings (perspective spacing)
+#define MILKY_TUNNEL_RING_SPACING 1.6f
+
+// rows rasterized per parallel work item
+#define MILKY_TUNNEL_ROWS_PER_BAND 16
+
+// tunnel of a context
+typedef struct {
+    clock_t lastPaletteInitTime; // time of the last palette change (0 = none yet)
+} TunnelState;
 
 void drawPixel(uint8_t *screen, size_t width, size_t height, int x, int y, uint8_t r, uint8_t g, uint8_t b, uint8_t a);
-void renderTunnelCircle(size_t currentTime, float timeFrame, uint8_t *screen, int radius, unsigned int count, size_t width, size_t height, unsigned int seed, int thickness);
+void renderTunnelRings(uint8_t *screen, size_t width, size_t height, float centerX, float centerY, const float *radii, unsigned int count, float thickness, uint8_t intensity);
+void renderTunnelCircle(MilkyContext *context, size_t currentTime, float timeFrame, uint8_t *screen, int radius, unsigned int count, size_t width, size_t height, unsigned int seed, int thickness);
 
 #endif // TUNNEL_H
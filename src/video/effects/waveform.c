@@ -0,0 +1,214 @@
+#include "waveform.h"
+#include "../../context.h"
+
+/**
+ * Rebuilds the polar lookup tables for a new number of points, so the radial
+ * scopes need no trigonometry per frame.
+ *
+ * @param pointCount Number of points around the circle.
+ */
+static void updatePolarTables(MilkyContext *context, size_t pointCount) {
+    if (pointCount == context->waveform.polarPointCount) return;
+
+    const float angleStep = 2.0f * 3.14159265f / (float)pointCount;
+    for (size_t j = 0; j < pointCount; j++) {
+        // start at the top and go clockwise
+        float angle = (float)j * angleStep - 0.5f * 3.14159265f;
+        context->waveform.cos[j] = cosf(angle);
+        context->waveform.sin[j] = sinf(angle);
+    }
+    context->waveform.polarPointCount = pointCount;
+}
+
+/**
+ * Resamples the perceptual band levels to `pointCount` points by linear interpolation.
+ *
+ * @param pointCount Number of points to produce (at least 2).
+ */
+static void resampleSpectrum(MilkyContext *context, size_t pointCount) {
+    size_t bandCount = 0;
+    const float *levels = getSpectrumBandLevels(context, &bandCount);
+
+    if (!levels || bandCount < 2) {
+        memset(context->waveform.spectrumPoints, 0, pointCount * sizeof(float));
+        return;
+    }
+
+    const float step = (float)(bandCount - 1) / (float)(pointCount - 1);
+    for (size_t j = 0; j < pointCount; j++) {
+        float position = (float)j * step;
+        size_t index = (size_t)position;
+        index = index > bandCount - 2 ? bandCount - 2 : index;
+        float fraction = position - (float)index;
+        context->waveform.spectrumPoints[j] = (levels[index] + (levels[index + 1] - levels[index]) * fraction) * 256.0f;
+    }
+}
+
+/**
+ * Resamples the waveform to `pointCount` points by linear interpolation and
+ * centers the values around 0 (removing the 128 offset and the smoothing's bias).
+ *
+ * @param waveform       Waveform samples (see smoothBassEmphasizedWaveform()).
+ * @param waveformLength Number of waveform samples (at least 2).
+ * @param pointCount     Number of points to produce (at least 2).
+ */
+static void resampleWaveform(MilkyContext *context, const float *waveform, size_t waveformLength, size_t pointCount) {
+    const float step = (float)(waveformLength - 1) / (float)(pointCount - 1);
+    const float bias = 128.0f + context->sound.averageOffset;
+    const int lastIndex = (int)waveformLength - 2;
+    size_t j = 0;
+
+#if defined(__AVX2__)
+    const __m256 stepVector = _mm256_set1_ps(step);
+    const __m256 biasVector = _mm256_set1_ps(bias);
+    const __m256i lastVector = _mm256_set1_epi32(lastIndex);
+    const __m256 lanes = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+    for (; j + 8 <= pointCount; j += 8) {
+        __m256 position = _mm256_mul_ps(_mm256_add_ps(_mm256_set1_ps((float)j), lanes), stepVector);
+        __m256i index = _mm256_min_epi32(_mm256_cvttps_epi32(position), lastVector);
+        __m256 fraction = _mm256_sub_ps(position, _mm256_cvtepi32_ps(index));
+        __m256 a = _mm256_i32gather_ps(waveform, index, 4);
+        __m256 b = _mm256_i32gather_ps(waveform + 1, index, 4);
+        __m256 value = _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), fraction));
+        _mm256_storeu_ps(&context->waveform.points[j], _mm256_sub_ps(value, biasVector));
+    }
+#endif
+
+    for (; j < pointCount; j++) {
+        float position = (float)j * step;
+        int index = (int)position;
+        index = index > lastIndex ? lastIndex : index;
+        float fraction = position - (float)index;
+        float value = waveform[index] + (waveform[index + 1] - waveform[index]) * fraction;
+        context->waveform.points[j] = value - bias;
+    }
+    context->waveform.pointCount = pointCount;
+}
+
+/**
+ * Queues a scope line along the canvas width: point j at the baseline minus its
+ * value times the scale (a negative scale reflects the line at the baseline).
+ */
+static void queueWaveformLine(MilkyContext *context, const WaveformLayer *layer, const float *values, size_t pointCount,
+                              float spacing, float baseline, float scale) {
+    float points[2 * MILKY_WAVEFORM_MAX_POINTS];
+    for (size_t j = 0; j < pointCount; j++) {
+        points[2 * j] = (float)j * spacing;
+        points[2 * j + 1] = baseline - values[j] * scale;
+    }
+    queueRasterPolyline(context, points, pointCount, layer->thickness, layer->intensity);
+}
+
+/**
+ * Queues a scope around the scope center (a closed line or one dot per point).
+ */
+static void queueRadialWaveform(MilkyContext *context, const WaveformLayer *layer, const float *values, size_t pointCount,
+                                float radius, float scale, float centerX, float centerY) {
+    float points[2 * (MILKY_WAVEFORM_MAX_POINTS + 1)];
+    for (size_t j = 0; j < pointCount; j++) {
+        // the spectrum runs up both sides of the circle, so its ends meet at the bottom
+        size_t index = layer->source == MILKY_SCOPE_SPECTRUM ? (j < pointCount / 2 ? 2 * j : 2 * (pointCount - j) - 1) : j;
+        float r = radius + values[index < pointCount ? index : pointCount - 1] * scale;
+        points[2 * j] = centerX + context->waveform.cos[j] * r;
+        points[2 * j + 1] = centerY + context->waveform.sin[j] * r;
+    }
+
+    if (layer->style == MILKY_WAVEFORM_RADIAL_DOTS) {
+        for (size_t j = 0; j < pointCount; j++) {
+            queueRasterDisc(context, points[2 * j], points[2 * j + 1], layer->thickness * 0.5f, layer->intensity);
+        }
+        return;
+    }
+
+    // close the ring
+    points[2 * pointCount] = points[0];
+    points[2 * pointCount + 1] = points[1];
+    queueRasterPolyline(context, points, pointCount + 1, layer->thickness, layer->intensity);
+}
+
+/**
+ * Queues one layer of the scope into the current raster batch.
+ */
+static void queueWaveformLayer(MilkyContext *context, const WaveformLayer *layer, size_t width, size_t height, float centerX, float centerY) {
+    const size_t pointCount = context->waveform.pointCount;
+    const float *values = layer->source == MILKY_SCOPE_SPECTRUM ? context->waveform.spectrumPoints : context->waveform.points;
+    const float spacing = (float)width / (float)(pointCount - 1);
+    const float scale = layer->amplitude * (float)height / 512.0f;
+    const float baseline = layer->position * (float)height;
+
+    switch (layer->style) {
+    case MILKY_WAVEFORM_DOTS:
+        for (size_t j = 0; j < pointCount; j++) {
+            queueRasterDisc(context, (float)j * spacing, baseline - values[j] * scale, layer->thickness * 0.5f, layer->intensity);
+        }
+        break;
+
+    case MILKY_WAVEFORM_FILLED:
+        // one column (as wide as the point spacing) per point, from the baseline to the sample
+        for (size_t j = 0; j < pointCount; j++) {
+            float x = (float)j * spacing;
+            queueRasterRect(context, x - spacing * 0.5f, baseline, x + spacing * 0.5f, baseline - values[j] * scale, layer->intensity);
+        }
+        break;
+
+    case MILKY_WAVEFORM_MIRRORED:
+        // the reflection, then the line itself
+        queueWaveformLine(context, layer, values, pointCount, spacing, baseline, -scale);
+        __attribute__((fallthrough));
+    case MILKY_WAVEFORM_LINES:
+        queueWaveformLine(context, layer, values, pointCount, spacing, baseline, scale);
+        break;
+
+    case MILKY_WAVEFORM_RADIAL:
+    case MILKY_WAVEFORM_RADIAL_DOTS:
+        queueRadialWaveform(context, layer, values, pointCount, layer->position * (float)height * 0.5f, scale, centerX, centerY);
+        break;
+    }
+}
+
+/**
+ * Renders the waveform / spectrum scopes: the waveform is resampled to the canvas
+ * width once (SIMD linear interpolation, refreshed every MILKY_WAVEFORM_HOLD_FRAMES
+ * frames), then every layer is queued as connected anti-aliased segments (or dots)
+ * and all layers are rasterized together in a single band-parallel pass.
+ * Radial layers use the same points, placed around the scope center with the
+ * polar lookup tables, so they cost about the same as the linear ones.
+ *
+ * @param screen         The screen buffer to render on (RGBA format).
+ * @param width          The width of the screen buffer in pixels.
+ * @param height         The height of the screen buffer in pixels.
+ * @param waveform       Waveform samples (see smoothBassEmphasizedWaveform()).
+ * @param waveformLength Number of waveform samples.
+ * @param layers         The layers to draw, in drawing order.
+ * @param layerCount     The number of layers.
+ * @param centerX        Horizontal center of the radial scopes as a fraction of the canvas width (preset x_center).
+ * @param centerY        Vertical center of the radial scopes as a fraction of the canvas height (preset y_center).
+ */
+void renderWaveform(MilkyContext *context, uint8_t *screen, size_t width, size_t height, const float *waveform, size_t waveformLength,
+                    const WaveformLayer *layers, size_t layerCount, float centerX, float centerY) {
+    if (!waveform || waveformLength < 2 || width < 2 || height == 0 || layerCount == 0) return;
+    if (layerCount > MILKY_WAVEFORM_MAX_LAYERS) layerCount = MILKY_WAVEFORM_MAX_LAYERS;
+
+    size_t pointCount = (size_t)((float)width / MILKY_WAVEFORM_POINT_SPACING) + 1;
+    pointCount = pointCount < 2 ? 2 : (pointCount > MILKY_WAVEFORM_MAX_POINTS ? MILKY_WAVEFORM_MAX_POINTS : pointCount);
+
+    if (context->waveform.frameCounter % MILKY_WAVEFORM_HOLD_FRAMES == 0 || pointCount != context->waveform.pointCount) {
+        resampleWaveform(context, waveform, waveformLength, pointCount);
+    }
+    context->waveform.frameCounter++;
+
+    // the spectrum and the polar tables are only needed by layers that show them
+    int needsSpectrum = 0, needsPolar = 0;
+    for (size_t i = 0; i < layerCount; i++) {
+        needsSpectrum |= layers[i].source == MILKY_SCOPE_SPECTRUM;
+        needsPolar |= layers[i].style == MILKY_WAVEFORM_RADIAL || layers[i].style == MILKY_WAVEFORM_RADIAL_DOTS;
+    }
+    if (needsSpectrum) resampleSpectrum(context, pointCount);
+    if (needsPolar) updatePolarTables(context, pointCount);
+
+    beginRasterBatch(context, width, height);
+    for (size_t i = 0; i < layerCount; i++) {
+        queueWaveformLayer(context, &layers[i], width, height, centerX * (float)width, centerY * (float)height);
+    }
+    flushRasterBatch(context, screen);
+}
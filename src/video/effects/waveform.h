@@ -0,0 +1,66 @@
+#ifndef WAVEFORM_H
+#define WAVEFORM_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "../raster.h"
+#include "../../audio/sound.h"
+#include "../../audio/bands.h"
+#include "../../milky.h"
+
+#define MILKY_WAVEFORM_MAX_POINTS 2048     // upper limit for the resampled points per layer
+#define MILKY_WAVEFORM_POINT_SPACING 4.0f  // horizontal distance of two resampled points in pixels
+#define MILKY_WAVEFORM_HOLD_FRAMES 2       // the resampled waveform is refreshed every n-th frame
+#define MILKY_WAVEFORM_MAX_LAYERS 8        // upper limit for the layers drawn in one pass
+
+typedef enum {
+    MILKY_WAVEFORM_DOTS = 0,     // one dot per resampled point
+    MILKY_WAVEFORM_LINES = 1,    // connected oscilloscope line
+    MILKY_WAVEFORM_FILLED = 2,   // area between the baseline and the waveform
+    MILKY_WAVEFORM_MIRRORED = 3, // line plus its reflection at the baseline
+    MILKY_WAVEFORM_RADIAL = 4,   // closed line around the scope center
+    MILKY_WAVEFORM_RADIAL_DOTS = 5 // one dot per point around the scope center
+} WaveformStyle;
+
+typedef enum {
+    MILKY_SCOPE_WAVEFORM = 0,    // the (smoothed) waveform
+    MILKY_SCOPE_SPECTRUM = 1     // the perceptual spectrum bands (see getSpectrumBandLevels())
+} ScopeSource;
+
+// one layer of the waveform scope
+typedef struct {
+    WaveformStyle style; // how the layer is drawn
+    ScopeSource source;  // what the layer shows
+    float position;      // baseline as a fraction of the canvas height (radial: ring radius as a fraction of half the height)
+    float amplitude;     // vertical scale (1.0 = the classic scope, 256 sample steps span half the canvas height)
+    float thickness;     // line thickness (dot diameter) in pixels
+    uint8_t intensity;   // gray level to blend in
+} WaveformLayer;
+
+// scope of a context
+typedef struct {
+    // waveform resampled to the canvas width (sample values centered around 0)
+    float points[MILKY_WAVEFORM_MAX_POINTS];
+    size_t pointCount;
+    int frameCounter;
+
+    // spectrum bands resampled to the same number of points (0..256, like the waveform's range)
+    float spectrumPoints[MILKY_WAVEFORM_MAX_POINTS];
+
+    // polar lookup tables: direction of every point index on the radial scopes (rebuilt on resize)
+    float cos[MILKY_WAVEFORM_MAX_POINTS];
+    float sin[MILKY_WAVEFORM_MAX_POINTS];
+    size_t polarPointCount;
+} WaveformState;
+
+void renderWaveform(MilkyContext *context, uint8_t *screen, size_t width, size_t height, const float *waveform, size_t waveformLength,
+                    const WaveformLayer *layers, size_t layerCount, float centerX, float centerY);
+
+#endif // WAVEFORM_H
@@ -0,0 +1,169 @@
+#include "export.h"
+
+// the shared memory (one export per process)
+static int milky_exportFile = -1;
+static char milky_exportName[256];
+static ExportHeader *milky_exportHeader = NULL;
+static size_t milky_exportMappingSize = 0;
+static uint64_t milky_exportSequence = 0;
+
+static size_t alignExportSize(size_t size) {
+    return (size + MILKY_EXPORT_ALIGNMENT - 1) / MILKY_EXPORT_ALIGNMENT * MILKY_EXPORT_ALIGNMENT;
+}
+
+/**
+ * Sizes the shared memory for slots of at least `frameSize` bytes and (re)maps it.
+ * Only grows; existing slots are invalidated first, since their offsets change.
+ *
+ * @param frameSize Bytes of one frame.
+ * @return          1 on success, 0 on failure (the old mapping stays valid).
+ */
+static int reserveFrameExport(size_t frameSize) {
+    if (milky_exportHeader && frameSize <= milky_exportHeader->slotSize) return 1;
+
+    const size_t slotCount = milky_exportHeader ? milky_exportHeader->slotCount : 0;
+    const size_t slotOffset = alignExportSize(sizeof(ExportHeader));
+    const size_t slotSize = alignExportSize(frameSize);
+    const size_t mappingSize = slotOffset + slotCount * slotSize;
+
+    // consumers that still read a slot see its sequence change and drop the frame
+    for (size_t i = 0; i < slotCount; i++) {
+        __atomic_store_n(&milky_exportHeader->slots[i].sequence, 0, __ATOMIC_RELEASE);
+    }
+
+    if (ftruncate(milky_exportFile, (off_t)mappingSize) != 0) {
+        fprintf(stderr, "Failed to resize the frame export: %s\n", strerror(errno));
+        return 0;
+    }
+    void *mapping = mmap(NULL, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, milky_exportFile, 0);
+    if (mapping == MAP_FAILED) {
+        fprintf(stderr, "Failed to map the frame export: %s\n", strerror(errno));
+        return 0;
+    }
+    munmap(milky_exportHeader, milky_exportMappingSize);
+    milky_exportHeader = (ExportHeader *)mapping;
+    milky_exportMappingSize = mappingSize;
+
+    milky_exportHeader->slotOffset = slotOffset;
+    milky_exportHeader->slotSize = slotSize;
+    __atomic_store_n(&milky_exportHeader->mappingSize, (uint64_t)mappingSize, __ATOMIC_RELEASE);
+    return 1;
+}
+
+/**
+ * Creates a POSIX shared memory object (/dev/shm/NAME) with a ring of frame slots,
+ * which local consumers (an OBS source, a compositor) map to read the frames in
+ * place. See export.h for the layout and the protocol.
+ *
+ * @param name      Name of the shared memory object (leading '/' optional).
+ * @param slotCount Number of slots (clamped to [2, MILKY_EXPORT_MAX_SLOTS]).
+ * @param width     Initial canvas width (the slots grow with the canvas).
+ * @param height    Initial canvas height.
+ * @return          1 on success, 0 on failure.
+ */
+int openFrameExport(const char *name, size_t slotCount, size_t width, size_t height) {
+    closeFrameExport();
+
+    snprintf(milky_exportName, sizeof(milky_exportName), "%s%s", name[0] == '/' ? "" : "/", name);
+    milky_exportFile = shm_open(milky_exportName, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (milky_exportFile < 0) {
+        fprintf(stderr, "Failed to create the frame export %s: %s\n", milky_exportName, strerror(errno));
+        return 0;
+    }
+
+    // the header alone first, then the slots
+    const size_t headerSize = alignExportSize(sizeof(ExportHeader));
+    if (ftruncate(milky_exportFile, (off_t)headerSize) != 0) {
+        fprintf(stderr, "Failed to resize the frame export: %s\n", strerror(errno));
+        closeFrameExport();
+        return 0;
+    }
+    void *mapping = mmap(NULL, headerSize, PROT_READ | PROT_WRITE, MAP_SHARED, milky_exportFile, 0);
+    if (mapping == MAP_FAILED) {
+        fprintf(stderr, "Failed to map the frame export: %s\n", strerror(errno));
+        closeFrameExport();
+        return 0;
+    }
+    milky_exportHeader = (ExportHeader *)mapping;
+    milky_exportMappingSize = headerSize;
+
+    if (slotCount < 2) slotCount = 2;
+    if (slotCount > MILKY_EXPORT_MAX_SLOTS) slotCount = MILKY_EXPORT_MAX_SLOTS;
+    memset(milky_exportHeader, 0, sizeof(ExportHeader));
+    milky_exportHeader->version = MILKY_EXPORT_VERSION;
+    milky_exportHeader->slotCount = (uint32_t)slotCount;
+    milky_exportHeader->slotOffset = headerSize;
+    milky_exportSequence = 0;
+
+    if (!reserveFrameExport(width * height * 4)) {
+        closeFrameExport();
+        return 0;
+    }
+
+    // consumers check the magic last
+    __atomic_store_n(&milky_exportHeader->magic, MILKY_EXPORT_MAGIC, __ATOMIC_RELEASE);
+    return 1;
+}
+
+/**
+ * Checks whether frames are exported.
+ */
+int isFrameExportOpen(void) {
+    return milky_exportHeader != NULL;
+}
+
+/**
+ * Publishes a finished frame to the next slot of the ring (one copy; the feedback
+ * loop keeps rendering into its own buffer, so it can't render into a slot).
+ *
+ * @param pixels The frame (RGBA format).
+ * @param width  Its width in pixels.
+ * @param height Its height in pixels.
+ * @return       1 on success, 0 if the frame couldn't be published.
+ */
+int publishFrameExport(const uint8_t *pixels, size_t width, size_t height) {
+    if (!milky_exportHeader) return 0;
+
+    const size_t frameSize = width * height * 4;
+    if (!reserveFrameExport(frameSize)) return 0;
+
+    const uint64_t sequence = milky_exportSequence + 1;
+    const size_t index = (size_t)((sequence - 1) % milky_exportHeader->slotCount);
+    ExportSlot *slot = &milky_exportHeader->slots[index];
+
+    // mark the slot as being written before touching its pixels
+    __atomic_store_n(&slot->sequence, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    memcpy((uint8_t *)milky_exportHeader + milky_exportHeader->slotOffset + index * milky_exportHeader->slotSize, pixels, frameSize);
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    slot->width = (uint32_t)width;
+    slot->height = (uint32_t)height;
+    slot->stride = (uint32_t)(width * 4);
+    slot->format = MILKY_EXPORT_FORMAT_RGBA;
+    slot->timeUs = (uint64_t)now.tv_sec * 1000000u + (uint64_t)now.tv_nsec / 1000u;
+
+    __atomic_store_n(&slot->sequence, sequence, __ATOMIC_RELEASE);
+    __atomic_store_n(&milky_exportHeader->sequence, sequence, __ATOMIC_RELEASE);
+    milky_exportSequence = sequence;
+    return 1;
+}
+
+/**
+ * Unmaps and removes the shared memory (consumers keep their mappings until they
+ * unmap them; safe to call if nothing is exported).
+ */
+void closeFrameExport(void) {
+    if (milky_exportHeader) {
+        munmap(milky_exportHeader, milky_exportMappingSize);
+        milky_exportHeader = NULL;
+        milky_exportMappingSize = 0;
+    }
+    if (milky_exportFile >= 0) {
+        close(milky_exportFile);
+        shm_unlink(milky_exportName);
+        milky_exportFile = -1;
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef EXPORT_H
+#define EXPORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define MILKY_EXPORT_MAGIC 0x4b4c494du        // "MILK" (little endian)
+#define MILKY_EXPORT_VERSION 1
+#define MILKY_EXPORT_FORMAT_RGBA 0x41424752u  // fourcc "RGBA": 4 bytes per pixel, rows top to bottom
+#define MILKY_EXPORT_MAX_SLOTS 8              // upper limit of the ring size
+#define MILKY_EXPORT_DEFAULT_SLOTS 3          // consumers have two frames of time to read a slot
+#define MILKY_EXPORT_ALIGNMENT 4096           // the header and every slot start on a page
+
+/*
+ * Layout of the shared memory (/dev/shm/NAME, see openFrameExport()):
+ *
+ *   [ExportHeader, padded to MILKY_EXPORT_ALIGNMENT] [slot 0] [slot 1] ... [slot N-1]
+ *
+ * Slot i starts at slotOffset + i * slotSize. Frame n (n = 1, 2, ...) is written to
+ * slot (n - 1) % slotCount, then published by storing n to the slot's sequence and
+ * to the header's sequence (release). A consumer loads the header's sequence n
+ * (acquire), checks that the slot's sequence is n, reads the pixels in place (or
+ * copies them) and checks the slot's sequence again: if it changed, the slot was
+ * overwritten meanwhile and the frame must be dropped. A slot's sequence is 0 while
+ * the slot is being written.
+ *
+ * The mapping only grows (on canvas resizes): consumers remap when mappingSize is
+ * larger than their mapping.
+ */
+
+// geometry of the frame in a slot
+typedef struct {
+    uint64_t sequence; // frame number in the slot (0 = being written, accessed atomically)
+    uint32_t width;    // in pixels
+    uint32_t height;
+    uint32_t stride;   // bytes per row
+    uint32_t format;   // MILKY_EXPORT_FORMAT_RGBA
+    uint64_t timeUs;   // CLOCK_MONOTONIC time of publishing in microseconds
+} ExportSlot;
+
+// start of the shared memory
+typedef struct {
+    uint32_t magic;      // MILKY_EXPORT_MAGIC
+    uint32_t version;    // MILKY_EXPORT_VERSION
+    uint32_t slotCount;
+    uint32_t reserved;
+    uint64_t slotOffset; // byte offset of slot 0 from the start of the mapping
+    uint64_t slotSize;   // bytes per slot (changes with mappingSize)
+    uint64_t mappingSize;
+    uint64_t sequence;   // number of the newest published frame (0 = none yet, accessed atomically)
+    ExportSlot slots[MILKY_EXPORT_MAX_SLOTS];
+} ExportHeader;
+
+int openFrameExport(const char *name, size_t slotCount, size_t width, size_t height);
+int isFrameExportOpen(void);
+int publishFrameExport(const uint8_t *pixels, size_t width, size_t height);
+void closeFrameExport(void);
+
+#endif // EXPORT_H
@@ -0,0 +1,66 @@
+#include "fixed.h"
+
+/**
+ * Blends `source` into `destination` byte by byte with a Q8.8 weight:
+ * destination = destination * (1 - weight) + source * weight.
+ * Uses 16-bit lanes, so one 256-bit register handles 16 channels per multiply
+ * (twice as many as the 32-bit float lanes).
+ *
+ * @param destination The buffer to blend into.
+ * @param source      The buffer to blend from.
+ * @param count       The number of bytes.
+ * @param weight      Weight of the source in Q8.8 (0..256).
+ */
+void blendFixed(uint8_t *destination, const uint8_t *source, size_t count, uint16_t weight) {
+    const size_t blockCount = count / 32;
+
+#if defined(__AVX2__)
+    const __m256i sourceWeight = _mm256_set1_epi16((short)weight);
+    const __m256i destinationWeight = _mm256_set1_epi16((short)(MILKY_FIXED_ONE - weight));
+
+    #pragma omp parallel for schedule(static)
+    for (size_t block = 0; block < blockCount; block++) {
+        uint8_t *target = &destination[block * 32];
+        const __m256i to = _mm256_loadu_si256((const __m256i *)&source[block * 32]);
+        const __m256i from = _mm256_loadu_si256((const __m256i *)target);
+
+        // widen to 16 bit (both halves), weight, add and keep the high bytes
+        __m256i low = _mm256_add_epi16(
+            _mm256_mullo_epi16(_mm256_unpacklo_epi8(from, _mm256_setzero_si256()), destinationWeight),
+            _mm256_mullo_epi16(_mm256_unpacklo_epi8(to, _mm256_setzero_si256()), sourceWeight));
+        __m256i high = _mm256_add_epi16(
+            _mm256_mullo_epi16(_mm256_unpackhi_epi8(from, _mm256_setzero_si256()), destinationWeight),
+            _mm256_mullo_epi16(_mm256_unpackhi_epi8(to, _mm256_setzero_si256()), sourceWeight));
+
+        // unpack and pack work per 128-bit lane, so the byte order is restored by the pack
+        _mm256_storeu_si256((__m256i *)target,
+            _mm256_packus_epi16(_mm256_srli_epi16(low, MILKY_FIXED_SHIFT), _mm256_srli_epi16(high, MILKY_FIXED_SHIFT)));
+    }
+#elif defined(__ARM_NEON__)
+    const uint16x8_t sourceWeight = vdupq_n_u16(weight);
+    const uint16x8_t destinationWeight = vdupq_n_u16((uint16_t)(MILKY_FIXED_ONE - weight));
+
+    #pragma omp parallel for schedule(static)
+    for (size_t block = 0; block < blockCount * 2; block++) {
+        uint8_t *target = &destination[block * 16];
+        const uint8x16_t to = vld1q_u8(&source[block * 16]);
+        const uint8x16_t from = vld1q_u8(target);
+
+        uint16x8_t low = vmlaq_u16(vmulq_u16(vmovl_u8(vget_low_u8(from)), destinationWeight),
+                                   vmovl_u8(vget_low_u8(to)), sourceWeight);
+        uint16x8_t high = vmlaq_u16(vmulq_u16(vmovl_u8(vget_high_u8(from)), destinationWeight),
+                                    vmovl_u8(vget_high_u8(to)), sourceWeight);
+
+        vst1q_u8(target, vcombine_u8(vshrn_n_u16(low, MILKY_FIXED_SHIFT), vshrn_n_u16(high, MILKY_FIXED_SHIFT)));
+    }
+#else
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < blockCount * 32; i++) {
+        destination[i] = lerpFixed(destination[i], source[i], weight);
+    }
+#endif
+
+    for (size_t i = blockCount * 32; i < count; i++) {
+        destination[i] = lerpFixed(destination[i], source[i], weight);
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef FIXED_H
+#define FIXED_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+#include <omp.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#ifdef __ARM_NEON__
+#include <arm_neon.h>
+#endif
+
+// Q8.8 fixed point: factors in [0, 1] are stored as 0..256, so an 8-bit channel times a
+// factor always fits into a 16-bit lane (255 * 256 = 65280) and the result is the high byte
+#define MILKY_FIXED_SHIFT 8
+#define MILKY_FIXED_ONE (1 << MILKY_FIXED_SHIFT)
+
+/**
+ * Converts a factor in [0, 1] to Q8.8 (rounded to the nearest step, clamped).
+ *
+ * @param value The factor.
+ * @return      The factor in Q8.8 (0..256).
+ */
+static inline uint16_t toFixed(float value) {
+    if (!(value > 0.0f)) return 0;
+    if (value >= 1.0f) return MILKY_FIXED_ONE;
+    return (uint16_t)lrintf(value * (float)MILKY_FIXED_ONE);
+}
+
+/**
+ * Scales a channel by a Q8.8 factor (truncating, like the float kernels' casts).
+ *
+ * @param value  The channel value.
+ * @param factor The factor in Q8.8.
+ * @return       value * factor.
+ */
+static inline uint8_t mulFixed(uint8_t value, uint16_t factor) {
+    return (uint8_t)(((uint32_t)value * factor) >> MILKY_FIXED_SHIFT);
+}
+
+/**
+ * Interpolates between two channels with a Q8.8 weight (truncating).
+ *
+ * @param from   Channel value at t = 0.
+ * @param to     Channel value at t = 1.
+ * @param weight Interpolation weight t in Q8.8.
+ * @return       from * (1 - t) + to * t.
+ */
+static inline uint8_t lerpFixed(uint8_t from, uint8_t to, uint16_t weight) {
+    return (uint8_t)(((uint32_t)from * (MILKY_FIXED_ONE - weight) + (uint32_t)to * weight) >> MILKY_FIXED_SHIFT);
+}
+
+/**
+ * Converts a fade factor in [0, 1) to Q0.16 (truncated, clamped). Repeated fades need
+ * finer factors than Q8.8: the channel is kept in Q8.8 in a 16-bit lane and the
+ * product's high 16 bits (one mulhi) are again Q8.8.
+ *
+ * @param value The factor (values of 1 or more must be handled by the caller).
+ * @return      The factor in Q0.16 (0..65535).
+ */
+static inline uint16_t toFixedFraction(float value) {
+    if (!(value > 0.0f)) return 0;
+    if (value >= 65535.0f / 65536.0f) return 65535;
+    return (uint16_t)(value * 65536.0f);
+}
+
+/**
+ * Scales a channel by a Q0.16 factor (truncating, like the float kernels' casts).
+ *
+ * @param value    The channel value.
+ * @param fraction The factor in Q0.16.
+ * @return         value * fraction.
+ */
+static inline uint8_t mulFixedFraction(uint8_t value, uint16_t fraction) {
+    return (uint8_t)(((uint32_t)value * fraction) >> 16);
+}
+
+void blendFixed(uint8_t *destination, const uint8_t *source, size_t count, uint16_t weight);
+
+#endif // FIXED_H
@@ -1,16 +1,5 @@
 #include "palette.h"
-
-// Define a palette as an array of 256 RGB color values
-uint8_t milky_palettePalette[MILKY_PALETTE_SIZE][3];
-static clock_t milky_paletteLastPaletteInitTime = 0;
-
-// **New Variables for Palette Transition**
-static RGB currentPalette[MILKY_PALETTE_SIZE];
-static RGB targetPalette[MILKY_PALETTE_SIZE];
-static RGB oldPalette[MILKY_PALETTE_SIZE];
-static int isTransitioning = 0;
-static int transitionStep = 0;
-static int totalTransitionSteps = 450; // Default transition steps
+#include "../context.h"
 
 // Helper function for HSL to RGB conversion
 float hue2rgb(float p, float q, float t) {
@@ -102,15 +91,15 @@ RGB changeHue(RGB originalRgb, float newHue) {
  * @param g The green component value.
  * @param b The blue component value.
  */
-void setRGB(uint8_t index, uint8_t r, uint8_t g, uint8_t b) {
-    milky_palettePalette[index][0] = r; // Set red component
-    milky_palettePalette[index][1] = g; // Set green component
-    milky_palettePalette[index][2] = b; // Set blue component
+void setRGB(MilkyContext *context, uint8_t index, uint8_t r, uint8_t g, uint8_t b) {
+    context->palette.palette[index][0] = r; // Set red component
+    context->palette.palette[index][1] = g; // Set green component
+    context->palette.palette[index][2] = b; // Set blue component
 
     // Update currentPalette for transition purposes
-    currentPalette[index].r = r;
-    currentPalette[index].g = g;
-    currentPalette[index].b = b;
+    context->palette.currentPalette[index].r = r;
+    context->palette.currentPalette[index].g = g;
+    context->palette.currentPalette[index].b = b;
 }
 
 // Function to apply brightness factor safely and selectively
@@ -158,7 +147,7 @@ void shiftHue(uint8_t r, uint8_t g, uint8_t b, float matrix[3][3], uint8_t* r_ou
 }
 
 // Light Purple palette generation with hue adjustment using rotation matrix
-void generateHuePalette(float hue_shift, float brightness_purple) {
+void generateHuePalette(MilkyContext *context, float hue_shift, float brightness_purple) {
     float rotationMatrix[3][3];
     calculateHueRotationMatrix(hue_shift, rotationMatrix);
     
@@ -190,13 +179,13 @@ void generateHuePalette(float hue_shift, float brightness_purple) {
         shiftHue(r, g, b, rotationMatrix, &shifted_r, &shifted_g, &shifted_b);
         
         // Set the shifted RGB values in the palette
-        setRGB(a, shifted_r, shifted_g, shifted_b);
+        setRGB(context, a, shifted_r, shifted_g, shifted_b);
     }
     
     // Set the remaining colors to maximum intensity white
     #pragma omp parallel for
     for (int a = GRADIENT_SIZE; a < MILKY_PALETTE_SIZE; a++) {
-        setRGB(a, MILKY_MAX_COLOR, MILKY_MAX_COLOR, MILKY_MAX_COLOR); // Pure white
+        setRGB(context, a, MILKY_MAX_COLOR, MILKY_MAX_COLOR, MILKY_MAX_COLOR); // Pure white
     }
 }
 
@@ -204,12 +193,9 @@ void generateHuePalette(float hue_shift, float brightness_purple) {
  * Generates a random color palette based on predefined types.
  * The palette is filled with different gradient effects depending on the selected type.
  */
-void generatePalette(void) {
-    // Seed the random number generator with the current time to ensure different results each time
-    srand((unsigned int)time(NULL));
-
-    // Randomly select a palette type from 0 to 6
-    int paletteType = rand() % 5;
+void generatePalette(MilkyContext *context) {
+    // Randomly select a palette type from 0 to 4 (from the sequence of the context)
+    int paletteType = (int)(nextContextRandom(context) % 5);
 
     // Generate the palette based on the selected type
     switch (paletteType) {
@@ -219,13 +205,13 @@ void generatePalette(void) {
                 // Fill the first 64 colors with a gradient effect
                 #pragma omp for
                 for (int a = 0; a < 64; a++) {
-                    setRGB(a, a, a * a / 64, (uint8_t)(sqrtf(a) * 8));
+                    setRGB(context, a, a, a * a / 64, (uint8_t)(sqrtf(a) * 8));
                 }
 
                 // Set the remaining colors to maximum intensity white
                 #pragma omp for
                 for (int a = 64; a < MILKY_PALETTE_SIZE; a++) {
-                    setRGB(a, MILKY_MAX_COLOR, MILKY_MAX_COLOR, MILKY_MAX_COLOR);
+                    setRGB(context, a, MILKY_MAX_COLOR, MILKY_MAX_COLOR, MILKY_MAX_COLOR);
                 }
             }
             break;
@@ -248,13 +234,13 @@ void generatePalette(void) {
                         // Blue remains minimal to maintain yellow (can set to 0 or a small value for variation)
                         uint8_t blue = 0; // Alternatively, use a small value like (uint8_t)(sqrtf(a) * 2) for slight variation
 
-                        setRGB(a, applyBrightness(red, brightness), applyBrightness(green, brightness), blue);
+                        setRGB(context, a, applyBrightness(red, brightness), applyBrightness(green, brightness), blue);
                     }
 
                     // Set the remaining colors to maximum intensity yellow
                     #pragma omp for
                     for (int a = 64; a < MILKY_PALETTE_SIZE; a++) {
-                        setRGB(a, MILKY_MAX_COLOR, MILKY_MAX_COLOR, 0); // Pure yellow
+                        setRGB(context, a, MILKY_MAX_COLOR, MILKY_MAX_COLOR, 0); // Pure yellow
                     }
                 }
             }
@@ -266,13 +252,13 @@ void generatePalette(void) {
                 // Fill the first 64 colors with yet another gradient effect
                 #pragma omp for
                 for (int a = 0; a < 64; a++) {
-                    setRGB(a, fminf((uint8_t)(sqrtf(a) * 8), a), fmaxf(a, a+10), fminf(a * a / 64, a));
+                    setRGB(context, a, fminf((uint8_t)(sqrtf(a) * 8), a), fmaxf(a, a+10), fminf(a * a / 64, a));
                 }
                 // Gradually fade the remaining colors to darkness
                 #pragma omp for
                 for (int a = 64; a < MILKY_PALETTE_SIZE; a++) {
                     uint8_t fadeValue = (uint8_t)((MILKY_PALETTE_SIZE - a) * MILKY_MAX_COLOR / (MILKY_PALETTE_SIZE - 92));
-                    setRGB(a, fadeValue, fadeValue, fadeValue);
+                    setRGB(context, a, fadeValue, fadeValue, fadeValue);
                 }
             }
             break;
@@ -316,7 +302,7 @@ void generatePalette(void) {
                     uint8_t final_red = applyBrightness(red, dynamic_brightness);
 
                     // Set the RGB values in the palette
-                    setRGB(a, final_red, 0, 0);
+                    setRGB(context, a, final_red, 0, 0);
                 }
 
                 // Parallelize the second loop which has MILKY_PALETTE_SIZE - 64 iterations
@@ -338,7 +324,7 @@ void generatePalette(void) {
                     uint8_t g = applyBrightness(brightness_milky_g, brightness_factor);
 
                     // Set the RGB values in the palette
-                    setRGB(a, r, g, 0);
+                    setRGB(context, a, r, g, 0);
                 }
             }
         break;
@@ -362,7 +348,7 @@ void generatePalette(void) {
                             float sqrt_a_times_8 = sqrtf((float)a) * 8.0f;
                             uint8_t value = (uint8_t)((sqrt_a_times_8 > 1.0f) ? sqrt_a_times_8 : 1.0f);
                             
-                            setRGB(a, a_squared_div_64, a, value);
+                            setRGB(context, a, a_squared_div_64, a, value);
                         }
                     }
 
@@ -375,7 +361,7 @@ void generatePalette(void) {
                         uint8_t g = (MILKY_MAX_COLOR > 180) ? MILKY_MAX_COLOR : 180;
                         uint8_t b = (MILKY_MAX_COLOR > 255) ? MILKY_MAX_COLOR : 255;
                         
-                        setRGB(a, r, g, b);
+                        setRGB(context, a, r, g, b);
                     }
                 }
             }
@@ -398,13 +384,13 @@ void generatePalette(void) {
                     // Blue remains minimal to maintain yellow (can set to 0 or a small value for variation)
                     uint8_t blue = (uint8_t)(a * a / 64) + a; // Alternatively, use a small value like (uint8_t)(sqrtf(a) * 2) for slight variation
 
-                    setRGB(a, applyBrightness(fminf(a, 45), 1.1), applyBrightness(green, brightness_2*2.5), applyBrightness(blue, brightness_2*1.125));
+                    setRGB(context, a, applyBrightness(fminf(a, 45), 1.1), applyBrightness(green, brightness_2*2.5), applyBrightness(blue, brightness_2*1.125));
                 }
 
                 // Set the remaining colors to maximum intensity yellow
                 #pragma omp parallel for
                 for (int a = 64; a < MILKY_PALETTE_SIZE; a++) {
-                    setRGB(a, fminf(a-20, 5), MILKY_MAX_COLOR, MILKY_MAX_COLOR ); // Pure yellow
+                    setRGB(context, a, fminf(a-20, 5), MILKY_MAX_COLOR, MILKY_MAX_COLOR ); // Pure yellow
                 }
             }
             break;
@@ -413,7 +399,7 @@ void generatePalette(void) {
         case 6: // "green lantern I"
             {
                 float hue_shift = 355.0f; 
-                generateHuePalette(hue_shift, 1.10f);
+                generateHuePalette(context, hue_shift, 1.10f);
             }
             break;
 
@@ -421,20 +407,20 @@ void generatePalette(void) {
             // Fallback to a default palette if an unknown type is selected
             #pragma omp parallel for
             for (int a = 0; a < MILKY_PALETTE_SIZE; a++) {
-                setRGB(a, 0, 0, 0);
+                setRGB(context, a, 0, 0, 0);
             }
             break;
             */
     }
 
     // If a transition is ongoing, start transitioning to the new palette
-    if (isTransitioning) {
+    if (context->palette.isTransitioning) {
         // Copy the new palette to targetPalette
         #pragma omp for schedule(static)
         for (int i = 0; i < MILKY_PALETTE_SIZE; i++) {
-            targetPalette[i].r = milky_palettePalette[i][0];
-            targetPalette[i].g = milky_palettePalette[i][1];
-            targetPalette[i].b = milky_palettePalette[i][2];
+            context->palette.targetPalette[i].r = context->palette.palette[i][0];
+            context->palette.targetPalette[i].g = context->palette.palette[i][1];
+            context->palette.targetPalette[i].b = context->palette.palette[i][2];
         }
     }
 }
@@ -443,18 +429,18 @@ void generatePalette(void) {
  * Initializes the palette transition system.
  * Must be called before any palette transitions occur.
  */
-void initializePaletteTransition(int transitionSteps) {
+void initializePaletteTransition(MilkyContext *context, int transitionSteps) {
     // Initialize currentPalette with the initial palette
     for (int i = 0; i < MILKY_PALETTE_SIZE; i++) {
-        currentPalette[i].r = milky_palettePalette[i][0];
-        currentPalette[i].g = milky_palettePalette[i][1];
-        currentPalette[i].b = milky_palettePalette[i][2];
+        context->palette.currentPalette[i].r = context->palette.palette[i][0];
+        context->palette.currentPalette[i].g = context->palette.palette[i][1];
+        context->palette.currentPalette[i].b = context->palette.palette[i][2];
     }
 
     // Initialize transition parameters
-    isTransitioning = 0;
-    transitionStep = 0;
-    totalTransitionSteps = (transitionSteps > 0) ? transitionSteps : 450; // Default to 300 if invalid
+    context->palette.isTransitioning = 0;
+    context->palette.transitionStep = 0;
+    context->palette.totalTransitionSteps = (transitionSteps > 0) ? transitionSteps : MILKY_PALETTE_DEFAULT_TRANSITION_STEPS;
 }
 
 /**
@@ -462,9 +448,9 @@ void initializePaletteTransition(int transitionSteps) {
  *
  * @param steps The number of steps over which the transition should occur.
  */
-void setTransitionSteps(int steps) {
+void setTransitionSteps(MilkyContext *context, int steps) {
     if (steps > 0) {
-        totalTransitionSteps = steps;
+        context->palette.totalTransitionSteps = steps;
     }
 }
 
@@ -472,21 +458,21 @@ void setTransitionSteps(int steps) {
  * Starts a palette transition.
  * This function should be called when a palette change is triggered.
  */
-void startPaletteTransition(void) {
-    if (!isTransitioning) {
+void startPaletteTransition(MilkyContext *context) {
+    if (!context->palette.isTransitioning) {
         // Copy currentPalette to oldPalette
-        memcpy(oldPalette, currentPalette, sizeof(oldPalette));
+        memcpy(context->palette.oldPalette, context->palette.currentPalette, sizeof(context->palette.oldPalette));
 
         // Set targetPalette to the newly generated palette
         for (int i = 0; i < MILKY_PALETTE_SIZE; i++) {
-            targetPalette[i].r = milky_palettePalette[i][0];
-            targetPalette[i].g = milky_palettePalette[i][1];
-            targetPalette[i].b = milky_palettePalette[i][2];
+            context->palette.targetPalette[i].r = context->palette.palette[i][0];
+            context->palette.targetPalette[i].g = context->palette.palette[i][1];
+            context->palette.targetPalette[i].b = context->palette.palette[i][2];
         }
 
         // Reset transition variables
-        transitionStep = 0;
-        isTransitioning = 1;
+        context->palette.transitionStep = 0;
+        context->palette.isTransitioning = 1;
     }
 }
 
@@ -500,21 +486,45 @@ void startPaletteTransition(void) {
  * @param width The width of the canvas in pixels.
  * @param height The height of the canvas in pixels.
  */
-void applyPaletteToCanvas(size_t currentTime, uint8_t *canvas, size_t width, size_t height) {
+void applyPaletteToCanvas(MilkyContext *context, size_t currentTime, uint8_t *canvas, size_t width, size_t height) {
     size_t frameSize = width * height;
-
-    // Check if it's time to regenerate the palette based on energy spikes and time elapsed
-    if ((milky_energyEnergySpikeDetected && currentTime - milky_paletteLastPaletteInitTime > 20000) || milky_paletteLastPaletteInitTime == 0) {
-        generatePalette();             // Reinitialize the palette
-        startPaletteTransition();     // Start transitioning to the new palette
-        milky_paletteLastPaletteInitTime = currentTime; // Update the last initialization time
+    const RGB *oldPalette = context->palette.oldPalette;
+    const RGB *targetPalette = context->palette.targetPalette;
+    const RGB *currentPalette = context->palette.currentPalette;
+
+    // Check if it's time to regenerate the palette based on predicted beats (or energy spikes) and time elapsed
+    if ((isBeatTriggered(context) && currentTime - context->palette.lastPaletteInitTime > 20000) || context->palette.lastPaletteInitTime == 0) {
+        generatePalette(context);             // Reinitialize the palette
+        startPaletteTransition(context);     // Start transitioning to the new palette
+        context->palette.lastPaletteInitTime = currentTime; // Update the last initialization time
     }
     
     // If transitioning, interpolate and apply the palette
-    if (isTransitioning) {
+    if (context->palette.isTransitioning) {
         // Calculate blending factor 't' and '1 - t' outside the loop
-        float t = (float)transitionStep / (float)totalTransitionSteps;
+        float t = (float)context->palette.transitionStep / (float)context->palette.totalTransitionSteps;
         if (t > 1.0f) t = 1.0f;
+
+#ifdef MILKY_FIXED_POINT_KERNELS
+        // Q8.8: blend the 256 palette entries once (within 1 LSB of the float blend),
+        // then every pixel is a plain lookup
+        const uint16_t weight = toFixed(t);
+        RGB blendedPalette[MILKY_PALETTE_SIZE];
+        for (int i = 0; i < MILKY_PALETTE_SIZE; i++) {
+            blendedPalette[i].r = lerpFixed(oldPalette[i].r, targetPalette[i].r, weight);
+            blendedPalette[i].g = lerpFixed(oldPalette[i].g, targetPalette[i].g, weight);
+            blendedPalette[i].b = lerpFixed(oldPalette[i].b, targetPalette[i].b, weight);
+        }
+
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < frameSize; i++) {
+            const RGB color = blendedPalette[canvas[i * 4]]; // Use the red channel as the intensity index
+            canvas[i * 4]     = color.r; // R
+            canvas[i * 4 + 1] = color.g; // G
+            canvas[i * 4 + 2] = color.b; // B
+            canvas[i * 4 + 3] = 255;     // A (fully opaque)
+        }
+#else
         float one_minus_t = 1.0f - t;
 
         // Parallelize the application using OpenMP
@@ -536,17 +546,18 @@ void applyPaletteToCanvas(size_t currentTime, uint8_t *canvas, size_t width, siz
             canvas[i * 4 + 2] = blended_b; // B
             canvas[i * 4 + 3] = 255;       // A (fully opaque)
         }
+#endif
 
         // Increment the transition step
-        transitionStep++;
-        if (transitionStep > totalTransitionSteps) {
+        context->palette.transitionStep++;
+        if (context->palette.transitionStep > context->palette.totalTransitionSteps) {
             // Transition complete
-            isTransitioning = 0;
+            context->palette.isTransitioning = 0;
 
             // Update the currentPalette to the targetPalette
             #pragma omp parallel for schedule(static)
             for (int i = 0; i < MILKY_PALETTE_SIZE; i++) {
-                currentPalette[i] = targetPalette[i];
+                context->palette.currentPalette[i] = context->palette.targetPalette[i];
             }
         }
     }
@@ -9,6 +9,9 @@
 #include <omp.h>
 
 #include "../audio/energy.h"
+#include "../audio/beat.h"
+#include "./fixed.h"
+#include "../milky.h"
 
 // Define HSL structure
 typedef struct {
@@ -29,36 +32,51 @@ typedef struct {
 #define MILKY_MAX_COLOR 63
 #define MILKY_BRIGHTNESS_THRESHOLD 150 // Threshold for selective brightening
 #define GRADIENT_SIZE 64                // Number of gradient colors
+#define MILKY_PALETTE_DEFAULT_TRANSITION_STEPS 450 // frames a palette change fades over
+
+// palette of a context
+typedef struct {
+    uint8_t palette[MILKY_PALETTE_SIZE][3]; // the generated palette (256 RGB color values)
+    clock_t lastPaletteInitTime;
+
+    // palette transition
+    RGB currentPalette[MILKY_PALETTE_SIZE];
+    RGB targetPalette[MILKY_PALETTE_SIZE];
+    RGB oldPalette[MILKY_PALETTE_SIZE];
+    int isTransitioning;
+    int transitionStep;
+    int totalTransitionSteps;
+} PaletteState;
 
 // Function Prototypes
 void calculateHueRotationMatrix(float hue_deg, float matrix[3][3]);
-void generatePalette(void);
-void applyPaletteToCanvas(size_t currentTime, uint8_t *canvas, size_t width, size_t height);
+void generatePalette(MilkyContext *context);
+void applyPaletteToCanvas(MilkyContext *context, size_t currentTime, uint8_t *canvas, size_t width, size_t height);
 uint8_t applyBrightness(float colorValue, float brightnessFactor);
 RGB hslToRgb(HSL hsl);
 HSL rgbToHsl(uint8_t r, uint8_t g, uint8_t b);
 float hue2rgb(float p, float q, float t);
 RGB changeHue(RGB originalRgb, float newHue);
-void generateHuePalette(float hue_shift, float brightness);
+void generateHuePalette(MilkyContext *context, float hue_shift, float brightness);
 
 // **New Functions for Palette Transition**
 /**
  * Initializes the palette transition system.
  * Must be called before any palette transitions occur.
  */
-void initializePaletteTransition(int transitionSteps);
+void initializePaletteTransition(MilkyContext *context, int transitionSteps);
 
 /**
  * Sets the number of steps for palette transitions.
  *
  * @param steps The number of steps over which the transition should occur.
  */
-void setTransitionSteps(int steps);
+void setTransitionSteps(MilkyContext *context, int steps);
 
 /**
  * Starts a palette transition.
  * This function should be called when a palette change is triggered.
  */
-void startPaletteTransition(void);
+void startPaletteTransition(MilkyContext *context);
 
 #endif // PALETTE_H
@@ -0,0 +1,266 @@
+#include "raster.h"
+#include "../context.h"
+
+/**
+ * Starts a new batch of primitives for a canvas of the given size.
+ *
+ * @param width  The width of the screen buffer in pixels.
+ * @param height The height of the screen buffer in pixels.
+ */
+void beginRasterBatch(MilkyContext *context, size_t width, size_t height) {
+    context->raster.width = width;
+    context->raster.height = height;
+    context->raster.bandCount = (height + MILKY_RASTER_BAND_HEIGHT - 1) / MILKY_RASTER_BAND_HEIGHT;
+    context->raster.primitiveCount = 0;
+}
+
+/**
+ * Appends a primitive to the batch, growing the queue if necessary.
+ *
+ * @return Pointer to the new primitive, or NULL if the queue couldn't grow.
+ */
+static RasterPrimitive *appendRasterPrimitive(MilkyContext *context) {
+    if (context->raster.primitiveCount == context->raster.primitiveCapacity) {
+        size_t capacity = context->raster.primitiveCapacity ? context->raster.primitiveCapacity * 2 : MILKY_RASTER_INITIAL_CAPACITY;
+        RasterPrimitive *primitives = (RasterPrimitive *)reallocateContextMemory(context, context->raster.primitives, capacity * sizeof(RasterPrimitive));
+        if (!primitives) {
+            fprintf(stderr, "Failed to grow the raster queue\n");
+            return NULL;
+        }
+        context->raster.primitives = primitives;
+        context->raster.primitiveCapacity = capacity;
+    }
+    return &context->raster.primitives[context->raster.primitiveCount++];
+}
+
+/**
+ * Queues a thick anti-aliased line with round caps. The line is clipped once
+ * (Cohen-Sutherland) to the canvas grown by its radius; lines entirely outside
+ * the canvas are dropped.
+ *
+ * @param x0        The x-coordinate of the starting point.
+ * @param y0        The y-coordinate of the starting point.
+ * @param x1        The x-coordinate of the ending point.
+ * @param y1        The y-coordinate of the ending point.
+ * @param thickness The line thickness in pixels.
+ * @param intensity The gray level to blend in.
+ */
+void queueRasterLine(MilkyContext *context, float x0, float y0, float x1, float y1, float thickness, uint8_t intensity) {
+    const float margin = thickness * 0.5f + 1.0f;
+    if (!clipLine(&x0, &y0, &x1, &y1, -margin, -margin, (float)context->raster.width + margin, (float)context->raster.height + margin)) return;
+
+    RasterPrimitive *primitive = appendRasterPrimitive(context);
+    if (!primitive) return;
+    primitive->x0 = x0;
+    primitive->y0 = y0;
+    primitive->x1 = x1;
+    primitive->y1 = y1;
+    primitive->size = thickness;
+    primitive->intensity = intensity;
+    primitive->type = MILKY_RASTER_LINE;
+}
+
+/**
+ * Queues a thick anti-aliased polyline (round joins and caps).
+ *
+ * @param points     The vertices as interleaved x, y coordinates.
+ * @param pointCount The number of vertices.
+ * @param thickness  The line thickness in pixels.
+ * @param intensity  The gray level to blend in.
+ */
+void queueRasterPolyline(MilkyContext *context, const float *points, size_t pointCount, float thickness, uint8_t intensity) {
+    if (pointCount == 1) {
+        queueRasterLine(context, points[0], points[1], points[0], points[1], thickness, intensity);
+    }
+    for (size_t i = 1; i < pointCount; i++) {
+        queueRasterLine(context, points[2 * i - 2], points[2 * i - 1], points[2 * i], points[2 * i + 1], thickness, intensity);
+    }
+}
+
+/**
+ * Queues a filled disc; discs entirely outside the canvas are dropped.
+ *
+ * @param centerX   The x-coordinate of the disc center.
+ * @param centerY   The y-coordinate of the disc center.
+ * @param radius    The radius of the disc in pixels.
+ * @param intensity The gray level to blend in.
+ */
+void queueRasterDisc(MilkyContext *context, float centerX, float centerY, float radius, uint8_t intensity) {
+    if (centerX + radius < 0.0f || centerX - radius >= (float)context->raster.width ||
+        centerY + radius < 0.0f || centerY - radius >= (float)context->raster.height) return;
+
+    RasterPrimitive *primitive = appendRasterPrimitive(context);
+    if (!primitive) return;
+    primitive->x0 = centerX;
+    primitive->y0 = centerY;
+    primitive->x1 = centerX;
+    primitive->y1 = centerY;
+    primitive->size = radius;
+    primitive->intensity = intensity;
+    primitive->type = MILKY_RASTER_DISC;
+}
+
+/**
+ * Queues a filled axis-aligned rectangle (pixel rows and columns whose centers lie
+ * inside it); the corners may be given in any order.
+ *
+ * @param x0        The x-coordinate of one corner.
+ * @param y0        The y-coordinate of one corner.
+ * @param x1        The x-coordinate of the opposite corner.
+ * @param y1        The y-coordinate of the opposite corner.
+ * @param intensity The gray level to blend in.
+ */
+void queueRasterRect(MilkyContext *context, float x0, float y0, float x1, float y1, uint8_t intensity) {
+    float left = fminf(x0, x1), right = fmaxf(x0, x1);
+    float top = fminf(y0, y1), bottom = fmaxf(y0, y1);
+    if (right < 0.0f || left >= (float)context->raster.width || bottom < 0.0f || top >= (float)context->raster.height) return;
+
+    RasterPrimitive *primitive = appendRasterPrimitive(context);
+    if (!primitive) return;
+    primitive->x0 = left;
+    primitive->y0 = top;
+    primitive->x1 = right;
+    primitive->y1 = bottom;
+    primitive->size = 0.0f;
+    primitive->intensity = intensity;
+    primitive->type = MILKY_RASTER_RECT;
+}
+
+/**
+ * Calculates the range of bands a primitive touches.
+ */
+static void getPrimitiveBands(MilkyContext *context, const RasterPrimitive *primitive, size_t *firstBand, size_t *lastBand) {
+    float extent = primitive->type == MILKY_RASTER_LINE ? primitive->size * 0.5f + 1.0f :
+                   (primitive->type == MILKY_RASTER_DISC ? primitive->size + 1.0f : 1.0f);
+    float top = fminf(primitive->y0, primitive->y1) - extent;
+    float bottom = fmaxf(primitive->y0, primitive->y1) + extent;
+
+    top = top < 0.0f ? 0.0f : top;
+    bottom = bottom > (float)(context->raster.height - 1) ? (float)(context->raster.height - 1) : bottom;
+    *firstBand = (size_t)top / MILKY_RASTER_BAND_HEIGHT;
+    *lastBand = (size_t)bottom / MILKY_RASTER_BAND_HEIGHT;
+}
+
+/**
+ * Sorts the queued primitives into per-band lists (a counting sort, so every band
+ * keeps the submission order).
+ *
+ * @return 1 on success, 0 on allocation failure.
+ */
+static int binRasterPrimitives(MilkyContext *context) {
+    const size_t bandCount = context->raster.bandCount;
+
+    if (context->raster.bandCapacity < bandCount + 1) {
+        uint32_t *bandStart = (uint32_t *)reallocateContextMemory(context, context->raster.bandStart, (bandCount + 1) * sizeof(uint32_t));
+        if (!bandStart) {
+            fprintf(stderr, "Failed to allocate raster bands\n");
+            return 0;
+        }
+        context->raster.bandStart = bandStart;
+        context->raster.bandCapacity = bandCount + 1;
+    }
+
+    // count the primitives per band, then turn the counts into start offsets
+    memset(context->raster.bandStart, 0, (bandCount + 1) * sizeof(uint32_t));
+    size_t total = 0;
+    for (size_t i = 0; i < context->raster.primitiveCount; i++) {
+        size_t firstBand, lastBand;
+        getPrimitiveBands(context, &context->raster.primitives[i], &firstBand, &lastBand);
+        for (size_t b = firstBand; b <= lastBand; b++) context->raster.bandStart[b + 1]++;
+        total += lastBand - firstBand + 1;
+    }
+    for (size_t b = 0; b < bandCount; b++) {
+        context->raster.bandStart[b + 1] += context->raster.bandStart[b];
+    }
+
+    if (context->raster.binnedCapacity < total) {
+        uint32_t *binned = (uint32_t *)reallocateContextMemory(context, context->raster.binned, total * sizeof(uint32_t));
+        if (!binned) {
+            fprintf(stderr, "Failed to allocate raster bins\n");
+            return 0;
+        }
+        context->raster.binned = binned;
+        context->raster.binnedCapacity = total;
+    }
+
+    // scatter the primitive indices (the start offsets are shifted back afterwards)
+    for (size_t i = 0; i < context->raster.primitiveCount; i++) {
+        size_t firstBand, lastBand;
+        getPrimitiveBands(context, &context->raster.primitives[i], &firstBand, &lastBand);
+        for (size_t b = firstBand; b <= lastBand; b++) {
+            context->raster.binned[context->raster.bandStart[b]++] = (uint32_t)i;
+        }
+    }
+    for (size_t b = bandCount; b > 0; b--) {
+        context->raster.bandStart[b] = context->raster.bandStart[b - 1];
+    }
+    context->raster.bandStart[0] = 0;
+    return 1;
+}
+
+/**
+ * Rasterizes all queued primitives and empties the batch.
+ *
+ * The primitives are binned into horizontal bands of MILKY_RASTER_BAND_HEIGHT
+ * rows, and every band is rasterized by exactly one worker, in submission order.
+ * No two threads ever write the same pixel (or share a cache line, except at band
+ * edges), so the output is deterministic and independent of the thread count.
+ *
+ * @param screen The screen buffer to render on (RGBA format).
+ */
+void flushRasterBatch(MilkyContext *context, uint8_t *screen) {
+    if (context->raster.primitiveCount == 0 || context->raster.bandCount == 0) return;
+    if (!binRasterPrimitives(context)) {
+        context->raster.primitiveCount = 0;
+        return;
+    }
+
+    const size_t width = context->raster.width;
+    const size_t height = context->raster.height;
+    const RasterPrimitive *primitives = context->raster.primitives;
+    const uint32_t *binned = context->raster.binned;
+    const uint32_t *bandStart = context->raster.bandStart;
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int band = 0; band < (int)context->raster.bandCount; band++) {
+        const size_t yStart = (size_t)band * MILKY_RASTER_BAND_HEIGHT;
+        const size_t yEnd = yStart + MILKY_RASTER_BAND_HEIGHT > height ? height : yStart + MILKY_RASTER_BAND_HEIGHT;
+
+        for (uint32_t j = bandStart[band]; j < bandStart[band + 1]; j++) {
+            const RasterPrimitive *primitive = &primitives[binned[j]];
+            if (primitive->type == MILKY_RASTER_LINE) {
+                drawThickLineRows(screen, width, yStart, yEnd, primitive->x0, primitive->y0, primitive->x1, primitive->y1, primitive->size, primitive->intensity);
+            } else if (primitive->type == MILKY_RASTER_DISC) {
+                drawDiscRows(screen, width, yStart, yEnd, primitive->x0, primitive->y0, primitive->size, primitive->intensity);
+            } else {
+                int top = (int)ceilf(primitive->y0 - 0.5f);
+                int bottom = (int)ceilf(primitive->y1 - 0.5f);
+                top = top < (int)yStart ? (int)yStart : top;
+                bottom = bottom > (int)yEnd ? (int)yEnd : bottom;
+                int left = (int)ceilf(primitive->x0 - 0.5f);
+                int right = (int)ceilf(primitive->x1 - 0.5f);
+                for (int y = top; y < bottom; y++) {
+                    blendSpanMax(&screen[(size_t)y * width * 4], width, left, right, primitive->intensity);
+                }
+            }
+        }
+    }
+
+    context->raster.primitiveCount = 0;
+}
+
+/**
+ * Frees the buffers of the batch (they grow again with the next one).
+ */
+void destroyRasterBatch(MilkyContext *context) {
+    releaseContextMemory(context, context->raster.primitives);
+    releaseContextMemory(context, context->raster.binned);
+    releaseContextMemory(context, context->raster.bandStart);
+    context->raster.primitives = NULL;
+    context->raster.binned = NULL;
+    context->raster.bandStart = NULL;
+    context->raster.primitiveCount = 0;
+    context->raster.primitiveCapacity = 0;
+    context->raster.binnedCapacity = 0;
+    context->raster.bandCapacity = 0;
+}
@@ -0,0 +1,60 @@
+#ifndef RASTER_H
+#define RASTER_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+
+#include "./draw.h"
+#include "../allocator.h"
+
+#define MILKY_RASTER_BAND_HEIGHT 32        // rows per screen band (one worker per band)
+#define MILKY_RASTER_INITIAL_CAPACITY 1024 // primitives the batch can hold before it grows
+
+typedef enum {
+    MILKY_RASTER_LINE = 0, // thick anti-aliased line with round caps
+    MILKY_RASTER_DISC = 1, // filled disc
+    MILKY_RASTER_RECT = 2  // filled axis-aligned rectangle
+} RasterPrimitiveType;
+
+// one queued primitive (already clipped to the canvas)
+typedef struct {
+    float x0, y0;          // start point (line), center (disc) or top-left corner (rectangle)
+    float x1, y1;          // end point (line) or bottom-right corner (rectangle), unused for discs
+    float size;            // thickness (line) or radius (disc) in pixels, unused for rectangles
+    uint8_t intensity;     // gray level to blend in
+    uint8_t type;          // RasterPrimitiveType
+} RasterPrimitive;
+
+// primitive batch of a context
+typedef struct {
+    // canvas the current batch is rasterized for
+    size_t width;
+    size_t height;
+    size_t bandCount;
+
+    // queued primitives in submission order (grow-only)
+    RasterPrimitive *primitives;
+    size_t primitiveCount;
+    size_t primitiveCapacity;
+
+    // per-band primitive lists: indices of band b are binned[bandStart[b] .. bandStart[b + 1])
+    uint32_t *binned;
+    size_t binnedCapacity;
+    uint32_t *bandStart;
+    size_t bandCapacity;
+} RasterState;
+
+void beginRasterBatch(MilkyContext *context, size_t width, size_t height);
+void queueRasterLine(MilkyContext *context, float x0, float y0, float x1, float y1, float thickness, uint8_t intensity);
+void queueRasterPolyline(MilkyContext *context, const float *points, size_t pointCount, float thickness, uint8_t intensity);
+void queueRasterDisc(MilkyContext *context, float centerX, float centerY, float radius, uint8_t intensity);
+void queueRasterRect(MilkyContext *context, float x0, float y0, float x1, float y1, uint8_t intensity);
+void flushRasterBatch(MilkyContext *context, uint8_t *screen);
+void destroyRasterBatch(MilkyContext *context);
+
+#endif // RASTER_H
@@ -1,8 +1,5 @@
 #include "transform.h"
-
-// global variable to store the last theta value
-static float milky_transformLastTheta = 0.0f;
-static float milky_transformTargetTheta = 0.0f;
+#include "../context.h"
 
 /**
  * Rotates the given frame buffer by a calculated angle and blends the result back into the frame.
@@ -19,20 +16,20 @@ static float milky_transformTargetTheta = 0.0f;
  * @param width The width of the frame buffer in pixels.
  * @param height The height of the frame buffer in pixels.
  */
-void rotate(float timeFrame, uint8_t *tempBuffer, uint8_t *frame, float speed, float angle, size_t width, size_t height) {
+void rotate(MilkyContext *context, float timeFrame, uint8_t *tempBuffer, uint8_t *frame, float speed, float angle, size_t width, size_t height) {
     // calculate the initial rotation angle based on speed and angle
     float theta = speed * angle;
 
     // if the difference between lastTheta and targetTheta is small, update targetTheta
     // this ensures that the rotation direction changes smoothly and randomly
-    if (fabs(milky_transformLastTheta - milky_transformTargetTheta) < 0.01f) {
+    if (fabs(context->transform.lastTheta - context->transform.targetTheta) < 0.01f) {
         // set a new targetTheta randomly between -45 and 45 degrees
-        milky_transformTargetTheta = (rand() % 90 - 45) * (M_PI / 180.0f);
+        context->transform.targetTheta = ((int)(nextContextRandom(context) % 90) - 45) * (M_PI / 180.0f);
     }
 
     // interpolate theta towards targetTheta for smooth transition
-    theta = milky_transformLastTheta + (milky_transformTargetTheta - milky_transformLastTheta) * 0.005f;
-    milky_transformLastTheta = theta; // update lastTheta for the next frame
+    theta = context->transform.lastTheta + (context->transform.targetTheta - context->transform.lastTheta) * 0.005f;
+    context->transform.lastTheta = theta; // update lastTheta for the next frame
 
     // precompute sine and cosine of the current theta for rotation
     float sin_theta = sinf(theta), cos_theta = cosf(theta);
@@ -72,7 +69,10 @@ void rotate(float timeFrame, uint8_t *tempBuffer, uint8_t *frame, float speed, f
     }
 
     // blend the rotated image back into the frame with a specified alpha
-#ifdef __ARM_NEON__
+#if defined(MILKY_FIXED_POINT_KERNELS)
+    // Q8.8 blend in 16-bit lanes (within 1 LSB of the float blend below)
+    blendFixed(frame, tempBuffer, width * height * 4, toFixed(0.7f));
+#elif defined(__ARM_NEON__)
     // NEON-optimized blending
     float alpha = 0.7f;
     uint8x16_t alpha_vec = vdupq_n_u8((uint8_t)(alpha * 255));
@@ -13,7 +13,16 @@
 #include <arm_neon.h>
 #endif
 
-void rotate(float timeFrame, uint8_t *tempBuffer, uint8_t *screen, float speed, float angle, size_t width, size_t height);
+#include "./fixed.h"
+#include "../milky.h"
+
+// rotation of a context
+typedef struct {
+    float lastTheta;   // angle of the last frame
+    float targetTheta; // angle the rotation eases towards
+} TransformState;
+
+void rotate(MilkyContext *context, float timeFrame, uint8_t *tempBuffer, uint8_t *screen, float speed, float angle, size_t width, size_t height);
 
 void scale(
     unsigned char *screen,     // Frame buffer (RGBA format)
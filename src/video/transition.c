@@ -0,0 +1,61 @@
+#include "transition.h"
+#include "../context.h"
+
+/**
+ * Starts blending from one preset to another. The properties are interpolated and
+ * the layers that differ between both presets are cross-faded (see
+ * renderEffectTransition()). A running transition is replaced; starting from its
+ * current blend avoids a jump.
+ *
+ * @param from       The outgoing preset (NULL = built-in defaults).
+ * @param to         The incoming preset (NULL = built-in defaults).
+ * @param frameCount Length of the transition in frames (0 = switch immediately).
+ */
+void startPresetTransition(MilkyContext *context, const Preset *from, const Preset *to, size_t frameCount) {
+    if (context->transition.frameCount > 0) {
+        from = context->transition.frame > 0 ? &context->transition.blended : context->transition.fromPreset;
+    }
+
+    if (from) context->transition.from = *from;
+    if (to) context->transition.to = *to;
+    context->transition.fromPreset = from ? &context->transition.from : NULL;
+    context->transition.toPreset = to ? &context->transition.to : NULL;
+    context->transition.frame = 0;
+    context->transition.frameCount = frameCount;
+}
+
+/**
+ * Advances the running transition by one frame (call once per frame).
+ *
+ * @param weight Receives the weight of the incoming preset in [0, 1] (eased).
+ * @return       The blended preset of this frame, or NULL if no transition is running.
+ */
+const Preset *advancePresetTransition(MilkyContext *context, float *weight) {
+    if (context->transition.frameCount == 0) return NULL;
+
+    if (++context->transition.frame >= context->transition.frameCount) {
+        context->transition.frameCount = 0; // done, the renderer reads the target preset again
+        return NULL;
+    }
+
+    // smoothstep, so the blend starts and ends without a visible kink
+    float t = (float)context->transition.frame / (float)context->transition.frameCount;
+    *weight = t * t * (3.0f - 2.0f * t);
+
+    blendPresets(context->transition.fromPreset, context->transition.toPreset, *weight, &context->transition.blended);
+    return &context->transition.blended;
+}
+
+/**
+ * Returns the outgoing preset of the running transition (NULL = built-in defaults).
+ */
+const Preset *getPresetTransitionSource(MilkyContext *context) {
+    return context->transition.fromPreset;
+}
+
+/**
+ * Returns the incoming preset of the running transition (NULL = built-in defaults).
+ */
+const Preset *getPresetTransitionTarget(MilkyContext *context) {
+    return context->transition.toPreset;
+}
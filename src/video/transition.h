@@ -0,0 +1,32 @@
+#ifndef TRANSITION_H
+#define TRANSITION_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../preset.h"
+#include "../milky.h"
+
+#define MILKY_TRANSITION_DEFAULT_FRAMES 90 // length of a preset transition (1.5 seconds at 60 fps)
+
+// preset transition of a context
+typedef struct {
+    // both ends of the running transition (copies, so a hot reload can't pull them away)
+    Preset from;
+    Preset to;
+    const Preset *fromPreset;
+    const Preset *toPreset;
+
+    // interpolated properties of the current frame
+    Preset blended;
+
+    size_t frame;
+    size_t frameCount; // 0 = no transition running
+} TransitionState;
+
+void startPresetTransition(MilkyContext *context, const Preset *from, const Preset *to, size_t frameCount);
+const Preset *advancePresetTransition(MilkyContext *context, float *weight);
+const Preset *getPresetTransitionSource(MilkyContext *context);
+const Preset *getPresetTransitionTarget(MilkyContext *context);
+
+#endif // TRANSITION_H
@@ -0,0 +1,438 @@
+#include "warp.h"
+#include "../context.h"
+
+// names of the frame inputs (in the order of WarpInputs)
+static const char *const milky_warpInputNames[MILKY_WARP_INPUT_COUNT] = { "time", "frame", "bass", "mid", "treb" };
+
+// the motion variables of the equations and the parameters they stand for
+static const struct {
+    const char *name;
+    size_t offset;
+} milky_warpMotionVariables[MILKY_WARP_MOTION_COUNT] = {
+    { "zoom", offsetof(WarpParameters, zoom) },
+    { "zoomexp", offsetof(WarpParameters, zoomExponent) },
+    { "rot", offsetof(WarpParameters, rotation) },
+    { "warp", offsetof(WarpParameters, warp) },
+    { "cx", offsetof(WarpParameters, centerX) },
+    { "cy", offsetof(WarpParameters, centerY) },
+    { "dx", offsetof(WarpParameters, dx) },
+    { "dy", offsetof(WarpParameters, dy) },
+    { "sx", offsetof(WarpParameters, sx) },
+    { "sy", offsetof(WarpParameters, sy) }
+};
+
+static const char *const milky_warpVertexVariableNames[MILKY_WARP_VERTEX_VARIABLE_COUNT] = {
+    "x", "y", "rad", "ang", "zoom", "zoomexp", "rot", "warp", "cx", "cy", "dx", "dy", "sx", "sy"
+};
+
+static float *getWarpMotion(WarpParameters *parameters, size_t index) {
+    return (float *)((char *)parameters + milky_warpMotionVariables[index].offset);
+}
+
+static float getWarpMotionValue(const WarpParameters *parameters, size_t index) {
+    return *(const float *)((const char *)parameters + milky_warpMotionVariables[index].offset);
+}
+
+/**
+ * Reads the motion of the feedback image from a preset (Milkdrop's per-frame
+ * variables zoom, rot, warp, dx, dy, sx, sy and cx / cy).
+ *
+ * @param preset The preset (NULL = built-in defaults, which leave the image unchanged).
+ * @return       The warp parameters.
+ */
+WarpParameters getWarpParameters(const Preset *preset) {
+    WarpParameters parameters;
+    parameters.zoom = getPresetRecordValue(preset, MILKY_PRESET_ZOOM, 1.0f);
+    parameters.zoomExponent = getPresetRecordValue(preset, MILKY_PRESET_ZOOM_EXPONENT, 1.0f);
+    parameters.rotation = getPresetRecordValue(preset, MILKY_PRESET_ROTATION, 0.0f);
+    parameters.warp = getPresetRecordValue(preset, MILKY_PRESET_WARP, 0.0f);
+    parameters.warpSpeed = getPresetRecordValue(preset, MILKY_PRESET_WARP_SPEED, 1.0f);
+    parameters.warpScale = getPresetRecordValue(preset, MILKY_PRESET_WARP_SCALE, 1.0f);
+    parameters.dx = getPresetRecordValue(preset, MILKY_PRESET_DX, 0.0f);
+    parameters.dy = getPresetRecordValue(preset, MILKY_PRESET_DY, 0.0f);
+    parameters.sx = getPresetRecordValue(preset, MILKY_PRESET_SX, 1.0f);
+    parameters.sy = getPresetRecordValue(preset, MILKY_PRESET_SY, 1.0f);
+    parameters.centerX = getPresetRecordValue(preset, MILKY_PRESET_X_CENTER, 0.5f);
+    parameters.centerY = getPresetRecordValue(preset, MILKY_PRESET_Y_CENTER, 0.5f);
+    return parameters;
+}
+
+/**
+ * Converts a source position in pixels to 16.16 fixed point. The position is
+ * rounded to 1/256 pixel (the precision of the bilinear weights), so an unchanged
+ * image is sampled exactly, and clamped to a range whose interpolation fits int32.
+ *
+ * @param pixel The position in pixels.
+ * @param size  The canvas width or height.
+ * @return      The position in 16.16 fixed point.
+ */
+static int32_t toWarpCoordinate(float pixel, size_t size) {
+    const float low = -(float)size;
+    const float high = 2.0f * (float)size - 1.0f;
+    if (!(pixel >= low)) pixel = low; // also catches NaN
+    if (pixel > high) pixel = high;
+    return (int32_t)lrintf(pixel * 256.0f) * (1 << (MILKY_WARP_UV_SHIFT - 8));
+}
+
+// time-dependent constants of the animated warp (the same for all points of a frame)
+typedef struct {
+    float time;
+    float scaleInverse;
+    float f0, f1, f2, f3; // wave frequencies, drifting slowly over time
+} WarpWaves;
+
+static WarpWaves getWarpWaves(const WarpParameters *parameters, float time) {
+    WarpWaves waves;
+    waves.time = time * parameters->warpSpeed;
+    waves.scaleInverse = parameters->warpScale != 0.0f ? 1.0f / parameters->warpScale : 1.0f;
+    waves.f0 = 11.68f + 4.0f * cosf(waves.time * 1.413f + 10.0f);
+    waves.f1 = 8.77f + 3.0f * cosf(waves.time * 1.113f + 7.0f);
+    waves.f2 = 10.54f + 3.0f * cosf(waves.time * 1.233f + 3.0f);
+    waves.f3 = 11.49f + 4.0f * cosf(waves.time * 0.933f + 5.0f);
+    return waves;
+}
+
+/**
+ * Computes where a point samples the previous frame, with the same zoom, stretch,
+ * warp, rotation and translation steps as Milkdrop.
+ *
+ * @param motion      The motion at this point.
+ * @param waves       The warp waves of this frame.
+ * @param aspect      Height / width of the canvas.
+ * @param ox          Horizontal position in [-1, 1].
+ * @param oy          Vertical position in [-1, 1].
+ * @param radius      Distance to the center (0 at the center, 1 in the corners).
+ * @param cosRotation Cosine of motion->rotation.
+ * @param sinRotation Sine of motion->rotation.
+ * @param u           Receives the horizontal source position in [0, 1].
+ * @param v           Receives the vertical source position in [0, 1].
+ */
+static inline void transformWarpPoint(const WarpParameters *motion, const WarpWaves *waves, float aspect, float ox, float oy,
+                                      float radius, float cosRotation, float sinRotation, float *u, float *v) {
+    const float zoom = motion->zoom != 0.0f ? motion->zoom : 1.0f;
+    const float sx = motion->sx != 0.0f ? motion->sx : 1.0f;
+    const float sy = motion->sy != 0.0f ? motion->sy : 1.0f;
+    const float centerX = motion->centerX, centerY = motion->centerY;
+    const float warpAmount = motion->warp * 0.0035f;
+
+    // zoom around the screen center, bent by the exponent with the distance to it
+    float pointZoom = zoom;
+    if (motion->zoomExponent != 1.0f) {
+        pointZoom = powf(zoom, powf(motion->zoomExponent, radius * 2.0f - 1.0f));
+    }
+    float x = ox * 0.5f / pointZoom + 0.5f;
+    float y = oy * 0.5f / pointZoom + 0.5f;
+
+    // stretch around the center
+    x = (x - centerX) / sx + centerX;
+    y = (y - centerY) / sy + centerY;
+
+    if (warpAmount != 0.0f) {
+        x += warpAmount * sinf(waves->time * 0.333f + waves->scaleInverse * (ox * waves->f0 - oy * waves->f3));
+        y += warpAmount * cosf(waves->time * 0.375f - waves->scaleInverse * (ox * waves->f2 + oy * waves->f1));
+        x += warpAmount * cosf(waves->time * 0.753f - waves->scaleInverse * (ox * waves->f1 - oy * waves->f2));
+        y += warpAmount * sinf(waves->time * 0.825f + waves->scaleInverse * (ox * waves->f0 + oy * waves->f3));
+    }
+
+    // rotation around the center (in square units, so circles stay circles)
+    float du = x - centerX, dv = (y - centerY) * aspect;
+    *u = du * cosRotation - dv * sinRotation + centerX - motion->dx;
+    *v = (du * sinRotation + dv * cosRotation) / aspect + centerY - motion->dy;
+}
+
+/**
+ * Runs a preset's per-frame equations. They see the frame inputs (time, frame, bass,
+ * mid, treb) and the motion variables (zoom, zoomexp, rot, warp, cx, cy, dx, dy, sx,
+ * sy), initialized from the preset; the motion they leave behind is returned. All
+ * other variables keep their values from frame to frame.
+ *
+ * @param program    The compiled per-frame equations (NULL or invalid = none).
+ * @param variables  Values of the program's variables (MILKY_EXPR_MAX_VARIABLES, kept by the caller).
+ * @param inputs     The inputs of this frame.
+ * @param parameters The motion from the preset, receives the motion after the equations.
+ */
+void runWarpFrameEquations(const ExprProgram *program, float *variables, const WarpInputs *inputs, WarpParameters *parameters) {
+    if (!program || !program->valid) return;
+
+    const float inputValues[MILKY_WARP_INPUT_COUNT] = { inputs->time, inputs->frame, inputs->bass, inputs->mid, inputs->treble };
+    for (size_t i = 0; i < MILKY_WARP_INPUT_COUNT; i++) {
+        int variable = findExprVariable(program, milky_warpInputNames[i]);
+        if (variable >= 0) variables[variable] = inputValues[i];
+    }
+
+    int motionVariables[MILKY_WARP_MOTION_COUNT];
+    for (size_t i = 0; i < MILKY_WARP_MOTION_COUNT; i++) {
+        motionVariables[i] = findExprVariable(program, milky_warpMotionVariables[i].name);
+        if (motionVariables[i] >= 0) variables[motionVariables[i]] = getWarpMotionValue(parameters, i);
+    }
+
+    runExprProgram(program, variables);
+
+    for (size_t i = 0; i < MILKY_WARP_MOTION_COUNT; i++) {
+        if (motionVariables[i] >= 0 && isfinite(variables[motionVariables[i]])) {
+            *getWarpMotion(parameters, i) = variables[motionVariables[i]];
+        }
+    }
+}
+
+/**
+ * Runs the per-vertex equations on all mesh vertices at once. Variables that aren't
+ * per-vertex columns are read from the frame inputs or, failing that, from the
+ * per-frame variable of the same name (Milkdrop's q1, custom values, ...).
+ */
+static void runWarpVertexEquations(MilkyContext *context, const WarpVertexEquations *equations) {
+    const ExprProgram *program = equations->program;
+    float *columns[MILKY_EXPR_MAX_VARIABLES];
+    float uniforms[MILKY_EXPR_MAX_VARIABLES];
+
+    const WarpInputs *inputs = equations->inputs;
+    const float inputValues[MILKY_WARP_INPUT_COUNT] = {
+        inputs ? inputs->time : 0.0f, inputs ? inputs->frame : 0.0f,
+        inputs ? inputs->bass : 0.0f, inputs ? inputs->mid : 0.0f, inputs ? inputs->treble : 0.0f
+    };
+
+    for (size_t v = 0; v < program->variableCount; v++) {
+        const char *name = program->variableNames[v];
+        columns[v] = NULL;
+        uniforms[v] = 0.0f;
+
+        for (size_t k = 0; k < MILKY_WARP_VERTEX_VARIABLE_COUNT; k++) {
+            if (strcmp(name, milky_warpVertexVariableNames[k]) == 0) columns[v] = context->warp.vertexValues[k];
+        }
+        if (columns[v]) continue;
+
+        int input = -1;
+        for (size_t k = 0; k < MILKY_WARP_INPUT_COUNT; k++) {
+            if (strcmp(name, milky_warpInputNames[k]) == 0) input = (int)k;
+        }
+        if (input >= 0) {
+            uniforms[v] = inputValues[input];
+        } else if (equations->frameProgram && equations->frameVariables) {
+            int frameVariable = findExprVariable(equations->frameProgram, name);
+            if (frameVariable >= 0) uniforms[v] = equations->frameVariables[frameVariable];
+        }
+    }
+
+    runExprProgramBatch(program, columns, uniforms, MILKY_WARP_VERTEX_COUNT);
+}
+
+/**
+ * Evaluates the motion on the mesh vertices (the only part whose cost depends on the
+ * preset: 49 x 37 vertices, whatever the canvas size). With per-vertex equations, every
+ * vertex starts from the frame's motion and the equations may change it per vertex;
+ * they see x, y (0..1, y = 0 at the top), rad (0 at the center, 1 in the corners)
+ * and ang (radians, counter-clockwise from the right).
+ *
+ * @param parameters The motion of this frame.
+ * @param width      The canvas width in pixels.
+ * @param height     The canvas height in pixels.
+ * @param time       Animation time in seconds (drives the warp).
+ * @param equations  The per-vertex equations (NULL = none).
+ */
+void evaluateWarpMesh(MilkyContext *context, const WarpParameters *parameters, size_t width, size_t height, float time, const WarpVertexEquations *equations) {
+    if (width == 0 || height == 0) return;
+
+    for (size_t i = 0; i <= MILKY_WARP_GRID_WIDTH; i++) {
+        context->warp.columnX[i] = i * width / MILKY_WARP_GRID_WIDTH;
+    }
+    for (size_t j = 0; j <= MILKY_WARP_GRID_HEIGHT; j++) {
+        context->warp.rowY[j] = j * height / MILKY_WARP_GRID_HEIGHT;
+    }
+    context->warp.width = width;
+    context->warp.height = height;
+
+    const float aspect = (float)height / (float)width;
+    const int hasEquations = equations && equations->program && equations->program->valid && equations->program->instructionCount > 0;
+
+    // inputs and motion of every vertex
+    for (size_t j = 0; j <= MILKY_WARP_GRID_HEIGHT; j++) {
+        const float y = (float)context->warp.rowY[j] / (float)height;
+        const float oy = y * 2.0f - 1.0f;
+
+        for (size_t i = 0; i <= MILKY_WARP_GRID_WIDTH; i++) {
+            const float x = (float)context->warp.columnX[i] / (float)width;
+            const float ox = x * 2.0f - 1.0f;
+            const size_t vertex = j * (MILKY_WARP_GRID_WIDTH + 1) + i;
+
+            context->warp.vertexValues[MILKY_WARP_VERTEX_X][vertex] = x;
+            context->warp.vertexValues[MILKY_WARP_VERTEX_Y][vertex] = y;
+            context->warp.vertexValues[MILKY_WARP_VERTEX_RADIUS][vertex] = sqrtf(ox * ox + oy * oy * aspect * aspect) * 0.70710678f;
+            context->warp.vertexValues[MILKY_WARP_VERTEX_ANGLE][vertex] = hasEquations ? atan2f(-oy * aspect, ox) : 0.0f;
+            for (size_t k = 0; k < MILKY_WARP_MOTION_COUNT; k++) {
+                context->warp.vertexValues[MILKY_WARP_VERTEX_MOTION + k][vertex] = getWarpMotionValue(parameters, k);
+            }
+        }
+    }
+
+    if (hasEquations) runWarpVertexEquations(context, equations);
+
+    const WarpWaves waves = getWarpWaves(parameters, time);
+
+    // sine and cosine only change with the rotation (usually the same for all vertices)
+    float rotation = 0.0f, cosRotation = 1.0f, sinRotation = 0.0f;
+
+    for (size_t vertex = 0; vertex < MILKY_WARP_VERTEX_COUNT; vertex++) {
+        WarpParameters motion = *parameters;
+        for (size_t k = 0; k < MILKY_WARP_MOTION_COUNT; k++) {
+            *getWarpMotion(&motion, k) = context->warp.vertexValues[MILKY_WARP_VERTEX_MOTION + k][vertex];
+        }
+        if (motion.rotation != rotation) {
+            rotation = motion.rotation;
+            cosRotation = cosf(rotation);
+            sinRotation = sinf(rotation);
+        }
+
+        float u, v;
+        transformWarpPoint(&motion, &waves, aspect,
+                           context->warp.vertexValues[MILKY_WARP_VERTEX_X][vertex] * 2.0f - 1.0f,
+                           context->warp.vertexValues[MILKY_WARP_VERTEX_Y][vertex] * 2.0f - 1.0f,
+                           context->warp.vertexValues[MILKY_WARP_VERTEX_RADIUS][vertex], cosRotation, sinRotation, &u, &v);
+
+        context->warp.vertexU[vertex] = toWarpCoordinate(u * (float)width, width);
+        context->warp.vertexV[vertex] = toWarpCoordinate(v * (float)height, height);
+    }
+}
+
+/**
+ * Evaluates the motion exactly for every pixel of a row (without the mesh), for
+ * tables that are computed once and reused, like the displacement maps.
+ *
+ * @param parameters The motion.
+ * @param width      The canvas width in pixels.
+ * @param height     The canvas height in pixels.
+ * @param y          The pixel row.
+ * @param time       Animation time in seconds (drives the warp).
+ * @param u          Receives the horizontal source position of every pixel of the row, in pixels.
+ * @param v          Receives the vertical source positions, in pixels.
+ */
+void evaluateWarpRow(const WarpParameters *parameters, size_t width, size_t height, size_t y, float time, float *u, float *v) {
+    const float aspect = (float)height / (float)width;
+    const WarpWaves waves = getWarpWaves(parameters, time);
+    const float cosRotation = cosf(parameters->rotation), sinRotation = sinf(parameters->rotation);
+    const float oy = (float)y / (float)height * 2.0f - 1.0f;
+
+    for (size_t x = 0; x < width; x++) {
+        const float ox = (float)x / (float)width * 2.0f - 1.0f;
+        const float radius = sqrtf(ox * ox + oy * oy * aspect * aspect) * 0.70710678f;
+        transformWarpPoint(parameters, &waves, aspect, ox, oy, radius, cosRotation, sinRotation, &u[x], &v[x]);
+        u[x] *= (float)width;
+        v[x] *= (float)height;
+    }
+}
+
+/**
+ * Samples the source bilinearly at a 16.16 fixed point position (weights 0..256,
+ * rounded to the nearest 1/256 pixel; the blend is rounded once, at the end).
+ * Positions on the last column / row are sampled as the far end of the cell
+ * before, so the right and the lower neighbor always exist.
+ *
+ * @param source The source frame (RGBA format).
+ * @param width  The width of the source in pixels (at least 2).
+ * @param height The height of the source in pixels (at least 2).
+ * @param u      Horizontal position in 16.16 fixed point, in [0, width - 1].
+ * @param v      Vertical position in 16.16 fixed point, in [0, height - 1].
+ * @param pixel  Receives the RGBA value.
+ */
+static inline void sampleBilinear(const uint8_t *source, size_t width, size_t height, int32_t u, int32_t v, uint8_t *pixel) {
+    size_t x = (size_t)(u >> MILKY_WARP_UV_SHIFT), y = (size_t)(v >> MILKY_WARP_UV_SHIFT);
+    if (x > width - 2) x = width - 2;
+    if (y > height - 2) y = height - 2;
+
+    const uint32_t half = 1u << (MILKY_WARP_UV_SHIFT - 9);
+    const uint32_t fx = ((uint32_t)(u - (int32_t)(x << MILKY_WARP_UV_SHIFT)) + half) >> (MILKY_WARP_UV_SHIFT - 8);
+    const uint32_t fy = ((uint32_t)(v - (int32_t)(y << MILKY_WARP_UV_SHIFT)) + half) >> (MILKY_WARP_UV_SHIFT - 8);
+    const uint8_t *top = &source[(y * width + x) * 4];
+    const uint8_t *bottom = top + width * 4;
+
+#if defined(__AVX2__)
+    // both pixels of a row in one register (p0 | p1), 16-bit lanes: 255 * 256 still fits; the
+    // columns are blended in 32-bit lanes without dropping bits, so the result is rounded once
+    __m128i upper = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)top));
+    __m128i lower = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)bottom));
+    __m128i column = _mm_add_epi16(_mm_mullo_epi16(upper, _mm_set1_epi16((short)(256 - fy))),
+                                   _mm_mullo_epi16(lower, _mm_set1_epi16((short)fy)));
+    __m128i left = _mm_cvtepu16_epi32(column), right = _mm_cvtepu16_epi32(_mm_srli_si128(column, 8));
+    __m128i sum = _mm_add_epi32(_mm_add_epi32(_mm_mullo_epi32(left, _mm_set1_epi32((int)(256 - fx))),
+                                              _mm_mullo_epi32(right, _mm_set1_epi32((int)fx))), _mm_set1_epi32(32768));
+    sum = _mm_packus_epi32(_mm_srli_epi32(sum, 16), _mm_setzero_si128());
+    uint32_t value = (uint32_t)_mm_cvtsi128_si32(_mm_packus_epi16(sum, sum));
+    memcpy(pixel, &value, 4);
+#elif defined(__ARM_NEON__)
+    uint16x8_t upper = vmovl_u8(vld1_u8(top));
+    uint16x8_t lower = vmovl_u8(vld1_u8(bottom));
+    uint16x8_t column = vmlaq_u16(vmulq_u16(upper, vdupq_n_u16((uint16_t)(256 - fy))), lower, vdupq_n_u16((uint16_t)fy));
+    uint32x4_t sum = vmlal_u16(vmull_u16(vget_low_u16(column), vdup_n_u16((uint16_t)(256 - fx))),
+                               vget_high_u16(column), vdup_n_u16((uint16_t)fx));
+    uint16x4_t rounded = vrshrn_n_u32(sum, 16);
+    vst1_lane_u32((uint32_t *)pixel, vreinterpret_u32_u8(vmovn_u16(vcombine_u16(rounded, rounded))), 0);
+#else
+    for (size_t c = 0; c < 4; c++) {
+        uint32_t left = top[c] * (256 - fy) + bottom[c] * fy;
+        uint32_t right = top[c + 4] * (256 - fy) + bottom[c + 4] * fy;
+        pixel[c] = (uint8_t)((left * (256 - fx) + right * fx + 32768) >> 16);
+    }
+#endif
+}
+
+/**
+ * Warps a frame with the mesh of evaluateWarpMesh(). Per pixel row, the vertex
+ * coordinates are interpolated once per vertex column; inside a cell the source
+ * position then advances by a constant fixed point step per pixel, so the per-pixel
+ * work is one bilinear sample, independent of the preset.
+ *
+ * @param destination The warped frame (RGBA format, must not overlap the source).
+ * @param source      The frame to warp.
+ * @param width       The width of both frames in pixels.
+ * @param height      The height of both frames in pixels.
+ */
+void applyWarpMesh(MilkyContext *context, uint8_t *destination, const uint8_t *source, size_t width, size_t height) {
+    if (width < 2 || height < 2 || width != context->warp.width || height != context->warp.height) {
+        memcpy(destination, source, width * height * 4); // no mesh for this canvas size
+        return;
+    }
+
+    // samples outside the frame repeat its edge
+    const int32_t maxU = (int32_t)((width - 1) << MILKY_WARP_UV_SHIFT);
+    const int32_t maxV = (int32_t)((height - 1) << MILKY_WARP_UV_SHIFT);
+
+    #pragma omp parallel for schedule(static)
+    for (int y = 0; y < (int)height; y++) {
+        // cell row of this pixel row (rows of tiny canvases may skip cells)
+        size_t j = (size_t)y * MILKY_WARP_GRID_HEIGHT / height;
+        while (j + 1 < MILKY_WARP_GRID_HEIGHT && context->warp.rowY[j + 1] <= (size_t)y) j++;
+        while (j > 0 && context->warp.rowY[j] > (size_t)y) j--;
+
+        const int64_t rowOffset = (int64_t)y - (int64_t)context->warp.rowY[j];
+        const int64_t rowHeight = (int64_t)context->warp.rowY[j + 1] - (int64_t)context->warp.rowY[j];
+        const int32_t *topU = &context->warp.vertexU[j * (MILKY_WARP_GRID_WIDTH + 1)];
+        const int32_t *topV = &context->warp.vertexV[j * (MILKY_WARP_GRID_WIDTH + 1)];
+        const int32_t *bottomU = topU + MILKY_WARP_GRID_WIDTH + 1;
+        const int32_t *bottomV = topV + MILKY_WARP_GRID_WIDTH + 1;
+
+        // vertex coordinates interpolated to this pixel row
+        int32_t rowU[MILKY_WARP_GRID_WIDTH + 1], rowV[MILKY_WARP_GRID_WIDTH + 1];
+        for (size_t i = 0; i <= MILKY_WARP_GRID_WIDTH; i++) {
+            rowU[i] = topU[i] + (int32_t)(((int64_t)bottomU[i] - topU[i]) * rowOffset / rowHeight);
+            rowV[i] = topV[i] + (int32_t)(((int64_t)bottomV[i] - topV[i]) * rowOffset / rowHeight);
+        }
+
+        uint8_t *row = &destination[(size_t)y * width * 4];
+        for (size_t i = 0; i < MILKY_WARP_GRID_WIDTH; i++) {
+            const size_t xStart = context->warp.columnX[i], xEnd = context->warp.columnX[i + 1];
+            if (xEnd == xStart) continue;
+
+            const int64_t cellWidth = (int64_t)(xEnd - xStart);
+            const int32_t stepU = (int32_t)(((int64_t)rowU[i + 1] - rowU[i]) / cellWidth);
+            const int32_t stepV = (int32_t)(((int64_t)rowV[i + 1] - rowV[i]) / cellWidth);
+            int32_t u = rowU[i], v = rowV[i];
+
+            for (size_t x = xStart; x < xEnd; x++) {
+                int32_t sampleU = u < 0 ? 0 : (u > maxU ? maxU : u);
+                int32_t sampleV = v < 0 ? 0 : (v > maxV ? maxV : v);
+                sampleBilinear(source, width, height, sampleU, sampleV, &row[x * 4]);
+                u += stepU;
+                v += stepV;
+            }
+        }
+    }
+}
@@ -0,0 +1,111 @@
+#ifndef WARP_H
+#define WARP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <omp.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#ifdef __ARM_NEON__
+#include <arm_neon.h>
+#endif
+
+#include "../preset.h"
+#include "../expr.h"
+#include "../milky.h"
+
+#define MILKY_WARP_GRID_WIDTH 48  // mesh cells per row (Milkdrop's default mesh size)
+#define MILKY_WARP_GRID_HEIGHT 36 // mesh cells per column
+#define MILKY_WARP_UV_SHIFT 16    // source coordinates are interpolated in 16.16 fixed point
+#define MILKY_WARP_INPUT_COUNT 5  // fields of WarpInputs
+#define MILKY_WARP_MOTION_COUNT 10 // motion variables the equations can change (zoom, zoomexp, rot, warp, cx, cy, dx, dy, sx, sy)
+
+// preset properties that enable the mesh warp (presets without any of them keep rotate() / scale())
+#define MILKY_WARP_PROPERTY_MASK ( \
+    (1ULL << MILKY_PRESET_ZOOM) | (1ULL << MILKY_PRESET_ZOOM_EXPONENT) | (1ULL << MILKY_PRESET_ROTATION) | \
+    (1ULL << MILKY_PRESET_WARP) | (1ULL << MILKY_PRESET_DX) | (1ULL << MILKY_PRESET_DY) | \
+    (1ULL << MILKY_PRESET_SX) | (1ULL << MILKY_PRESET_SY))
+
+// per-frame motion of the feedback image, evaluated on the mesh vertices
+typedef struct {
+    float zoom;         // > 1 zooms in, < 1 zooms out (per frame)
+    float zoomExponent; // bends the zoom towards the center (< 1) or the edges (> 1)
+    float rotation;     // rotation around (centerX, centerY) in radians per frame
+    float warp;         // strength of the animated warp
+    float warpSpeed;    // animation speed of the warp
+    float warpScale;    // size of the warp's waves (larger = smoother)
+    float dx;           // horizontal translation (fraction of the width, per frame)
+    float dy;           // vertical translation (fraction of the height, per frame)
+    float sx;           // horizontal stretch around centerX
+    float sy;           // vertical stretch around centerY
+    float centerX;      // center of rotation and stretch [0, 1]
+    float centerY;
+} WarpParameters;
+
+// read-only inputs of the preset equations
+typedef struct {
+    float time;   // seconds
+    float frame;  // frames rendered so far
+    float bass;   // band levels of the frame (see EffectContext)
+    float mid;
+    float treble; // "treb" in the equations
+} WarpInputs;
+
+// per-vertex equations of a preset and the per-frame state they can read
+typedef struct {
+    const ExprProgram *program;      // per-vertex equations
+    const ExprProgram *frameProgram; // per-frame equations (NULL = none)
+    const float *frameVariables;     // values of the per-frame variables after this frame's run
+    const WarpInputs *inputs;
+} WarpVertexEquations;
+
+#define MILKY_WARP_VERTEX_COUNT ((MILKY_WARP_GRID_WIDTH + 1) * (MILKY_WARP_GRID_HEIGHT + 1))
+
+// per-vertex variables, stored as one column per variable (the layout runExprProgramBatch() works on)
+enum {
+    MILKY_WARP_VERTEX_X = 0,
+    MILKY_WARP_VERTEX_Y,
+    MILKY_WARP_VERTEX_RADIUS,
+    MILKY_WARP_VERTEX_ANGLE,
+    MILKY_WARP_VERTEX_MOTION, // followed by the motion variables, in the order of milky_warpMotionVariables
+    MILKY_WARP_VERTEX_ZOOM = MILKY_WARP_VERTEX_MOTION,
+    MILKY_WARP_VERTEX_ZOOM_EXPONENT,
+    MILKY_WARP_VERTEX_ROTATION,
+    MILKY_WARP_VERTEX_WARP,
+    MILKY_WARP_VERTEX_CENTER_X,
+    MILKY_WARP_VERTEX_CENTER_Y,
+    MILKY_WARP_VERTEX_DX,
+    MILKY_WARP_VERTEX_DY,
+    MILKY_WARP_VERTEX_SX,
+    MILKY_WARP_VERTEX_SY,
+    MILKY_WARP_VERTEX_VARIABLE_COUNT
+};
+
+// mesh of a context
+typedef struct {
+    // source coordinates of the mesh vertices in 16.16 fixed point pixels (row by row)
+    int32_t vertexU[MILKY_WARP_VERTEX_COUNT];
+    int32_t vertexV[MILKY_WARP_VERTEX_COUNT];
+
+    // pixel position of every vertex column / row for the canvas size the mesh was evaluated for
+    size_t columnX[MILKY_WARP_GRID_WIDTH + 1];
+    size_t rowY[MILKY_WARP_GRID_HEIGHT + 1];
+    size_t width;
+    size_t height;
+
+    // per-vertex variables of the last evaluation (see the enum above)
+    float vertexValues[MILKY_WARP_VERTEX_VARIABLE_COUNT][MILKY_WARP_VERTEX_COUNT];
+} WarpState;
+
+WarpParameters getWarpParameters(const Preset *preset);
+void runWarpFrameEquations(const ExprProgram *program, float *variables, const WarpInputs *inputs, WarpParameters *parameters);
+void evaluateWarpMesh(MilkyContext *context, const WarpParameters *parameters, size_t width, size_t height, float time, const WarpVertexEquations *equations);
+void evaluateWarpRow(const WarpParameters *parameters, size_t width, size_t height, size_t y, float time, float *u, float *v);
+void applyWarpMesh(MilkyContext *context, uint8_t *destination, const uint8_t *source, size_t width, size_t height);
+
+#endif // WARP_H
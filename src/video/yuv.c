@@ -0,0 +1,124 @@
+#include "yuv.h"
+
+// BT.601 limited range with the usual integer coefficients: 7 bit for the luma (so the
+// coefficients fit into signed bytes for _mm256_maddubs_epi16), 8 bit for the chroma
+static inline uint8_t toLuma(const uint8_t *pixel) {
+    return (uint8_t)(((33 * pixel[0] + 64 * pixel[1] + 13 * pixel[2] + 64) >> 7) + 16);
+}
+
+static inline uint8_t toChromaU(const uint8_t *pixel) {
+    return (uint8_t)((112 * pixel[2] - 74 * pixel[1] - 38 * pixel[0] + 0x8080) >> 8);
+}
+
+static inline uint8_t toChromaV(const uint8_t *pixel) {
+    return (uint8_t)((112 * pixel[0] - 94 * pixel[1] - 18 * pixel[2] + 0x8080) >> 8);
+}
+
+/**
+ * Averages the 2x2 block of a chroma sample (rows first, then columns, rounding up
+ * like _mm256_avg_epu8, so the scalar and the SIMD paths agree exactly).
+ */
+static inline void averageChromaBlock(const uint8_t *row0, const uint8_t *row1, size_t x, size_t width, uint8_t *average) {
+    const size_t x1 = x + 1 < width ? x + 1 : x;
+    for (size_t c = 0; c < 3; c++) {
+        const unsigned left = (row0[x * 4 + c] + row1[x * 4 + c] + 1) >> 1;
+        const unsigned right = (row0[x1 * 4 + c] + row1[x1 * 4 + c] + 1) >> 1;
+        average[c] = (uint8_t)((left + right + 1) >> 1);
+    }
+}
+
+#if defined(__AVX2__)
+// converts 32 pixels to luma
+static inline void convertLumaAVX2(const uint8_t *rgba, uint8_t *y) {
+    const __m256i coefficients = _mm256_set1_epi32(0x000d4021); // 33, 64, 13, 0
+    const __m256i rounding = _mm256_set1_epi16(64);
+    const __m256i offset = _mm256_set1_epi16(16);
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+    __m256i sums[4];
+    for (int i = 0; i < 4; i++) {
+        sums[i] = _mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i *)(rgba + i * 32)), coefficients);
+    }
+    __m256i low = _mm256_add_epi16(_mm256_srai_epi16(_mm256_add_epi16(_mm256_hadd_epi16(sums[0], sums[1]), rounding), 7), offset);
+    __m256i high = _mm256_add_epi16(_mm256_srai_epi16(_mm256_add_epi16(_mm256_hadd_epi16(sums[2], sums[3]), rounding), 7), offset);
+
+    // hadd and pack work per 128-bit lane, the permutation restores the pixel order
+    _mm256_storeu_si256((__m256i *)y, _mm256_permutevar8x32_epi32(_mm256_packus_epi16(low, high), order));
+}
+
+// converts 2 rows of 32 pixels to 16 chroma samples each of u and v
+static inline void convertChromaAVX2(const uint8_t *row0, const uint8_t *row1, uint8_t *u, uint8_t *v) {
+    const __m256i uCoefficients = _mm256_set1_epi32(0x0070b6da); // -38, -74, 112, 0
+    const __m256i vCoefficients = _mm256_set1_epi32(0x00eea270); // 112, -94, -18, 0
+    const __m256i offset = _mm256_set1_epi16((short)0x8080);
+    const __m256i evenFirst = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+    // average the rows, then each pixel with its neighbor; the even pixels hold the 2x2 averages
+    __m256i even[4];
+    for (int i = 0; i < 4; i++) {
+        __m256i rows = _mm256_avg_epu8(_mm256_loadu_si256((const __m256i *)(row0 + i * 32)),
+                                       _mm256_loadu_si256((const __m256i *)(row1 + i * 32)));
+        rows = _mm256_avg_epu8(rows, _mm256_shuffle_epi32(rows, _MM_SHUFFLE(2, 3, 0, 1)));
+        even[i] = _mm256_permutevar8x32_epi32(rows, evenFirst);
+    }
+    const __m256i blocks0 = _mm256_permute2x128_si256(even[0], even[1], 0x20);
+    const __m256i blocks1 = _mm256_permute2x128_si256(even[2], even[3], 0x20);
+
+    // the sums wrap around in 16 bits, the offset moves them into [0, 65535] (logical shift)
+    __m256i uSum = _mm256_hadd_epi16(_mm256_maddubs_epi16(blocks0, uCoefficients), _mm256_maddubs_epi16(blocks1, uCoefficients));
+    __m256i vSum = _mm256_hadd_epi16(_mm256_maddubs_epi16(blocks0, vCoefficients), _mm256_maddubs_epi16(blocks1, vCoefficients));
+    uSum = _mm256_srli_epi16(_mm256_add_epi16(uSum, offset), 8);
+    vSum = _mm256_srli_epi16(_mm256_add_epi16(vSum, offset), 8);
+
+    const __m256i packed = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(uSum, vSum), order);
+    _mm_storeu_si128((__m128i *)u, _mm256_castsi256_si128(packed));
+    _mm_storeu_si128((__m128i *)v, _mm256_extracti128_si256(packed, 1));
+}
+#endif
+
+/**
+ * Converts an RGBA frame to planar YUV 4:2:0 (I420, BT.601 limited range), the
+ * format video encoders take. Chroma is the average of each 2x2 block.
+ *
+ * @param rgba   The frame (RGBA format).
+ * @param width  Its width in pixels.
+ * @param height Its height in pixels.
+ * @param y      Receives the luma plane (width * height bytes).
+ * @param u      Receives the blue difference plane (MILKY_YUV_CHROMA_SIZE(width) * MILKY_YUV_CHROMA_SIZE(height) bytes).
+ * @param v      Receives the red difference plane (same size).
+ */
+void convertRgbaToI420(const uint8_t *rgba, size_t width, size_t height, uint8_t *y, uint8_t *u, uint8_t *v) {
+    const size_t chromaWidth = MILKY_YUV_CHROMA_SIZE(width);
+    const size_t chromaHeight = MILKY_YUV_CHROMA_SIZE(height);
+
+    #pragma omp parallel for schedule(static)
+    for (size_t chromaY = 0; chromaY < chromaHeight; chromaY++) {
+        const size_t y0 = chromaY * 2;
+        const size_t y1 = y0 + 1 < height ? y0 + 1 : y0;
+        const uint8_t *row0 = rgba + y0 * width * 4;
+        const uint8_t *row1 = rgba + y1 * width * 4;
+        uint8_t *uRow = u + chromaY * chromaWidth;
+        uint8_t *vRow = v + chromaY * chromaWidth;
+
+        size_t x = 0;
+        #if defined(__AVX2__)
+        for (; x + 32 <= width; x += 32) {
+            convertLumaAVX2(row0 + x * 4, y + y0 * width + x);
+            if (y1 != y0) convertLumaAVX2(row1 + x * 4, y + y1 * width + x);
+            convertChromaAVX2(row0 + x * 4, row1 + x * 4, uRow + x / 2, vRow + x / 2);
+        }
+        #endif
+
+        for (size_t lumaX = x; lumaX < width; lumaX++) {
+            y[y0 * width + lumaX] = toLuma(row0 + lumaX * 4);
+            y[y1 * width + lumaX] = toLuma(row1 + lumaX * 4);
+        }
+        for (; x < width; x += 2) {
+            uint8_t average[3];
+            averageChromaBlock(row0, row1, x, width, average);
+            uRow[x / 2] = toChromaU(average);
+            vRow[x / 2] = toChromaV(average);
+        }
+    }
+}
@@ -0,0 +1,17 @@
+#ifndef YUV_H
+#define YUV_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <omp.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// size of the chroma planes of a 4:2:0 frame (odd sizes round up)
+#define MILKY_YUV_CHROMA_SIZE(size) (((size) + 1) / 2)
+
+void convertRgbaToI420(const uint8_t *rgba, size_t width, size_t height, uint8_t *y, uint8_t *u, uint8_t *v);
+
+#endif // YUV_H
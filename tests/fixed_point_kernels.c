@@ -0,0 +1,325 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <omp.h>
+
+#include "../src/context.h"
+#include "../src/video/blur.h"
+#include "../src/video/fixed.h"
+#include "../src/video/palette.h"
+
+// the float kernel of blur.c, compiled a second time without MILKY_FIXED_POINT_KERNELS
+// under another name (see CMakeLists.txt)
+void milky_floatBlurFrame(uint8_t *prevFrame, size_t frameSize, size_t step, float factor);
+
+// the float kernels write up to two bytes past the last visited pixel (steps 1 and 2)
+#define MILKY_TEST_FRAME_SLACK 2
+
+// largest difference the fixed-point kernels may have to the float ones
+#define MILKY_TEST_TOLERANCE 1
+
+static size_t milky_testFailures = 0;
+
+/**
+ * Compares the output of a fixed-point kernel with its float reference byte by byte.
+ *
+ * @param kernel    Name of the kernel (for the report).
+ * @param fixed     Output of the fixed-point kernel.
+ * @param reference Output of the float kernel.
+ * @param count     Number of bytes.
+ * @param detail    Parameters of the case (for the report).
+ */
+static void expectWithinTolerance(const char *kernel, const uint8_t *fixed, const uint8_t *reference, size_t count, const char *detail) {
+    for (size_t i = 0; i < count; i++) {
+        int difference = abs((int)fixed[i] - (int)reference[i]);
+        if (difference > MILKY_TEST_TOLERANCE) {
+            fprintf(stderr, "%s (%s): byte %zu is %u, the float kernel gives %u\n", kernel, detail, i, fixed[i], reference[i]);
+            milky_testFailures++;
+            return;
+        }
+    }
+}
+
+/**
+ * Fills a buffer with reproducible pseudo-random bytes (xorshift).
+ */
+static void fillRandom(uint8_t *buffer, size_t count, uint32_t seed) {
+    uint32_t state = seed ? seed : 1;
+    for (size_t i = 0; i < count; i++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        buffer[i] = (uint8_t)(state >> 24);
+    }
+}
+
+/**
+ * blurFrame(): steps 1-17 (step 1 and 2 fade bytes repeatedly, through the overlapping
+ * lane masks) on frames with and without a partial last block.
+ */
+static void testBlurFrame(void) {
+    static const size_t frameSizes[] = { 3, 17, 64, 100, 1024, 4099, 320 * 180 * 4 };
+    static const float factors[] = { 0.0f, 0.25f, 0.5f, 0.9f, 0.95f, 0.99f };
+
+    for (size_t s = 0; s < sizeof(frameSizes) / sizeof(frameSizes[0]); s++) {
+        const size_t frameSize = frameSizes[s];
+        uint8_t *fixed = (uint8_t *)malloc(frameSize + MILKY_TEST_FRAME_SLACK);
+        uint8_t *reference = (uint8_t *)malloc(frameSize + MILKY_TEST_FRAME_SLACK);
+        if (!fixed || !reference) {
+            fprintf(stderr, "Failed to allocate a %zu byte frame\n", frameSize);
+            exit(EXIT_FAILURE);
+        }
+
+        for (size_t step = 1; step <= 17; step++) {
+            for (size_t f = 0; f < sizeof(factors) / sizeof(factors[0]); f++) {
+                fillRandom(fixed, frameSize + MILKY_TEST_FRAME_SLACK, (uint32_t)(frameSize * 31 + step * 7 + f));
+                memcpy(reference, fixed, frameSize + MILKY_TEST_FRAME_SLACK);
+
+                blurFrame(fixed, frameSize, step, factors[f]);
+                milky_floatBlurFrame(reference, frameSize, step, factors[f]);
+
+                char detail[64];
+                snprintf(detail, sizeof(detail), "%zu bytes, step %zu, factor %.2f", frameSize, step, factors[f]);
+                expectWithinTolerance("blurFrame", fixed, reference, frameSize, detail);
+            }
+        }
+
+        free(fixed);
+        free(reference);
+    }
+}
+
+/**
+ * blendFixed(): all pairs of channel values for a sweep of weights (the 65536 pairs
+ * also cover the SIMD blocks and, with an odd count, the scalar tail).
+ */
+static void testBlendFixed(void) {
+    const size_t count = 256 * 256 + 7;
+    uint8_t *destination = (uint8_t *)malloc(count);
+    uint8_t *source = (uint8_t *)malloc(count);
+    uint8_t *reference = (uint8_t *)malloc(count);
+    if (!destination || !source || !reference) {
+        fprintf(stderr, "Failed to allocate the blend buffers\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int w = 0; w <= 100; w++) {
+        const float alpha = w == 100 ? 0.7f : (float)w / 99.0f; // 0.7 = rotate()
+        for (size_t i = 0; i < count; i++) {
+            destination[i] = (uint8_t)(i >> 8);
+            source[i] = (uint8_t)i;
+            // the float blend of rotate()
+            reference[i] = (uint8_t)(destination[i] * (1 - alpha) + source[i] * alpha);
+        }
+
+        blendFixed(destination, source, count, toFixed(alpha));
+
+        char detail[32];
+        snprintf(detail, sizeof(detail), "weight %.3f", alpha);
+        expectWithinTolerance("blendFixed", destination, reference, count, detail);
+    }
+
+    free(destination);
+    free(source);
+    free(reference);
+}
+
+/**
+ * The palette transition: lerpFixed() of all pairs of palette channels at every
+ * step of a transition.
+ */
+static void testPaletteLerp(void) {
+    for (int step = 0; step <= MILKY_PALETTE_DEFAULT_TRANSITION_STEPS; step++) {
+        const float t = (float)step / (float)MILKY_PALETTE_DEFAULT_TRANSITION_STEPS;
+        const float oneMinusT = 1.0f - t;
+        const uint16_t weight = toFixed(t);
+
+        uint8_t fixed[256 * 256], reference[256 * 256];
+        for (int from = 0; from < 256; from++) {
+            for (int to = 0; to < 256; to++) {
+                fixed[from * 256 + to] = lerpFixed((uint8_t)from, (uint8_t)to, weight);
+                // the float blend of applyPaletteToCanvas()
+                reference[from * 256 + to] = (uint8_t)((oneMinusT * (uint8_t)from) + (t * (uint8_t)to));
+            }
+        }
+
+        char detail[32];
+        snprintf(detail, sizeof(detail), "step %d", step);
+        expectWithinTolerance("lerpFixed", fixed, reference, sizeof(fixed), detail);
+    }
+}
+
+/**
+ * reduceBitDepth(): the integer quantization (x / 255 as a shift, the rescale as a
+ * Q8.8 multiply) against the float formula with the same dither thresholds, for
+ * the bit depths in use and odd ones, on rows with full tiles and a partial one.
+ */
+static void testReduceBitDepth(MilkyContext *context) {
+    static const uint8_t bitDepths[] = { 3, 6, 8, 9, 12, 15, 16, 18, 21 };
+    const size_t width = MILKY_DITHER_TILE_SIZE * 9 + 5, height = MILKY_DITHER_TILE_SIZE * 2;
+    const size_t frameSize = width * height * 4;
+    uint8_t *fixed = (uint8_t *)malloc(frameSize);
+    uint8_t *reference = (uint8_t *)malloc(frameSize);
+    if (!fixed || !reference) {
+        fprintf(stderr, "Failed to allocate the bit depth frames\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t d = 0; d < sizeof(bitDepths) / sizeof(bitDepths[0]); d++) {
+        for (int pattern = 0; pattern < 2; pattern++) {
+            // random bytes, then every value on every position of the tile
+            if (pattern == 0) {
+                fillRandom(fixed, frameSize, (uint32_t)bitDepths[d] * 131);
+            } else {
+                for (size_t i = 0; i < frameSize; i++) fixed[i] = (uint8_t)(i / 4 + i / (width * 4));
+            }
+            memcpy(reference, fixed, frameSize);
+
+            reduceBitDepth(context, fixed, width, height, bitDepths[d]);
+
+            // the float quantization with the tables the kernel was built with
+            for (size_t y = 0; y < height; y++) {
+                for (size_t i = 0; i < width * 4; i++) {
+                    const size_t byte = i % (MILKY_DITHER_TILE_SIZE * 4);
+                    const float levels = (float)context->bitdepth.levels[byte];
+                    const float threshold = (float)context->bitdepth.thresholds[y % MILKY_DITHER_TILE_SIZE][byte];
+                    uint8_t *value = &reference[y * width * 4 + i];
+                    const float level = floorf(((float)*value * levels + threshold) / 255.0f);
+                    const long rescaled = lrintf(level * 255.0f / levels);
+                    *value = (uint8_t)(rescaled > 255 ? 255 : rescaled);
+                }
+            }
+
+            char detail[48];
+            snprintf(detail, sizeof(detail), "%u bit, pattern %d", bitDepths[d], pattern);
+            expectWithinTolerance("reduceBitDepth", fixed, reference, frameSize, detail);
+        }
+    }
+
+    free(fixed);
+    free(reference);
+}
+
+/**
+ * Samples a frame bilinearly in float (exact weights, rounded), clamping the position
+ * to the frame like the warp does.
+ */
+static void sampleBilinearFloat(const uint8_t *source, size_t width, size_t height, float u, float v, uint8_t *pixel) {
+    if (u < 0.0f) u = 0.0f;
+    if (u > (float)(width - 1)) u = (float)(width - 1);
+    if (v < 0.0f) v = 0.0f;
+    if (v > (float)(height - 1)) v = (float)(height - 1);
+
+    size_t x = (size_t)u, y = (size_t)v;
+    if (x > width - 2) x = width - 2;
+    if (y > height - 2) y = height - 2;
+    const float fx = u - (float)x, fy = v - (float)y;
+
+    const uint8_t *top = &source[(y * width + x) * 4];
+    const uint8_t *bottom = top + width * 4;
+    for (size_t c = 0; c < 4; c++) {
+        const float left = (float)top[c] * (1.0f - fy) + (float)bottom[c] * fy;
+        const float right = (float)top[c + 4] * (1.0f - fy) + (float)bottom[c + 4] * fy;
+        pixel[c] = (uint8_t)lrintf(left * (1.0f - fx) + right * fx);
+    }
+}
+
+/**
+ * applyWarpMesh(): the 16.16 interpolation of the mesh and the 8-bit bilinear
+ * weights against a float walk over the same mesh, for a still image and for
+ * motions with zoom, rotation, translation, stretch and the animated warp.
+ */
+static void testWarpSampling(MilkyContext *context) {
+    static const size_t sizes[][2] = { { 64, 36 }, { 97, 53 }, { 320, 180 } };
+    static const WarpParameters motions[] = {
+        // zoom, zoom exponent, rotation, warp, warp speed, warp scale, dx, dy, sx, sy, center x, center y
+        { 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.5f, 0.5f },
+        { 1.1f, 1.0f, 0.1f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.5f, 0.5f },
+        { 0.95f, 1.3f, -0.05f, 0.0f, 1.0f, 1.0f, 0.01f, -0.02f, 1.02f, 0.98f, 0.4f, 0.6f },
+        { 1.0f, 1.0f, 0.0f, 0.8f, 1.0f, 1.5f, 0.0f, 0.0f, 1.0f, 1.0f, 0.5f, 0.5f }
+    };
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        const size_t width = sizes[s][0], height = sizes[s][1];
+        const size_t frameSize = width * height * 4;
+        uint8_t *source = (uint8_t *)malloc(frameSize);
+        uint8_t *fixed = (uint8_t *)malloc(frameSize);
+        uint8_t *reference = (uint8_t *)malloc(frameSize);
+        if (!source || !fixed || !reference) {
+            fprintf(stderr, "Failed to allocate the warp frames\n");
+            exit(EXIT_FAILURE);
+        }
+        fillRandom(source, frameSize, (uint32_t)(width * 17 + height));
+
+        for (size_t m = 0; m < sizeof(motions) / sizeof(motions[0]); m++) {
+            evaluateWarpMesh(context, &motions[m], width, height, 1.0f, NULL);
+            applyWarpMesh(context, fixed, source, width, height);
+
+            // the same mesh, interpolated in float
+            for (size_t y = 0; y < height; y++) {
+                size_t j = 0;
+                while (context->warp.rowY[j + 1] <= y) j++;
+                const float t = (float)(y - context->warp.rowY[j]) / (float)(context->warp.rowY[j + 1] - context->warp.rowY[j]);
+
+                for (size_t x = 0; x < width; x++) {
+                    size_t i = 0;
+                    while (context->warp.columnX[i + 1] <= x) i++;
+                    const float r = (float)(x - context->warp.columnX[i]) / (float)(context->warp.columnX[i + 1] - context->warp.columnX[i]);
+
+                    float corners[2][2];
+                    for (int k = 0; k < 2; k++) {
+                        const size_t top = j * (MILKY_WARP_GRID_WIDTH + 1) + i + (size_t)k;
+                        const size_t bottom = top + MILKY_WARP_GRID_WIDTH + 1;
+                        corners[0][k] = ((float)context->warp.vertexU[top] * (1.0f - t) + (float)context->warp.vertexU[bottom] * t) / 65536.0f;
+                        corners[1][k] = ((float)context->warp.vertexV[top] * (1.0f - t) + (float)context->warp.vertexV[bottom] * t) / 65536.0f;
+                    }
+                    sampleBilinearFloat(source, width, height,
+                                        corners[0][0] * (1.0f - r) + corners[0][1] * r,
+                                        corners[1][0] * (1.0f - r) + corners[1][1] * r,
+                                        &reference[(y * width + x) * 4]);
+                }
+            }
+
+            char detail[48];
+            snprintf(detail, sizeof(detail), "%zux%zu, motion %zu", width, height, m);
+            expectWithinTolerance("applyWarpMesh", fixed, reference, frameSize, detail);
+        }
+
+        free(source);
+        free(fixed);
+        free(reference);
+    }
+}
+
+/**
+ * Checks the fixed-point kernels (MILKY_FIXED_POINT_KERNELS) against the float
+ * kernels they replace, and the integer bit depth and warp kernels against float
+ * references: every byte must be within 1 LSB.
+ */
+int main(void) {
+    // the float fade races on the overlapping pixels of steps 1 and 2 with several threads
+    omp_set_num_threads(1);
+
+    testBlurFrame();
+    testBlendFixed();
+    testPaletteLerp();
+
+    // the bit depth and warp kernels keep their tables in a context
+    MilkyContext *context = (MilkyContext *)calloc(1, sizeof(MilkyContext));
+    if (!context) {
+        fprintf(stderr, "Failed to allocate a context\n");
+        return EXIT_FAILURE;
+    }
+    testReduceBitDepth(context);
+    testWarpSampling(context);
+    free(context);
+
+    if (milky_testFailures > 0) {
+        fprintf(stderr, "%zu fixed-point kernel cases differ by more than %d LSB\n", milky_testFailures, MILKY_TEST_TOLERANCE);
+        return EXIT_FAILURE;
+    }
+    printf("fixed-point kernels are within %d LSB of the float kernels\n", MILKY_TEST_TOLERANCE);
+    return EXIT_SUCCESS;
+}
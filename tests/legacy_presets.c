@@ -0,0 +1,108 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "../src/context.h"
+#include "../src/preset.h"
+
+#define MILKY_TEST_PRESETS 2
+#define MILKY_TEST_FRAMES 4
+#define MILKY_TEST_CHUNK 1470 // samples per frame at 44.1 kHz and 30 fps
+
+static size_t milky_testFailures = 0;
+
+/**
+ * Reports a failed expectation.
+ */
+static void expect(int condition, const char *description) {
+    if (!condition) {
+        fprintf(stderr, "%s\n", description);
+        milky_testFailures++;
+    }
+}
+
+/**
+ * Fills a flattened preset buffer in the legacy layout: the classic properties, the
+ * rest of every section zeroed (zoom, sx and sy would be 0 if they were read).
+ */
+static void fillLegacyBuffer(float *buffer) {
+    memset(buffer, 0, MILKY_TEST_PRESETS * MILKY_MAX_PROPERTY_COUNT_PER_PRESET * sizeof(float));
+    for (size_t i = 0; i < MILKY_TEST_PRESETS; i++) {
+        float *section = buffer + i * MILKY_MAX_PROPERTY_COUNT_PER_PRESET;
+        section[MILKY_PRESET_DAMPING] = 0.9f;
+        section[MILKY_PRESET_EFFECT_CHASERS] = 1.0f;
+        section[MILKY_PRESET_EFFECT_DOTS] = (float)i;
+        section[MILKY_PRESET_GAMMA] = 1.0f;
+        section[MILKY_PRESET_X_CENTER] = 0.5f;
+        section[MILKY_PRESET_Y_CENTER] = 0.5f;
+    }
+}
+
+/**
+ * Parsing: only the properties of a legacy section are defined, none of the warp mesh.
+ */
+static void testLegacyDefinedMask(void) {
+    for (size_t i = 0; i < MILKY_TEST_PRESETS; i++) {
+        const Preset *preset = getPreset(i);
+        expect(preset != NULL, "a preset of the legacy buffer is missing");
+        if (!preset) continue;
+
+        expect((preset->definedMask & MILKY_WARP_PROPERTY_MASK) == 0, "a legacy preset defines warp mesh properties");
+        expect(getPresetRecordValue(preset, MILKY_PRESET_ZOOM, 1.0f) == 1.0f, "a legacy preset reads zoom from the padding");
+        expect(getPresetRecordValue(preset, MILKY_PRESET_DAMPING, 0.0f) == 0.9f, "a legacy preset lost its damping");
+    }
+}
+
+/**
+ * Rendering: frames of a legacy preset take the classic rotate / zoom path and never
+ * evaluate the warp mesh.
+ */
+static void testLegacyRender(void) {
+    MilkyContextOptions options = milky_context_default_options();
+    options.width = 160;
+    options.height = 90;
+    options.threads = 1;
+    MilkyContext *context = milky_context_create(&options);
+    if (!context) {
+        fprintf(stderr, "Failed to create a context\n");
+        exit(EXIT_FAILURE);
+    }
+
+    uint8_t audio[MILKY_TEST_CHUNK * 2];
+    for (size_t frame = 0; frame < MILKY_TEST_FRAMES; frame++) {
+        for (size_t i = 0; i < MILKY_TEST_CHUNK; i++) {
+            audio[2 * i] = audio[2 * i + 1] = (uint8_t)(128.0f + 100.0f * sinf((float)(frame * MILKY_TEST_CHUNK + i) * 0.05f));
+        }
+        milky_context_analyze(context, audio, sizeof(audio), frame * 33);
+        milky_context_render(context, audio, sizeof(audio), frame * 33);
+    }
+
+    const DisplayMotion motion = getContextFrameMotion(context);
+    const DisplayMotion still = getStaticDisplayMotion();
+    expect(context->warp.width == 0, "a legacy preset evaluated the warp mesh");
+    expect(memcmp(&motion, &still, sizeof(motion)) == 0, "a legacy preset reported the motion of the warp mesh");
+
+    milky_context_destroy(context);
+}
+
+/**
+ * Checks that presets of a legacy flattened buffer (parseFlattenedPresetBuffer()) keep
+ * the classic motion instead of switching to the warp mesh.
+ */
+int main(void) {
+    float buffer[MILKY_TEST_PRESETS * MILKY_MAX_PROPERTY_COUNT_PER_PRESET];
+    fillLegacyBuffer(buffer);
+    parseFlattenedPresetBuffer(buffer, sizeof(buffer) / sizeof(buffer[0]));
+
+    testLegacyDefinedMask();
+    testLegacyRender();
+
+    if (milky_testFailures > 0) {
+        fprintf(stderr, "%zu legacy preset checks failed\n", milky_testFailures);
+        return EXIT_FAILURE;
+    }
+    printf("legacy presets keep the classic motion\n");
+    return EXIT_SUCCESS;
+}